@@ -118,6 +118,30 @@ extern "C" {
 #define BOR_STRDUP(str) \
     _BOR_STRDUP(str)
 
+/**
+ * Allocates one element of given type from the memory pool (see
+ * mempool.h). If {pool} is NULL, BOR_ALLOC() is used instead.
+ */
+#define BOR_POOL_ALLOC(pool, type) \
+    ((pool) ? (type *)borMemPoolAlloc((pool), sizeof(type)) : BOR_ALLOC(type))
+
+/**
+ * Returns the element allocated by BOR_POOL_ALLOC() back to the pool (or
+ * frees it by BOR_FREE() if {pool} is NULL).
+ */
+#define BOR_POOL_FREE(pool, type, ptr) \
+    do { \
+        if (pool){ \
+            borMemPoolFree((pool), (ptr), sizeof(type)); \
+        }else{ \
+            BOR_FREE(ptr); \
+        } \
+    } while (0)
+
+struct _bor_mempool_t;
+void *borMemPoolAlloc(struct _bor_mempool_t *pool, size_t size);
+void borMemPoolFree(struct _bor_mempool_t *pool, void *ptr, size_t size);
+
 
 #ifdef BOR_MEMCHECK
 void *borRealloc(void *ptr, size_t size,
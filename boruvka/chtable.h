@@ -0,0 +1,147 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_CHTABLE_H__
+#define __BOR_CHTABLE_H__
+
+#include <pthread.h>
+#include <boruvka/core.h>
+#include <boruvka/ebr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Concurrent Hash Table
+ * ======================
+ *
+ * See bor_chtable_t.
+ *
+ * Hash table that can be shared between threads (e.g., workers of
+ * bor_task_pool_t) without any external locking. It is designed for
+ * dedup and visited-set workloads, i.e., many lookups and "insert if not
+ * there" operations.
+ *
+ * Keys and values of fixed size are copied into the table. Lookups are
+ * lock-free: they only traverse the bucket chains. Inserts and erases
+ * lock one of BOR_CHTABLE_STRIPES mutexes (chosen by the hash of the key)
+ * so writers of different stripes do not contend. The table doubles its
+ * number of buckets when it holds more elements than buckets; the resize
+ * builds a new bucket array while all stripes are locked and publishes
+ * it at once, so concurrent lookups are never blocked. Erased elements
+ * and replaced bucket arrays are freed using epoch-based reclamation
+ * (see bor_ebr_t).
+ *
+ * Every function gets the id of the calling thread {tid} from the range
+ * [0, num_threads) that was given to borCHTableNew(), two threads must
+ * not use the same id at the same time.
+ */
+
+/** Number of locks guarding the buckets */
+#define BOR_CHTABLE_STRIPES 64
+
+/**
+ * Hash function.
+ * If set to NULL, borFastHash_64() of the key is used.
+ */
+typedef uint64_t (*bor_chtable_hash_fn)(const void *key, void *userdata);
+
+/**
+ * Returns true if two given keys are same.
+ * If set to NULL, the keys are compared with memcmp().
+ */
+typedef int (*bor_chtable_eq_fn)(const void *key1, const void *key2,
+                                 void *userdata);
+
+typedef struct _bor_chtable_node_t bor_chtable_node_t;
+typedef struct _bor_chtable_buckets_t bor_chtable_buckets_t;
+
+/**
+ * Concurrent hash table.
+ */
+struct _bor_chtable_t {
+    bor_chtable_buckets_t *buckets; /*!< Current bucket array */
+    size_t num_elements;
+    size_t key_size;
+    size_t val_size;
+
+    bor_chtable_hash_fn hash;
+    bor_chtable_eq_fn eq;
+    void *data;
+
+    bor_ebr_t *ebr;
+    pthread_mutex_t lock[BOR_CHTABLE_STRIPES];
+};
+typedef struct _bor_chtable_t bor_chtable_t;
+
+/**
+ * Creates a new table storing keys of {key_size} bytes with values of
+ * {val_size} bytes ({val_size} can be zero) that will be used by
+ * {num_threads} threads.
+ */
+bor_chtable_t *borCHTableNew(size_t key_size, size_t val_size,
+                             int num_threads,
+                             bor_chtable_hash_fn hash_func,
+                             bor_chtable_eq_fn eq_func,
+                             void *userdata);
+
+/**
+ * Deletes the table. No other thread can access the table.
+ */
+void borCHTableDel(bor_chtable_t *t);
+
+/**
+ * Returns number of elements in the table.
+ * The number is exact only if no insert or erase is in progress.
+ */
+_bor_inline size_t borCHTableNumElements(const bor_chtable_t *t);
+
+/**
+ * Searches for the key. If found, returns 0 and copies the value into
+ * {val} (if not NULL), otherwise returns -1.
+ */
+int borCHTableFind(bor_chtable_t *t, int tid, const void *key, void *val);
+
+/**
+ * Inserts the key with the value (can be NULL for zeroized value) only if
+ * the key is not already in the table.
+ * Returns 0 if the key was inserted and -1 if it was already there.
+ * Exactly one of the threads concurrently inserting the same key
+ * succeeds.
+ */
+int borCHTableInsert(bor_chtable_t *t, int tid,
+                     const void *key, const void *val);
+
+/**
+ * Removes the key from the table.
+ * Returns 0 if the key was in the table and -1 otherwise.
+ */
+int borCHTableErase(bor_chtable_t *t, int tid, const void *key);
+
+
+/**** INLINES ****/
+_bor_inline size_t borCHTableNumElements(const bor_chtable_t *t)
+{
+    return __atomic_load_n(&t->num_elements, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __BOR_CHTABLE_H__ */
@@ -18,8 +18,11 @@
 #define __BOR_CHULL3_H__
 
 #include <boruvka/mesh3.h>
+#include <boruvka/mempool.h>
+#include <boruvka/pc.h>
 #include <boruvka/list.h>
-/* #include <boruvka/predicates.h> */
+#include <boruvka/predicates.h>
+#include <boruvka/task-pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,8 +35,14 @@ extern "C" {
 struct _bor_chull3_t {
     bor_mesh3_t *mesh; /*!< Mesh representing convex hull */
     int coplanar;
+    bor_mempool_t *pool; /*!< Memory pool of vertices, edges and faces */
 
-    /* bor_pred_t pred; */
+    bor_list_t orphans;  /*!< Conflicting points of deleted faces (see
+                              borCHull3AddPoints()) */
+    unsigned long stamp; /*!< Stamp for marking visited faces */
+
+    int exact;           /*!< True if exact orientation predicate is used */
+    bor_pred_t pred;
 };
 typedef struct _bor_chull3_t bor_chull3_t;
 
@@ -57,6 +66,33 @@ _bor_inline bor_mesh3_t *borCHull3Mesh(bor_chull3_t *h);
  */
 void borCHull3Add(bor_chull3_t *h, const bor_vec3_t *point);
 
+/**
+ * Adds all points from point cloud {pc} (of dimension 3) to convex hull.
+ *
+ * Points are inserted in random order and each point that is not yet
+ * inside the hull keeps one face visible from it (the conflict face). The
+ * faces visible from the inserted point are then found by walking from its
+ * conflict face and only points conflicting with the removed faces are
+ * tested against the new faces, so the expected running time is
+ * O(n log n) instead of O(n h) of repeated borCHull3Add().
+ *
+ * The point cloud is not modified.
+ */
+void borCHull3AddPoints(bor_chull3_t *h, bor_pc_t *pc);
+
+/**
+ * Creates convex hull of all points from point cloud {pc} (of dimension 3)
+ * using Quickhull algorithm.
+ *
+ * The construction starts with a tetrahedron spanned by extreme points and
+ * then it repeatedly adds the furthest point of some face's outside set.
+ * Points are partitioned into outside sets of the new faces in parallel on
+ * task pool {tp} (which may be NULL). Visibility of faces is decided by
+ * the exact borPredOrient3d() predicate, also for points added later by
+ * borCHull3Add() into the returned hull.
+ */
+bor_chull3_t *borCHull3NewQuickhull(bor_pc_t *pc, bor_task_pool_t *tp);
+
 /**
  * Returns number of points on hull.
  */
@@ -0,0 +1,62 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_DELAUNAY_H__
+#define __BOR_DELAUNAY_H__
+
+#include <boruvka/qhull.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Delaunay - In-process Delaunay tetrahedralization
+ * ==================================================
+ *
+ * Incremental (Bowyer-Watson) 3D Delaunay tetrahedralization built on the
+ * exact predicates borPredOrient3d() and borPredInSphere().
+ *
+ * Points are inserted in biased randomized insertion order (BRIO): they
+ * are shuffled and split into rounds of doubling size and each round is
+ * sorted along a Hilbert curve, so consecutive points are close to each
+ * other and a walk from the last created tetrahedron finds the next
+ * point in a few steps.
+ * The outside of the convex hull is covered by "ghost" tetrahedra sharing
+ * a vertex at infinity, so no bounding tetrahedron is needed and the
+ * triangulation is exact for any input.
+ *
+ * The result has the same form as the one from borQDelaunayMesh3(), so
+ * both can be used interchangeably.
+ */
+
+/**
+ * Performs 3D Delaunay tetrahedralization of the given point cloud.
+ *
+ * Returned mesh contains one vertex for each point in order of the point
+ * cloud (duplicate points end up as isolated vertices) and one edge for
+ * each edge of the tetrahedralization. If all points are coplanar, the
+ * mesh contains vertices only.
+ * The mesh must be deleted by borQHullMesh3Del().
+ */
+bor_qhull_mesh3_t *borDelaunayMesh3(const bor_pc_t *pc);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BOR_DELAUNAY_H__ */
@@ -20,6 +20,8 @@
 #include <boruvka/core.h>
 #include <boruvka/list.h>
 #include <boruvka/pairheap.h>
+#include <boruvka/bucketheap.h>
+#include <boruvka/radixheap.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +32,16 @@ extern "C" {
 #define BOR_DIJ_STATE_CLOSED  1
 #define BOR_DIJ_STATE_OPEN    2
 
+/**
+ * Priority heaps that can be used by the algorithm, see borDijSetHeap().
+ */
+/** vvvv */
+#define BOR_DIJ_HEAP_PAIRING 0 /*!< Pairing heap with bor_real_t keys
+                                    (default) */
+#define BOR_DIJ_HEAP_BUCKET  1 /*!< Bucket heap with int keys */
+#define BOR_DIJ_HEAP_RADIX   2 /*!< Radix heap with uint64_t keys */
+/** ^^^^ */
+
 /**
  * Dij - Dijkstra Algorithm
  * =========================
@@ -40,6 +52,17 @@ extern "C" {
  * Node in graph
  * --------------
  */
+
+/**
+ * Connector of a node into a priority heap.
+ */
+union _bor_dij_heap_node_t {
+    bor_pairheap_node_t pair;
+    bor_bucketheap_node_t bucket;
+    bor_radixheap_node_t radix;
+};
+typedef union _bor_dij_heap_node_t bor_dij_heap_node_t;
+
 struct _bor_dij_node_t {
     int state;       /*!< State of node: CLOSED, OPEN, UNKNOWN */
     bor_real_t dist; /*!< Overall distance from start node.
@@ -54,7 +77,17 @@ struct _bor_dij_node_t {
                                See function borDijNodeAdd() and operation
                                expand() */
 
-    bor_pairheap_node_t _heap; /*!< Internal connection into heap */
+    bor_real_t _key;  /*!< Key in heap, i.e., .dist or .dist plus
+                           heuristic estimate in A* search */
+    bor_dij_heap_node_t _heap; /*!< Internal connection into heap */
+
+    int _state_rev;       /*!< State in backward search of bidirectional
+                               search */
+    bor_real_t _dist_rev; /*!< Distance to end node found by backward
+                               search */
+    struct _bor_dij_node_t *_next; /*!< Next node on path towards end
+                                        node in backward search */
+    bor_dij_heap_node_t _heap_rev; /*!< Connection into backward heap */
 };
 typedef struct _bor_dij_node_t bor_dij_node_t;
 
@@ -72,6 +105,13 @@ _bor_inline void borDijNodeInit(bor_dij_node_t *n);
  */
 _bor_inline int borDijNodeClosed(const bor_dij_node_t *n);
 
+/**
+ * Returns true if node is closed by the backward search of
+ * borDijRunBidir(). Use this instead of borDijNodeClosed() in expand_rev()
+ * operation.
+ */
+_bor_inline int borDijNodeClosedRev(const bor_dij_node_t *n);
+
 /**
  * Returns overall distance of node from start node.
  */
@@ -111,10 +151,25 @@ _bor_inline bor_dij_node_t *borDijNodeFromList(bor_list_t *item);
  */
 typedef void (*bor_dij_expand)(bor_dij_node_t *n, bor_list_t *list, void *);
 
+/**
+ * Returns estimate of the distance from {n} to the end node {end}.
+ * The estimate must be consistent (monotone), i.e., it must not be
+ * greater than the length of an edge (n, m) plus the estimate for m, and
+ * it must be zero for the end node, otherwise borDijRunAStar() can return
+ * a suboptimal path.
+ */
+typedef bor_real_t (*bor_dij_heuristic)(const bor_dij_node_t *n,
+                                        const bor_dij_node_t *end, void *);
+
 /** ^^^^ */
 
 struct _bor_dij_ops_t {
-    bor_dij_expand expand; /*!< Expands nodes */
+    bor_dij_expand expand;     /*!< Expands nodes */
+    bor_dij_expand expand_rev; /*!< Expands nodes along reversed edges,
+                                    i.e., fills list with predecessors of
+                                    the node (used by borDijRunBidir()) */
+    bor_dij_heuristic heuristic; /*!< Estimate of the distance to the end
+                                      node (used by borDijRunAStar()) */
     void *data;
 };
 typedef struct _bor_dij_ops_t bor_dij_ops_t;
@@ -130,9 +185,18 @@ _bor_inline void borDijOpsInit(bor_dij_ops_t *ops);
  * Dijkstra algorithm
  * -------------------
  */
+struct _bor_dij_heap_t {
+    bor_pairheap_t *pair;
+    bor_bucketheap_t *bucket;
+    bor_radixheap_t *radix;
+};
+typedef struct _bor_dij_heap_t bor_dij_heap_t;
+
 struct _bor_dij_t {
     bor_dij_ops_t ops;    /*!< Operations */
-    bor_pairheap_t *heap; /*!< Priority heap */
+    int heap_type;        /*!< One of BOR_DIJ_HEAP_* */
+    bor_real_t key_scale; /*!< Scale of distances for integer keys */
+    bor_dij_heap_t heap[2]; /*!< Forward and backward priority heap */
 };
 typedef struct _bor_dij_t bor_dij_t;
 
@@ -147,6 +211,21 @@ bor_dij_t *borDijNew(const bor_dij_ops_t *ops);
  */
 void borDijDel(bor_dij_t *dij);
 
+/**
+ * Selects priority heap used by borDijRun() (BOR_DIJ_HEAP_PAIRING by
+ * default).
+ * The bucket and radix heaps are monotone heaps with integer keys, the
+ * key of a node is computed from its distance as
+ * (integer)(dist * {key_scale}) (the scale is ignored for the pairing
+ * heap). With integer edge weights and {key_scale} 1 the result is
+ * exact, for fractional weights the scale sets the fixed-point precision,
+ * i.e., the nodes with distances closer than 1 / {key_scale} can be
+ * closed in any order.
+ * The bucket heap allocates memory proportional to the maximal key, so it
+ * is suitable only for small distances.
+ */
+void borDijSetHeap(bor_dij_t *dij, int heap_type, bor_real_t key_scale);
+
 /**
  * Runs dikstra algorithm.
  * Returns 0 if path was found.
@@ -154,6 +233,28 @@ void borDijDel(bor_dij_t *dij);
 int borDijRun(bor_dij_t *dij, bor_dij_node_t *start,
                               bor_dij_node_t *end);
 
+/**
+ * Runs A* search from {start} to {end} guided by the heuristic() operation
+ * (see bor_dij_heuristic). With the zero heuristic it is the same as
+ * borDijRun(). Only nodes that were closed have their final distance.
+ * Returns 0 if path was found.
+ */
+int borDijRunAStar(bor_dij_t *dij, bor_dij_node_t *start,
+                                   bor_dij_node_t *end);
+
+/**
+ * Runs bidirectional Dijkstra algorithm, i.e., forward search from {start}
+ * using expand() operation and backward search from {end} using
+ * expand_rev() operation. The search stops once the sum of the minimal
+ * keys of both heaps reaches the length of the shortest path found so
+ * far.
+ * If the path was found, the nodes on it have .prev and .dist set as if
+ * borDijRun() was called, so borDijPath() can be used as usual.
+ * Returns 0 if path was found.
+ */
+int borDijRunBidir(bor_dij_t *dij, bor_dij_node_t *start,
+                                   bor_dij_node_t *end);
+
 /**
  * Fills given list by path which ends on endnode.
  */
@@ -165,6 +266,8 @@ _bor_inline void borDijNodeInit(bor_dij_node_t *n)
 {
     n->state = BOR_DIJ_STATE_UNKNOWN;
     n->dist  = BOR_REAL_MAX;
+    n->_state_rev = BOR_DIJ_STATE_UNKNOWN;
+    n->_dist_rev  = BOR_REAL_MAX;
 }
 
 _bor_inline int borDijNodeClosed(const bor_dij_node_t *n)
@@ -172,6 +275,11 @@ _bor_inline int borDijNodeClosed(const bor_dij_node_t *n)
     return n->state == BOR_DIJ_STATE_CLOSED;
 }
 
+_bor_inline int borDijNodeClosedRev(const bor_dij_node_t *n)
+{
+    return n->_state_rev == BOR_DIJ_STATE_CLOSED;
+}
+
 _bor_inline bor_real_t borDijDist(const bor_dij_node_t *n)
 {
     return n->dist;
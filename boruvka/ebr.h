@@ -0,0 +1,156 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_EBR_H__
+#define __BOR_EBR_H__
+
+#include <stdint.h>
+#include <boruvka/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Epoch-Based Reclamation
+ * ========================
+ *
+ * Safe memory reclamation for lock-free readers. Readers enclose every
+ * access to a shared structure between borEBREnter() and borEBRExit().
+ * A writer that unlinks an object from the structure does not free it
+ * directly but passes it to borEBRRetire(); the object is freed only
+ * after every thread that could have seen it left its critical section.
+ *
+ * The global epoch is advanced only if all threads that are currently in
+ * a critical section have already observed it. An object retired in
+ * epoch e can be freed once the global epoch reaches e + 2.
+ *
+ * Each thread is identified by an id from the range [0, num_threads)
+ * (e.g., the id of a bor_task_pool_t worker), and the same id must not
+ * be used by two threads at the same time.
+ */
+
+/** Size of cache line used for padding */
+#define BOR_EBR_CACHE_LINE 64
+
+/**
+ * Number of retired objects after which a thread tries to advance the
+ * global epoch and free its retired objects.
+ */
+#define BOR_EBR_RECLAIM_PERIOD 64
+
+/**
+ * Callback that frees a retired object.
+ */
+typedef void (*bor_ebr_free_fn)(void *obj, void *userdata);
+
+struct _bor_ebr_retired_t {
+    void *obj;
+    bor_ebr_free_fn free_fn;
+    void *userdata;
+    uint64_t epoch;
+};
+typedef struct _bor_ebr_retired_t bor_ebr_retired_t;
+
+struct _bor_ebr_thread_t {
+    uint64_t epoch;     /*!< (epoch << 1) | 1 while in critical section,
+                             0 otherwise */
+    int nesting;        /*!< Nesting level of borEBREnter() */
+    bor_ebr_retired_t *retired; /*!< Objects waiting for reclamation */
+    size_t retired_len;
+    size_t retired_alloc;
+    char _pad[BOR_EBR_CACHE_LINE];
+};
+typedef struct _bor_ebr_thread_t bor_ebr_thread_t;
+
+struct _bor_ebr_t {
+    uint64_t epoch; /*!< Global epoch */
+    char _pad[BOR_EBR_CACHE_LINE];
+    bor_ebr_thread_t *thread;
+    int num_threads;
+};
+typedef struct _bor_ebr_t bor_ebr_t;
+
+/**
+ * Creates a new reclamation domain for {num_threads} threads.
+ */
+bor_ebr_t *borEBRNew(int num_threads);
+
+/**
+ * Deletes the domain and frees all retired objects.
+ * No thread can be in a critical section.
+ */
+void borEBRDel(bor_ebr_t *e);
+
+/**
+ * Enters critical section of thread {tid}. Pointers read from the shared
+ * structure are valid until the matching borEBRExit().
+ * Critical sections can be nested.
+ */
+_bor_inline void borEBREnter(bor_ebr_t *e, int tid);
+
+/**
+ * Leaves critical section of thread {tid}.
+ */
+_bor_inline void borEBRExit(bor_ebr_t *e, int tid);
+
+/**
+ * Retires the object {obj} that was already unlinked from the shared
+ * structure, i.e., no new reader can reach it. {free_fn} is called on
+ * the object once it is safe.
+ */
+void borEBRRetire(bor_ebr_t *e, int tid, void *obj,
+                  bor_ebr_free_fn free_fn, void *userdata);
+
+/**
+ * Tries to advance the global epoch and frees objects retired by thread
+ * {tid} that are safe to free. Returns number of freed objects.
+ * This is called automatically by borEBRRetire() every
+ * BOR_EBR_RECLAIM_PERIOD retired objects.
+ */
+size_t borEBRReclaim(bor_ebr_t *e, int tid);
+
+
+/**** INLINES ****/
+_bor_inline void borEBREnter(bor_ebr_t *e, int tid)
+{
+    bor_ebr_thread_t *th = e->thread + tid;
+    uint64_t epoch;
+
+    if (th->nesting++ > 0)
+        return;
+
+    epoch = __atomic_load_n(&e->epoch, __ATOMIC_RELAXED);
+    __atomic_store_n(&th->epoch, (epoch << 1) | 1, __ATOMIC_RELAXED);
+    /* The announcement must be visible before any pointer is read */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+_bor_inline void borEBRExit(bor_ebr_t *e, int tid)
+{
+    bor_ebr_thread_t *th = e->thread + tid;
+
+    if (--th->nesting > 0)
+        return;
+    __atomic_store_n(&th->epoch, 0, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __BOR_EBR_H__ */
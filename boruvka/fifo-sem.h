@@ -29,13 +29,51 @@ extern "C" {
  * Concurrent FIFO with semaphores
  * ================================
  *
+ * By default, any number of threads can push and pop concurrently and the
+ * queue is protected by a mutex.
+ *
+ * If the FIFO is initialized by borFifoSemInitSPSC() (or created by
+ * borFifoSemNewSPSC()), exactly one thread may push and exactly one
+ * (other) thread may pop. Push and pop are then wait-free and don't touch
+ * the mutex or semaphores unless the consumer sleeps in
+ * borFifoSemPopBlock*(). Blocking pop first spins for an adaptively
+ * adjusted number of rounds and only then goes to sleep.
  */
 
+/** Size of cache line used for padding */
+#define BOR_FIFO_SEM_CACHE_LINE 64
+
+/** vvvv */
+struct _bor_fifo_sem_spsc_t {
+    char _pad0[BOR_FIFO_SEM_CACHE_LINE];
+    /* owned by consumer */
+    bor_fifo_segm_t *front; /*!< Segment with the first element */
+    char *front_el;
+    char *front_end;
+    size_t popped;          /*!< Number of popped elements */
+    size_t pushed_cache;    /*!< Last seen value of .pushed */
+    int spin;               /*!< Current limit of spinning rounds */
+    char _pad1[BOR_FIFO_SEM_CACHE_LINE];
+    /* owned by producer */
+    bor_fifo_segm_t *back;  /*!< The last segment */
+    char *back_el;
+    char *back_end;
+    size_t pushed;          /*!< Number of pushed elements */
+    char _pad2[BOR_FIFO_SEM_CACHE_LINE];
+    /* shared */
+    bor_fifo_segm_t *spare; /*!< Freed segment waiting for reuse */
+    int waiting;            /*!< True if consumer sleeps on .full */
+};
+typedef struct _bor_fifo_sem_spsc_t bor_fifo_sem_spsc_t;
+/** ^^^^ */
+
 struct _bor_fifo_sem_t {
     bor_fifo_t fifo;
     pthread_mutex_t lock;
     sem_t full;
     sem_t empty;
+    int spsc;              /*!< True if single-producer/single-consumer */
+    bor_fifo_sem_spsc_t s; /*!< State of SPSC variant */
 };
 typedef struct _bor_fifo_sem_t bor_fifo_sem_t;
 
@@ -55,6 +93,11 @@ bor_fifo_sem_t *borFifoSemNew(size_t el_size);
  */
 bor_fifo_sem_t *borFifoSemNewSize(size_t el_size, size_t buf_size);
 
+/**
+ * Creates a new single-producer/single-consumer fifo.
+ */
+bor_fifo_sem_t *borFifoSemNewSPSC(size_t el_size, size_t buf_size);
+
 /**
  * Deletes a fifo.
  */
@@ -70,6 +113,13 @@ int borFifoSemInit(bor_fifo_sem_t *fifo, size_t el_size);
  */
 int borFifoSemInitSize(bor_fifo_sem_t *fifo, size_t el_size, size_t buf_size);
 
+/**
+ * In-place initialization of single-producer/single-consumer fifo.
+ * If {buf_size} is 0, the default size of segment is used.
+ */
+int borFifoSemInitSPSC(bor_fifo_sem_t *fifo, size_t el_size,
+                       size_t buf_size);
+
 /**
  * Frees allocated resources.
  */
@@ -0,0 +1,153 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_GRAPH_CSR_H__
+#define __BOR_GRAPH_CSR_H__
+
+#include <stdint.h>
+#include <boruvka/core.h>
+#include <boruvka/net.h>
+#include <boruvka/scc.h>
+#include <boruvka/task-pool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Compressed Sparse Row Graph
+ * ============================
+ *
+ * Static directed graph stored in compressed sparse row format: nodes
+ * are identified by integers 0, ..., node_size - 1 and the outgoing edges
+ * of node i occupy the range [beg[i], beg[i + 1]) of the edge arrays.
+ *
+ * The graph can be searched with specialized kernels (borGraphCSRDij(),
+ * borGraphCSRSCC()) that work directly over the arrays, i.e., without
+ * callbacks and linked lists of bor_dij_t and bor_scc_t.
+ */
+
+struct _bor_graph_csr_t {
+    int node_size;      /*!< Number of nodes */
+    int64_t edge_size;  /*!< Number of edges */
+    int64_t *beg;       /*!< Offsets of the first outgoing edge of each
+                             node, beg[node_size] == edge_size */
+    int *dst;           /*!< Destination node of each edge */
+    bor_real_t *weight; /*!< Weight of each edge or NULL if the graph is
+                             unweighted (all weights are one) */
+};
+typedef struct _bor_graph_csr_t bor_graph_csr_t;
+
+/**
+ * Returns weight of the edge for the conversion from bor_net_t.
+ */
+typedef bor_real_t (*bor_graph_csr_net_weight_fn)(const bor_net_edge_t *e,
+                                                  void *userdata);
+
+/**
+ * Creates a graph from the list of {edge_size} edges (src[i], dst[i])
+ * with weights weight[i]. {weight} can be NULL for unweighted graph.
+ * The edges of each node keep their relative order from the input.
+ */
+bor_graph_csr_t *borGraphCSRNew(int node_size, int64_t edge_size,
+                                const int *src, const int *dst,
+                                const bor_real_t *weight);
+
+/**
+ * Creates a graph from the network. The nodes get IDs in the order of
+ * borNetNodes() list. Each edge of the network is converted to a directed
+ * edge from .n[0] to .n[1], and if {directed} is false also to the
+ * reversed edge.
+ * If {weight_fn} is NULL, the graph is unweighted.
+ * If {nodes} is non-NULL, it is filled with the network nodes indexed by
+ * their IDs (it must have room for borNetNodesLen() elements).
+ */
+bor_graph_csr_t *borGraphCSRNewNet(bor_net_t *net, int directed,
+                                   bor_graph_csr_net_weight_fn weight_fn,
+                                   void *userdata,
+                                   bor_net_node_t **nodes);
+
+/**
+ * Creates a graph with all edges of {g} reversed.
+ */
+bor_graph_csr_t *borGraphCSRTranspose(const bor_graph_csr_t *g);
+
+/**
+ * Deletes the graph.
+ */
+void borGraphCSRDel(bor_graph_csr_t *g);
+
+/**
+ * Returns number of outgoing edges of the node.
+ */
+_bor_inline int64_t borGraphCSRDegree(const bor_graph_csr_t *g, int node);
+
+/**
+ * Runs Dijkstra algorithm from the node {start}. If {end} is
+ * non-negative, the search stops as soon as the end node is closed,
+ * otherwise the distances to all nodes are computed.
+ * {dist} must have room for g->node_size elements and it is filled with
+ * the distances from the start node (BOR_REAL_MAX for nodes that weren't
+ * reached). {prev} can be NULL, otherwise it is filled with the
+ * predecessors of the nodes on the shortest paths (-1 for the start node
+ * and not reached nodes).
+ * Returns 0 if the end node was reached or if {end} is negative, -1
+ * otherwise.
+ */
+int borGraphCSRDij(const bor_graph_csr_t *g, int start, int end,
+                   bor_real_t *dist, int *prev);
+
+/**
+ * Finds strongly connected components of the graph using the Tarjan's
+ * algorithm without recursion. {scc} is initialized by this function and
+ * it is filled with the same components as borSCC() would find. It must
+ * be freed by borSCCFree().
+ */
+void borGraphCSRSCC(const bor_graph_csr_t *g, bor_scc_t *scc);
+
+/**
+ * Parallel variant of borGraphCSRSCC() running on the threads of {tp}
+ * ({tp} can be NULL in which case it runs in the calling thread).
+ *
+ * The nodes without predecessors or successors are split off first as
+ * singleton components. The rest is processed by the forward-backward
+ * algorithm: the nodes reached both by forward and backward search
+ * (parallel BFS) from a pivot form its component and the remaining nodes
+ * are split into three independent subsets (reached only forward, only
+ * backward, not reached). Subsets smaller than a few thousand nodes are
+ * finished by sequential Tarjan's algorithm, many subsets in parallel.
+ *
+ * {scc} is filled with the same components as by borGraphCSRSCC(), but
+ * they are ordered by their smallest node ID.
+ * borTaskPoolRun() must be already called on {tp} and the function must
+ * not be called from a task running in {tp} (see borParallelFor()).
+ */
+void borGraphCSRSCCPar(const bor_graph_csr_t *g, bor_scc_t *scc,
+                       bor_task_pool_t *tp);
+
+
+/**** INLINES ****/
+_bor_inline int64_t borGraphCSRDegree(const bor_graph_csr_t *g, int node)
+{
+    return g->beg[node + 1] - g->beg[node];
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BOR_GRAPH_CSR_H__ */
@@ -19,6 +19,7 @@
 
 #include <boruvka/list.h>
 #include <boruvka/vec.h>
+#include <boruvka/task-pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +31,23 @@ struct _bor_gug_cell_t {
 };
 typedef struct _bor_gug_cell_t bor_gug_cell_t;
 
+struct _bor_gug_el_t;
+
+/** Internal structure: packed (structure-of-arrays) copy of one cell */
+struct _bor_gug_packed_t {
+    bor_real_t *coords;          /*!< Coordinates of elements,
+                                      coords[i * .alloc + j] is i'th
+                                      coordinate of j'th element. Each row
+                                      is aligned to BOR_GUG_PACKED_ALIGN */
+    struct _bor_gug_el_t **els;  /*!< Handles of elements */
+    size_t len;                  /*!< Number of elements in cell */
+    size_t alloc;                /*!< Allocated length of rows */
+};
+typedef struct _bor_gug_packed_t bor_gug_packed_t;
+
+/** Alignment (in bytes) of coordinate rows in packed mode */
+#define BOR_GUG_PACKED_ALIGN 32
+
 
 /**
  * Growing Uniform Grid
@@ -69,6 +87,16 @@ struct _bor_gug_params_t {
     int approx;             /*!< Set to true if approximate nearest
                                  neighbor search should be used.
                                  Defaule: False */
+    int packed;             /*!< Set to true if each cell should also keep
+                                 a packed copy of coordinates of its
+                                 elements (structure-of-arrays) that is
+                                 used for nearest neighbor search instead
+                                 of dereferencing elements' points.
+                                 In this mode coordinates are copied when
+                                 element is added or updated, so
+                                 borGUGUpdate() must be called whenever
+                                 element moves.
+                                 Default: False */
 };
 typedef struct _bor_gug_params_t bor_gug_params_t;
 
@@ -106,6 +134,8 @@ struct _bor_gug_t {
     size_t cells_len;          /*!< Length of .cells array */
     size_t next_expand;        /*!< Treshold when number of cells should be
                                     expanded */
+    bor_gug_packed_t *packed;  /*!< Packed copies of .cells (same length)
+                                    or NULL if packed mode is disabled */
 };
 typedef struct _bor_gug_t bor_gug_t;
 
@@ -225,6 +255,42 @@ size_t borGUGNearest(const bor_gug_t *cs, const bor_vec_t *p, size_t num,
 size_t borGUGNearestApprox(const bor_gug_t *cs, const bor_vec_t *p,
                                size_t num, bor_gug_el_t **els);
 
+/**
+ * Callback for borGUGRange(). {dist} is the distance between element
+ * {el} and the query point.
+ */
+typedef void (*bor_gug_range_fn)(bor_gug_el_t *el, bor_real_t dist,
+                                 void *data);
+
+/**
+ * Calls {cb} for each element whose distance from point {p} is at most
+ * {radius}. Only cells intersecting the ball are visited. Elements are
+ * reported in no particular order. Returns number of reported elements.
+ */
+size_t borGUGRange(const bor_gug_t *cs, const bor_vec_t *p,
+                   bor_real_t radius, bor_gug_range_fn cb, void *data);
+
+/**
+ * Batch version of {borGUGNearest}.
+ *
+ * Finds {num} nearest elements for each of {len} query points {ps}.
+ * Array {els} must have at least {len} * {num} items, nearest elements to
+ * i'th query point are stored in els[i * num], ..., els[i * num + num - 1]
+ * and slots that weren't filled are set to NULL. If {found} is non-NULL
+ * it must have {len} items and number of elements found for i'th query
+ * is stored in found[i].
+ *
+ * If task pool {tp} is non-NULL, queries are processed in parallel by
+ * threads of the pool using borParallelFor() (the pool must be already
+ * running, see borTaskPoolRun()). The function blocks until all queries
+ * are answered. Scratch buffers are allocated once per batch for each
+ * thread of the pool. The gug must not be modified during the call.
+ */
+void borGUGNearestBatch(const bor_gug_t *cs,
+                        const bor_vec_t **ps, size_t len, size_t num,
+                        bor_gug_el_t **els, size_t *found,
+                        bor_task_pool_t *tp);
+
 
 
 
@@ -240,6 +306,11 @@ _bor_inline size_t __borGUGCoordsToID(const bor_gug_t *cs,
 /** Expands number of cells. This is function for internal use. Don't use it! */
 void __borGUGExpand(bor_gug_t *cs);
 
+/** Maintenance of packed cells. Internal use only. */
+void __borGUGPackedAdd(bor_gug_t *cs, bor_gug_el_t *el);
+void __borGUGPackedRemove(bor_gug_t *cs, bor_gug_el_t *el);
+void __borGUGPackedUpdate(bor_gug_t *cs, bor_gug_el_t *el);
+
 /**** INLINES ****/
 _bor_inline void borGUGElInit(bor_gug_el_t *el, const bor_vec_t *p)
 {
@@ -283,12 +354,18 @@ _bor_inline void borGUGAdd(bor_gug_t *cs, bor_gug_el_t *el)
     el->cell_id = id;
     cs->num_els++;
 
+    if (cs->packed)
+        __borGUGPackedAdd(cs, el);
+
     if (cs->num_els >= cs->next_expand)
         __borGUGExpand(cs);
 }
 
 _bor_inline void borGUGRemove(bor_gug_t *cs, bor_gug_el_t *el)
 {
+    if (cs->packed)
+        __borGUGPackedRemove(cs, el);
+
     borListDel(&el->list);
 
     el->cell_id = (size_t)-1;
@@ -302,6 +379,8 @@ _bor_inline void borGUGUpdate(bor_gug_t *cs, bor_gug_el_t *el)
     id = __borGUGCoordsToID(cs, el->p);
     if (id != el->cell_id){
         borGUGUpdateForce(cs, el);
+    }else if (cs->packed){
+        __borGUGPackedUpdate(cs, el);
     }
 }
 
@@ -0,0 +1,570 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_HTABLE_OA_H__
+#define __BOR_HTABLE_OA_H__
+
+#include <string.h>
+#include <boruvka/core.h>
+#include <boruvka/alloc.h>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif /* __SSE2__ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Open-Addressing Hash Table
+ * ===========================
+ *
+ * See bor_htable_oa_t.
+ *
+ * An alternative to bor_htable_t that stores keys and values directly in
+ * one flat array of slots instead of chaining intrusive list nodes.
+ * The table is organized in the "Swiss table" fashion: each slot has one
+ * control byte that is either empty, deleted (tombstone), or holds the
+ * lowest 7 bits of the hash of the stored key. The control bytes are
+ * probed in groups of 16 (using SSE2 if available), so a lookup touches
+ * the slots themselves only when the 7-bit part of the hash matches.
+ * The number of slots is always a power of two and the maximal load
+ * factor is 7/8.
+ *
+ * Two flavours are provided:
+ * 1. bor_htable_oa_t with keys and values of sizes given at runtime and
+ *    with hash and equality given as callbacks, and
+ * 2. BOR_HTABLE_OA_DECL() macro that declares a typed table with inlined
+ *    hash and equality functions (similarly to BOR_VARR_DECL()).
+ */
+
+/** vvvv */
+#define BOR_HTABLE_OA_GROUP    16 /*!< Number of control bytes in a group */
+#define BOR_HTABLE_OA_EMPTY    ((int8_t)-128) /*!< Empty slot */
+#define BOR_HTABLE_OA_DELETED  ((int8_t)-2) /*!< Erased slot (tombstone) */
+#define BOR_HTABLE_OA_MIN_SIZE 16 /*!< Minimal number of slots */
+/** ^^^^ */
+
+/**
+ * Callbacks
+ * ----------
+ */
+
+/**
+ * Hash function.
+ * If this callback is set to NULL, borFastHash_64() of the key is used.
+ */
+typedef uint64_t (*bor_htable_oa_hash_fn)(const void *key, void *userdata);
+
+/**
+ * Returns true if two given keys are same.
+ * If this callback is set to NULL, keys are compared with memcmp().
+ */
+typedef int (*bor_htable_oa_eq_fn)(const void *key1, const void *key2,
+                                   void *userdata);
+
+/**
+ * Hash table structure.
+ */
+struct _bor_htable_oa_t {
+    int8_t *ctrl;       /*!< Control bytes, one per slot */
+    char *slots;        /*!< Array of slots (key followed by value) */
+    size_t size;        /*!< Number of slots */
+    size_t num_elements;
+    size_t growth_left; /*!< Number of empty slots that can be filled
+                             before the table has to be rehashed */
+
+    size_t key_size;
+    size_t val_size;
+    size_t val_offset;  /*!< Offset of the value within a slot */
+    size_t slot_size;
+
+    bor_htable_oa_hash_fn hash;
+    bor_htable_oa_eq_fn eq;
+    void *data;
+};
+typedef struct _bor_htable_oa_t bor_htable_oa_t;
+
+/**
+ * Functions
+ * ----------
+ */
+
+/**
+ * Creates a hash table storing keys of {key_size} bytes and values of
+ * {val_size} bytes. {val_size} can be zero in which case the table is
+ * a set.
+ */
+bor_htable_oa_t *borHTableOANew(size_t key_size, size_t val_size,
+                                bor_htable_oa_hash_fn hash_func,
+                                bor_htable_oa_eq_fn eq_func,
+                                void *userdata);
+
+/**
+ * Deletes a table.
+ */
+void borHTableOADel(bor_htable_oa_t *t);
+
+/**
+ * Returns number of slots of the table.
+ */
+_bor_inline size_t borHTableOASize(const bor_htable_oa_t *t);
+
+/**
+ * Returns number of elements stored in the table.
+ */
+_bor_inline size_t borHTableOANumElements(const bor_htable_oa_t *t);
+
+/**
+ * Removes all elements from the table (the memory is kept).
+ */
+void borHTableOAClear(bor_htable_oa_t *t);
+
+/**
+ * Resizes the table so that at least {num} elements can be stored
+ * without rehashing.
+ */
+void borHTableOAReserve(bor_htable_oa_t *t, size_t num);
+
+/**
+ * Returns pointer to the value stored under the given key or NULL if
+ * there is no such key. If the table has zero-sized values, pointer to
+ * the stored key is returned instead.
+ */
+void *borHTableOAFind(const bor_htable_oa_t *t, const void *key);
+
+/**
+ * Inserts the key with the value into the table. If the key is already
+ * there, its value is overwritten. If {val} is NULL, the value is
+ * zeroized.
+ * Returns pointer to the stored value (see borHTableOAFind()).
+ */
+void *borHTableOAInsert(bor_htable_oa_t *t, const void *key, const void *val);
+
+/**
+ * Inserts the key with the value only if the same key isn't already in
+ * the table.
+ * Returns pointer to the value of the equal key if already in the table
+ * or NULL if the given key was inserted.
+ */
+void *borHTableOAInsertUnique(bor_htable_oa_t *t,
+                              const void *key, const void *val);
+
+/**
+ * Removes the key from the table.
+ * Returns 0 if such a key was stored in the table and -1 otherwise.
+ */
+int borHTableOAErase(bor_htable_oa_t *t, const void *key);
+
+/**
+ * Iterates over all elements of the table. {it} must be initialized to
+ * zero before the first call. Returns 0 and fills {key} and {val} (both
+ * can be NULL) with pointers to the next stored element, or returns -1
+ * if there are no more elements.
+ * The table must not be modified during the iteration except by
+ * borHTableOAErase() of the element just returned.
+ */
+int borHTableOANext(const bor_htable_oa_t *t, size_t *it,
+                    void **key, void **val);
+
+
+/**
+ * Typed Table
+ * ------------
+ *
+ * BOR_HTABLE_OA_DECL(key_type, val_type, struct_name, func_prefix,
+ *                    hash_func, eq_func)
+ * declares the struct
+ * ~~~~
+ * struct _{struct_name}_slot {
+ *     {key_type} key;
+ *     {val_type} val;
+ * };
+ * typedef struct _{struct_name}_slot {struct_name}_slot;
+ *
+ * struct _{struct_name} {
+ *     int8_t *ctrl;
+ *     {struct_name}_slot *slots;
+ *     size_t size;
+ *     size_t num_elements;
+ *     size_t growth_left;
+ * };
+ * typedef struct _{struct_name} {struct_name};
+ * ~~~~
+ * and the following inline functions:
+ * ~~~~
+ * void {func_prefix}Init({struct_name} *t, size_t init_size);
+ * void {func_prefix}Free({struct_name} *t);
+ * void {func_prefix}Clear({struct_name} *t);
+ * void {func_prefix}Reserve({struct_name} *t, size_t num);
+ * {val_type} *{func_prefix}Find(const {struct_name} *t,
+ *                               const {key_type} *key);
+ * {val_type} *{func_prefix}Insert({struct_name} *t,
+ *                                 const {key_type} *key,
+ *                                 const {val_type} *val);
+ * {val_type} *{func_prefix}InsertUnique({struct_name} *t,
+ *                                       const {key_type} *key,
+ *                                       const {val_type} *val);
+ * int {func_prefix}Erase({struct_name} *t, const {key_type} *key);
+ * ~~~~
+ * with the same semantics as the corresponding borHTableOA*() functions
+ * (plus {func_prefix}Rehash, {func_prefix}FindSlot and
+ * {func_prefix}InsertSlot that are used internally).
+ * {hash_func} must be a function or a macro with the signature
+ * uint64_t hash_func(const {key_type} *key) and {eq_func} with the
+ * signature int eq_func(const {key_type} *k1, const {key_type} *k2).
+ * Elements can be iterated directly: slot i is occupied if
+ * .ctrl[i] >= 0.
+ */
+#define BOR_HTABLE_OA_DECL(key_type, val_type, struct_name, func_prefix, \
+                           hash_func, eq_func) \
+    _BOR_HTABLE_OA_DECL_STRUCT(key_type, val_type, struct_name) \
+    _BOR_HTABLE_OA_DECL_REHASH(struct_name, func_prefix, hash_func) \
+    _BOR_HTABLE_OA_DECL_INIT(struct_name, func_prefix) \
+    _BOR_HTABLE_OA_DECL_FIND(key_type, val_type, struct_name, func_prefix, \
+                             hash_func, eq_func) \
+    _BOR_HTABLE_OA_DECL_INSERT(key_type, val_type, struct_name, \
+                               func_prefix, hash_func, eq_func) \
+    _BOR_HTABLE_OA_DECL_ERASE(key_type, struct_name, func_prefix, hash_func)
+
+
+/**** INTERNALS ****/
+/** Bitmask of the occupied slots in the group starting at {ctrl} that
+ *  have control byte equal to {h} */
+_bor_inline unsigned __borHTableOAMatch(const int8_t *ctrl, int8_t h);
+/** Bitmask of empty slots in the group */
+_bor_inline unsigned __borHTableOAMatchEmpty(const int8_t *ctrl);
+/** Bitmask of empty or deleted slots in the group */
+_bor_inline unsigned __borHTableOAMatchFree(const int8_t *ctrl);
+/** Index of the lowest set bit */
+_bor_inline int __borHTableOABit(unsigned mask);
+/** 7-bit part of the hash stored in control bytes */
+_bor_inline int8_t __borHTableOAH2(uint64_t hash);
+/** First group of the probe sequence */
+_bor_inline size_t __borHTableOAH1(uint64_t hash, size_t size);
+/** Number of slots needed for {num} elements */
+_bor_inline size_t __borHTableOASizeFor(size_t num);
+/** Number of elements that fits into the table of the given size */
+_bor_inline size_t __borHTableOACapacity(size_t size);
+/** Returns the first free slot in the probe sequence of {hash} */
+_bor_inline size_t __borHTableOAFindFree(const int8_t *ctrl, size_t size,
+                                         uint64_t hash);
+/** Sets {slot} free after erase, returns true if it could be set empty
+ *  (i.e., not to a tombstone) */
+_bor_inline int __borHTableOASetFree(int8_t *ctrl, size_t slot);
+/** Allocates an array of empty control bytes */
+_bor_inline int8_t *__borHTableOACtrlNew(size_t size);
+/** Size the table should be rehashed to when it runs out of empty slots */
+_bor_inline size_t __borHTableOANextSize(size_t size, size_t num_elements);
+
+
+#define _BOR_HTABLE_OA_DECL_STRUCT(key_type, val_type, struct_name) \
+    struct _##struct_name##_slot { \
+        key_type key; \
+        val_type val; \
+    }; \
+    typedef struct _##struct_name##_slot struct_name##_slot; \
+    struct _##struct_name { \
+        int8_t *ctrl; \
+        struct_name##_slot *slots; \
+        size_t size; \
+        size_t num_elements; \
+        size_t growth_left; \
+    }; \
+    typedef struct _##struct_name struct_name;
+
+#define _BOR_HTABLE_OA_DECL_REHASH(struct_name, fprefix, hash_func) \
+    _bor_inline void fprefix##Rehash(struct_name *t, size_t size) \
+    { \
+        int8_t *ctrl; \
+        struct_name##_slot *slots; \
+        size_t i, j; \
+\
+        ctrl = __borHTableOACtrlNew(size); \
+        slots = BOR_ALLOC_ARR(struct_name##_slot, size); \
+        for (i = 0; i < t->size; ++i){ \
+            if (t->ctrl[i] < 0) \
+                continue; \
+            j = __borHTableOAFindFree(ctrl, size, \
+                                      hash_func(&t->slots[i].key)); \
+            ctrl[j] = t->ctrl[i]; \
+            slots[j] = t->slots[i]; \
+        } \
+        BOR_FREE(t->ctrl); \
+        BOR_FREE(t->slots); \
+        t->ctrl = ctrl; \
+        t->slots = slots; \
+        t->size = size; \
+        t->growth_left = __borHTableOACapacity(size) - t->num_elements; \
+    }
+
+#define _BOR_HTABLE_OA_DECL_INIT(struct_name, fprefix) \
+    _bor_inline void fprefix##Init(struct_name *t, size_t init_size) \
+    { \
+        t->size = __borHTableOASizeFor(init_size); \
+        t->ctrl = __borHTableOACtrlNew(t->size); \
+        t->slots = BOR_ALLOC_ARR(struct_name##_slot, t->size); \
+        t->num_elements = 0; \
+        t->growth_left = __borHTableOACapacity(t->size); \
+    } \
+    _bor_inline void fprefix##Free(struct_name *t) \
+    { \
+        BOR_FREE(t->ctrl); \
+        BOR_FREE(t->slots); \
+        t->ctrl = NULL; \
+        t->slots = NULL; \
+        t->size = t->num_elements = t->growth_left = 0; \
+    } \
+    _bor_inline void fprefix##Clear(struct_name *t) \
+    { \
+        memset(t->ctrl, BOR_HTABLE_OA_EMPTY, t->size); \
+        t->num_elements = 0; \
+        t->growth_left = __borHTableOACapacity(t->size); \
+    } \
+    _bor_inline void fprefix##Reserve(struct_name *t, size_t num) \
+    { \
+        size_t size = __borHTableOASizeFor(num); \
+        if (size > t->size) \
+            fprefix##Rehash(t, size); \
+    }
+
+#define _BOR_HTABLE_OA_DECL_FIND(key_type, val_type, struct_name, fprefix, \
+                                 hash_func, eq_func) \
+    _bor_inline size_t fprefix##FindSlot(const struct_name *t, \
+                                         const key_type *key, \
+                                         uint64_t hash) \
+    { \
+        size_t mask = t->size - 1, pos, step = 0; \
+        int8_t h2 = __borHTableOAH2(hash); \
+        unsigned m; \
+\
+        pos = __borHTableOAH1(hash, t->size); \
+        __builtin_prefetch(t->slots + pos); \
+        while (1){ \
+            m = __borHTableOAMatch(t->ctrl + pos, h2); \
+            for (; m; m &= m - 1){ \
+                size_t i = pos + __borHTableOABit(m); \
+                if (eq_func(&t->slots[i].key, key)) \
+                    return i; \
+            } \
+            if (__borHTableOAMatchEmpty(t->ctrl + pos)) \
+                return t->size; \
+            step += BOR_HTABLE_OA_GROUP; \
+            pos = (pos + step) & mask; \
+        } \
+    } \
+    _bor_inline val_type *fprefix##Find(const struct_name *t, \
+                                        const key_type *key) \
+    { \
+        size_t i = fprefix##FindSlot(t, key, hash_func(key)); \
+        if (i == t->size) \
+            return NULL; \
+        return &t->slots[i].val; \
+    }
+
+#define _BOR_HTABLE_OA_DECL_INSERT(key_type, val_type, struct_name, \
+                                   fprefix, hash_func, eq_func) \
+    _bor_inline size_t fprefix##InsertSlot(struct_name *t, \
+                                           const key_type *key, \
+                                           int *found) \
+    { \
+        uint64_t hash = hash_func(key); \
+        size_t i = fprefix##FindSlot(t, key, hash); \
+\
+        *found = (i != t->size); \
+        if (*found) \
+            return i; \
+\
+        i = __borHTableOAFindFree(t->ctrl, t->size, hash); \
+        if (t->growth_left == 0 && t->ctrl[i] == BOR_HTABLE_OA_EMPTY){ \
+            fprefix##Rehash(t, __borHTableOANextSize(t->size, \
+                                                     t->num_elements)); \
+            i = __borHTableOAFindFree(t->ctrl, t->size, hash); \
+        } \
+        if (t->ctrl[i] == BOR_HTABLE_OA_EMPTY) \
+            --t->growth_left; \
+        t->ctrl[i] = __borHTableOAH2(hash); \
+        t->slots[i].key = *key; \
+        ++t->num_elements; \
+        return i; \
+    } \
+    _bor_inline val_type *fprefix##InsertUnique(struct_name *t, \
+                                                const key_type *key, \
+                                                const val_type *val) \
+    { \
+        int found; \
+        size_t i = fprefix##InsertSlot(t, key, &found); \
+        if (found) \
+            return &t->slots[i].val; \
+        if (val != NULL){ \
+            t->slots[i].val = *val; \
+        }else{ \
+            memset(&t->slots[i].val, 0, sizeof(val_type)); \
+        } \
+        return NULL; \
+    } \
+    _bor_inline val_type *fprefix##Insert(struct_name *t, \
+                                          const key_type *key, \
+                                          const val_type *val) \
+    { \
+        int found; \
+        size_t i = fprefix##InsertSlot(t, key, &found); \
+        if (val != NULL){ \
+            t->slots[i].val = *val; \
+        }else{ \
+            memset(&t->slots[i].val, 0, sizeof(val_type)); \
+        } \
+        return &t->slots[i].val; \
+    }
+
+#define _BOR_HTABLE_OA_DECL_ERASE(key_type, struct_name, fprefix, hash_func) \
+    _bor_inline int fprefix##Erase(struct_name *t, const key_type *key) \
+    { \
+        size_t i = fprefix##FindSlot(t, key, hash_func(key)); \
+        if (i == t->size) \
+            return -1; \
+        if (__borHTableOASetFree(t->ctrl, i)) \
+            ++t->growth_left; \
+        --t->num_elements; \
+        return 0; \
+    }
+
+
+/**** INLINES ****/
+_bor_inline size_t borHTableOASize(const bor_htable_oa_t *t)
+{
+    return t->size;
+}
+
+_bor_inline size_t borHTableOANumElements(const bor_htable_oa_t *t)
+{
+    return t->num_elements;
+}
+
+_bor_inline unsigned __borHTableOAMatch(const int8_t *ctrl, int8_t h)
+{
+#ifdef __SSE2__
+    __m128i g = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(h)));
+#else /* __SSE2__ */
+    unsigned m = 0;
+    int i;
+    for (i = 0; i < BOR_HTABLE_OA_GROUP; ++i)
+        m |= (unsigned)(ctrl[i] == h) << i;
+    return m;
+#endif /* __SSE2__ */
+}
+
+_bor_inline unsigned __borHTableOAMatchEmpty(const int8_t *ctrl)
+{
+    return __borHTableOAMatch(ctrl, BOR_HTABLE_OA_EMPTY);
+}
+
+_bor_inline unsigned __borHTableOAMatchFree(const int8_t *ctrl)
+{
+#ifdef __SSE2__
+    /* empty and deleted are exactly the control bytes with the sign bit */
+    __m128i g = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(g);
+#else /* __SSE2__ */
+    unsigned m = 0;
+    int i;
+    for (i = 0; i < BOR_HTABLE_OA_GROUP; ++i)
+        m |= (unsigned)(ctrl[i] < 0) << i;
+    return m;
+#endif /* __SSE2__ */
+}
+
+_bor_inline int __borHTableOABit(unsigned mask)
+{
+    return __builtin_ctz(mask);
+}
+
+_bor_inline int8_t __borHTableOAH2(uint64_t hash)
+{
+    return (int8_t)(hash & 0x7f);
+}
+
+_bor_inline size_t __borHTableOAH1(uint64_t hash, size_t size)
+{
+    return (size_t)((hash >> 7) * BOR_HTABLE_OA_GROUP) & (size - 1);
+}
+
+_bor_inline size_t __borHTableOASizeFor(size_t num)
+{
+    size_t size = BOR_HTABLE_OA_MIN_SIZE;
+    while (__borHTableOACapacity(size) < num)
+        size <<= 1;
+    return size;
+}
+
+_bor_inline size_t __borHTableOACapacity(size_t size)
+{
+    return size - size / 8;
+}
+
+_bor_inline size_t __borHTableOAFindFree(const int8_t *ctrl, size_t size,
+                                         uint64_t hash)
+{
+    size_t mask = size - 1, pos, step = 0;
+    unsigned m;
+
+    pos = __borHTableOAH1(hash, size);
+    while (!(m = __borHTableOAMatchFree(ctrl + pos))){
+        step += BOR_HTABLE_OA_GROUP;
+        pos = (pos + step) & mask;
+    }
+    return pos + __borHTableOABit(m);
+}
+
+_bor_inline int __borHTableOASetFree(int8_t *ctrl, size_t slot)
+{
+    size_t group = slot & ~(size_t)(BOR_HTABLE_OA_GROUP - 1);
+
+    /* Probing stops at the first group containing an empty slot, so if
+     * there is one in this group, no probe sequence can continue past it
+     * and the slot does not need a tombstone. */
+    if (__borHTableOAMatchEmpty(ctrl + group)){
+        ctrl[slot] = BOR_HTABLE_OA_EMPTY;
+        return 1;
+    }
+    ctrl[slot] = BOR_HTABLE_OA_DELETED;
+    return 0;
+}
+
+_bor_inline int8_t *__borHTableOACtrlNew(size_t size)
+{
+    int8_t *ctrl = BOR_ALLOC_ARR(int8_t, size);
+    memset(ctrl, BOR_HTABLE_OA_EMPTY, size);
+    return ctrl;
+}
+
+_bor_inline size_t __borHTableOANextSize(size_t size, size_t num_elements)
+{
+    /* If more than half of the capacity is taken by tombstones, just
+     * clean them up, otherwise grow */
+    if (num_elements <= __borHTableOACapacity(size) / 2)
+        return size;
+    return size * 2;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __BOR_HTABLE_OA_H__ */
@@ -55,6 +55,12 @@ typedef int (*bor_htable_eq_fn)(const bor_list_t *key1, const bor_list_t *key2,
                                 void *userdata);
 
 
+/**
+ * Number of buckets of the old table migrated by each insert or erase
+ * during incremental resizing.
+ */
+#define BOR_HTABLE_MIGRATE_STEP 4
+
 /**
  * Hash table structure.
  */
@@ -66,6 +72,12 @@ struct _bor_htable_t {
     bor_htable_hash_fn hash;
     bor_htable_eq_fn eq;
     void *data;
+
+    int incremental;       /*!< True if incremental resizing is enabled */
+    bor_list_t *old_table; /*!< Table being migrated or NULL */
+    size_t old_size;       /*!< Size of .old_table */
+    size_t migrated;       /*!< Number of already migrated buckets of
+                                .old_table */
 };
 typedef struct _bor_htable_t bor_htable_t;
 
@@ -88,6 +100,35 @@ bor_htable_t *borHTableNew(bor_htable_hash_fn hash_func,
  */
 void borHTableDel(bor_htable_t *h);
 
+/**
+ * Enables or disables incremental resizing.
+ * By default, the table is resized at once when it gets full, i.e., all
+ * elements are rehashed during a single insert. If incremental resizing
+ * is enabled, the old buckets are kept aside and a few of them
+ * (BOR_HTABLE_MIGRATE_STEP) are migrated to the new table with each
+ * subsequent insert and erase, so the time of every single operation
+ * stays bounded. Buckets of the new table are allocated lazily, so the
+ * cost of the allocation is spread as well.
+ * Until the migration is finished, the elements can be stored in either
+ * of the tables, so iterating directly over the buckets in {.table} is
+ * not safe in this mode (use borHTableGather() instead).
+ * Disabling the incremental resizing finishes the pending migration.
+ */
+void borHTableSetIncrementalResize(bor_htable_t *m, int enable);
+
+/**
+ * Returns true if there is an unfinished incremental resize.
+ */
+_bor_inline int borHTableResizing(const bor_htable_t *m);
+
+/**
+ * Migrates at most {num_buckets} buckets of the pending incremental
+ * resize. This can be used to finish the migration in idle time, because
+ * borHTableFind() never modifies the table.
+ * Returns true if the migration is still not finished.
+ */
+int borHTableResizeStep(bor_htable_t *m, size_t num_buckets);
+
 /**
  * Returns size of hash map
  */
@@ -195,9 +236,17 @@ _bor_inline size_t borHTableBucket(const bor_htable_t *m,
 
 /**
  * Resize hash table to the specifed size.
+ * Any pending incremental resize is finished first.
  */
 void borHTableResize(bor_htable_t *m, size_t size);
 
+/**
+ * Starts incremental resize of the table to the specified size (see
+ * borHTableSetIncrementalResize()). Any pending incremental resize is
+ * finished first.
+ */
+void borHTableResizeIncremental(bor_htable_t *m, size_t size);
+
 /**
  * Returns next prime suitable for the hash table size that is not lower
  * than hint.
@@ -205,7 +254,19 @@ void borHTableResize(bor_htable_t *m, size_t size);
 _bor_inline size_t borHTableNextPrime(size_t hint);
 
 
+/**** INTERNALS ****/
+/** Searches the not yet migrated part of .old_table */
+bor_list_t *__borHTableFindOld(const bor_htable_t *m, const bor_list_t *key1);
+/** Returns the list of the bucket, initializes it if necessary */
+_bor_inline bor_list_t *__borHTableList(bor_htable_t *m, size_t bucket);
+
+
 /**** INLINES ****/
+_bor_inline int borHTableResizing(const bor_htable_t *m)
+{
+    return m->old_table != NULL;
+}
+
 _bor_inline size_t borHTableSize(const bor_htable_t *t)
 {
     return t->size;
@@ -254,7 +315,11 @@ _bor_inline void borHTableInsertBucket(bor_htable_t *m, size_t bucket,
     if (m->num_elements + 1 > m->size){
         size = borHTableNextPrime(m->num_elements + 1);
         if (size > m->size){
-            borHTableResize(m, size);
+            if (m->incremental){
+                borHTableResizeIncremental(m, size);
+            }else{
+                borHTableResize(m, size);
+            }
 
             // re-compute bucket id because of resize
             bucket = borHTableBucket(m, key1);
@@ -263,13 +328,16 @@ _bor_inline void borHTableInsertBucket(bor_htable_t *m, size_t bucket,
 
     // put item into table
     borHTableInsertBucketNoResize(m, bucket, key1);
+
+    if (m->old_table != NULL)
+        borHTableResizeStep(m, BOR_HTABLE_MIGRATE_STEP);
 }
 
 _bor_inline void borHTableInsertBucketNoResize(bor_htable_t *m,
                                                size_t bucket,
                                                bor_list_t *key1)
 {
-    borListAppend(&m->table[bucket], key1);
+    borListAppend(__borHTableList(m, bucket), key1);
     ++m->num_elements;
 }
 
@@ -289,6 +357,8 @@ _bor_inline int borHTableEraseBucket(bor_htable_t *m, size_t bucket,
     if (item){
         borListDel(item);
         --m->num_elements;
+        if (m->old_table != NULL)
+            borHTableResizeStep(m, BOR_HTABLE_MIGRATE_STEP);
         return 0;
     }
     return -1;
@@ -308,11 +378,16 @@ _bor_inline bor_list_t *borHTableFindBucket(const bor_htable_t *m,
 {
     bor_list_t *item;
 
-    BOR_LIST_FOR_EACH(&m->table[bucket], item){
-        if (m->eq(key1, item, m->data))
-            return item;
+    // a bucket that was never initialized is empty (see __borHTableList())
+    if (m->table[bucket].next != NULL){
+        BOR_LIST_FOR_EACH(&m->table[bucket], item){
+            if (m->eq(key1, item, m->data))
+                return item;
+        }
     }
 
+    if (m->old_table != NULL)
+        return __borHTableFindOld(m, key1);
     return NULL;
 }
 
@@ -327,6 +402,14 @@ _bor_inline size_t borHTableBucket(const bor_htable_t *m,
     return m->hash(key1, m->data) % (bor_htable_key_t)m->size;
 }
 
+_bor_inline bor_list_t *__borHTableList(bor_htable_t *m, size_t bucket)
+{
+    bor_list_t *list = m->table + bucket;
+    if (list->next == NULL)
+        borListInit(list);
+    return list;
+}
+
 _bor_inline size_t borHTableNextPrime(size_t hint)
 {
     static size_t primes[] = {
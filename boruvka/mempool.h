@@ -0,0 +1,159 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_MEMPOOL_H__
+#define __BOR_MEMPOOL_H__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <boruvka/core.h>
+#include <boruvka/list.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Memory Pool
+ * ============
+ *
+ * Slab allocator of small objects. Objects are carved from big slabs by
+ * bumping a pointer and freed objects are kept in free lists of size
+ * classes (multiples of 16 bytes up to BOR_MEMPOOL_MAX_SIZE), so
+ * allocation and deallocation are a few instructions in the common case.
+ * All memory is returned at once by borMemPoolDel() (or made reusable by
+ * borMemPoolReset()), i.e., a structure built from a pool can be torn
+ * down without visiting its objects.
+ *
+ * The size of the object must be passed to borMemPoolFree() too, there
+ * are no per-object headers. Objects bigger than BOR_MEMPOOL_MAX_SIZE
+ * are allocated by malloc() and they are also released by
+ * borMemPoolDel().
+ *
+ * Unless the pool is created with BOR_MEMPOOL_SINGLE_THREAD flag, it can
+ * be used from any number of threads at once: each thread gets its own
+ * cache of free objects and it exchanges objects with the shared lists
+ * in batches of BOR_MEMPOOL_BATCH under a lock. An object can be freed by
+ * other thread than the one that allocated it.
+ *
+ * Allocation macros BOR_POOL_ALLOC() and BOR_POOL_FREE() from alloc.h
+ * fall back to the standard allocation if the pool is NULL.
+ */
+
+/** vvvv */
+
+/** Objects bigger than this are allocated by malloc() */
+#define BOR_MEMPOOL_MAX_SIZE 512
+
+/** Granularity of size classes (and alignment of objects) */
+#define BOR_MEMPOOL_ALIGN 16
+
+/** Number of size classes */
+#define BOR_MEMPOOL_CLASSES (BOR_MEMPOOL_MAX_SIZE / BOR_MEMPOOL_ALIGN)
+
+/** Size of one slab */
+#define BOR_MEMPOOL_SLAB_SIZE (64 * 1024)
+
+/** Number of objects moved between a thread cache and the shared lists
+ *  at once */
+#define BOR_MEMPOOL_BATCH 32
+
+/**
+ * Flag: the pool is used only from one thread at a time, so no locking
+ * and no thread caches are used.
+ */
+#define BOR_MEMPOOL_SINGLE_THREAD 0x1
+
+/** ^^^^ */
+
+/**
+ * Free list of one size class.
+ */
+struct _bor_mempool_list_t {
+    void *head;
+    int len;
+};
+typedef struct _bor_mempool_list_t bor_mempool_list_t;
+
+/**
+ * Per-thread cache of free objects.
+ */
+struct _bor_mempool_cache_t {
+    pthread_t owner;
+    bor_mempool_list_t free[BOR_MEMPOOL_CLASSES];
+    struct _bor_mempool_cache_t *next;
+};
+typedef struct _bor_mempool_cache_t bor_mempool_cache_t;
+
+struct _bor_mempool_t {
+    uint64_t uid;           /*!< Unique ID used by thread-local lookup of
+                                 caches */
+    int flags;
+    pthread_mutex_t lock;   /*!< Protects everything below */
+
+    bor_mempool_list_t free[BOR_MEMPOOL_CLASSES]; /*!< Shared free lists */
+    char *bump;             /*!< Next free byte of the current slab */
+    char *bump_end;         /*!< End of the current slab */
+    char **slab;            /*!< All allocated slabs */
+    int slab_size;          /*!< Number of allocated slabs */
+    int slab_cur;           /*!< Index of the current slab */
+    bor_list_t large;       /*!< Objects allocated by malloc() */
+
+    bor_mempool_cache_t *caches; /*!< Caches of all threads */
+};
+typedef struct _bor_mempool_t bor_mempool_t;
+
+/**
+ * Creates a new empty pool. {flags} is zero or BOR_MEMPOOL_SINGLE_THREAD.
+ */
+bor_mempool_t *borMemPoolNew(int flags);
+
+/**
+ * Frees all memory of the pool including all objects that weren't freed.
+ * No thread may use the pool at the same time.
+ */
+void borMemPoolDel(bor_mempool_t *pool);
+
+/**
+ * Frees all objects at once, but keeps the slabs for the subsequent
+ * allocations.
+ * No thread may use the pool at the same time.
+ */
+void borMemPoolReset(bor_mempool_t *pool);
+
+/**
+ * Allocates {size} bytes aligned to BOR_MEMPOOL_ALIGN.
+ */
+void *borMemPoolAlloc(bor_mempool_t *pool, size_t size);
+
+/**
+ * Returns the object of {size} bytes (the same as was used for its
+ * allocation) to the pool.
+ */
+void borMemPoolFree(bor_mempool_t *pool, void *ptr, size_t size);
+
+/**
+ * Returns number of bytes of slabs allocated by the pool (i.e., without
+ * objects bigger than BOR_MEMPOOL_MAX_SIZE).
+ */
+size_t borMemPoolAllocated(const bor_mempool_t *pool);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BOR_MEMPOOL_H__ */
@@ -390,6 +390,15 @@ void borMesh3Del2(bor_mesh3_t *m,
                   void (*deledge)(bor_mesh3_edge_t *, void *), void *edata,
                   void (*delface)(bor_mesh3_face_t *, void *), void *fdata);
 
+/**
+ * Deletes mesh without disconnecting its vertices, edges and faces, i.e.,
+ * without visiting them at all.
+ * This is meant for meshes whose elements are allocated from a memory
+ * pool (see mempool.h) that is deleted or reset together with the mesh.
+ * The elements must not be used afterwards.
+ */
+void borMesh3DelShallow(bor_mesh3_t *m);
+
 /**
  * Returns number of vertices stored in mesh.
  */
@@ -132,6 +132,26 @@ _bor_inline void borNNLinearUpdate(bor_nn_linear_t *nn, bor_nn_linear_el_t *el);
 size_t borNNLinearNearest(const bor_nn_linear_t *nn, const bor_vec_t *p, size_t num,
                           bor_nn_linear_el_t **els);
 
+/**
+ * Callback for borNNLinearRange(). {dist} is the distance between
+ * element {el} and the query point.
+ */
+typedef void (*bor_nn_linear_range_fn)(bor_nn_linear_el_t *el,
+                                       bor_real_t dist, void *data);
+
+/**
+ * Calls {cb} for each element whose distance from point {p} is at most
+ * {radius}. Elements are reported in the order they were added.
+ * Returns number of reported elements.
+ *
+ * If .dist parameter is a custom callback, {radius} is compared directly
+ * with its values. With the default callback (which returns squared
+ * distance) {radius} and the reported distances are Euclidean.
+ */
+size_t borNNLinearRange(const bor_nn_linear_t *nn, const bor_vec_t *p,
+                        bor_real_t radius, bor_nn_linear_range_fn cb,
+                        void *data);
+
 /**** INLINES ****/
 _bor_inline void borNNLinearElInit(bor_nn_linear_el_t *el, const bor_vec_t *p)
 {
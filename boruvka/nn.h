@@ -20,6 +20,7 @@
 #include <boruvka/gug.h>
 #include <boruvka/vptree.h>
 #include <boruvka/nn-linear.h>
+#include <boruvka/alloc.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -149,6 +150,54 @@ _bor_inline void borNNUpdate(bor_nn_t *nn, bor_nn_el_t *el);
 _bor_inline size_t borNNNearest(const bor_nn_t *nn, const bor_vec_t *p,
                                 size_t num, bor_nn_el_t **els);
 
+/**
+ * Callback for borNNRange(). {dist} is the distance between element {el}
+ * and the query point.
+ */
+typedef void (*bor_nn_range_fn)(bor_nn_el_t *el, bor_real_t dist, void *data);
+
+/**
+ * Calls {cb} for each element whose distance from the point {p} is at
+ * most {radius}. Elements are reported in no particular order and the
+ * search struct must not be modified from the callback. Number of
+ * reported elements is returned.
+ *
+ * GUG visits only cells intersecting the ball, VP-tree prunes subtrees
+ * using radii of its nodes and linear search checks all elements.
+ */
+_bor_inline size_t borNNRange(const bor_nn_t *nn, const bor_vec_t *p,
+                              bor_real_t radius,
+                              bor_nn_range_fn cb, void *data);
+
+/**
+ * Growable buffer for results of borNNRangeBuf().
+ */
+struct _bor_nn_range_buf_t {
+    bor_nn_el_t **els; /*!< Found elements */
+    bor_real_t *dist;  /*!< dist[i] is distance of els[i] */
+    size_t len;        /*!< Number of found elements */
+    size_t alloc;      /*!< Allocated size of .els and .dist */
+};
+typedef struct _bor_nn_range_buf_t bor_nn_range_buf_t;
+
+/**
+ * Initializes empty buffer.
+ */
+_bor_inline void borNNRangeBufInit(bor_nn_range_buf_t *buf);
+
+/**
+ * Frees memory allocated by the buffer.
+ */
+_bor_inline void borNNRangeBufFree(bor_nn_range_buf_t *buf);
+
+/**
+ * Same as borNNRange() but the found elements are stored in {buf} which
+ * is emptied first and grown as needed. The buffer can be reused for
+ * many queries to avoid reallocations. Returns buf->len.
+ */
+_bor_inline size_t borNNRangeBuf(const bor_nn_t *nn, const bor_vec_t *p,
+                                 bor_real_t radius, bor_nn_range_buf_t *buf);
+
 
 /**** INLINES ****/
 _bor_inline void borNNParamsInit(bor_nn_params_t *params)
@@ -253,6 +302,64 @@ _bor_inline size_t borNNNearest(const bor_nn_t *nn, const bor_vec_t *p,
     return 0;
 }
 
+_bor_inline size_t borNNRange(const bor_nn_t *nn, const bor_vec_t *p,
+                              bor_real_t radius,
+                              bor_nn_range_fn cb, void *data)
+{
+    if (nn->type == BOR_NN_GUG){
+        return borGUGRange((const bor_gug_t *)nn, p, radius,
+                           (bor_gug_range_fn)cb, data);
+    }else if (nn->type == BOR_NN_VPTREE){
+        return borVPTreeRange((const bor_vptree_t *)nn, p, radius,
+                              (bor_vptree_range_fn)cb, data);
+    }else if (nn->type == BOR_NN_LINEAR){
+        return borNNLinearRange((const bor_nn_linear_t *)nn, p, radius,
+                                (bor_nn_linear_range_fn)cb, data);
+    }
+
+    return 0;
+}
+
+_bor_inline void borNNRangeBufInit(bor_nn_range_buf_t *buf)
+{
+    buf->els   = NULL;
+    buf->dist  = NULL;
+    buf->len   = 0;
+    buf->alloc = 0;
+}
+
+_bor_inline void borNNRangeBufFree(bor_nn_range_buf_t *buf)
+{
+    if (buf->els)
+        BOR_FREE(buf->els);
+    if (buf->dist)
+        BOR_FREE(buf->dist);
+    borNNRangeBufInit(buf);
+}
+
+_bor_inline void __borNNRangeBufAdd(bor_nn_el_t *el, bor_real_t dist,
+                                    void *data)
+{
+    bor_nn_range_buf_t *buf = (bor_nn_range_buf_t *)data;
+
+    if (buf->len == buf->alloc){
+        buf->alloc = (buf->alloc == 0 ? 16 : buf->alloc * 2);
+        buf->els  = BOR_REALLOC_ARR(buf->els, bor_nn_el_t *, buf->alloc);
+        buf->dist = BOR_REALLOC_ARR(buf->dist, bor_real_t, buf->alloc);
+    }
+    buf->els[buf->len]  = el;
+    buf->dist[buf->len] = dist;
+    ++buf->len;
+}
+
+_bor_inline size_t borNNRangeBuf(const bor_nn_t *nn, const bor_vec_t *p,
+                                 bor_real_t radius, bor_nn_range_buf_t *buf)
+{
+    buf->len = 0;
+    borNNRange(nn, p, radius, __borNNRangeBufAdd, (void *)buf);
+    return buf->len;
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
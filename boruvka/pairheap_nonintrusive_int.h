@@ -19,6 +19,7 @@
 
 #include <boruvka/core.h>
 #include <boruvka/list.h>
+#include <boruvka/mempool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,7 @@ struct _bor_pairheap_nonintr_int_t {
     bor_list_t root; /*!< List of root nodes. In fact, pairing heap has
                           always one root node, but we need this to make
                           effecient (lazy) merging. */
+    bor_mempool_t *nodes; /*!< Memory pool of the nodes */
 };
 typedef struct _bor_pairheap_nonintr_int_t bor_pairheap_nonintr_int_t;
 /** ^^^^ */
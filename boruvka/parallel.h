@@ -0,0 +1,95 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_PARALLEL_H__
+#define __BOR_PARALLEL_H__
+
+#include <boruvka/task-pool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Parallel Loops
+ * ===============
+ *
+ * Parallel-for and parallel-reduce over an index range executed by the
+ * threads of bor_task_pool_t.
+ *
+ * The range is split adaptively: each thread repeatedly claims a chunk of
+ * 1/(2 * num_threads) of the remaining indices (but at least {grain}
+ * indices), so big chunks are handed out first and small ones at the end
+ * to balance the load. The callback is called once per chunk.
+ *
+ * If {tp} is NULL, has only one thread or the range is not longer than
+ * {grain}, the callback is called once for the whole range in the calling
+ * thread (with thinfo->id set to 0).
+ *
+ * Both functions return after the whole range is processed. They use
+ * borTaskPoolBarrier() so they must not be called from a task running in
+ * the same task pool.
+ */
+
+/**
+ * Callback processing indices [from, to).
+ */
+typedef void (*bor_parallel_for_fn)(size_t from, size_t to, void *data,
+                                    const bor_task_pool_thinfo_t *thinfo);
+
+/**
+ * Callback accumulating indices [from, to) into {acc}.
+ */
+typedef void (*bor_parallel_reduce_fn)(size_t from, size_t to, void *acc,
+                                       void *data,
+                                       const bor_task_pool_thinfo_t *thinfo);
+
+/**
+ * Callback merging accumulator {acc2} into {acc}.
+ */
+typedef void (*bor_parallel_join_fn)(void *acc, const void *acc2,
+                                     void *data);
+
+/**
+ * Calls {fn} on chunks of range [from, to).
+ * If {grain} is 0, it is set to 1.
+ */
+void borParallelFor(bor_task_pool_t *tp, size_t from, size_t to,
+                    size_t grain, bor_parallel_for_fn fn, void *data);
+
+/**
+ * Reduces range [from, to) into {acc} which is a memory of {acc_size}
+ * bytes.
+ *
+ * {acc} must be initialized to the neutral element of the reduction
+ * before the call. Each thread gets its own copy of {acc}, chunks are
+ * accumulated into the copy of the thread that claimed them and finally
+ * all copies are merged into {acc} using {join} in order of thread IDs.
+ * Note that assignment of chunks to threads is not deterministic, so
+ * {fn} and {join} should be associative and commutative (e.g., min, max;
+ * floating point sums may differ in rounding between runs).
+ */
+void borParallelReduce(bor_task_pool_t *tp, size_t from, size_t to,
+                       size_t grain, void *acc, size_t acc_size,
+                       bor_parallel_reduce_fn fn, bor_parallel_join_fn join,
+                       void *data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __BOR_PARALLEL_H__ */
@@ -20,6 +20,7 @@
 #include <boruvka/vec.h>
 #include <boruvka/rand-mt.h>
 #include <boruvka/pc-internal.h>
+#include <boruvka/task-pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +47,9 @@ struct _bor_pc_t {
                                 BOR_PC_MIN_CHUNK_SIZE */
 
     bor_rand_mt_t *rand;
+
+    bor_task_pool_t *tp; /*!< Task pool used by borPCAABB() and
+                              borPCPermutate(), NULL by default */
 };
 typedef struct _bor_pc_t bor_pc_t;
 
@@ -87,9 +91,18 @@ _bor_inline size_t borPCLen(const bor_pc_t *pc);
  */
 bor_vec_t *borPCGet(bor_pc_t *pc, size_t n);
 
+/**
+ * Sets task pool used for parallel processing of points.
+ * The task pool must be already running and is not owned by point cloud.
+ * Set {tp} to NULL to process points serially.
+ */
+_bor_inline void borPCSetTaskPool(bor_pc_t *pc, bor_task_pool_t *tp);
+
 /**
  * Permutates points in point cloud.
  * Permutated pc can be used for random access to whole point clouds' pool.
+ * If task pool is set, the points are moved in parallel which needs
+ * temporary copy of the whole point cloud.
  */
 void borPCPermutate(bor_pc_t *pc);
 
@@ -158,6 +171,11 @@ _bor_inline size_t borPCLen(const bor_pc_t *pc)
     return pc->len;
 }
 
+_bor_inline void borPCSetTaskPool(bor_pc_t *pc, bor_task_pool_t *tp)
+{
+    pc->tp = tp;
+}
+
 
 
 
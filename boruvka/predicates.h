@@ -176,6 +176,64 @@ bor_real_t borPredInSphere(const bor_pred_t *pred,
                            const bor_vec3_t *pd,
                            const bor_vec3_t *pe);
 
+
+/**
+ * Batch Predicates
+ * -----------------
+ * Following functions evaluate one predicate for {n} query points (the
+ * last argument of the corresponding single-query function) against the
+ * same fixed points and store the results into {res}. The results are
+ * the same as if the robust single-query function was called for each
+ * query.
+ *
+ * The floating-point filter is evaluated for blocks of queries at once
+ * in a form the compiler vectorizes, and only the queries whose sign
+ * can't be decided by the filter fall back to the adaptive exact
+ * arithmetic.
+ * All functions return number of queries that needed the exact
+ * arithmetic.
+ */
+
+/**
+ * Batch version of borPredOrient2d() with queries {pc}.
+ */
+size_t borPredOrient2dBatch(const bor_pred_t *pred,
+                            const bor_vec2_t *pa,
+                            const bor_vec2_t *pb,
+                            const bor_vec2_t *pc, size_t n,
+                            bor_real_t *res);
+
+/**
+ * Batch version of borPredOrient3d() with queries {pd}.
+ */
+size_t borPredOrient3dBatch(const bor_pred_t *pred,
+                            const bor_vec3_t *pa,
+                            const bor_vec3_t *pb,
+                            const bor_vec3_t *pc,
+                            const bor_vec3_t *pd, size_t n,
+                            bor_real_t *res);
+
+/**
+ * Batch version of borPredInCircle() with queries {pd}.
+ */
+size_t borPredInCircleBatch(const bor_pred_t *pred,
+                            const bor_vec2_t *pa,
+                            const bor_vec2_t *pb,
+                            const bor_vec2_t *pc,
+                            const bor_vec2_t *pd, size_t n,
+                            bor_real_t *res);
+
+/**
+ * Batch version of borPredInSphere() with queries {pe}.
+ */
+size_t borPredInSphereBatch(const bor_pred_t *pred,
+                            const bor_vec3_t *pa,
+                            const bor_vec3_t *pb,
+                            const bor_vec3_t *pc,
+                            const bor_vec3_t *pd,
+                            const bor_vec3_t *pe, size_t n,
+                            bor_real_t *res);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -20,6 +20,7 @@
 #include <boruvka/core.h>
 #include <boruvka/pc.h>
 #include <boruvka/mesh3.h>
+#include <boruvka/mempool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,9 +48,16 @@ struct _bor_qhull_mesh3_t {
 
     bor_vec3_t *vecs; /*!< Array of Vec3 vectors */
     size_t vecs_len;  /*!< Length of .vecs array */
+
+    bor_mempool_t *pool; /*!< Memory pool of vertices and edges of .mesh */
 };
 typedef struct _bor_qhull_mesh3_t bor_qhull_mesh3_t;
 
+/**
+ * Creates new empty mesh with array of {vertices} vectors.
+ */
+bor_qhull_mesh3_t *borQHullMesh3New(size_t vertices);
+
 /**
  * Deletes mesh3 returned from some qhull functions.
  */
@@ -68,6 +76,7 @@ _bor_inline bor_mesh3_t *borQHullMesh3(bor_qhull_mesh3_t *m);
  */
 struct _bor_qdelaunay_t {
     char *bin_path; /*!< Path to qdelaunay binary */
+    char *buf;      /*!< I/O buffer reused by all calls */
 };
 typedef struct _bor_qdelaunay_t bor_qdelaunay_t;
 
@@ -94,6 +103,14 @@ void borQDelaunaySetPath(bor_qdelaunay_t *q, const char *path);
 /**
  * Performs 3D delaunay triangulation on given point cloud.
  * New Mesh3 instance is returned.
+ *
+ * qdelaunay is spawned (without fork()) with options "Qt i", points are
+ * sent in exact hexadecimal notation and the indices of tetrahedra are
+ * parsed directly from a large read buffer.
+ *
+ * If the path to qdelaunay binary is not set or the binary is not
+ * executable, the triangulation is computed in-process by
+ * borDelaunayMesh3() instead of running qdelaunay.
  */
 bor_qhull_mesh3_t *borQDelaunayMesh3(bor_qdelaunay_t *q, const bor_pc_t *pc);
 
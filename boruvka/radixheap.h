@@ -0,0 +1,183 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_RADIXHEAP_H__
+#define __BOR_RADIXHEAP_H__
+
+#include <stdint.h>
+#include <boruvka/core.h>
+#include <boruvka/list.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Radix Heap
+ * ===========
+ *
+ * Monotone priority queue with unsigned integer keys, i.e., a key of any
+ * node inserted into the heap (or decreased) must not be lower than the
+ * key of the last extracted node. This holds for Dijkstra algorithm with
+ * non-negative edge weights.
+ *
+ * Nodes are kept in 65 buckets, bucket i holds the nodes whose key
+ * differs from the last extracted key first in the (i-1)-th bit. Each
+ * node moves to a lower bucket at most 64 times, so all operations take
+ * amortized O(1) time for bounded number of bits, except extract-min
+ * which takes amortized O(log C) where C is the maximal difference of
+ * keys.
+ */
+
+/** vvvv */
+#define BOR_RADIXHEAP_BUCKETS 65
+
+/**
+ * Connector to the radix heap.
+ */
+struct _bor_radixheap_node_t {
+    bor_list_t list; /*!< Connection into bucket */
+    uint64_t key;    /*!< Key of the node */
+    int bucket;      /*!< Index of the bucket */
+};
+typedef struct _bor_radixheap_node_t bor_radixheap_node_t;
+
+struct _bor_radixheap_t {
+    bor_list_t bucket[BOR_RADIXHEAP_BUCKETS];
+    uint64_t last;    /*!< Last extracted key */
+    size_t size;      /*!< Number of nodes in the heap */
+};
+typedef struct _bor_radixheap_t bor_radixheap_t;
+/** ^^^^ */
+
+
+/**
+ * Functions
+ * ----------
+ */
+
+/**
+ * Creates new empty heap.
+ */
+bor_radixheap_t *borRadixHeapNew(void);
+
+/**
+ * Deletes heap.
+ * Note that individual nodes are not disconnected from heap.
+ */
+void borRadixHeapDel(bor_radixheap_t *h);
+
+/**
+ * Removes all nodes from the heap and resets the last extracted key to
+ * zero.
+ */
+void borRadixHeapClear(bor_radixheap_t *h);
+
+/**
+ * Returns true if heap is empty.
+ */
+_bor_inline int borRadixHeapEmpty(const bor_radixheap_t *h);
+
+/**
+ * Returns key of the node.
+ */
+_bor_inline uint64_t borRadixHeapKey(const bor_radixheap_node_t *n);
+
+/**
+ * Adds node with the {key} to the heap. The key must not be lower than
+ * the key of the last extracted node.
+ */
+_bor_inline void borRadixHeapAdd(bor_radixheap_t *h,
+                                 bor_radixheap_node_t *n, uint64_t key);
+
+/**
+ * Removes and returns the node with the minimal key.
+ * The heap must not be empty.
+ */
+bor_radixheap_node_t *borRadixHeapExtractMin(bor_radixheap_t *h);
+
+/**
+ * Decreases key of the node already in the heap. The new key must not be
+ * lower than the key of the last extracted node.
+ */
+_bor_inline void borRadixHeapDecreaseKey(bor_radixheap_t *h,
+                                         bor_radixheap_node_t *n,
+                                         uint64_t key);
+
+/**
+ * Removes the node from the heap.
+ */
+_bor_inline void borRadixHeapRemove(bor_radixheap_t *h,
+                                    bor_radixheap_node_t *n);
+
+
+/**** INLINES ****/
+_bor_inline int __borRadixHeapBucket(const bor_radixheap_t *h, uint64_t key)
+{
+    uint64_t x = key ^ h->last;
+    if (x == 0)
+        return 0;
+    return 64 - __builtin_clzll(x);
+}
+
+_bor_inline int borRadixHeapEmpty(const bor_radixheap_t *h)
+{
+    return h->size == 0;
+}
+
+_bor_inline uint64_t borRadixHeapKey(const bor_radixheap_node_t *n)
+{
+    return n->key;
+}
+
+_bor_inline void borRadixHeapAdd(bor_radixheap_t *h,
+                                 bor_radixheap_node_t *n, uint64_t key)
+{
+    int b = __borRadixHeapBucket(h, key);
+
+    n->key = key;
+    n->bucket = b;
+    borListAppend(&h->bucket[b], &n->list);
+    ++h->size;
+}
+
+_bor_inline void borRadixHeapDecreaseKey(bor_radixheap_t *h,
+                                         bor_radixheap_node_t *n,
+                                         uint64_t key)
+{
+    int b = __borRadixHeapBucket(h, key);
+
+    n->key = key;
+    if (b != n->bucket){
+        borListDel(&n->list);
+        borListAppend(&h->bucket[b], &n->list);
+        n->bucket = b;
+    }
+}
+
+_bor_inline void borRadixHeapRemove(bor_radixheap_t *h,
+                                    bor_radixheap_node_t *n)
+{
+    borListDel(&n->list);
+    --h->size;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BOR_RADIXHEAP_H__ */
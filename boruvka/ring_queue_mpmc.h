@@ -0,0 +1,145 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#ifndef __BOR_RING_QUEUE_MPMC_H__
+#define __BOR_RING_QUEUE_MPMC_H__
+
+#include <stdint.h>
+#include <boruvka/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Lock-free Bounded MPMC Ring Queue
+ * ==================================
+ *
+ * Bounded queue of data pointers for multiple producers and multiple
+ * consumers. Each slot of the ring buffer carries a sequence number that
+ * tells whether the slot is ready to be written or read in the current
+ * lap, so push and pop need only one CAS on the tail (head) counter.
+ *
+ * Unlike bor_ring_queue_t, the buffer is never extended, push fails if
+ * the queue is full.
+ *
+ * Blocking variants spin for a while, then yield the CPU a few times and
+ * then sleep on a futex (on Linux, elsewhere they fall back to sleeping in
+ * short intervals). Producers and consumers that do not block never make
+ * a system call unless some thread is sleeping.
+ */
+
+/** Size of cache line used for padding */
+#define BOR_RING_QUEUE_MPMC_CACHE_LINE 64
+
+struct _bor_ring_queue_mpmc_cell_t {
+    size_t seq;
+    void *data;
+};
+typedef struct _bor_ring_queue_mpmc_cell_t bor_ring_queue_mpmc_cell_t;
+
+struct _bor_ring_queue_mpmc_t {
+    bor_ring_queue_mpmc_cell_t *buf; /*!< Ring buffer */
+    size_t mask;                     /*!< Size of buffer - 1 */
+    char _pad0[BOR_RING_QUEUE_MPMC_CACHE_LINE];
+    size_t tail;                     /*!< Position of next push */
+    char _pad1[BOR_RING_QUEUE_MPMC_CACHE_LINE];
+    size_t head;                     /*!< Position of next pop */
+    char _pad2[BOR_RING_QUEUE_MPMC_CACHE_LINE];
+    uint32_t pop_futex;   /*!< Bumped by push if consumers sleep */
+    int pop_waiters;      /*!< Number of sleeping consumers */
+    uint32_t push_futex;  /*!< Bumped by pop if producers sleep */
+    int push_waiters;     /*!< Number of sleeping producers */
+};
+typedef struct _bor_ring_queue_mpmc_t bor_ring_queue_mpmc_t;
+
+/**
+ * Initializes queue with room for at least {size} elements (rounded up to
+ * power of two).
+ */
+void borRingQueueMPMCInit(bor_ring_queue_mpmc_t *q, size_t size);
+
+/**
+ * Frees allocated resources.
+ */
+void borRingQueueMPMCFree(bor_ring_queue_mpmc_t *q);
+
+/**
+ * Returns capacity of the queue.
+ */
+_bor_inline size_t borRingQueueMPMCSize(const bor_ring_queue_mpmc_t *q);
+
+/**
+ * Pushes data pointer to the queue.
+ * Returns 0 on success, -1 if the queue is full.
+ */
+int borRingQueueMPMCPush(bor_ring_queue_mpmc_t *q, void *data);
+
+/**
+ * Pops data pointer from the queue.
+ * Returns 0 on success, -1 if the queue is empty.
+ */
+int borRingQueueMPMCPop(bor_ring_queue_mpmc_t *q, void **data);
+
+/**
+ * Pushes up to {len} data pointers from {data} at once.
+ * Returns number of pushed elements, i.e., elements data[0], ...,
+ * data[ret - 1] were pushed.
+ * Only slots that are already free are reserved (with single CAS), so
+ * the call never waits for other threads.
+ */
+size_t borRingQueueMPMCPushBatch(bor_ring_queue_mpmc_t *q,
+                                 void **data, size_t len);
+
+/**
+ * Pops up to {len} data pointers into {data} at once.
+ * Returns number of popped elements.
+ * Similarly to borRingQueueMPMCPushBatch(), only slots that are already
+ * written are reserved and the call never waits.
+ */
+size_t borRingQueueMPMCPopBatch(bor_ring_queue_mpmc_t *q,
+                                void **data, size_t len);
+
+/**
+ * Pushes data pointer, blocks while the queue is full.
+ */
+void borRingQueueMPMCPushBlock(bor_ring_queue_mpmc_t *q, void *data);
+
+/**
+ * Pops data pointer, blocks while the queue is empty.
+ */
+void *borRingQueueMPMCPopBlock(bor_ring_queue_mpmc_t *q);
+
+/**
+ * Same as borRingQueueMPMCPopBlock() but gives up after {time_in_ms}
+ * milliseconds. Returns 0 on success and -1 on timeout.
+ */
+int borRingQueueMPMCPopBlockTimeout(bor_ring_queue_mpmc_t *q,
+                                    int time_in_ms, void **data);
+
+
+/**** INLINES ****/
+_bor_inline size_t borRingQueueMPMCSize(const bor_ring_queue_mpmc_t *q)
+{
+    return q->mask + 1;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __BOR_RING_QUEUE_MPMC_H__ */
@@ -78,6 +78,9 @@ void borSCCFree(bor_scc_t *scc);
 
 /**
  * Finds strongly connected components -- it fills .comp* members.
+ * The Tarjan's algorithm runs with an explicit stack instead of recursion,
+ * so the depth of the search is limited only by the memory.
+ * See also borGraphCSRSCC() and borGraphCSRSCCPar() in graph-csr.h.
  */
 void borSCC(bor_scc_t *scc);
 
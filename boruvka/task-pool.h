@@ -21,6 +21,7 @@
 #include <semaphore.h>
 #include <boruvka/core.h>
 #include <boruvka/list.h>
+#include <boruvka/mempool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,6 +68,7 @@ struct _bor_task_pool_t {
     size_t threads_len;               /*!< Number of .threads array */
     int started;                      /*!< Set to 1 if all threads were
                                            started */
+    bor_mempool_t *tasks;             /*!< Memory pool of task descriptors */
 };
 typedef struct _bor_task_pool_t bor_task_pool_t;
 
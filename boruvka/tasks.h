@@ -29,23 +29,54 @@ extern "C" {
 /**
  * Tasks - Abstraction for Paralelization Using Threads
  * =====================================================
+ *
+ * Each thread owns a work-stealing deque (Chase-Lev). Tasks added from
+ * inside a running task are pushed to the deque of the current thread
+ * and idle threads steal them from the other end. Tasks added from
+ * outside the worker threads go to a shared injection queue. Task
+ * descriptors are recycled, so adding a task does not allocate memory in
+ * the steady state.
+ *
+ * Fork/join parallelism is supported by task groups, see
+ * borTasksSpawn() and borTasksJoin().
  */
-struct _bor_tasks_t {
-    bor_list_t tasks;     /*!< List of tasks */
-    bor_list_t threads;   /*!< List of all threads */
-    size_t threads_len;   /*!< Number of threads in list */
-    int next_id;          /*!< Next unique ID for threads */
+struct _bor_tasks_thread_t;
+struct _bor_tasks_task_t;
 
-    pthread_mutex_t lock; /*!< Global lock for thread synchronization */
-    sem_t full, empty;    /*!< Full/Empty semaphores for tasks queue */
+struct _bor_tasks_t {
+    struct _bor_tasks_thread_t **threads; /*!< Array of all threads */
+    size_t threads_len;   /*!< Number of threads */
+    int running;          /*!< True if threads were started */
+    int quit;             /*!< Set to 1 when threads should terminate */
+    int cancel;           /*!< Set to 1 if remaining tasks should be
+                               dropped */
+
+    pthread_mutex_t lock; /*!< Lock for injection queue, descriptor pool
+                               and sleeping threads */
+    bor_list_t inject;    /*!< Tasks added from outside of threads */
+    int inject_len;       /*!< Number of tasks in .inject */
+    struct _bor_tasks_task_t *free; /*!< Pool of unused descriptors */
+
+    int sleeping;         /*!< Number of sleeping threads */
+    unsigned long epoch;  /*!< Incremented whenever task is published */
+    pthread_cond_t wake;  /*!< Idle threads sleep here */
 
     int pending;                  /*!< Number of pending tasks */
     pthread_cond_t pending_cond;  /*!< Conditional variable to allow user
                                        code to wait until all tasks are
                                        finished */
+    pthread_cond_t group_cond;    /*!< Signaled when any group finishes */
 };
 typedef struct _bor_tasks_t bor_tasks_t;
 
+/**
+ * Group of tasks that can be waited for using borTasksJoin().
+ */
+struct _bor_tasks_group_t {
+    int pending; /*!< Number of unfinished tasks in group */
+};
+typedef struct _bor_tasks_group_t bor_tasks_group_t;
+
 /**
  * Info about thread.
  */
@@ -93,8 +124,9 @@ _bor_inline size_t borTasksSize(const bor_tasks_t *t);
 void borTasksCancelDel(bor_tasks_t *t);
 
 /**
- * Adds task to an end of queue.
- * Returns 0 on success.
+ * Adds task to the queue.
+ * If called from within a task, the task is pushed to the deque of the
+ * current thread.
  */
 void borTasksAdd(bor_tasks_t *t, bor_tasks_fn fn, int id, void *data);
 
@@ -119,9 +151,34 @@ void borTasksRunBlock(bor_tasks_t *t);
  */
 void borTasksBarrier(bor_tasks_t *t);
 
+/**
+ * Initializes empty task group.
+ */
+_bor_inline void borTasksGroupInit(bor_tasks_group_t *g);
+
+/**
+ * Adds task as a part of group {g}.
+ * If called from within a task, the new task is pushed to the deque of
+ * the current thread, so it can be stolen by the idle threads.
+ */
+void borTasksSpawn(bor_tasks_t *t, bor_tasks_group_t *g,
+                   bor_tasks_fn fn, int id, void *data);
+
+/**
+ * Blocks until all tasks in group {g} are finished.
+ * If called from within a task, the current thread executes other tasks
+ * while waiting, so nested fork/join does not deadlock.
+ */
+void borTasksJoin(bor_tasks_t *t, bor_tasks_group_t *g);
+
 // TODO: AddThreads()/RemoveThreads()
 
 /**** INLINES ****/
+_bor_inline void borTasksGroupInit(bor_tasks_group_t *g)
+{
+    g->pending = 0;
+}
+
 _bor_inline size_t borTasksNumThreads(const bor_tasks_t *t)
 {
     return t->threads_len;
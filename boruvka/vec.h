@@ -141,6 +141,62 @@ _bor_inline bor_real_t borVecDist2(size_t size, const bor_vec_t *a, const bor_ve
  */
 _bor_inline bor_real_t borVecDist(size_t size, const bor_vec_t *a, const bor_vec_t *b);
 
+/**
+ * Computes squared distances between point {p} and {len} points {vs} and
+ * stores them into {dist} (dist[i] is distance between p and vs[i]).
+ * Several distances are computed at once using SIMD instructions if
+ * available, see borVecSIMDSet().
+ */
+void borVecDist2Batch(size_t size, const bor_vec_t *p,
+                      const bor_vec_t **vs, size_t len, bor_real_t *dist);
+
+/**
+ * Maximal dimension for which borVecDist2Batch() is faster than computing
+ * the distances one by one. For bigger dimensions the function falls
+ * back to the plain loop, so it is better not to gather the points into
+ * blocks at all.
+ */
+#define BOR_VEC_DIST2_BATCH_MAX 4
+
+/**
+ * Same as borVecDist2Batch() but the points are stored in
+ * structure-of-arrays layout, i.e., coords[i * stride + j] is i'th
+ * coordinate of j'th point.
+ */
+void borVecDist2BatchSoA(size_t size, const bor_vec_t *p,
+                         const bor_real_t *coords, size_t stride,
+                         size_t len, bor_real_t *dist);
+
+/**
+ * SIMD Implementation
+ * --------------------
+ *
+ * Batch functions (borVecDist2Batch*()) use the best instruction set
+ * supported by the CPU the code is running on. The selection is made at
+ * runtime (using cpuid) on the first call and can be overridden by
+ * borVecSIMDSet(). Results of the implementations may differ in
+ * rounding, so they should be compared with a tolerance.
+ */
+
+/** vvvv */
+#define BOR_VEC_SIMD_AUTO 0 /*!< Best available instruction set */
+#define BOR_VEC_SIMD_NONE 1 /*!< Plain C implementation */
+#define BOR_VEC_SIMD_SSE  2 /*!< SSE2 */
+#define BOR_VEC_SIMD_AVX2 3 /*!< AVX2 */
+/** ^^^^ */
+
+/**
+ * Selects implementation of batch functions. If the requested
+ * instruction set isn't supported by CPU, the best supported one is used
+ * instead. Returns the selected implementation (never BOR_VEC_SIMD_AUTO).
+ */
+int borVecSIMDSet(int impl);
+
+/**
+ * Returns currently used implementation of batch functions.
+ */
+int borVecSIMD(void);
+
 
 /**
  * Adds coordinates of vector w to vector v.
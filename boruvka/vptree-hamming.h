@@ -19,6 +19,7 @@
 
 #include <boruvka/core.h>
 #include <boruvka/list.h>
+#include <boruvka/task-pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -149,6 +150,67 @@ size_t borVPTreeHammingNearest(const bor_vptree_hamming_t *vp,
                                const unsigned char *p, size_t num,
                                bor_vptree_hamming_el_t **els);
 
+/**
+ * Finds {num} nearest elements for each of {len} query points {ps}.
+ * Array {els} must have at least {len} * {num} items, nearest elements to
+ * i'th query point are stored in els[i * num], ..., els[i * num + num - 1]
+ * and slots that weren't filled are set to NULL. If {found} is non-NULL
+ * it must have {len} items and number of elements found for i'th query
+ * is stored in found[i] (zero for all queries if {num} is zero).
+ *
+ * The traversal stack and the other scratch buffers are allocated once
+ * per batch for each thread and reused for all queries the thread
+ * processes. If task pool {tp} is non-NULL, queries are processed in
+ * parallel by threads of the (already running) pool using
+ * borParallelFor(). The tree must not be modified during the call.
+ */
+void borVPTreeHammingNearestBatch(const bor_vptree_hamming_t *vp,
+                                  const unsigned char **ps, size_t len,
+                                  size_t num,
+                                  bor_vptree_hamming_el_t **els,
+                                  size_t *found,
+                                  bor_task_pool_t *tp);
+
+
+/**
+ * Distance Implementation
+ * ------------------------
+ *
+ * Keys are compared by 64-bit words (or wider vectors) and bits are
+ * counted using the best instruction set supported by the CPU. The
+ * selection is made at runtime on creation of the first tree and can be
+ * overridden by borVPTreeHammingImplSet(). Keys don't need to be aligned.
+ * BOR_VPTREE_HAMMING_AVX2 is never selected automatically because it is
+ * slower than POPCNT for keys up to 512 bits.
+ */
+
+/** vvvv */
+#define BOR_VPTREE_HAMMING_AUTO   0 /*!< Best available implementation */
+#define BOR_VPTREE_HAMMING_NONE   1 /*!< Plain C */
+#define BOR_VPTREE_HAMMING_POPCNT 2 /*!< POPCNT instruction */
+#define BOR_VPTREE_HAMMING_AVX2   3 /*!< AVX2 nibble lookup */
+#define BOR_VPTREE_HAMMING_AVX512 4 /*!< AVX-512 VPOPCNTDQ */
+/** ^^^^ */
+
+/**
+ * Selects implementation of Hamming distance. If the requested one isn't
+ * supported by CPU, the best supported one is used instead. Returns the
+ * selected implementation (never BOR_VPTREE_HAMMING_AUTO).
+ * Should not be called while any tree is being queried from other thread.
+ */
+int borVPTreeHammingImplSet(int impl);
+
+/**
+ * Returns currently used implementation of Hamming distance.
+ */
+int borVPTreeHammingImpl(void);
+
+/**
+ * Returns Hamming distance between two keys of {size} bytes.
+ */
+int borVPTreeHammingDist(const unsigned char *p1, const unsigned char *p2,
+                         size_t size);
+
 
 #if 0
 void borVPTreeDump(bor_vptree_t *vp, FILE *out);
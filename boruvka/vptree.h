@@ -20,6 +20,8 @@
 #include <boruvka/core.h>
 #include <boruvka/vec.h>
 #include <boruvka/list.h>
+#include <boruvka/mempool.h>
+#include <boruvka/task-pool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +72,34 @@ struct _bor_vptree_params_t {
     int maxsize;          /*!< Maximal number of elements in leaf node. Default: 2 */
     int samplesize;       /*!< Size of the samples used in *Build()
                                function. Default: 5 */
+    int approx;           /*!< Set to true if borVPTreeNearest() should
+                               use approximate search (see
+                               borVPTreeNearestApprox()). Default: False */
+    bor_real_t approx_eps; /*!< Approximate search prunes subtrees as if
+                                the current search radius was divided by
+                                (1 + .approx_eps), i.e., the found
+                                nearest element is at most (1 + eps)
+                                times farther than the exact one (if
+                                .approx_leaves doesn't stop the search
+                                first). Default: 0 */
+    size_t approx_leaves; /*!< Maximal number of leaves visited by
+                               approximate search, leaves closer to the
+                               query point are visited first. Zero means
+                               no limit. Default: 0 */
+    uint32_t seed;        /*!< Seed of random number generator used in
+                               *Build() function. Zero means that the
+                               generator is seeded automatically.
+                               Default: 0 */
+    bor_task_pool_t *tp;  /*!< If non-NULL, *Build() function builds
+                               independent subtrees in parallel using
+                               this (already running) task pool.
+                               Default: NULL */
+    size_t parsize;       /*!< Subtrees with at most this number of
+                               elements are built as a whole by one
+                               thread, larger ones are split level by
+                               level. For a fixed non-zero .seed the
+                               built tree depends only on .seed and
+                               .parsize, not on .tp. Default: 10000 */
 };
 typedef struct _bor_vptree_params_t bor_vptree_params_t;
 
@@ -90,14 +120,41 @@ struct __bor_vptree_node_t {
 };
 typedef struct __bor_vptree_node_t _bor_vptree_node_t;
 
+/** Node of frozen vp-tree */
+struct __bor_vptree_fnode_t {
+    bor_real_t radius; /*!< Radius of inner node */
+    uint32_t off;      /*!< Inner node: offset of vantage point in .vps,
+                            leaf: index of the first element in .els */
+    uint32_t len;      /*!< Number of elements in leaf */
+    uint32_t child;    /*!< Index of left child, the right child is
+                            always next to it. Zero for leaves. */
+};
+typedef struct __bor_vptree_fnode_t _bor_vptree_fnode_t;
+
+/** Frozen (flat) representation of vp-tree */
+struct __bor_vptree_flat_t {
+    _bor_vptree_fnode_t *nodes;    /*!< Nodes in breadth-first order */
+    size_t nodes_len;
+    bor_real_t *vps;               /*!< Vantage points of inner nodes */
+    bor_real_t *pts;               /*!< Copies of elements' points stored
+                                        leaf after leaf */
+    struct _bor_vptree_el_t **els; /*!< Elements in the same order as .pts */
+    size_t els_len;
+};
+typedef struct __bor_vptree_flat_t _bor_vptree_flat_t;
+
 struct _bor_vptree_t {
     uint8_t type; /*!< Type of NN search algorithm. See boruvka/nn.h */
 
     bor_vptree_params_t params;
     _bor_vptree_node_t *root;
+    _bor_vptree_flat_t *flat; /*!< Frozen tree or NULL */
 
     struct _bor_vptree_el_t **els; /*!< Tmp array for elements */
     size_t els_size;               /*!< Size of .els array */
+
+    bor_mempool_t *nodes; /*!< Memory pool of nodes (shared by the threads
+                               of parallel build) */
 };
 typedef struct _bor_vptree_t bor_vptree_t;
 
@@ -135,7 +192,9 @@ void borVPTreeElInit(bor_vptree_el_t *el, const bor_vec_t *p);
 bor_vptree_t *borVPTreeNew(const bor_vptree_params_t *params);
 
 /**
- * Builds vp-tree from array of elements
+ * Builds vp-tree from array of elements.
+ * If params->tp is set, the subtrees are built in parallel (see
+ * bor_vptree_params_t.parsize).
  * TODO: Example
  */
 bor_vptree_t *borVPTreeBuild(const bor_vptree_params_t *params,
@@ -146,6 +205,32 @@ bor_vptree_t *borVPTreeBuild(const bor_vptree_params_t *params,
  */
 void borVPTreeDel(bor_vptree_t *vp);
 
+/**
+ * Freezes the vp-tree, i.e., converts it to a compact read-only
+ * representation: all nodes are stored in a single array in
+ * breadth-first order and points of elements are copied into one
+ * contiguous array leaf after leaf. This is meant for static datasets
+ * (typically right after borVPTreeBuild()) as borVPTreeNearest() then
+ * touches much less memory.
+ *
+ * Note that in frozen tree, the distance callback receives pointers to
+ * the copies of the elements' points, not the original ones.
+ * borVPTreeAdd(), borVPTreeRemove() and borVPTreeUpdate() automatically
+ * thaw the tree.
+ */
+void borVPTreeFreeze(bor_vptree_t *vp);
+
+/**
+ * Converts frozen tree back to the dynamic representation.
+ * Nothing is done if the tree is not frozen.
+ */
+void borVPTreeThaw(bor_vptree_t *vp);
+
+/**
+ * Returns true if the tree is frozen.
+ */
+_bor_inline int borVPTreeFrozen(const bor_vptree_t *vp);
+
 /**
  * Adds element to the vp-tree
  */
@@ -171,9 +256,42 @@ void borVPTreeUpdate(bor_vptree_t *vp, bor_vptree_el_t *el);
 size_t borVPTreeNearest(const bor_vptree_t *vp, const bor_vec_t *p, size_t num,
                         bor_vptree_el_t **els);
 
+/**
+ * Same as borVPTreeNearest() but approximate search driven by
+ * .approx_eps and .approx_leaves parameters is used regardless of
+ * .approx parameter. The returned elements are sorted by distance but
+ * they don't have to be the nearest ones.
+ */
+size_t borVPTreeNearestApprox(const bor_vptree_t *vp, const bor_vec_t *p,
+                              size_t num, bor_vptree_el_t **els);
+
+/**
+ * Callback for borVPTreeRange(). {dist} is the distance between element
+ * {el} and the query point.
+ */
+typedef void (*bor_vptree_range_fn)(bor_vptree_el_t *el, bor_real_t dist,
+                                    void *data);
+
+/**
+ * Calls {cb} for each element whose distance from point {p} is at most
+ * {radius}. Subtrees that can't intersect the ball are pruned using
+ * the radii of nodes. Elements are reported in no particular order.
+ * Returns number of reported elements. The tree must not be modified
+ * from the callback.
+ */
+size_t borVPTreeRange(const bor_vptree_t *vp, const bor_vec_t *p,
+                      bor_real_t radius, bor_vptree_range_fn cb, void *data);
+
 
 void borVPTreeDump(bor_vptree_t *vp, FILE *out);
 
+
+/**** INLINES ****/
+_bor_inline int borVPTreeFrozen(const bor_vptree_t *vp)
+{
+    return vp->flat != NULL;
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -0,0 +1,268 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include <string.h>
+#include "boruvka/alloc.h"
+#include "boruvka/hfunc.h"
+#include "boruvka/chtable.h"
+
+/** Initial number of buckets, must be multiple of BOR_CHTABLE_STRIPES */
+#define INITIAL_SIZE (4 * BOR_CHTABLE_STRIPES)
+
+struct _bor_chtable_node_t {
+    bor_chtable_node_t *next;
+    uint64_t hash;
+    char data[]; /*!< Key followed by value */
+};
+
+struct _bor_chtable_buckets_t {
+    size_t size; /*!< Number of buckets (power of two) */
+    bor_chtable_node_t **bucket;
+};
+
+#define KEY(node) ((node)->data)
+#define VAL(t, node) ((node)->data + (t)->key_size)
+
+_bor_inline uint64_t hashKey(const bor_chtable_t *t, const void *key)
+{
+    if (t->hash == NULL)
+        return borFastHash_64(key, t->key_size, 0);
+    return t->hash(key, t->data);
+}
+
+_bor_inline int eqKey(const bor_chtable_t *t,
+                      const void *key1, const void *key2)
+{
+    if (t->eq == NULL)
+        return memcmp(key1, key2, t->key_size) == 0;
+    return t->eq(key1, key2, t->data);
+}
+
+static bor_chtable_buckets_t *bucketsNew(size_t size);
+static void bucketsDel(void *b, void *userdata);
+static void nodeDel(void *node, void *userdata);
+static void resize(bor_chtable_t *t, int tid,
+                   bor_chtable_buckets_t *old, size_t old_size);
+
+bor_chtable_t *borCHTableNew(size_t key_size, size_t val_size,
+                             int num_threads,
+                             bor_chtable_hash_fn hash_func,
+                             bor_chtable_eq_fn eq_func,
+                             void *userdata)
+{
+    bor_chtable_t *t;
+    int i;
+
+    t = BOR_ALLOC(bor_chtable_t);
+    t->buckets = bucketsNew(INITIAL_SIZE);
+    t->num_elements = 0;
+    t->key_size = key_size;
+    t->val_size = val_size;
+    t->hash = hash_func;
+    t->eq = eq_func;
+    t->data = userdata;
+    t->ebr = borEBRNew(num_threads);
+    for (i = 0; i < BOR_CHTABLE_STRIPES; ++i)
+        pthread_mutex_init(t->lock + i, NULL);
+
+    return t;
+}
+
+void borCHTableDel(bor_chtable_t *t)
+{
+    int i;
+
+    borEBRDel(t->ebr);
+    bucketsDel(t->buckets, NULL);
+    for (i = 0; i < BOR_CHTABLE_STRIPES; ++i)
+        pthread_mutex_destroy(t->lock + i);
+    BOR_FREE(t);
+}
+
+int borCHTableFind(bor_chtable_t *t, int tid, const void *key, void *val)
+{
+    bor_chtable_buckets_t *b;
+    bor_chtable_node_t *node;
+    uint64_t hash;
+    int ret = -1;
+
+    hash = hashKey(t, key);
+
+    borEBREnter(t->ebr, tid);
+    b = __atomic_load_n(&t->buckets, __ATOMIC_ACQUIRE);
+    node = __atomic_load_n(&b->bucket[hash & (b->size - 1)],
+                           __ATOMIC_ACQUIRE);
+    for (; node != NULL; node = __atomic_load_n(&node->next,
+                                                __ATOMIC_ACQUIRE)){
+        if (node->hash == hash && eqKey(t, KEY(node), key)){
+            if (val != NULL)
+                memcpy(val, VAL(t, node), t->val_size);
+            ret = 0;
+            break;
+        }
+    }
+    borEBRExit(t->ebr, tid);
+
+    return ret;
+}
+
+int borCHTableInsert(bor_chtable_t *t, int tid,
+                     const void *key, const void *val)
+{
+    bor_chtable_buckets_t *b;
+    bor_chtable_node_t *node, **head;
+    uint64_t hash;
+    size_t size, num;
+    pthread_mutex_t *lock;
+
+    hash = hashKey(t, key);
+    lock = t->lock + (hash % BOR_CHTABLE_STRIPES);
+
+    pthread_mutex_lock(lock);
+    // The bucket array is replaced only with all stripes locked
+    b = t->buckets;
+    size = b->size;
+    head = &b->bucket[hash & (size - 1)];
+    for (node = *head; node != NULL; node = node->next){
+        if (node->hash == hash && eqKey(t, KEY(node), key)){
+            pthread_mutex_unlock(lock);
+            return -1;
+        }
+    }
+
+    node = BOR_MALLOC(sizeof(*node) + t->key_size + t->val_size);
+    node->hash = hash;
+    memcpy(KEY(node), key, t->key_size);
+    if (val != NULL){
+        memcpy(VAL(t, node), val, t->val_size);
+    }else{
+        memset(VAL(t, node), 0, t->val_size);
+    }
+    node->next = *head;
+    // publish fully initialized node to lock-free readers
+    __atomic_store_n(head, node, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(lock);
+
+    num = __atomic_add_fetch(&t->num_elements, 1, __ATOMIC_RELAXED);
+    if (num > size)
+        resize(t, tid, b, size);
+    return 0;
+}
+
+int borCHTableErase(bor_chtable_t *t, int tid, const void *key)
+{
+    bor_chtable_buckets_t *b;
+    bor_chtable_node_t *node, **prev;
+    uint64_t hash;
+    pthread_mutex_t *lock;
+
+    hash = hashKey(t, key);
+    lock = t->lock + (hash % BOR_CHTABLE_STRIPES);
+
+    pthread_mutex_lock(lock);
+    b = t->buckets;
+    prev = &b->bucket[hash & (b->size - 1)];
+    for (node = *prev; node != NULL; prev = &node->next, node = *prev){
+        if (node->hash == hash && eqKey(t, KEY(node), key))
+            break;
+    }
+
+    if (node == NULL){
+        pthread_mutex_unlock(lock);
+        return -1;
+    }
+
+    // Readers standing on the node can still continue through its .next
+    __atomic_store_n(prev, node->next, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(lock);
+
+    __atomic_sub_fetch(&t->num_elements, 1, __ATOMIC_RELAXED);
+    borEBRRetire(t->ebr, tid, node, nodeDel, NULL);
+    return 0;
+}
+
+
+static bor_chtable_buckets_t *bucketsNew(size_t size)
+{
+    bor_chtable_buckets_t *b;
+
+    b = BOR_ALLOC(bor_chtable_buckets_t);
+    b->size = size;
+    b->bucket = BOR_CALLOC_ARR(bor_chtable_node_t *, size);
+    return b;
+}
+
+static void bucketsDel(void *_b, void *userdata)
+{
+    bor_chtable_buckets_t *b = _b;
+    bor_chtable_node_t *node, *next;
+    size_t i;
+
+    for (i = 0; i < b->size; ++i){
+        for (node = b->bucket[i]; node != NULL; node = next){
+            next = node->next;
+            BOR_FREE(node);
+        }
+    }
+    BOR_FREE(b->bucket);
+    BOR_FREE(b);
+}
+
+static void nodeDel(void *node, void *userdata)
+{
+    BOR_FREE(node);
+}
+
+static void resize(bor_chtable_t *t, int tid,
+                   bor_chtable_buckets_t *old, size_t old_size)
+{
+    bor_chtable_buckets_t *b;
+    bor_chtable_node_t *node, *cp, **head;
+    size_t i, node_size, mask;
+
+    for (i = 0; i < BOR_CHTABLE_STRIPES; ++i)
+        pthread_mutex_lock(t->lock + i);
+
+    // Someone else could have been faster
+    old = t->buckets;
+    if (old->size != old_size || t->num_elements <= old->size){
+        for (i = 0; i < BOR_CHTABLE_STRIPES; ++i)
+            pthread_mutex_unlock(t->lock + i);
+        return;
+    }
+
+    // The old array stays intact for the readers that are still
+    // traversing it, so the nodes are copied into the new one.
+    b = bucketsNew(2 * old->size);
+    mask = b->size - 1;
+    node_size = sizeof(*node) + t->key_size + t->val_size;
+    for (i = 0; i < old->size; ++i){
+        for (node = old->bucket[i]; node != NULL; node = node->next){
+            cp = BOR_MALLOC(node_size);
+            memcpy(cp, node, node_size);
+            head = &b->bucket[node->hash & mask];
+            cp->next = *head;
+            *head = cp;
+        }
+    }
+    __atomic_store_n(&t->buckets, b, __ATOMIC_RELEASE);
+
+    for (i = 0; i < BOR_CHTABLE_STRIPES; ++i)
+        pthread_mutex_unlock(t->lock + i);
+
+    borEBRRetire(t->ebr, tid, old, bucketsDel, NULL);
+}
@@ -18,6 +18,13 @@
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
 #include <boruvka/predicates.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/parallel.h>
+
+/** Minimal number of points partitioned in parallel */
+#define PARTITION_PAR_MIN 4096
+/** Grain of parallel loops over points */
+#define PAR_GRAIN 1024
 
 struct _bor_chull3_vert_t {
     bor_vec3_t v;
@@ -35,13 +42,31 @@ struct _bor_chull3_edge_t {
 };
 typedef struct _bor_chull3_edge_t bor_chull3_edge_t;
 
+struct _bor_chull3_point_t;
+
 struct _bor_chull3_face_t {
     bor_mesh3_face_t m;
     bor_chull3_vert_t *v[3];
     bor_list_t list;
+    bor_list_t conflicts; /*!< Points that see this face */
+    struct _bor_chull3_point_t *far; /*!< The furthest point of .conflicts */
+    bor_list_t pending;   /*!< Connection into list of faces with
+                               non-empty .conflicts (Quickhull) */
+    unsigned long stamp;  /*!< Last visit by findVisibleFaces() */
 };
 typedef struct _bor_chull3_face_t bor_chull3_face_t;
 
+/** Point waiting for insertion in borCHull3AddPoints() or
+ *  borCHull3NewQuickhull() */
+struct _bor_chull3_point_t {
+    bor_vec3_t v;
+    bor_chull3_face_t *face; /*!< Conflict face or NULL if the point is
+                                  inside hull */
+    bor_real_t dist;         /*!< Orientation of the point wrt .face */
+    bor_list_t list;         /*!< Connection into face's conflict list */
+};
+typedef struct _bor_chull3_point_t bor_chull3_point_t;
+
 /** Predicate that returns true if f is visible from v */
 _bor_inline int isVisible(const bor_chull3_t *h,
                           const bor_vec3_t *v,
@@ -66,14 +91,12 @@ _bor_inline int isCoplanar(const bor_chull3_t *h,
 static bor_chull3_vert_t *vertNew(bor_chull3_t *h, const bor_vec3_t *v);
 /** Delete vertex */
 static void vertDel(bor_chull3_t *h, bor_chull3_vert_t *v);
-static void vertDelMesh(bor_mesh3_vertex_t *, void *);
 
 /** Create new edge */
 static bor_chull3_edge_t *edgeNew(bor_chull3_t *h,
                                   bor_chull3_vert_t *v1, bor_chull3_vert_t *v2);
 /** Delete edge */
 static void edgeDel(bor_chull3_t *h, bor_chull3_edge_t *e);
-static void edgeDelMesh(bor_mesh3_edge_t *, void *);
 /** Fills v[] with vertices incidenting with edge */
 static void edgeVertices(bor_chull3_edge_t *e, bor_chull3_vert_t **v);
 
@@ -83,7 +106,6 @@ static bor_chull3_face_t *faceNew(bor_chull3_t *h,
                                   bor_chull3_edge_t *e3);
 /** Delete face */
 static void faceDel(bor_chull3_t *h, bor_chull3_face_t *f);
-static void faceDelMesh(bor_mesh3_face_t *, void *);
 /** Set triplet of bounding vertices in specified order */
 static void faceSetVertices(bor_chull3_t *h, bor_chull3_face_t *f,
                             bor_chull3_vert_t *v1, bor_chull3_vert_t *v2,
@@ -103,8 +125,33 @@ static void firstNonCoplanar(bor_chull3_t *h, const bor_vec3_t *v);
 /** Obtain border edges */
 static void findBorderEdges(bor_chull3_t *h, const bor_vec3_t *v,
                             bor_list_t *edges);
-/** Makes new cone connecting new point {v} with border edges */
-static void makeCone(bor_chull3_t *h, bor_list_t *edges, const bor_vec3_t *v);
+/** Collects faces visible from {v} by walking from visible face {start}.
+ *  Returns -1 if {v} is duplicate with some vertex of hull. */
+static int findVisibleFaces(bor_chull3_t *h, const bor_vec3_t *v,
+                            bor_chull3_face_t *start, bor_list_t *faces);
+/** Removes visible {faces} and obtains border edges */
+static void removeVisibleFaces(bor_chull3_t *h, const bor_vec3_t *v,
+                               bor_list_t *faces, bor_list_t *edges);
+/** Makes new cone connecting new point {v} with border edges. If {faces}
+ *  is non-NULL, the new faces are appended to it. */
+static void makeCone(bor_chull3_t *h, bor_list_t *edges, const bor_vec3_t *v,
+                     bor_list_t *faces);
+
+/** Loads points from point cloud */
+static bor_chull3_point_t *pointsFromPC(bor_pc_t *pc, size_t *len);
+/** Assigns conflict faces to the points */
+static void conflictsInit(bor_chull3_t *h, bor_chull3_point_t *pts, size_t len,
+                          bor_task_pool_t *tp, bor_list_t *pending);
+/** Assigns conflict faces from {faces} to orphaned points. If {pending} is
+ *  non-NULL, faces that got some points are appended to it. */
+static void conflictsPartition(bor_chull3_t *h, bor_list_t *faces,
+                               bor_task_pool_t *tp, bor_list_t *pending);
+/** Adds point with conflict face to hull */
+static void conflictsAdd(bor_chull3_t *h, bor_chull3_point_t *pt,
+                         bor_task_pool_t *tp, bor_list_t *pending);
+/** Adds four extreme points to the empty hull */
+static void quickhullSimplex(bor_chull3_t *h, bor_chull3_point_t *pts,
+                             size_t len, bor_task_pool_t *tp);
 
 bor_chull3_t *borCHull3New(void)
 {
@@ -113,8 +160,11 @@ bor_chull3_t *borCHull3New(void)
     h = BOR_ALLOC(bor_chull3_t);
     h->mesh = borMesh3New();
     h->coplanar = 1;
-
-    //borPredInit(&h->pred);
+    h->pool = borMemPoolNew(BOR_MEMPOOL_SINGLE_THREAD);
+    borListInit(&h->orphans);
+    h->stamp = 0;
+    h->exact = 0;
+    borPredInit(&h->pred);
 
     return h;
 }
@@ -122,10 +172,9 @@ bor_chull3_t *borCHull3New(void)
 
 void borCHull3Del(bor_chull3_t *h)
 {
-    borMesh3Del2(h->mesh,
-                 vertDelMesh, NULL,
-                 edgeDelMesh, NULL,
-                 faceDelMesh, NULL);
+    /* vertices, edges and faces are released all at once with the pool */
+    borMesh3DelShallow(h->mesh);
+    borMemPoolDel(h->pool);
 
     BOR_FREE(h);
 }
@@ -150,7 +199,77 @@ void borCHull3Add(bor_chull3_t *h, const bor_vec3_t *point)
         return;
 
 
-    makeCone(h, &border_edges, point);
+    makeCone(h, &border_edges, point, NULL);
+}
+
+void borCHull3AddPoints(bor_chull3_t *h, bor_pc_t *pc)
+{
+    bor_chull3_point_t *pts, tmp;
+    bor_rand_mt_t *rnd;
+    size_t i, j, len;
+
+    pts = pointsFromPC(pc, &len);
+    if (pts == NULL)
+        return;
+
+    // shuffle points
+    rnd = borRandMTNewAuto();
+    for (i = len - 1; i > 0; --i){
+        j = borRandMT(rnd, 0, i + 1);
+        j = BOR_MIN(j, i);
+        tmp = pts[i];
+        pts[i] = pts[j];
+        pts[j] = tmp;
+    }
+    borRandMTDel(rnd);
+
+    // first make full-dimensional hull the usual way
+    for (i = 0; i < len && h->coplanar; ++i)
+        borCHull3Add(h, &pts[i].v);
+
+    if (i < len){
+        conflictsInit(h, pts + i, len - i, NULL, NULL);
+        for (; i < len; ++i){
+            if (pts[i].face)
+                conflictsAdd(h, pts + i, NULL, NULL);
+        }
+    }
+
+    BOR_FREE(pts);
+}
+
+bor_chull3_t *borCHull3NewQuickhull(bor_pc_t *pc, bor_task_pool_t *tp)
+{
+    bor_chull3_t *h;
+    bor_chull3_point_t *pts;
+    bor_chull3_face_t *f;
+    bor_list_t pending;
+    size_t i, len;
+
+    h = borCHull3New();
+    h->exact = 1;
+
+    pts = pointsFromPC(pc, &len);
+    if (pts == NULL)
+        return h;
+
+    quickhullSimplex(h, pts, len, tp);
+
+    // degenerate input, all extreme points are coplanar
+    for (i = 0; i < len && h->coplanar; ++i)
+        borCHull3Add(h, &pts[i].v);
+
+    borListInit(&pending);
+    if (i < len)
+        conflictsInit(h, pts + i, len - i, tp, &pending);
+
+    while (!borListEmpty(&pending)){
+        f = BOR_LIST_ENTRY(borListNext(&pending), bor_chull3_face_t, pending);
+        conflictsAdd(h, f->far, tp, &pending);
+    }
+
+    BOR_FREE(pts);
+    return h;
 }
 
 void borCHull3DumpSVT(bor_chull3_t *h, FILE *out, const char *name)
@@ -183,8 +302,7 @@ _bor_inline bor_real_t orient3d(const bor_chull3_t *h,
                                 const bor_vec3_t *v,
                                 const bor_chull3_face_t *f)
 {
-    return borVec3Volume6(&f->v[0]->v, &f->v[1]->v, &f->v[2]->v, v);
-    //return borPredOrient3d(&h->pred, &f->v[0]->v, &f->v[1]->v, &f->v[2]->v, v);
+    return orient3d2(h, v, &f->v[0]->v, &f->v[1]->v, &f->v[2]->v);
 }
 
 _bor_inline bor_real_t orient3d2(const bor_chull3_t *h,
@@ -192,8 +310,9 @@ _bor_inline bor_real_t orient3d2(const bor_chull3_t *h,
                                  const bor_vec3_t *f1, const bor_vec3_t *f2,
                                  const bor_vec3_t *f3)
 {
+    if (h->exact)
+        return borPredOrient3d(&h->pred, f1, f2, f3, v);
     return borVec3Volume6(f1, f2, f3, v);
-    //return borPredOrient3d(&h->pred, f1, f2, f3, v);
 }
 
 _bor_inline int isCoplanar(const bor_chull3_t *h,
@@ -211,7 +330,7 @@ static bor_chull3_vert_t *vertNew(bor_chull3_t *h, const bor_vec3_t *v)
 {
     bor_chull3_vert_t *vert;
 
-    vert = BOR_ALLOC_ALIGN(bor_chull3_vert_t, 16);
+    vert = BOR_POOL_ALLOC(h->pool, bor_chull3_vert_t);
 
     // copy coordinates
     borVec3Copy(&vert->v, v);
@@ -230,14 +349,7 @@ static bor_chull3_vert_t *vertNew(bor_chull3_t *h, const bor_vec3_t *v)
 static void vertDel(bor_chull3_t *h, bor_chull3_vert_t *v)
 {
     borMesh3RemoveVertex(h->mesh, &v->m);
-    BOR_FREE(v);
-}
-static void vertDelMesh(bor_mesh3_vertex_t *_v, void *_)
-{
-    bor_chull3_vert_t *v;
-
-    v = bor_container_of(_v, bor_chull3_vert_t, m);
-    BOR_FREE(v);
+    BOR_POOL_FREE(h->pool, bor_chull3_vert_t, v);
 }
 
 
@@ -246,7 +358,7 @@ static bor_chull3_edge_t *edgeNew(bor_chull3_t *h,
 {
     bor_chull3_edge_t *e;
 
-    e = BOR_ALLOC(bor_chull3_edge_t);
+    e = BOR_POOL_ALLOC(h->pool, bor_chull3_edge_t);
     borMesh3AddEdge(h->mesh, &e->m, &v1->m, &v2->m);
     e->swap = 0;
     e->onedge = 0;
@@ -257,15 +369,7 @@ static bor_chull3_edge_t *edgeNew(bor_chull3_t *h,
 static void edgeDel(bor_chull3_t *h, bor_chull3_edge_t *e)
 {
     borMesh3RemoveEdge(h->mesh, &e->m);
-    BOR_FREE(e);
-}
-
-static void edgeDelMesh(bor_mesh3_edge_t *_e, void *_)
-{
-    bor_chull3_edge_t *e;
-
-    e = bor_container_of(_e, bor_chull3_edge_t, m);
-    BOR_FREE(e);
+    BOR_POOL_FREE(h->pool, bor_chull3_edge_t, e);
 }
 
 static void edgeVertices(bor_chull3_edge_t *e, bor_chull3_vert_t **v)
@@ -287,29 +391,28 @@ static bor_chull3_face_t *faceNew(bor_chull3_t *h,
 {
     bor_chull3_face_t *f;
 
-    f = BOR_ALLOC(bor_chull3_face_t);
+    f = BOR_POOL_ALLOC(h->pool, bor_chull3_face_t);
     if (borMesh3AddFace(h->mesh, &f->m, &e1->m, &e2->m, &e3->m) != 0){
         DBG("Can't add face, %d", (int)borMesh3VerticesLen(h->mesh));
         // borCHull3DumpSVT(h, stdout, "Can't face");
     }
 
     f->v[0] = f->v[1] = f->v[2] = NULL;
+    borListInit(&f->conflicts);
+    f->far = NULL;
+    borListInit(&f->pending);
+    f->stamp = 0;
 
     return f;
 }
 
 static void faceDel(bor_chull3_t *h, bor_chull3_face_t *f)
 {
+    // conflicting points must find another face
+    borListMove(&f->conflicts, &h->orphans);
+    borListDel(&f->pending);
     borMesh3RemoveFace(h->mesh, &f->m);
-    BOR_FREE(f);
-}
-
-static void faceDelMesh(bor_mesh3_face_t *_f, void *_)
-{
-    bor_chull3_face_t *f;
-
-    f = bor_container_of(_f, bor_chull3_face_t, m);
-    BOR_FREE(f);
+    BOR_POOL_FREE(h->pool, bor_chull3_face_t, f);
 }
 
 static void faceSetVertices(bor_chull3_t *h, bor_chull3_face_t *f,
@@ -634,7 +737,7 @@ static void firstNonCoplanar(bor_chull3_t *h, const bor_vec3_t *point)
         }
     }
 
-    makeCone(h, &border_edges, point);
+    makeCone(h, &border_edges, point, NULL);
 }
 
 static void updateBorderEdges(bor_chull3_t *h, bor_chull3_face_t *f,
@@ -739,12 +842,10 @@ static void correctBorderEdges(bor_chull3_t *h, const bor_vec3_t *point,
 static void findBorderEdges(bor_chull3_t *h, const bor_vec3_t *point,
                             bor_list_t *edges)
 {
-    bor_list_t *list, *item, *itemtmp, wrong_vertices, faces;
+    bor_list_t *list, *item, *itemtmp, faces;
     bor_mesh3_face_t *mf;
     bor_chull3_face_t *f;
-    bor_chull3_vert_t *v;
 
-    borListInit(&wrong_vertices);
     borListInit(&faces);
 
     list = borMesh3Faces(h->mesh);
@@ -765,8 +866,61 @@ static void findBorderEdges(bor_chull3_t *h, const bor_vec3_t *point,
         }
     }
 
-    while (!borListEmpty(&faces)){
-        item = borListNext(&faces);
+    removeVisibleFaces(h, point, &faces, edges);
+}
+
+static int findVisibleFaces(bor_chull3_t *h, const bor_vec3_t *point,
+                            bor_chull3_face_t *start, bor_list_t *faces)
+{
+    bor_list_t *item;
+    bor_mesh3_face_t *mf;
+    bor_chull3_face_t *f, *f2;
+    bor_chull3_edge_t *e[3];
+    int i;
+
+    ++h->stamp;
+    start->stamp = h->stamp;
+    borListAppend(faces, &start->list);
+
+    // faces visible from the point form connected patch, so it is enough
+    // to walk over neighbors of visible faces
+    for (item = borListNext(faces); item != faces; item = borListNext(item)){
+        f = BOR_LIST_ENTRY(item, bor_chull3_face_t, list);
+        faceEdges(f, e);
+        for (i = 0; i < 3; i++){
+            mf = borMesh3EdgeOtherFace(&e[i]->m, &f->m);
+            if (mf == NULL)
+                continue;
+            f2 = bor_container_of(mf, bor_chull3_face_t, m);
+            if (f2->stamp == h->stamp)
+                continue;
+            f2->stamp = h->stamp;
+
+            if (isVisible(h, point, f2)){
+                borListAppend(faces, &f2->list);
+            }else if (borVec3Eq(point, &f2->v[0]->v)
+                        || borVec3Eq(point, &f2->v[1]->v)
+                        || borVec3Eq(point, &f2->v[2]->v)){
+                borListInit(faces);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void removeVisibleFaces(bor_chull3_t *h, const bor_vec3_t *point,
+                               bor_list_t *faces, bor_list_t *edges)
+{
+    bor_list_t *item, wrong_vertices;
+    bor_chull3_face_t *f;
+    bor_chull3_vert_t *v;
+
+    borListInit(&wrong_vertices);
+
+    while (!borListEmpty(faces)){
+        item = borListNext(faces);
         borListDel(item);
         f = BOR_LIST_ENTRY(item, bor_chull3_face_t, list);
 
@@ -781,8 +935,8 @@ static void findBorderEdges(bor_chull3_t *h, const bor_vec3_t *point,
     }
 }
 
-
-static void makeCone(bor_chull3_t *h, bor_list_t *edges, const bor_vec3_t *point)
+static void makeCone(bor_chull3_t *h, bor_list_t *edges, const bor_vec3_t *point,
+                     bor_list_t *faces)
 {
     bor_chull3_edge_t *e1, *e2, *e3;
     bor_chull3_vert_t *v[3];
@@ -823,5 +977,353 @@ static void makeCone(bor_chull3_t *h, bor_list_t *edges, const bor_vec3_t *point
         }else{
             faceSetVertices(h, f, v[0], v[1], v[2]);
         }
+
+        if (faces)
+            borListAppend(faces, &f->list);
+    }
+}
+
+
+static bor_chull3_point_t *pointsFromPC(bor_pc_t *pc, size_t *len)
+{
+    bor_chull3_point_t *pts;
+    bor_pc_it_t pcit;
+    bor_vec_t *v;
+    size_t i;
+
+    *len = borPCLen(pc);
+    if (*len == 0)
+        return NULL;
+
+    pts = BOR_ALLOC_ALIGN_ARR(bor_chull3_point_t, *len, 16);
+    borPCItInit(&pcit, pc);
+    for (i = 0; !borPCItEnd(&pcit); borPCItNext(&pcit), ++i){
+        v = borPCItGet(&pcit);
+        borVec3Set(&pts[i].v, borVecGet(v, 0), borVecGet(v, 1),
+                              borVecGet(v, 2));
+        pts[i].face = NULL;
+    }
+
+    return pts;
+}
+
+static void conflictsInit(bor_chull3_t *h, bor_chull3_point_t *pts, size_t len,
+                          bor_task_pool_t *tp, bor_list_t *pending)
+{
+    bor_list_t *list, *item, faces;
+    bor_mesh3_face_t *mf;
+    bor_chull3_face_t *f;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        borListAppend(&h->orphans, &pts[i].list);
+
+    borListInit(&faces);
+    list = borMesh3Faces(h->mesh);
+    BOR_LIST_FOR_EACH(list, item){
+        mf = BOR_LIST_ENTRY(item, bor_mesh3_face_t, list);
+        f  = bor_container_of(mf, bor_chull3_face_t, m);
+        borListAppend(&faces, &f->list);
+    }
+
+    conflictsPartition(h, &faces, tp, pending);
+}
+
+/** Finds the first face from {faces} visible from {p} */
+static void conflictFace(const bor_chull3_t *h, bor_chull3_point_t *p,
+                         bor_chull3_face_t **faces, int faces_len)
+{
+    bor_real_t orient;
+    int i;
+
+    p->face = NULL;
+    for (i = 0; i < faces_len; i++){
+        orient = orient3d(h, &p->v, faces[i]);
+        if (orient > BOR_ZERO){
+            p->face = faces[i];
+            p->dist = orient;
+            return;
+        }
+    }
+}
+
+struct _partition_t {
+    const bor_chull3_t *h;
+    bor_chull3_point_t **pts;
+    bor_chull3_face_t **faces;
+    int faces_len;
+};
+typedef struct _partition_t partition_t;
+
+static void partitionTask(size_t from, size_t to, void *data,
+                          const bor_task_pool_thinfo_t *thinfo)
+{
+    partition_t *part = data;
+    size_t i;
+
+    for (i = from; i < to; i++)
+        conflictFace(part->h, part->pts[i], part->faces, part->faces_len);
+}
+
+static void conflictsPartition(bor_chull3_t *h, bor_list_t *faces,
+                               bor_task_pool_t *tp, bor_list_t *pending)
+{
+    bor_list_t *item;
+    bor_chull3_point_t *p;
+    bor_chull3_face_t *f;
+    partition_t part;
+    size_t i, len;
+
+    part.h = h;
+    part.faces_len = 0;
+    BOR_LIST_FOR_EACH(faces, item)
+        ++part.faces_len;
+    if (part.faces_len == 0){
+        while (!borListEmpty(&h->orphans)){
+            item = borListNext(&h->orphans);
+            borListDel(item);
+            p = BOR_LIST_ENTRY(item, bor_chull3_point_t, list);
+            p->face = NULL;
+        }
+        return;
+    }
+
+    part.faces = BOR_ALLOC_ARR(bor_chull3_face_t *, part.faces_len);
+    i = 0;
+    BOR_LIST_FOR_EACH(faces, item)
+        part.faces[i++] = BOR_LIST_ENTRY(item, bor_chull3_face_t, list);
+
+    len = 0;
+    BOR_LIST_FOR_EACH(&h->orphans, item)
+        ++len;
+
+    if (tp && borTaskPoolSize(tp) > 1 && len >= PARTITION_PAR_MIN){
+        // orientation tests are the expensive part and they only read
+        // the hull, so they can run in parallel
+        part.pts = BOR_ALLOC_ARR(bor_chull3_point_t *, len);
+        i = 0;
+        BOR_LIST_FOR_EACH(&h->orphans, item)
+            part.pts[i++] = BOR_LIST_ENTRY(item, bor_chull3_point_t, list);
+        borParallelFor(tp, 0, len, PAR_GRAIN, partitionTask, &part);
+        BOR_FREE(part.pts);
+    }else{
+        BOR_LIST_FOR_EACH(&h->orphans, item){
+            p = BOR_LIST_ENTRY(item, bor_chull3_point_t, list);
+            conflictFace(h, p, part.faces, part.faces_len);
+        }
+    }
+
+    // A point that saw any removed face and is still outside of hull
+    // must see some of the new faces, otherwise it is inside.
+    while (!borListEmpty(&h->orphans)){
+        item = borListNext(&h->orphans);
+        borListDel(item);
+        p = BOR_LIST_ENTRY(item, bor_chull3_point_t, list);
+        if ((f = p->face) == NULL)
+            continue;
+
+        borListAppend(&f->conflicts, &p->list);
+        if (f->far == NULL || p->dist > f->far->dist)
+            f->far = p;
+    }
+
+    if (pending){
+        for (i = 0; i < (size_t)part.faces_len; i++){
+            f = part.faces[i];
+            if (f->far)
+                borListAppend(pending, &f->pending);
+        }
+    }
+
+    BOR_FREE(part.faces);
+}
+
+static void conflictsAdd(bor_chull3_t *h, bor_chull3_point_t *pt,
+                         bor_task_pool_t *tp, bor_list_t *pending)
+{
+    bor_list_t faces, edges, *item;
+    bor_chull3_point_t *p;
+    bor_chull3_face_t *f;
+
+    f = pt->face;
+    borListDel(&pt->list);
+    pt->face = NULL;
+
+    borListInit(&faces);
+    borListInit(&edges);
+    if (findVisibleFaces(h, &pt->v, f, &faces) != 0){
+        // the point is duplicate of some vertex, so the face stays and
+        // only its furthest point must be updated
+        f->far = NULL;
+        BOR_LIST_FOR_EACH(&f->conflicts, item){
+            p = BOR_LIST_ENTRY(item, bor_chull3_point_t, list);
+            if (f->far == NULL || p->dist > f->far->dist)
+                f->far = p;
+        }
+        if (f->far == NULL)
+            borListDel(&f->pending);
+        return;
     }
+    removeVisibleFaces(h, &pt->v, &faces, &edges);
+
+    borListInit(&faces);
+    if (!borListEmpty(&edges))
+        makeCone(h, &edges, &pt->v, &faces);
+
+    conflictsPartition(h, &faces, tp, pending);
+}
+
+
+struct _simplex_t {
+    size_t min[3], max[3]; /*!< Indices of extreme points along axes */
+    size_t best;           /*!< Index of the point with the best .val */
+    bor_real_t val;
+};
+typedef struct _simplex_t simplex_t;
+
+struct _simplex_data_t {
+    const bor_chull3_t *h;
+    const bor_chull3_point_t *pts;
+    const bor_vec3_t *a, *b, *c; /*!< Already chosen points */
+};
+typedef struct _simplex_data_t simplex_data_t;
+
+static void simplexExtremes(size_t from, size_t to, void *_acc, void *_data,
+                            const bor_task_pool_thinfo_t *thinfo)
+{
+    simplex_t *acc = _acc;
+    const simplex_data_t *data = _data;
+    const bor_chull3_point_t *pts = data->pts;
+    size_t i;
+    int j;
+
+    for (i = from; i < to; i++){
+        for (j = 0; j < 3; j++){
+            if (borVec3Get(&pts[i].v, j) < borVec3Get(&pts[acc->min[j]].v, j))
+                acc->min[j] = i;
+            if (borVec3Get(&pts[i].v, j) > borVec3Get(&pts[acc->max[j]].v, j))
+                acc->max[j] = i;
+        }
+    }
+}
+
+static void simplexExtremesJoin(void *_acc, const void *_acc2, void *_data)
+{
+    simplex_t *acc = _acc;
+    const simplex_t *acc2 = _acc2;
+    const simplex_data_t *data = _data;
+    const bor_chull3_point_t *pts = data->pts;
+    int j;
+
+    for (j = 0; j < 3; j++){
+        if (borVec3Get(&pts[acc2->min[j]].v, j)
+                < borVec3Get(&pts[acc->min[j]].v, j))
+            acc->min[j] = acc2->min[j];
+        if (borVec3Get(&pts[acc2->max[j]].v, j)
+                > borVec3Get(&pts[acc->max[j]].v, j))
+            acc->max[j] = acc2->max[j];
+    }
+}
+
+static void simplexLine(size_t from, size_t to, void *_acc, void *_data,
+                        const bor_task_pool_thinfo_t *thinfo)
+{
+    simplex_t *acc = _acc;
+    const simplex_data_t *data = _data;
+    bor_real_t dist;
+    size_t i;
+
+    for (i = from; i < to; i++){
+        dist = borVec3PointSegmentDist2(&data->pts[i].v, data->a, data->b,
+                                        NULL);
+        if (dist > acc->val){
+            acc->val = dist;
+            acc->best = i;
+        }
+    }
+}
+
+static void simplexPlane(size_t from, size_t to, void *_acc, void *_data,
+                         const bor_task_pool_thinfo_t *thinfo)
+{
+    simplex_t *acc = _acc;
+    const simplex_data_t *data = _data;
+    bor_real_t dist;
+    size_t i;
+
+    for (i = from; i < to; i++){
+        dist = BOR_FABS(orient3d2(data->h, &data->pts[i].v,
+                                  data->a, data->b, data->c));
+        if (dist > acc->val){
+            acc->val = dist;
+            acc->best = i;
+        }
+    }
+}
+
+static void simplexBestJoin(void *_acc, const void *_acc2, void *_data)
+{
+    simplex_t *acc = _acc;
+    const simplex_t *acc2 = _acc2;
+
+    if (acc2->val > acc->val
+            || (acc2->val == acc->val && acc2->best < acc->best)){
+        acc->val = acc2->val;
+        acc->best = acc2->best;
+    }
+}
+
+static void quickhullSimplex(bor_chull3_t *h, bor_chull3_point_t *pts,
+                             size_t len, bor_task_pool_t *tp)
+{
+    simplex_t acc;
+    simplex_data_t data;
+    size_t a, b;
+    bor_real_t extent, best_extent;
+    int j;
+
+    data.h = h;
+    data.pts = pts;
+
+    // the most distant pair of extreme points along some axis
+    bzero(&acc, sizeof(acc));
+    borParallelReduce(tp, 0, len, PAR_GRAIN, &acc, sizeof(acc),
+                      simplexExtremes, simplexExtremesJoin, &data);
+    a = acc.min[0];
+    b = acc.max[0];
+    best_extent = -BOR_ONE;
+    for (j = 0; j < 3; j++){
+        extent = borVec3Get(&pts[acc.max[j]].v, j)
+                    - borVec3Get(&pts[acc.min[j]].v, j);
+        if (extent > best_extent){
+            best_extent = extent;
+            a = acc.min[j];
+            b = acc.max[j];
+        }
+    }
+    data.a = &pts[a].v;
+    data.b = &pts[b].v;
+    borCHull3Add(h, data.a);
+    if (borVec3Eq(data.a, data.b))
+        return;
+    borCHull3Add(h, data.b);
+
+    // the furthest point from the line
+    acc.best = a;
+    acc.val = BOR_ZERO;
+    borParallelReduce(tp, 0, len, PAR_GRAIN, &acc, sizeof(acc),
+                      simplexLine, simplexBestJoin, &data);
+    if (borIsZero(acc.val))
+        return;
+    data.c = &pts[acc.best].v;
+    borCHull3Add(h, data.c);
+
+    // the furthest point from the plane
+    acc.best = a;
+    acc.val = BOR_ZERO;
+    borParallelReduce(tp, 0, len, PAR_GRAIN, &acc, sizeof(acc),
+                      simplexPlane, simplexBestJoin, &data);
+    if (acc.val == BOR_ZERO)
+        return;
+    borCHull3Add(h, &pts[acc.best].v);
 }
@@ -0,0 +1,740 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include <boruvka/delaunay.h>
+#include <boruvka/predicates.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/sort.h>
+#include <boruvka/alloc.h>
+
+/** vvvv */
+/** Index of the vertex at infinity */
+#define INF -1
+/** Marks deleted tetrahedron (stored in .v[0]) */
+#define DEAD -2
+
+/** Number of bits per axis of Hilbert keys, 3 * 8 bits fit into mantissa
+ *  of float so keys can be sorted by borRadixSort() */
+#define HILBERT_BITS 8
+/** Rounds of BRIO smaller than this are merged into one */
+#define BRIO_MIN 64
+/** ^^^^ */
+
+struct _tet_t {
+    int v[4];          /*!< Vertices, INF is vertex at infinity */
+    int n[4];          /*!< .n[i] is neighbor opposite to .v[i] */
+    unsigned int mark; /*!< Visit mark, see delInsert() */
+};
+typedef struct _tet_t tet_t;
+
+/** Face of cavity: face opposite to .v[face] of tetrahedron tet */
+struct _face_t {
+    int tet, face;
+};
+typedef struct _face_t face_t;
+
+/** Entry of hash table of edges of a new cone */
+struct _edge_t {
+    int u, w;          /*!< End points, u < w */
+    int tet, face;     /*!< Tetrahedron and its face waiting for neighbor */
+    unsigned int mark; /*!< Entry is valid if equals to del_t.stamp */
+};
+typedef struct _edge_t edge_t;
+
+struct _del_t {
+    bor_pred_t pred;
+    const bor_vec3_t *pts;
+
+    tet_t *tet;
+    int tet_len, tet_size;
+    int tet_free;   /*!< Head of list of deleted tetrahedra */
+    int last;       /*!< Finite tetrahedron where walks start */
+    unsigned int stamp;
+    uint32_t walk_rand;
+
+    int *conflicts;     /*!< Tetrahedra in conflict */
+    int conflicts_size;
+    face_t *border;     /*!< Border faces of cavity */
+    int border_size;
+    edge_t *edges;      /*!< Hash table of edges */
+    int edges_size;
+};
+typedef struct _del_t del_t;
+
+static void delInit(del_t *d, const bor_vec3_t *pts, size_t len);
+static void delFree(del_t *d);
+/** Creates first tetrahedron and its ghosts. Returns -1 if all points are
+ *  coplanar */
+static int delSimplex(del_t *d, int *order, int len);
+/** Inserts point into triangulation */
+static void delInsert(del_t *d, int p);
+/** Creates mesh edges from edges of tetrahedra */
+static void delToMesh(del_t *d, bor_qhull_mesh3_t *qmesh,
+                      bor_mesh3_vertex_t **verts);
+
+/** Fills order with indices of points in BRIO order */
+static void brioOrder(const bor_vec3_t *pts, int *order, int len);
+
+bor_qhull_mesh3_t *borDelaunayMesh3(const bor_pc_t *pc)
+{
+    bor_qhull_mesh3_t *qmesh;
+    bor_mesh3_vertex_t **verts, **iverts;
+    bor_vec3_t *pts;
+    bor_pc_it_t pcit;
+    bor_vec_t *w;
+    del_t del;
+    int *order;
+    int i, len;
+
+    len = borPCLen(pc);
+    qmesh = borQHullMesh3New(len);
+
+    verts = BOR_ALLOC_ARR(bor_mesh3_vertex_t *, len + 1);
+    borPCItInit(&pcit, (bor_pc_t *)pc);
+    for (i = 0; i < len; ++i, borPCItNext(&pcit)){
+        w = borPCItGet(&pcit);
+        borVec3Set(&qmesh->vecs[i], borVecGet(w, 0), borVecGet(w, 1),
+                                    borVecGet(w, 2));
+
+        verts[i] = BOR_POOL_ALLOC(qmesh->pool, bor_mesh3_vertex_t);
+        borMesh3VertexSetCoords(verts[i], &qmesh->vecs[i]);
+        borMesh3AddVertex(qmesh->mesh, verts[i]);
+    }
+
+    order = BOR_ALLOC_ARR(int, len + 1);
+    brioOrder(qmesh->vecs, order, len);
+
+    // Points are renumbered in insertion order, so points of neighboring
+    // tetrahedra are also close to each other in memory
+    pts = borVec3ArrNew(len + 1);
+    iverts = BOR_ALLOC_ARR(bor_mesh3_vertex_t *, len + 1);
+    for (i = 0; i < len; ++i){
+        borVec3Copy(&pts[i], &qmesh->vecs[order[i]]);
+        iverts[i] = verts[order[i]];
+        order[i] = i;
+    }
+
+    delInit(&del, pts, len);
+    if (delSimplex(&del, order, len) == 0){
+        for (i = 4; i < len; ++i)
+            delInsert(&del, order[i]);
+        delToMesh(&del, qmesh, iverts);
+    }
+    delFree(&del);
+
+    borVec3ArrDel(pts);
+    BOR_FREE(order);
+    BOR_FREE(iverts);
+    BOR_FREE(verts);
+
+    return qmesh;
+}
+
+
+static void delInit(del_t *d, const bor_vec3_t *pts, size_t len)
+{
+    borPredInit(&d->pred);
+    d->pts = pts;
+
+    // Delaunay tetrahedralization has about 6.5 tetrahedra per point
+    d->tet_size = 7 * len + 16;
+    d->tet = BOR_ALLOC_ARR(tet_t, d->tet_size);
+    d->tet_len = 0;
+    d->tet_free = -1;
+    d->last = 0;
+    d->stamp = 0;
+    d->walk_rand = 2463534242u;
+
+    d->conflicts_size = 64;
+    d->conflicts = BOR_ALLOC_ARR(int, d->conflicts_size);
+    d->border_size = 64;
+    d->border = BOR_ALLOC_ARR(face_t, d->border_size);
+    d->edges_size = 256;
+    d->edges = BOR_CALLOC_ARR(edge_t, d->edges_size);
+}
+
+static void delFree(del_t *d)
+{
+    BOR_FREE(d->tet);
+    BOR_FREE(d->conflicts);
+    BOR_FREE(d->border);
+    BOR_FREE(d->edges);
+}
+
+static int tetNew(del_t *d)
+{
+    int t;
+
+    if (d->tet_free >= 0){
+        t = d->tet_free;
+        d->tet_free = d->tet[t].n[0];
+    }else{
+        if (d->tet_len == d->tet_size){
+            d->tet_size *= 2;
+            d->tet = BOR_REALLOC_ARR(d->tet, tet_t, d->tet_size);
+        }
+        t = d->tet_len++;
+    }
+    d->tet[t].mark = 0;
+    return t;
+}
+
+static void tetDel(del_t *d, int t)
+{
+    d->tet[t].v[0] = DEAD;
+    d->tet[t].n[0] = d->tet_free;
+    d->tet_free = t;
+}
+
+/** Returns index of vertex at infinity or -1 for finite tetrahedron */
+_bor_inline int tetInf(const tet_t *t)
+{
+    if (t->v[0] == INF)
+        return 0;
+    if (t->v[1] == INF)
+        return 1;
+    if (t->v[2] == INF)
+        return 2;
+    if (t->v[3] == INF)
+        return 3;
+    return -1;
+}
+
+/** Orientation of tetrahedron t with i'th vertex replaced by point p */
+_bor_inline bor_real_t orientWith(const del_t *d, const tet_t *t,
+                                  int i, int p)
+{
+    const bor_vec3_t *v[4];
+    int j;
+
+    for (j = 0; j < 4; ++j)
+        v[j] = &d->pts[t->v[j]];
+    v[i] = &d->pts[p];
+    return borPredOrient3d(&d->pred, v[0], v[1], v[2], v[3]);
+}
+
+_bor_inline bor_real_t inSphere(const del_t *d, const tet_t *t, int p)
+{
+    return borPredInSphere(&d->pred, &d->pts[t->v[0]], &d->pts[t->v[1]],
+                                     &d->pts[t->v[2]], &d->pts[t->v[3]],
+                                     &d->pts[p]);
+}
+
+/** Returns true if point p lies in circumsphere of tetrahedron t.
+ *  Circumsphere of ghost tetrahedron is the open half-space above its hull
+ *  face plus the open circumcircle of the face. */
+static int conflict(const del_t *d, int t, int p)
+{
+    const tet_t *tet = d->tet + t;
+    bor_real_t o;
+    int k;
+
+    k = tetInf(tet);
+    if (k < 0)
+        return inSphere(d, tet, p) > BOR_ZERO;
+
+    o = orientWith(d, tet, k, p);
+    if (o > BOR_ZERO)
+        return 1;
+    if (o < BOR_ZERO)
+        return 0;
+    // p is coplanar with the hull face, the finite neighbor decides
+    return inSphere(d, d->tet + tet->n[k], p) > BOR_ZERO;
+}
+
+/** Visibility walk from d->last towards the point p. Returns ghost
+ *  tetrahedron if p lies outside of the hull or the finite tetrahedron
+ *  containing p. */
+static int locate(del_t *d, int p)
+{
+    const tet_t *tet;
+    int t, i, j, r, k;
+
+    t = d->last;
+    while (1){
+        tet = d->tet + t;
+        if (tetInf(tet) >= 0)
+            return t;
+
+        // start from random face to prevent cycling
+        d->walk_rand ^= d->walk_rand << 13;
+        d->walk_rand ^= d->walk_rand >> 17;
+        d->walk_rand ^= d->walk_rand << 5;
+        r = d->walk_rand & 3;
+
+        k = -1;
+        for (j = 0; j < 4; ++j){
+            i = (r + j) & 3;
+            if (orientWith(d, tet, i, p) < BOR_ZERO){
+                k = i;
+                break;
+            }
+        }
+
+        if (k < 0)
+            return t;
+        t = tet->n[k];
+    }
+}
+
+/** Returns pointer to the entry of edge (u, w) in the hash table */
+static edge_t *edgeFind(del_t *d, int u, int w)
+{
+    edge_t *e;
+    unsigned int h;
+
+    if (u > w){
+        BOR_SWAP(u, w, h);
+    }
+
+    h = ((unsigned int)u * 73856093u) ^ ((unsigned int)w * 19349663u);
+    h &= d->edges_size - 1;
+    while (1){
+        e = d->edges + h;
+        if (e->mark != d->stamp){
+            e->u = u;
+            e->w = w;
+            e->tet = -1;
+            e->mark = d->stamp;
+            return e;
+        }
+        if (e->u == u && e->w == w)
+            return e;
+        h = (h + 1) & (d->edges_size - 1);
+    }
+}
+
+/** Resizes edge hash table to be able to hold edges of the cone over
+ *  given number of faces (1.5 edge per face) with low load factor */
+static void edgesReserve(del_t *d, int faces)
+{
+    if (d->edges_size >= 4 * faces)
+        return;
+
+    while (d->edges_size < 4 * faces)
+        d->edges_size *= 2;
+    BOR_FREE(d->edges);
+    d->edges = BOR_CALLOC_ARR(edge_t, d->edges_size);
+}
+
+/** Links tetrahedron t with its neighbor across face opposite to .v[i]
+ *  using edge hash table */
+static void linkCone(del_t *d, int t, int i, int u, int w)
+{
+    edge_t *e;
+
+    e = edgeFind(d, u, w);
+    if (e->tet < 0){
+        e->tet = t;
+        e->face = i;
+    }else{
+        d->tet[t].n[i] = e->tet;
+        d->tet[e->tet].n[e->face] = t;
+    }
+}
+
+static void delInsert(del_t *d, int p)
+{
+    int t, c, nb, i, j, k, u, w, nt;
+    int conflicts_len, border_len, head;
+    unsigned int cmark, nmark;
+
+    t = locate(d, p);
+    if (!conflict(d, t, p)){
+        // p is duplicate of already inserted point
+        return;
+    }
+
+    // Find cavity by breadth first search from t.
+    // .mark is 2 * stamp for tetrahedra in conflict and 2 * stamp + 1 for
+    // tested tetrahedra not in conflict
+    ++d->stamp;
+    cmark = 2u * d->stamp;
+    nmark = cmark + 1u;
+
+    d->tet[t].mark = cmark;
+    d->conflicts[0] = t;
+    conflicts_len = 1;
+    border_len = 0;
+    for (head = 0; head < conflicts_len; ++head){
+        c = d->conflicts[head];
+        for (i = 0; i < 4; ++i){
+            nb = d->tet[c].n[i];
+
+            if (d->tet[nb].mark != cmark && d->tet[nb].mark != nmark){
+                if (conflict(d, nb, p)){
+                    d->tet[nb].mark = cmark;
+                    if (conflicts_len == d->conflicts_size){
+                        d->conflicts_size *= 2;
+                        d->conflicts = BOR_REALLOC_ARR(d->conflicts, int,
+                                                       d->conflicts_size);
+                    }
+                    d->conflicts[conflicts_len++] = nb;
+                }else{
+                    d->tet[nb].mark = nmark;
+                }
+            }
+
+            if (d->tet[nb].mark == nmark){
+                if (border_len == d->border_size){
+                    d->border_size *= 2;
+                    d->border = BOR_REALLOC_ARR(d->border, face_t,
+                                                d->border_size);
+                }
+                d->border[border_len].tet = c;
+                d->border[border_len].face = i;
+                ++border_len;
+            }
+        }
+    }
+
+    // Fill cavity with cone from p to its border
+    edgesReserve(d, border_len);
+    for (j = 0; j < border_len; ++j){
+        c = d->border[j].tet;
+        i = d->border[j].face;
+
+        nt = tetNew(d);
+        d->tet[nt] = d->tet[c];
+        d->tet[nt].v[i] = p;
+        d->tet[nt].mark = 0;
+
+        nb = d->tet[c].n[i];
+        for (k = 0; k < 4; ++k){
+            if (d->tet[nb].n[k] == c){
+                d->tet[nb].n[k] = nt;
+                break;
+            }
+        }
+
+        // neighbors across faces containing p share an edge of the
+        // border face
+        for (k = 0; k < 4; ++k){
+            if (k == i)
+                continue;
+            u = d->tet[nt].v[(k + 1) & 3];
+            w = d->tet[nt].v[(k + 2) & 3];
+            if (u == p)
+                u = d->tet[nt].v[(k + 3) & 3];
+            if (w == p)
+                w = d->tet[nt].v[(k + 3) & 3];
+            linkCone(d, nt, k, u, w);
+        }
+
+        if (tetInf(d->tet + nt) < 0)
+            d->last = nt;
+    }
+
+    for (j = 0; j < conflicts_len; ++j)
+        tetDel(d, d->conflicts[j]);
+}
+
+_bor_inline int ptEq(const del_t *d, int a, int b)
+{
+    return borVec3X(&d->pts[a]) == borVec3X(&d->pts[b])
+            && borVec3Y(&d->pts[a]) == borVec3Y(&d->pts[b])
+            && borVec3Z(&d->pts[a]) == borVec3Z(&d->pts[b]);
+}
+
+/** Exact test of collinearity using projections to coordinate planes */
+static int collinear(const del_t *d, int a, int b, int c)
+{
+    bor_vec2_t p[3];
+    int i, x, y;
+    int idx[3] = { a, b, c };
+
+    for (x = 0; x < 3; ++x){
+        y = (x + 1) % 3;
+        for (i = 0; i < 3; ++i){
+            borVec2Set(&p[i], borVec3Get(&d->pts[idx[i]], x),
+                              borVec3Get(&d->pts[idx[i]], y));
+        }
+        if (borPredOrient2d(&d->pred, &p[0], &p[1], &p[2]) != BOR_ZERO)
+            return 0;
+    }
+    return 1;
+}
+
+/** Finds k'th vertex of the first tetrahedron in order[k, len) -- point
+ *  different from v[0], not collinear with v[0], v[1] and not coplanar
+ *  with v[0], v[1], v[2], respectively -- and swaps it to order[k] */
+static int simplexVertex(del_t *d, int *order, int len, int *v, int k)
+{
+    int i, p, found;
+
+    for (i = k; i < len; ++i){
+        p = order[i];
+        if (k == 1){
+            found = !ptEq(d, v[0], p);
+        }else if (k == 2){
+            found = !collinear(d, v[0], v[1], p);
+        }else{
+            found = borPredOrient3d(&d->pred, &d->pts[v[0]], &d->pts[v[1]],
+                                    &d->pts[v[2]], &d->pts[p]) != BOR_ZERO;
+        }
+
+        if (found){
+            order[i] = order[k];
+            order[k] = p;
+            v[k] = p;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/** Returns true if faces opposite to ta.v[fa] and tb.v[fb] are the same */
+static int sameFace(const tet_t *ta, int fa, const tet_t *tb, int fb)
+{
+    int i, j, found;
+
+    for (i = 0; i < 4; ++i){
+        if (i == fa)
+            continue;
+        found = 0;
+        for (j = 0; j < 4 && !found; ++j)
+            found = (j != fb && ta->v[i] == tb->v[j]);
+        if (!found)
+            return 0;
+    }
+    return 1;
+}
+
+static int delSimplex(del_t *d, int *order, int len)
+{
+    tet_t *tet;
+    int i, j, k, l, t, tmp;
+    int v[4];
+
+    if (len < 4)
+        return -1;
+
+    v[0] = order[0];
+    for (k = 1; k < 4; ++k){
+        if (simplexVertex(d, order, len, v, k) != 0)
+            return -1;
+    }
+
+    if (borPredOrient3d(&d->pred, &d->pts[v[0]], &d->pts[v[1]],
+                        &d->pts[v[2]], &d->pts[v[3]]) < BOR_ZERO){
+        BOR_SWAP(v[0], v[1], tmp);
+    }
+
+    // positively oriented tetrahedron and one ghost over each of its
+    // faces -- replacing the vertex at infinity by a point above the face
+    // makes the ghost also positively oriented
+    for (i = 0; i < 5; ++i){
+        t = tetNew(d);
+        tet = d->tet + t;
+        for (j = 0; j < 4; ++j)
+            tet->v[j] = v[j];
+        if (i > 0){
+            tet->v[i - 1] = INF;
+            j = i & 3;
+            k = (i + 1) & 3;
+            BOR_SWAP(tet->v[j], tet->v[k], tmp);
+        }
+    }
+
+    for (i = 0; i < 5; ++i){
+        for (k = 0; k < 4; ++k){
+            for (j = 0; j < 5; ++j){
+                if (j == i)
+                    continue;
+                for (l = 0; l < 4; ++l){
+                    if (sameFace(d->tet + i, k, d->tet + j, l))
+                        d->tet[i].n[k] = j;
+                }
+            }
+        }
+    }
+
+    d->last = 0;
+    return 0;
+}
+
+static void delToMesh(del_t *d, bor_qhull_mesh3_t *qmesh,
+                      bor_mesh3_vertex_t **verts)
+{
+    const tet_t *tet;
+    bor_mesh3_edge_t *edge;
+    int *vtet, *vmark;
+    int len, t, t2, u, w, k, top;
+    unsigned int mark;
+
+    len = qmesh->vecs_len;
+    vtet = BOR_ALLOC_ARR(int, len);
+    vmark = BOR_ALLOC_ARR(int, len);
+    for (u = 0; u < len; ++u)
+        vtet[u] = vmark[u] = -1;
+
+    for (t = 0; t < d->tet_len; ++t){
+        tet = d->tet + t;
+        if (tet->v[0] == DEAD)
+            continue;
+        for (k = 0; k < 4; ++k){
+            if (tet->v[k] != INF)
+                vtet[tet->v[k]] = t;
+        }
+    }
+
+    // Walk over star of each vertex u and create edges to its neighbors
+    // with higher index. This visits each edge twice instead of testing
+    // incidence lists of mesh vertices for each edge of each tetrahedron.
+    for (u = 0; u < len; ++u){
+        if (vtet[u] < 0)
+            continue;
+
+        mark = 2u * ++d->stamp;
+        d->tet[vtet[u]].mark = mark;
+        d->conflicts[0] = vtet[u];
+        top = 1;
+        while (top > 0){
+            t = d->conflicts[--top];
+            for (k = 0; k < 4; ++k){
+                w = d->tet[t].v[k];
+                if (w == u)
+                    continue;
+
+                if (w > u && vmark[w] != u){
+                    vmark[w] = u;
+                    edge = BOR_POOL_ALLOC(qmesh->pool, bor_mesh3_edge_t);
+                    borMesh3AddEdge(qmesh->mesh, edge, verts[u], verts[w]);
+                }
+
+                // face opposite to w contains u
+                t2 = d->tet[t].n[k];
+                if (d->tet[t2].mark != mark){
+                    d->tet[t2].mark = mark;
+                    if (top == d->conflicts_size){
+                        d->conflicts_size *= 2;
+                        d->conflicts = BOR_REALLOC_ARR(d->conflicts, int,
+                                                       d->conflicts_size);
+                    }
+                    d->conflicts[top++] = t2;
+                }
+            }
+        }
+    }
+
+    BOR_FREE(vtet);
+    BOR_FREE(vmark);
+}
+
+
+/** Transforms coordinates to Hilbert key (Skilling's algorithm) */
+static uint32_t hilbertKey(uint32_t x[3])
+{
+    uint32_t m, p, q, t, key;
+    int i, b;
+
+    m = 1u << (HILBERT_BITS - 1);
+
+    // inverse undo
+    for (q = m; q > 1; q >>= 1){
+        p = q - 1;
+        for (i = 0; i < 3; ++i){
+            if (x[i] & q){
+                x[0] ^= p;
+            }else{
+                t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+
+    // gray encode
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    t = 0;
+    for (q = m; q > 1; q >>= 1){
+        if (x[2] & q)
+            t ^= q - 1;
+    }
+    for (i = 0; i < 3; ++i)
+        x[i] ^= t;
+
+    // interleave transposed bits
+    key = 0;
+    for (b = HILBERT_BITS - 1; b >= 0; --b){
+        for (i = 0; i < 3; ++i)
+            key = (key << 1) | ((x[i] >> b) & 1u);
+    }
+    return key;
+}
+
+static void brioOrder(const bor_vec3_t *pts, int *order, int len)
+{
+    bor_rand_mt_t *rnd;
+    bor_radix_sort_t *rs, *tmp;
+    bor_real_t min[3], scale[3], c;
+    uint32_t x[3];
+    int i, j, k, begin, end;
+
+    if (len == 0)
+        return;
+
+    for (i = 0; i < len; ++i)
+        order[i] = i;
+
+    // shuffle points
+    rnd = borRandMTNewAuto();
+    for (i = len - 1; i > 0; --i){
+        j = borRandMT(rnd, 0, i + 1);
+        j = BOR_MIN(j, i);
+        BOR_SWAP(order[i], order[j], k);
+    }
+    borRandMTDel(rnd);
+
+    // bounding box mapped to Hilbert grid
+    for (k = 0; k < 3; ++k){
+        min[k] = scale[k] = borVec3Get(&pts[0], k);
+        for (i = 1; i < len; ++i){
+            c = borVec3Get(&pts[i], k);
+            min[k] = BOR_MIN(min[k], c);
+            scale[k] = BOR_MAX(scale[k], c);
+        }
+        scale[k] -= min[k];
+        if (scale[k] > BOR_ZERO)
+            scale[k] = (bor_real_t)((1u << HILBERT_BITS) - 1) / scale[k];
+    }
+
+    // sort rounds of doubling size along Hilbert curve
+    rs  = BOR_ALLOC_ARR(bor_radix_sort_t, len);
+    tmp = BOR_ALLOC_ARR(bor_radix_sort_t, len);
+    for (end = len; end > 0; end = begin){
+        begin = (end > BRIO_MIN ? end / 2 : 0);
+
+        for (i = begin; i < end; ++i){
+            for (k = 0; k < 3; ++k){
+                c = (borVec3Get(&pts[order[i]], k) - min[k]) * scale[k];
+                x[k] = (uint32_t)c;
+                x[k] = BOR_MIN(x[k], (1u << HILBERT_BITS) - 1);
+            }
+            rs[i - begin].key = hilbertKey(x);
+            rs[i - begin].val = order[i];
+        }
+
+        borRadixSort(rs, tmp, end - begin);
+        for (i = begin; i < end; ++i)
+            order[i] = rs[i - begin].val;
+    }
+    BOR_FREE(rs);
+    BOR_FREE(tmp);
+}
@@ -18,10 +18,118 @@
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
 
-/** Compares two nodes and returns true if n1 < n2. */
+/** Compares two nodes and returns true if n1 < n2 in the forward and
+ *  backward heap, respectively. */
 static int heapLT(const bor_pairheap_node_t *n1,
                   const bor_pairheap_node_t *n2,
                   void *_);
+static int heapLTRev(const bor_pairheap_node_t *n1,
+                     const bor_pairheap_node_t *n2,
+                     void *_);
+
+/** Creates empty heaps of the selected type */
+static void heapNew(bor_dij_t *dij);
+/** Deletes the heaps */
+static void heapDel(bor_dij_t *dij);
+
+/** Returns node's connector into heap in direction {d} (0 is forward, 1
+ *  is backward) */
+_bor_inline bor_dij_heap_node_t *heapNode(bor_dij_node_t *n, int d)
+{
+    return (d ? &n->_heap_rev : &n->_heap);
+}
+
+/** Inverse of heapNode() */
+_bor_inline bor_dij_node_t *heapNodeEntry(bor_dij_heap_node_t *hn, int d)
+{
+    if (d)
+        return bor_container_of(hn, bor_dij_node_t, _heap_rev);
+    return bor_container_of(hn, bor_dij_node_t, _heap);
+}
+
+/** Returns integer key of the node */
+_bor_inline uint64_t heapKey(const bor_dij_t *dij,
+                             const bor_dij_node_t *n, int d)
+{
+    return (d ? n->_dist_rev : n->_key) * dij->key_scale;
+}
+
+_bor_inline int heapEmpty(const bor_dij_t *dij, int d)
+{
+    switch (dij->heap_type){
+        case BOR_DIJ_HEAP_BUCKET:
+            return borBucketHeapEmpty(dij->heap[d].bucket);
+        case BOR_DIJ_HEAP_RADIX:
+            return borRadixHeapEmpty(dij->heap[d].radix);
+        default:
+            return borPairHeapEmpty(dij->heap[d].pair);
+    }
+}
+
+_bor_inline void heapAdd(bor_dij_t *dij, bor_dij_node_t *n, int d)
+{
+    bor_dij_heap_node_t *hn = heapNode(n, d);
+
+    switch (dij->heap_type){
+        case BOR_DIJ_HEAP_BUCKET:
+            borBucketHeapAdd(dij->heap[d].bucket, heapKey(dij, n, d),
+                             &hn->bucket);
+            break;
+        case BOR_DIJ_HEAP_RADIX:
+            borRadixHeapAdd(dij->heap[d].radix, &hn->radix,
+                            heapKey(dij, n, d));
+            break;
+        default:
+            borPairHeapAdd(dij->heap[d].pair, &hn->pair);
+    }
+}
+
+_bor_inline void heapDecreaseKey(bor_dij_t *dij, bor_dij_node_t *n, int d)
+{
+    bor_dij_heap_node_t *hn = heapNode(n, d);
+
+    switch (dij->heap_type){
+        case BOR_DIJ_HEAP_BUCKET:
+            borBucketHeapDecreaseKey(dij->heap[d].bucket, &hn->bucket,
+                                     heapKey(dij, n, d));
+            break;
+        case BOR_DIJ_HEAP_RADIX:
+            borRadixHeapDecreaseKey(dij->heap[d].radix, &hn->radix,
+                                    heapKey(dij, n, d));
+            break;
+        default:
+            borPairHeapDecreaseKey(dij->heap[d].pair, &hn->pair);
+    }
+}
+
+_bor_inline bor_dij_node_t *heapExtractMin(bor_dij_t *dij, int d)
+{
+    bor_bucketheap_node_t *bn;
+    bor_radixheap_node_t *rn;
+    bor_pairheap_node_t *pn;
+
+    switch (dij->heap_type){
+        case BOR_DIJ_HEAP_BUCKET:
+            bn = borBucketHeapExtractMin(dij->heap[d].bucket, NULL);
+            return heapNodeEntry((bor_dij_heap_node_t *)bn, d);
+        case BOR_DIJ_HEAP_RADIX:
+            rn = borRadixHeapExtractMin(dij->heap[d].radix);
+            return heapNodeEntry((bor_dij_heap_node_t *)rn, d);
+        default:
+            pn = borPairHeapExtractMin(dij->heap[d].pair);
+            return heapNodeEntry((bor_dij_heap_node_t *)pn, d);
+    }
+}
+
+/** Forward search shared by borDijRun() and borDijRunAStar() */
+static int search(bor_dij_t *dij, bor_dij_node_t *start,
+                  bor_dij_node_t *end, int astar);
+
+/** Expands {node} in the direction {d} of the bidirectional search and
+ *  updates the length {mu} of the shortest path found so far and the
+ *  meeting node {meet} of that path */
+static void bidirExpand(bor_dij_t *dij, bor_dij_node_t *node, int d,
+                        bor_real_t *mu, bor_dij_node_t **meet);
 
 bor_dij_t *borDijNew(const bor_dij_ops_t *ops)
 {
@@ -30,43 +138,136 @@ bor_dij_t *borDijNew(const bor_dij_ops_t *ops)
     dij = BOR_ALLOC(bor_dij_t);
     dij->ops   = *ops;
 
-    dij->heap = NULL;
+    dij->heap_type = BOR_DIJ_HEAP_PAIRING;
+    dij->key_scale = BOR_ONE;
+    bzero(dij->heap, sizeof(dij->heap));
 
     return dij;
 }
 
 void borDijDel(bor_dij_t *dij)
 {
-    if (dij->heap)
-        borPairHeapDel(dij->heap);
+    heapDel(dij);
     BOR_FREE(dij);
 }
 
+void borDijSetHeap(bor_dij_t *dij, int heap_type, bor_real_t key_scale)
+{
+    heapDel(dij);
+    dij->heap_type = heap_type;
+    dij->key_scale = key_scale;
+}
+
 int borDijRun(bor_dij_t *dij, bor_dij_node_t *start,
                               bor_dij_node_t *end)
 {
-    bor_pairheap_node_t *heapnode;
+    return search(dij, start, end, 0);
+}
+
+int borDijRunAStar(bor_dij_t *dij, bor_dij_node_t *start,
+                                   bor_dij_node_t *end)
+{
+    return search(dij, start, end, dij->ops.heuristic != NULL);
+}
+
+int borDijRunBidir(bor_dij_t *dij, bor_dij_node_t *start,
+                                   bor_dij_node_t *end)
+{
+    bor_dij_node_t *node, *meet;
+    bor_real_t mu, top[2], w;
+    int d;
+
+    start->dist = BOR_ZERO;
+    start->prev = NULL;
+    if (start == end){
+        start->state = BOR_DIJ_STATE_CLOSED;
+        return 0;
+    }
+
+    // create priority heaps
+    heapDel(dij);
+    heapNew(dij);
+
+    // push start node on forward heap and end node on backward heap
+    start->_key = BOR_ZERO;
+    start->state = BOR_DIJ_STATE_OPEN;
+    heapAdd(dij, start, 0);
+
+    end->_dist_rev = BOR_ZERO;
+    end->_next = NULL;
+    end->_state_rev = BOR_DIJ_STATE_OPEN;
+    heapAdd(dij, end, 1);
+
+    mu = BOR_REAL_MAX;
+    meet = NULL;
+
+    // Keys of the nodes last extracted from each heap are lower bounds
+    // of the minimal keys in the heaps, so once their sum reaches {mu}
+    // no shorter path can be found.
+    top[0] = top[1] = BOR_ZERO;
+    while (!heapEmpty(dij, 0) && !heapEmpty(dij, 1)){
+        // grow the search with smaller radius
+        d = (top[1] < top[0]);
+
+        node = heapExtractMin(dij, d);
+        top[d] = (d ? node->_dist_rev : node->dist);
+        if (top[0] + top[1] >= mu)
+            break;
+
+        bidirExpand(dij, node, d, &mu, &meet);
+    }
+
+    if (meet == NULL)
+        return -1;
+
+    // Connect the backward part of the path to the forward part so that
+    // the path can be obtained by borDijPath() from the end node.
+    for (node = meet; node->_next; node = node->_next){
+        w = node->_dist_rev - node->_next->_dist_rev;
+        node->_next->dist = node->dist + w;
+        node->_next->prev = node;
+    }
+    end->dist = mu;
+
+    return 0;
+}
+
+void borDijPath(bor_dij_node_t *endnode, bor_list_t *list)
+{
+    bor_dij_node_t *node;
+
+    node = endnode;
+    while (node){
+        borListPrepend(list, &node->_list);
+        node = node->prev;
+    }
+}
+
+
+static int search(bor_dij_t *dij, bor_dij_node_t *start,
+                  bor_dij_node_t *end, int astar)
+{
     bor_dij_node_t *node, *nextnode;
     bor_list_t list, *item;
-    bor_real_t dist;
-
-    if (dij->heap)
-        borPairHeapDel(dij->heap);
+    bor_real_t dist, h;
 
     // create priority heap
-    dij->heap = borPairHeapNew(heapLT, NULL);
+    heapDel(dij);
+    heapNew(dij);
 
     // push start node on heap
     start->dist = BOR_ZERO;
     start->prev = NULL;
     start->state = BOR_DIJ_STATE_OPEN;
-    borPairHeapAdd(dij->heap, &start->_heap);
+    start->_key = BOR_ZERO;
+    if (astar)
+        start->_key = dij->ops.heuristic(start, end, dij->ops.data);
+    heapAdd(dij, start, 0);
 
     // run algorithm
-    while (!borPairHeapEmpty(dij->heap)){
+    while (!heapEmpty(dij, 0)){
         // Get minimal node from priority heap
-        heapnode = borPairHeapExtractMin(dij->heap);
-        node = bor_container_of(heapnode, bor_dij_node_t, _heap);
+        node = heapExtractMin(dij, 0);
 
         // set state to CLOSED
         node->state = BOR_DIJ_STATE_CLOSED;
@@ -97,16 +298,23 @@ int borDijRun(bor_dij_t *dij, bor_dij_node_t *start,
             // call borDijNodeInit() function which sets .dist to
             // BOR_REAL_MAX.
             if (dist < nextnode->dist){
-                // store new distance
-                nextnode->dist = dist;
-                nextnode->prev = node;
-
                 // and update its position in heap or add it on heap if it
                 // is not already on heap
                 if (nextnode->state == BOR_DIJ_STATE_OPEN){
-                    borPairHeapDecreaseKey(dij->heap, &nextnode->_heap);
+                    // heuristic value of the node is already known
+                    h = nextnode->_key - nextnode->dist;
+                    nextnode->dist = dist;
+                    nextnode->prev = node;
+                    nextnode->_key = dist + h;
+                    heapDecreaseKey(dij, nextnode, 0);
                 }else{
-                    borPairHeapAdd(dij->heap, &nextnode->_heap);
+                    h = BOR_ZERO;
+                    if (astar)
+                        h = dij->ops.heuristic(nextnode, end, dij->ops.data);
+                    nextnode->dist = dist;
+                    nextnode->prev = node;
+                    nextnode->_key = dist + h;
+                    heapAdd(dij, nextnode, 0);
                     nextnode->state = BOR_DIJ_STATE_OPEN;
                 }
             }
@@ -116,25 +324,120 @@ int borDijRun(bor_dij_t *dij, bor_dij_node_t *start,
     return -1;
 }
 
-void borDijPath(bor_dij_node_t *endnode, bor_list_t *list)
+static void bidirExpand(bor_dij_t *dij, bor_dij_node_t *node, int d,
+                        bor_real_t *mu, bor_dij_node_t **meet)
 {
-    bor_dij_node_t *node;
+    bor_dij_node_t *nextnode;
+    bor_list_t list, *item;
+    bor_real_t dist, *ndist, odist;
+    int *state;
 
-    node = endnode;
-    while (node){
-        borListPrepend(list, &node->_list);
-        node = node->prev;
+    if (d == 0){
+        node->state = BOR_DIJ_STATE_CLOSED;
+    }else{
+        node->_state_rev = BOR_DIJ_STATE_CLOSED;
+    }
+
+    borListInit(&list);
+    if (d == 0){
+        dij->ops.expand(node, &list, dij->ops.data);
+    }else{
+        dij->ops.expand_rev(node, &list, dij->ops.data);
+    }
+
+    BOR_LIST_FOR_EACH(&list, item){
+        nextnode = BOR_LIST_ENTRY(item, bor_dij_node_t, _list);
+
+        if (d == 0){
+            state = &nextnode->state;
+            ndist = &nextnode->dist;
+            odist = nextnode->_dist_rev;
+            dist  = node->dist + nextnode->_loc_dist;
+        }else{
+            state = &nextnode->_state_rev;
+            ndist = &nextnode->_dist_rev;
+            odist = nextnode->dist;
+            dist  = node->_dist_rev + nextnode->_loc_dist;
+        }
+
+        if (bor_unlikely(*state == BOR_DIJ_STATE_CLOSED))
+            continue;
+        if (dist >= *ndist)
+            continue;
+
+        *ndist = dist;
+        if (d == 0){
+            nextnode->prev = node;
+            nextnode->_key = dist;
+        }else{
+            nextnode->_next = node;
+        }
+
+        if (*state == BOR_DIJ_STATE_OPEN){
+            heapDecreaseKey(dij, nextnode, d);
+        }else{
+            heapAdd(dij, nextnode, d);
+            *state = BOR_DIJ_STATE_OPEN;
+        }
+
+        // the node was already reached from the other side
+        if (odist != BOR_REAL_MAX && dist + odist < *mu){
+            *mu = dist + odist;
+            *meet = nextnode;
+        }
     }
 }
 
+static void heapNew(bor_dij_t *dij)
+{
+    switch (dij->heap_type){
+        case BOR_DIJ_HEAP_BUCKET:
+            dij->heap[0].bucket = borBucketHeapNew();
+            dij->heap[1].bucket = borBucketHeapNew();
+            break;
+        case BOR_DIJ_HEAP_RADIX:
+            dij->heap[0].radix = borRadixHeapNew();
+            dij->heap[1].radix = borRadixHeapNew();
+            break;
+        default:
+            dij->heap[0].pair = borPairHeapNew(heapLT, NULL);
+            dij->heap[1].pair = borPairHeapNew(heapLTRev, NULL);
+    }
+}
+
+static void heapDel(bor_dij_t *dij)
+{
+    int i;
+
+    for (i = 0; i < 2; i++){
+        if (dij->heap[i].pair)
+            borPairHeapDel(dij->heap[i].pair);
+        if (dij->heap[i].bucket)
+            borBucketHeapDel(dij->heap[i].bucket);
+        if (dij->heap[i].radix)
+            borRadixHeapDel(dij->heap[i].radix);
+    }
+    bzero(dij->heap, sizeof(dij->heap));
+}
 
 static int heapLT(const bor_pairheap_node_t *h1,
                   const bor_pairheap_node_t *h2,
                   void *_)
 {
     bor_dij_node_t *n1, *n2;
-    n1 = bor_container_of(h1, bor_dij_node_t, _heap);
-    n2 = bor_container_of(h2, bor_dij_node_t, _heap);
+    n1 = bor_container_of(h1, bor_dij_node_t, _heap.pair);
+    n2 = bor_container_of(h2, bor_dij_node_t, _heap.pair);
+
+    return n1->_key < n2->_key;
+}
+
+static int heapLTRev(const bor_pairheap_node_t *h1,
+                     const bor_pairheap_node_t *h2,
+                     void *_)
+{
+    bor_dij_node_t *n1, *n2;
+    n1 = bor_container_of(h1, bor_dij_node_t, _heap_rev.pair);
+    n2 = bor_container_of(h2, bor_dij_node_t, _heap_rev.pair);
 
-    return n1->dist < n2->dist;
+    return n1->_dist_rev < n2->_dist_rev;
 }
@@ -0,0 +1,133 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include "boruvka/alloc.h"
+#include "boruvka/ebr.h"
+
+static int tryAdvance(bor_ebr_t *e);
+
+bor_ebr_t *borEBRNew(int num_threads)
+{
+    bor_ebr_t *e;
+    int i;
+
+    e = BOR_ALLOC(bor_ebr_t);
+    e->epoch = 1;
+    e->num_threads = num_threads;
+    e->thread = BOR_ALLOC_ARR(bor_ebr_thread_t, num_threads);
+    for (i = 0; i < num_threads; ++i){
+        e->thread[i].epoch = 0;
+        e->thread[i].nesting = 0;
+        e->thread[i].retired = NULL;
+        e->thread[i].retired_len = 0;
+        e->thread[i].retired_alloc = 0;
+    }
+
+    return e;
+}
+
+void borEBRDel(bor_ebr_t *e)
+{
+    bor_ebr_thread_t *th;
+    bor_ebr_retired_t *r;
+    size_t j;
+    int i;
+
+    for (i = 0; i < e->num_threads; ++i){
+        th = e->thread + i;
+        for (j = 0; j < th->retired_len; ++j){
+            r = th->retired + j;
+            r->free_fn(r->obj, r->userdata);
+        }
+        if (th->retired)
+            BOR_FREE(th->retired);
+    }
+
+    BOR_FREE(e->thread);
+    BOR_FREE(e);
+}
+
+void borEBRRetire(bor_ebr_t *e, int tid, void *obj,
+                  bor_ebr_free_fn free_fn, void *userdata)
+{
+    bor_ebr_thread_t *th = e->thread + tid;
+    bor_ebr_retired_t *r;
+
+    if (th->retired_len == th->retired_alloc){
+        th->retired_alloc = BOR_MAX(2 * th->retired_alloc,
+                                    BOR_EBR_RECLAIM_PERIOD);
+        th->retired = BOR_REALLOC_ARR(th->retired, bor_ebr_retired_t,
+                                      th->retired_alloc);
+    }
+
+    r = th->retired + th->retired_len++;
+    r->obj = obj;
+    r->free_fn = free_fn;
+    r->userdata = userdata;
+    /* The object is already unlinked, so readers that enter from now on
+     * cannot reach it. Readers that can still reach it entered in this
+     * or an older epoch. */
+    r->epoch = __atomic_load_n(&e->epoch, __ATOMIC_SEQ_CST);
+
+    if (th->retired_len % BOR_EBR_RECLAIM_PERIOD == 0)
+        borEBRReclaim(e, tid);
+}
+
+size_t borEBRReclaim(bor_ebr_t *e, int tid)
+{
+    bor_ebr_thread_t *th = e->thread + tid;
+    bor_ebr_retired_t *r;
+    uint64_t epoch;
+    size_t i, ins;
+
+    tryAdvance(e);
+    epoch = __atomic_load_n(&e->epoch, __ATOMIC_ACQUIRE);
+
+    ins = 0;
+    for (i = 0; i < th->retired_len; ++i){
+        r = th->retired + i;
+        if (r->epoch + 2 <= epoch){
+            r->free_fn(r->obj, r->userdata);
+        }else{
+            th->retired[ins++] = *r;
+        }
+    }
+
+    i = th->retired_len - ins;
+    th->retired_len = ins;
+    return i;
+}
+
+static int tryAdvance(bor_ebr_t *e)
+{
+    uint64_t epoch, th_epoch;
+    int i;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    epoch = __atomic_load_n(&e->epoch, __ATOMIC_SEQ_CST);
+    for (i = 0; i < e->num_threads; ++i){
+        th_epoch = __atomic_load_n(&e->thread[i].epoch, __ATOMIC_SEQ_CST);
+        if ((th_epoch & 1) && (th_epoch >> 1) != epoch)
+            return -1;
+    }
+
+    if (__atomic_compare_exchange_n(&e->epoch, &epoch, epoch + 1, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+        return 0;
+    }
+    return -1;
+}
@@ -16,10 +16,24 @@
 
 #include <limits.h>
 #include <stdio.h>
+#include <errno.h>
 
 #include "boruvka/alloc.h"
 #include "boruvka/fifo-sem.h"
 
+/** Bounds of the number of spinning rounds of blocking pop in SPSC mode */
+#define SPSC_SPIN_MIN 16
+#define SPSC_SPIN_MAX 4096
+
+static int spscInit(bor_fifo_sem_t *fifo);
+static void spscFree(bor_fifo_sem_t *fifo);
+static void spscPush(bor_fifo_sem_t *fifo, void *el_data);
+static int spscPop(bor_fifo_sem_t *fifo, void *dst);
+/** Blocking pop, negative {time_in_ms} means no timeout */
+static int spscPopBlock(bor_fifo_sem_t *fifo, int time_in_ms, void *dst);
+/** Sets {tm} to absolute time {time_in_ms} from now */
+static void deadline(struct timespec *tm, int time_in_ms);
+
 static int fifoInitSem(bor_fifo_sem_t *fifo)
 {
     if (pthread_mutex_init(&fifo->lock, NULL) != 0){
@@ -62,6 +76,17 @@ bor_fifo_sem_t *borFifoSemNewSize(size_t el_size, size_t buf_size)
     return fifo;
 }
 
+bor_fifo_sem_t *borFifoSemNewSPSC(size_t el_size, size_t buf_size)
+{
+    bor_fifo_sem_t *fifo;
+    fifo = BOR_ALLOC(bor_fifo_sem_t);
+    if (borFifoSemInitSPSC(fifo, el_size, buf_size) != 0){
+        BOR_FREE(fifo);
+        return NULL;
+    }
+    return fifo;
+}
+
 void borFifoSemDel(bor_fifo_sem_t *fifo)
 {
     borFifoSemFree(fifo);
@@ -71,20 +96,39 @@ void borFifoSemDel(bor_fifo_sem_t *fifo)
 int borFifoSemInit(bor_fifo_sem_t *fifo, size_t el_size)
 {
     borFifoInit(&fifo->fifo, el_size);
+    fifo->spsc = 0;
     return fifoInitSem(fifo);
 }
 
 int borFifoSemInitSize(bor_fifo_sem_t *fifo, size_t el_size, size_t buf_size)
 {
     borFifoInitSize(&fifo->fifo, el_size, buf_size);
+    fifo->spsc = 0;
     return fifoInitSem(fifo);
 }
 
+int borFifoSemInitSPSC(bor_fifo_sem_t *fifo, size_t el_size,
+                       size_t buf_size)
+{
+    if (buf_size == 0)
+        buf_size = BOR_FIFO_BUF_SIZE;
+    if (buf_size < sizeof(bor_fifo_segm_t) + el_size)
+        buf_size = sizeof(bor_fifo_segm_t) + el_size;
+
+    borFifoInitSize(&fifo->fifo, el_size, buf_size);
+    fifo->spsc = 1;
+    if (fifoInitSem(fifo) != 0)
+        return -1;
+    return spscInit(fifo);
+}
+
 void borFifoSemFree(bor_fifo_sem_t *fifo)
 {
     pthread_mutex_destroy(&fifo->lock);
     sem_destroy(&fifo->full);
     sem_destroy(&fifo->empty);
+    if (fifo->spsc)
+        spscFree(fifo);
     borFifoFree(&fifo->fifo);
 }
 
@@ -93,6 +137,11 @@ int borFifoSemEmpty(bor_fifo_sem_t *fifo)
 {
     int empty;
 
+    if (fifo->spsc){
+        return __atomic_load_n(&fifo->s.popped, __ATOMIC_ACQUIRE)
+                == __atomic_load_n(&fifo->s.pushed, __ATOMIC_ACQUIRE);
+    }
+
     pthread_mutex_lock(&fifo->lock);
     empty = (fifo->fifo.front == NULL);
     pthread_mutex_unlock(&fifo->lock);
@@ -101,6 +150,11 @@ int borFifoSemEmpty(bor_fifo_sem_t *fifo)
 
 void borFifoSemPush(bor_fifo_sem_t *fifo, void *el_data)
 {
+    if (fifo->spsc){
+        spscPush(fifo, el_data);
+        return;
+    }
+
     // reserve item in queue
     sem_wait(&fifo->empty);
 
@@ -132,6 +186,9 @@ _bor_inline int popPost(bor_fifo_sem_t *fifo, void *dst)
 
 int borFifoSemPop(bor_fifo_sem_t *fifo, void *dst)
 {
+    if (fifo->spsc)
+        return spscPop(fifo, dst);
+
     // wait for available messages or exit if there is none
     if (sem_trywait(&fifo->full) != 0)
         return -1;
@@ -140,6 +197,9 @@ int borFifoSemPop(bor_fifo_sem_t *fifo, void *dst)
 
 int borFifoSemPopBlock(bor_fifo_sem_t *fifo, void *dst)
 {
+    if (fifo->spsc)
+        return spscPopBlock(fifo, -1, dst);
+
     sem_wait(&fifo->full);
     return popPost(fifo, dst);
 }
@@ -147,21 +207,181 @@ int borFifoSemPopBlock(bor_fifo_sem_t *fifo, void *dst)
 int borFifoSemPopBlockTimeout(bor_fifo_sem_t *fifo, int time_in_ms, void *dst)
 {
     struct timespec tm;
-    int sec;
-    long nsec;
-
-    sec = time_in_ms / 1000;
-    nsec = (time_in_ms % 1000L) * 1000L * 1000L;
 
-    clock_gettime(CLOCK_REALTIME, &tm);
-    tm.tv_sec += sec;
-    tm.tv_nsec += nsec;
-    if (tm.tv_nsec > 1000L * 1000L * 1000L){
-        tm.tv_nsec %= 1000L * 1000L * 1000L;
-        tm.tv_sec += 1;
-    }
+    if (fifo->spsc)
+        return spscPopBlock(fifo, time_in_ms, dst);
 
+    deadline(&tm, time_in_ms);
     if (sem_timedwait(&fifo->full, &tm) != 0)
         return -1;
     return popPost(fifo, dst);
 }
+
+
+_bor_inline void cpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+_bor_inline bor_fifo_segm_t *spscSegmNew(bor_fifo_sem_t *fifo)
+{
+    bor_fifo_segm_t *segm;
+
+    segm = __atomic_exchange_n(&fifo->s.spare, NULL, __ATOMIC_ACQUIRE);
+    if (segm == NULL)
+        segm = (bor_fifo_segm_t *)BOR_MALLOC(fifo->fifo.segm_size);
+    segm->next = NULL;
+    return segm;
+}
+
+_bor_inline void spscSegmRelease(bor_fifo_sem_t *fifo, bor_fifo_segm_t *segm)
+{
+    // keep one segment for reuse by producer
+    segm = __atomic_exchange_n(&fifo->s.spare, segm, __ATOMIC_RELEASE);
+    if (segm != NULL)
+        BOR_FREE(segm);
+}
+
+_bor_inline void spscElPtrs(bor_fifo_sem_t *fifo, bor_fifo_segm_t *segm,
+                            char **el, char **end)
+{
+    *el  = ((char *)segm) + sizeof(bor_fifo_segm_t);
+    *end = ((char *)segm) + fifo->fifo.segm_size;
+}
+
+static int spscInit(bor_fifo_sem_t *fifo)
+{
+    bor_fifo_sem_spsc_t *s = &fifo->s;
+
+    s->spare = NULL;
+    s->waiting = 0;
+    s->front = s->back = spscSegmNew(fifo);
+    spscElPtrs(fifo, s->front, &s->front_el, &s->front_end);
+    spscElPtrs(fifo, s->back, &s->back_el, &s->back_end);
+    s->popped = s->pushed = s->pushed_cache = 0;
+    s->spin = SPSC_SPIN_MIN;
+    return 0;
+}
+
+static void spscFree(bor_fifo_sem_t *fifo)
+{
+    bor_fifo_segm_t *segm, *next;
+
+    for (segm = fifo->s.front; segm; segm = next){
+        next = segm->next;
+        BOR_FREE(segm);
+    }
+    if (fifo->s.spare)
+        BOR_FREE(fifo->s.spare);
+}
+
+static void spscPush(bor_fifo_sem_t *fifo, void *el_data)
+{
+    bor_fifo_sem_spsc_t *s = &fifo->s;
+    size_t el_size = fifo->fifo.el_size;
+    bor_fifo_segm_t *segm;
+
+    if (s->back_el + el_size > s->back_end){
+        // the link is published by the release store of .pushed
+        segm = spscSegmNew(fifo);
+        s->back->next = segm;
+        s->back = segm;
+        spscElPtrs(fifo, segm, &s->back_el, &s->back_end);
+    }
+
+    memcpy(s->back_el, el_data, el_size);
+    s->back_el += el_size;
+    __atomic_store_n(&s->pushed, s->pushed + 1, __ATOMIC_RELEASE);
+
+    // wake up consumer if it sleeps
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&s->waiting, __ATOMIC_RELAXED)
+            && __atomic_exchange_n(&s->waiting, 0, __ATOMIC_SEQ_CST)){
+        sem_post(&fifo->full);
+    }
+}
+
+static int spscPop(bor_fifo_sem_t *fifo, void *dst)
+{
+    bor_fifo_sem_spsc_t *s = &fifo->s;
+    size_t el_size = fifo->fifo.el_size;
+    bor_fifo_segm_t *segm;
+
+    if (s->popped == s->pushed_cache){
+        s->pushed_cache = __atomic_load_n(&s->pushed, __ATOMIC_ACQUIRE);
+        if (s->popped == s->pushed_cache)
+            return -1;
+    }
+
+    if (s->front_el + el_size > s->front_end){
+        // the element is in the next segment which must already exist
+        segm = s->front;
+        s->front = segm->next;
+        spscElPtrs(fifo, s->front, &s->front_el, &s->front_end);
+        spscSegmRelease(fifo, segm);
+    }
+
+    memcpy(dst, s->front_el, el_size);
+    s->front_el += el_size;
+    __atomic_store_n(&s->popped, s->popped + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int spscPopBlock(bor_fifo_sem_t *fifo, int time_in_ms, void *dst)
+{
+    bor_fifo_sem_spsc_t *s = &fifo->s;
+    struct timespec tm;
+    int i, ret;
+
+    // Spin first, the limit is increased if spinning was successful and
+    // decreased if the thread had to go to sleep anyway.
+    for (i = 0; i < s->spin; ++i){
+        if (spscPop(fifo, dst) == 0){
+            s->spin = BOR_MIN(2 * s->spin, SPSC_SPIN_MAX);
+            return 0;
+        }
+        cpuRelax();
+    }
+    s->spin = BOR_MAX(s->spin / 2, SPSC_SPIN_MIN);
+
+    if (time_in_ms >= 0)
+        deadline(&tm, time_in_ms);
+
+    while (1){
+        __atomic_store_n(&s->waiting, 1, __ATOMIC_SEQ_CST);
+        if (spscPop(fifo, dst) == 0)
+            break;
+
+        if (time_in_ms >= 0){
+            ret = sem_timedwait(&fifo->full, &tm);
+        }else{
+            ret = sem_wait(&fifo->full);
+        }
+
+        if (ret != 0 && errno != EINTR){
+            // timeout
+            if (!__atomic_exchange_n(&s->waiting, 0, __ATOMIC_SEQ_CST))
+                sem_wait(&fifo->full);
+            return spscPop(fifo, dst);
+        }
+    }
+
+    // Producer has already reset the flag, so it posts (or has posted)
+    // the semaphore which must be consumed.
+    if (!__atomic_exchange_n(&s->waiting, 0, __ATOMIC_SEQ_CST))
+        sem_wait(&fifo->full);
+    return 0;
+}
+
+static void deadline(struct timespec *tm, int time_in_ms)
+{
+    clock_gettime(CLOCK_REALTIME, tm);
+    tm->tv_sec += time_in_ms / 1000;
+    tm->tv_nsec += (time_in_ms % 1000L) * 1000L * 1000L;
+    if (tm->tv_nsec >= 1000L * 1000L * 1000L){
+        tm->tv_nsec -= 1000L * 1000L * 1000L;
+        tm->tv_sec += 1;
+    }
+}
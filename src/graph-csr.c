@@ -0,0 +1,867 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include "boruvka/graph-csr.h"
+#include "boruvka/htable-oa.h"
+#include "boruvka/parallel.h"
+#include "boruvka/alloc.h"
+
+/** Arity of the heap used by Dijkstra algorithm */
+#define HEAP_ARITY 4
+
+/**
+ * Indexed d-ary min-heap of node IDs keyed by dist[].
+ */
+struct _heap_t {
+    int *node;              /*!< Heap array */
+    int size;               /*!< Number of nodes in the heap */
+    int *pos;               /*!< Position of each node in the heap */
+    const bor_real_t *dist; /*!< Keys */
+};
+typedef struct _heap_t heap_t;
+
+_bor_inline void heapUp(heap_t *h, int i)
+{
+    int node = h->node[i];
+    bor_real_t key = h->dist[node];
+    int parent;
+
+    while (i > 0){
+        parent = (i - 1) / HEAP_ARITY;
+        if (h->dist[h->node[parent]] <= key)
+            break;
+        h->node[i] = h->node[parent];
+        h->pos[h->node[i]] = i;
+        i = parent;
+    }
+    h->node[i] = node;
+    h->pos[node] = i;
+}
+
+_bor_inline void heapDown(heap_t *h, int i)
+{
+    int node = h->node[i];
+    bor_real_t key = h->dist[node];
+    int child, last, min, j;
+
+    while ((child = HEAP_ARITY * i + 1) < h->size){
+        last = BOR_MIN(child + HEAP_ARITY, h->size);
+        min = child;
+        for (j = child + 1; j < last; ++j){
+            if (h->dist[h->node[j]] < h->dist[h->node[min]])
+                min = j;
+        }
+        if (key <= h->dist[h->node[min]])
+            break;
+        h->node[i] = h->node[min];
+        h->pos[h->node[i]] = i;
+        i = min;
+    }
+    h->node[i] = node;
+    h->pos[node] = i;
+}
+
+_bor_inline void heapPush(heap_t *h, int node)
+{
+    h->node[h->size++] = node;
+    heapUp(h, h->size - 1);
+}
+
+_bor_inline int heapPop(heap_t *h)
+{
+    int node = h->node[0];
+
+    h->pos[node] = -1;
+    if (--h->size > 0){
+        h->node[0] = h->node[h->size];
+        heapDown(h, 0);
+    }
+    return node;
+}
+
+static int cmpInt(const void *a, const void *b)
+{
+    return (*(int *)a) - (*(int *)b);
+}
+
+static bor_graph_csr_t *graphNew(int node_size, int64_t edge_size,
+                                 int weighted)
+{
+    bor_graph_csr_t *g;
+
+    g = BOR_ALLOC(bor_graph_csr_t);
+    g->node_size = node_size;
+    g->edge_size = edge_size;
+    g->beg = BOR_CALLOC_ARR(int64_t, node_size + 1);
+    g->dst = BOR_ALLOC_ARR(int, BOR_MAX(edge_size, 1));
+    g->weight = NULL;
+    if (weighted)
+        g->weight = BOR_ALLOC_ARR(bor_real_t, BOR_MAX(edge_size, 1));
+    return g;
+}
+
+/** Fills g->beg from the source nodes of the edges and returns the
+ *  array of the next free edge slot for each node */
+static int64_t *graphCount(bor_graph_csr_t *g, int64_t edge_size,
+                           const int *src)
+{
+    int64_t *fill, i;
+
+    for (i = 0; i < edge_size; ++i)
+        ++g->beg[src[i] + 1];
+    for (i = 0; i < g->node_size; ++i)
+        g->beg[i + 1] += g->beg[i];
+
+    fill = BOR_ALLOC_ARR(int64_t, g->node_size + 1);
+    memcpy(fill, g->beg, sizeof(int64_t) * (g->node_size + 1));
+    return fill;
+}
+
+bor_graph_csr_t *borGraphCSRNew(int node_size, int64_t edge_size,
+                                const int *src, const int *dst,
+                                const bor_real_t *weight)
+{
+    bor_graph_csr_t *g;
+    int64_t *fill, i, e;
+
+    g = graphNew(node_size, edge_size, weight != NULL);
+
+    // counting sort of the edges by their source node
+    fill = graphCount(g, edge_size, src);
+    for (i = 0; i < edge_size; ++i){
+        e = fill[src[i]]++;
+        g->dst[e] = dst[i];
+        if (weight)
+            g->weight[e] = weight[i];
+    }
+    BOR_FREE(fill);
+
+    return g;
+}
+
+bor_graph_csr_t *borGraphCSRNewNet(bor_net_t *net, int directed,
+                                   bor_graph_csr_net_weight_fn weight_fn,
+                                   void *userdata,
+                                   bor_net_node_t **nodes)
+{
+    bor_graph_csr_t *g;
+    bor_htable_oa_t *ids;
+    bor_list_t *item;
+    bor_net_node_t *n;
+    bor_net_edge_t *e;
+    int *src, *dst, id, i, j;
+    int64_t *fill, edge_size, k, l;
+    bor_real_t *weight;
+    size_t size;
+
+    // assign IDs to the nodes
+    ids = borHTableOANew(sizeof(bor_net_node_t *), sizeof(int),
+                         NULL, NULL, NULL);
+    borHTableOAReserve(ids, borNetNodesLen(net));
+    id = 0;
+    BOR_LIST_FOR_EACH(borNetNodes(net), item){
+        n = BOR_LIST_ENTRY(item, bor_net_node_t, list);
+        borHTableOAInsert(ids, &n, &id);
+        if (nodes)
+            nodes[id] = n;
+        ++id;
+    }
+
+    // collect edges
+    size = borNetEdgesLen(net) * (directed ? 1 : 2);
+    src = BOR_ALLOC_ARR(int, BOR_MAX(size, 1));
+    dst = BOR_ALLOC_ARR(int, BOR_MAX(size, 1));
+    weight = BOR_ALLOC_ARR(bor_real_t, BOR_MAX(size, 1));
+    edge_size = 0;
+    BOR_LIST_FOR_EACH(borNetEdges(net), item){
+        e = BOR_LIST_ENTRY(item, bor_net_edge_t, list);
+        i = *(int *)borHTableOAFind(ids, &e->n[0]);
+        j = *(int *)borHTableOAFind(ids, &e->n[1]);
+
+        src[edge_size] = i;
+        dst[edge_size] = j;
+        weight[edge_size] = BOR_ONE;
+        if (weight_fn)
+            weight[edge_size] = weight_fn(e, userdata);
+        ++edge_size;
+
+        if (!directed){
+            src[edge_size] = j;
+            dst[edge_size] = i;
+            weight[edge_size] = weight[edge_size - 1];
+            ++edge_size;
+        }
+    }
+
+    g = graphNew(id, edge_size, weight_fn != NULL);
+    fill = graphCount(g, edge_size, src);
+    for (k = 0; k < edge_size; ++k){
+        l = fill[src[k]]++;
+        g->dst[l] = dst[k];
+        if (g->weight)
+            g->weight[l] = weight[k];
+    }
+
+    BOR_FREE(fill);
+    BOR_FREE(src);
+    BOR_FREE(dst);
+    BOR_FREE(weight);
+    borHTableOADel(ids);
+
+    return g;
+}
+
+bor_graph_csr_t *borGraphCSRTranspose(const bor_graph_csr_t *g)
+{
+    bor_graph_csr_t *gt;
+    int64_t *fill, e, f;
+    int v;
+
+    gt = graphNew(g->node_size, g->edge_size, g->weight != NULL);
+    fill = graphCount(gt, g->edge_size, g->dst);
+    for (v = 0; v < g->node_size; ++v){
+        for (e = g->beg[v]; e < g->beg[v + 1]; ++e){
+            f = fill[g->dst[e]]++;
+            gt->dst[f] = v;
+            if (g->weight)
+                gt->weight[f] = g->weight[e];
+        }
+    }
+    BOR_FREE(fill);
+
+    return gt;
+}
+
+void borGraphCSRDel(bor_graph_csr_t *g)
+{
+    BOR_FREE(g->beg);
+    BOR_FREE(g->dst);
+    if (g->weight)
+        BOR_FREE(g->weight);
+    BOR_FREE(g);
+}
+
+int borGraphCSRDij(const bor_graph_csr_t *g, int start, int end,
+                   bor_real_t *dist, int *prev)
+{
+    heap_t heap;
+    bor_real_t d;
+    int node, to, i, ret;
+    int64_t e;
+
+    for (i = 0; i < g->node_size; ++i)
+        dist[i] = BOR_REAL_MAX;
+    if (prev){
+        for (i = 0; i < g->node_size; ++i)
+            prev[i] = -1;
+    }
+
+    // pos[] is -2 for nodes never pushed to the heap and -1 for closed
+    // nodes
+    heap.node = BOR_ALLOC_ARR(int, g->node_size);
+    heap.pos = BOR_ALLOC_ARR(int, g->node_size);
+    heap.size = 0;
+    heap.dist = dist;
+    for (i = 0; i < g->node_size; ++i)
+        heap.pos[i] = -2;
+
+    dist[start] = BOR_ZERO;
+    heapPush(&heap, start);
+
+    ret = (end < 0 ? 0 : -1);
+    while (heap.size > 0){
+        node = heapPop(&heap);
+        if (node == end){
+            ret = 0;
+            break;
+        }
+
+        for (e = g->beg[node]; e < g->beg[node + 1]; ++e){
+            to = g->dst[e];
+            if (heap.pos[to] == -1)
+                continue;
+
+            d = dist[node] + (g->weight ? g->weight[e] : BOR_ONE);
+            if (d < dist[to]){
+                dist[to] = d;
+                if (prev)
+                    prev[to] = node;
+
+                if (heap.pos[to] == -2){
+                    heapPush(&heap, to);
+                }else{
+                    heapUp(&heap, heap.pos[to]);
+                }
+            }
+        }
+    }
+
+    BOR_FREE(heap.node);
+    BOR_FREE(heap.pos);
+
+    return ret;
+}
+
+/** Called for each found component with its (unsorted) nodes */
+typedef void (*tarjan_comp_fn)(int *node, int size, void *userdata);
+
+/**
+ * Non-recursive Tarjan's algorithm.
+ */
+struct _tarjan_t {
+    const bor_graph_csr_t *g;
+    const int *color; /*!< If non-NULL, only the nodes with color[v] == col
+                           are searched */
+    int col;
+    int *index;       /*!< Per-node DFS index (-1 if not visited) */
+    int *lowlink;     /*!< Per-node lowlink */
+    int64_t *it;      /*!< Per-node next edge to be explored */
+    char *in_stack;   /*!< Per-node flag of presence in the stack */
+    int *stack;       /*!< Stack of nodes of unfinished components */
+    int stack_size;
+    int *dfs;         /*!< Explicit DFS stack replacing recursion */
+    int cur_index;
+    tarjan_comp_fn comp_fn;
+    void *userdata;
+};
+typedef struct _tarjan_t tarjan_t;
+
+_bor_inline void tarjanPush(tarjan_t *t, int node, int *dfs_size)
+{
+    t->index[node] = t->lowlink[node] = t->cur_index++;
+    t->stack[t->stack_size++] = node;
+    t->in_stack[node] = 1;
+    t->it[node] = t->g->beg[node];
+    t->dfs[(*dfs_size)++] = node;
+}
+
+static void tarjanStrongconnect(tarjan_t *t, int root)
+{
+    const bor_graph_csr_t *g = t->g;
+    int node, w, dfs_size, i;
+
+    dfs_size = 0;
+    tarjanPush(t, root, &dfs_size);
+    while (dfs_size > 0){
+        node = t->dfs[dfs_size - 1];
+
+        if (t->it[node] < g->beg[node + 1]){
+            w = g->dst[t->it[node]++];
+            if (t->color && t->color[w] != t->col)
+                continue;
+
+            if (t->index[w] == -1){
+                tarjanPush(t, w, &dfs_size);
+            }else if (t->in_stack[w]){
+                t->lowlink[node] = BOR_MIN(t->lowlink[node], t->lowlink[w]);
+            }
+            continue;
+        }
+
+        // all edges explored -- return from the node
+        --dfs_size;
+        if (dfs_size > 0){
+            w = t->dfs[dfs_size - 1];
+            t->lowlink[w] = BOR_MIN(t->lowlink[w], t->lowlink[node]);
+        }
+
+        if (t->index[node] != t->lowlink[node])
+            continue;
+
+        // Find how deep unroll stack
+        for (i = t->stack_size - 1; t->stack[i] != node; --i)
+            t->in_stack[t->stack[i]] = 0;
+        t->in_stack[t->stack[i]] = 0;
+
+        t->comp_fn(t->stack + i, t->stack_size - i, t->userdata);
+
+        // Shrink stack
+        t->stack_size = i;
+    }
+}
+
+/** Runs the search from all not yet visited {roots} (or from all nodes if
+ *  {roots} is NULL) */
+static void tarjanRun(tarjan_t *t, const int *roots, int roots_size)
+{
+    int i, root;
+
+    for (i = 0; i < roots_size; ++i){
+        root = (roots ? roots[i] : i);
+        if (t->index[root] == -1)
+            tarjanStrongconnect(t, root);
+    }
+}
+
+/** Appends the component to bor_scc_t */
+static void sccAdd(int *node, int size, void *_scc)
+{
+    bor_scc_t *scc = _scc;
+    bor_scc_comp_t *comp;
+
+    ++scc->comp_size;
+    scc->comp = BOR_REALLOC_ARR(scc->comp, bor_scc_comp_t, scc->comp_size);
+    comp = scc->comp + scc->comp_size - 1;
+    comp->node_size = size;
+    comp->node = BOR_ALLOC_ARR(int, size);
+    memcpy(comp->node, node, sizeof(int) * size);
+    if (size > 1)
+        qsort(comp->node, size, sizeof(int), cmpInt);
+}
+
+
+/** Subsets smaller than this are processed by sequential Tarjan's
+ *  algorithm */
+#define SCC_PAR_MIN_SIZE 4096
+/** If forward-backward search finds a component smaller than
+ *  1/SCC_PAR_MIN_RATIO of the subset, the resulting subsets are processed
+ *  by Tarjan's algorithm because further splitting would peel off only
+ *  small components at the cost of scanning the whole subset each time */
+#define SCC_PAR_MIN_RATIO 16
+/** Grain of parallel loops over nodes */
+#define SCC_PAR_GRAIN 1024
+
+/**
+ * Subset of nodes of the same color, i.e., the set of nodes that may
+ * contain whole components.
+ */
+struct _scc_item_t {
+    int color;
+    int size;
+    int *node;
+    int seq;   /*!< True if the subset is processed by Tarjan's algorithm */
+};
+typedef struct _scc_item_t scc_item_t;
+
+/** Growing per-thread buffer of nodes */
+struct _scc_buf_t {
+    int *node;
+    int size;
+    int alloc;
+};
+typedef struct _scc_buf_t scc_buf_t;
+
+struct _scc_par_t {
+    const bor_graph_csr_t *g;
+    bor_graph_csr_t *gt;  /*!< Transposed graph */
+    bor_task_pool_t *tp;
+    int *color;           /*!< Color of the subset the node belongs to or
+                               -1 if its component is already known */
+    int color_size;       /*!< Number of used colors */
+    int *comp;            /*!< ID of the component of each node */
+    int comp_size;        /*!< Number of found components */
+
+    int *index;           /*!< Tarjan's algorithm per-node data */
+    int *lowlink;
+    int64_t *it;
+    char *in_stack;
+
+    scc_item_t *items;    /*!< Subsets processed by sccParSmall() */
+
+    char *mark[2];        /*!< Nodes reached by forward/backward search */
+    const bor_graph_csr_t *bfs_g; /*!< Graph searched by BFS */
+    char *bfs_mark;
+    int bfs_color;
+    int *frontier;        /*!< Current BFS frontier */
+    int frontier_size;
+    scc_buf_t *buf;       /*!< Per-thread next frontier */
+    int buf_size;
+};
+typedef struct _scc_par_t scc_par_t;
+
+static void sccParInit(scc_par_t *par, const bor_graph_csr_t *g,
+                       bor_task_pool_t *tp)
+{
+    int n = g->node_size;
+
+    bzero(par, sizeof(*par));
+    par->g = g;
+    par->gt = borGraphCSRTranspose(g);
+    par->tp = tp;
+    par->color = BOR_ALLOC_ARR(int, n);
+    par->comp = BOR_ALLOC_ARR(int, n);
+    par->index = BOR_ALLOC_ARR(int, n);
+    par->lowlink = BOR_ALLOC_ARR(int, n);
+    par->it = BOR_ALLOC_ARR(int64_t, n);
+    par->in_stack = BOR_CALLOC_ARR(char, n);
+    par->mark[0] = BOR_CALLOC_ARR(char, n);
+    par->mark[1] = BOR_CALLOC_ARR(char, n);
+    par->frontier = BOR_ALLOC_ARR(int, n);
+    memset(par->index, 0xff, sizeof(int) * n);
+
+    par->buf_size = (tp ? borTaskPoolSize(tp) : 1);
+    par->buf = BOR_CALLOC_ARR(scc_buf_t, par->buf_size);
+}
+
+static void sccParFree(scc_par_t *par)
+{
+    int i;
+
+    borGraphCSRDel(par->gt);
+    BOR_FREE(par->color);
+    BOR_FREE(par->comp);
+    BOR_FREE(par->index);
+    BOR_FREE(par->lowlink);
+    BOR_FREE(par->it);
+    BOR_FREE(par->in_stack);
+    BOR_FREE(par->mark[0]);
+    BOR_FREE(par->mark[1]);
+    BOR_FREE(par->frontier);
+    for (i = 0; i < par->buf_size; ++i){
+        if (par->buf[i].node)
+            BOR_FREE(par->buf[i].node);
+    }
+    BOR_FREE(par->buf);
+}
+
+/** Returns true if the node has an edge to other node */
+_bor_inline int hasOtherNeighbor(const bor_graph_csr_t *g, int node)
+{
+    int64_t e;
+
+    for (e = g->beg[node]; e < g->beg[node + 1]; ++e){
+        if (g->dst[e] != node)
+            return 1;
+    }
+    return 0;
+}
+
+static void sccParTrim(size_t from, size_t to, void *data,
+                       const bor_task_pool_thinfo_t *thinfo)
+{
+    scc_par_t *par = data;
+    size_t v;
+
+    for (v = from; v < to; ++v){
+        if (hasOtherNeighbor(par->g, v) && hasOtherNeighbor(par->gt, v)){
+            par->color[v] = 0;
+        }else{
+            par->color[v] = -1;
+            par->comp[v] = __atomic_fetch_add(&par->comp_size, 1,
+                                              __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/** Returns the nodes that survived trimming as one subset */
+static scc_item_t *sccParRest(scc_par_t *par, int *size)
+{
+    scc_item_t *item;
+    int v, n;
+
+    par->color_size = 1;
+
+    for (n = 0, v = 0; v < par->g->node_size; ++v)
+        n += (par->color[v] == 0);
+    *size = 0;
+    if (n == 0)
+        return NULL;
+
+    item = BOR_ALLOC(scc_item_t);
+    item->color = 0;
+    item->size = 0;
+    item->node = BOR_ALLOC_ARR(int, n);
+    item->seq = 0;
+    for (v = 0; v < par->g->node_size; ++v){
+        if (par->color[v] == 0)
+            item->node[item->size++] = v;
+    }
+    *size = 1;
+    return item;
+}
+
+static void sccParComp(int *node, int size, void *data)
+{
+    scc_par_t *par = data;
+    int id, i;
+
+    id = __atomic_fetch_add(&par->comp_size, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < size; ++i)
+        par->comp[node[i]] = id;
+}
+
+static void sccParSmall(size_t from, size_t to, void *data,
+                        const bor_task_pool_thinfo_t *thinfo)
+{
+    scc_par_t *par = data;
+    scc_item_t *item;
+    tarjan_t t;
+    size_t i;
+
+    for (i = from; i < to; ++i){
+        item = par->items + i;
+        if (!item->seq)
+            continue;
+
+        t.g = par->g;
+        t.color = par->color;
+        t.col = item->color;
+        t.index = par->index;
+        t.lowlink = par->lowlink;
+        t.it = par->it;
+        t.in_stack = par->in_stack;
+        t.stack = BOR_ALLOC_ARR(int, 2 * item->size);
+        t.stack_size = 0;
+        t.dfs = t.stack + item->size;
+        t.cur_index = 0;
+        t.comp_fn = sccParComp;
+        t.userdata = par;
+        tarjanRun(&t, item->node, item->size);
+
+        BOR_FREE(t.stack);
+        BOR_FREE(item->node);
+    }
+}
+
+static void sccParBFSStep(size_t from, size_t to, void *data,
+                          const bor_task_pool_thinfo_t *thinfo)
+{
+    scc_par_t *par = data;
+    const bor_graph_csr_t *g = par->bfs_g;
+    scc_buf_t *buf = par->buf + thinfo->id;
+    int64_t e;
+    size_t i;
+    int v, w;
+
+    for (i = from; i < to; ++i){
+        v = par->frontier[i];
+        for (e = g->beg[v]; e < g->beg[v + 1]; ++e){
+            w = g->dst[e];
+            if (par->color[w] != par->bfs_color)
+                continue;
+            if (__atomic_load_n(par->bfs_mark + w, __ATOMIC_RELAXED))
+                continue;
+            if (__atomic_exchange_n(par->bfs_mark + w, 1, __ATOMIC_RELAXED))
+                continue;
+
+            if (buf->size == buf->alloc){
+                buf->alloc = BOR_MAX(2 * buf->alloc, 1024);
+                buf->node = BOR_REALLOC_ARR(buf->node, int, buf->alloc);
+            }
+            buf->node[buf->size++] = w;
+        }
+    }
+}
+
+/** Marks all nodes of the color reachable from {start} in {g} */
+static void sccParBFS(scc_par_t *par, const bor_graph_csr_t *g,
+                      char *mark, int color, int start)
+{
+    int i;
+
+    par->bfs_g = g;
+    par->bfs_mark = mark;
+    par->bfs_color = color;
+
+    mark[start] = 1;
+    par->frontier[0] = start;
+    par->frontier_size = 1;
+    while (par->frontier_size > 0){
+        for (i = 0; i < par->buf_size; ++i)
+            par->buf[i].size = 0;
+        borParallelFor(par->tp, 0, par->frontier_size, SCC_PAR_GRAIN,
+                       sccParBFSStep, par);
+
+        par->frontier_size = 0;
+        for (i = 0; i < par->buf_size; ++i){
+            memcpy(par->frontier + par->frontier_size, par->buf[i].node,
+                   sizeof(int) * par->buf[i].size);
+            par->frontier_size += par->buf[i].size;
+        }
+    }
+}
+
+static void sccParAddItem(scc_item_t **items, int *items_size,
+                          int color, int size, int seq)
+{
+    scc_item_t *item;
+
+    *items = BOR_REALLOC_ARR(*items, scc_item_t, *items_size + 1);
+    item = *items + (*items_size)++;
+    item->color = color;
+    item->size = 0;
+    item->node = BOR_ALLOC_ARR(int, size);
+    item->seq = (seq || size < SCC_PAR_MIN_SIZE);
+}
+
+/**
+ * Splits the subset by forward and backward search from a pivot: the
+ * intersection of the reached sets is the component of the pivot, the
+ * nodes reached only forward, only backward and not reached at all form
+ * three new subsets that are appended to {next}.
+ */
+static void sccParFWBW(scc_par_t *par, scc_item_t *item,
+                       scc_item_t **next, int *next_size)
+{
+    scc_item_t *item2;
+    int sub[3], size[3], color[3], start, id, f, b, c, i, v, seq;
+
+    start = item->node[item->size / 2];
+    sccParBFS(par, par->g, par->mark[0], item->color, start);
+    sccParBFS(par, par->gt, par->mark[1], item->color, start);
+
+    size[0] = size[1] = size[2] = 0;
+    for (i = 0; i < item->size; ++i){
+        v = item->node[i];
+        f = par->mark[0][v];
+        b = par->mark[1][v];
+        if (!f || !b)
+            ++size[f ? 0 : (b ? 1 : 2)];
+    }
+
+    seq = (item->size - size[0] - size[1] - size[2]
+                < item->size / SCC_PAR_MIN_RATIO);
+
+    // the rest can keep the color of the split subset
+    color[0] = par->color_size++;
+    color[1] = par->color_size++;
+    color[2] = item->color;
+    for (c = 0; c < 3; ++c){
+        sub[c] = -1;
+        if (size[c] > 0){
+            sccParAddItem(next, next_size, color[c], size[c], seq);
+            sub[c] = *next_size - 1;
+        }
+    }
+
+    id = par->comp_size++;
+    for (i = 0; i < item->size; ++i){
+        v = item->node[i];
+        f = par->mark[0][v];
+        b = par->mark[1][v];
+        par->mark[0][v] = par->mark[1][v] = 0;
+
+        if (f && b){
+            par->color[v] = -1;
+            par->comp[v] = id;
+        }else{
+            c = (f ? 0 : (b ? 1 : 2));
+            par->color[v] = color[c];
+            item2 = *next + sub[c];
+            item2->node[item2->size++] = v;
+        }
+    }
+
+    BOR_FREE(item->node);
+}
+
+/** Fills bor_scc_t with components ordered by their smallest node */
+static void sccParOutput(scc_par_t *par, bor_scc_t *scc)
+{
+    int *remap, v, c;
+
+    remap = BOR_ALLOC_ARR(int, par->comp_size);
+    memset(remap, 0xff, sizeof(int) * par->comp_size);
+    scc->comp = BOR_CALLOC_ARR(bor_scc_comp_t, par->comp_size);
+    scc->comp_size = 0;
+    for (v = 0; v < par->g->node_size; ++v){
+        c = par->comp[v];
+        if (remap[c] == -1)
+            remap[c] = scc->comp_size++;
+        ++scc->comp[remap[c]].node_size;
+    }
+
+    for (c = 0; c < scc->comp_size; ++c){
+        scc->comp[c].node = BOR_ALLOC_ARR(int, scc->comp[c].node_size);
+        scc->comp[c].node_size = 0;
+    }
+    for (v = 0; v < par->g->node_size; ++v){
+        c = remap[par->comp[v]];
+        scc->comp[c].node[scc->comp[c].node_size++] = v;
+    }
+
+    BOR_FREE(remap);
+}
+
+void borGraphCSRSCC(const bor_graph_csr_t *g, bor_scc_t *scc)
+{
+    tarjan_t t;
+    int n = g->node_size;
+
+    borSCCInit(scc, n, NULL, NULL, NULL);
+
+    t.g = g;
+    t.color = NULL;
+    t.col = 0;
+    t.index = BOR_ALLOC_ARR(int, 4 * (size_t)n);
+    t.lowlink = t.index + n;
+    t.stack = t.lowlink + n;
+    t.dfs = t.stack + n;
+    t.it = BOR_ALLOC_ARR(int64_t, n);
+    t.in_stack = BOR_CALLOC_ARR(char, n);
+    t.stack_size = 0;
+    t.cur_index = 0;
+    t.comp_fn = sccAdd;
+    t.userdata = scc;
+    memset(t.index, 0xff, sizeof(int) * n);
+
+    tarjanRun(&t, NULL, n);
+
+    BOR_FREE(t.index);
+    BOR_FREE(t.it);
+    BOR_FREE(t.in_stack);
+}
+
+void borGraphCSRSCCPar(const bor_graph_csr_t *g, bor_scc_t *scc,
+                       bor_task_pool_t *tp)
+{
+    scc_par_t par;
+    scc_item_t *items, *next, *large;
+    int items_size, next_size, large_size, i;
+
+    borSCCInit(scc, g->node_size, NULL, NULL, NULL);
+    if (g->node_size == 0)
+        return;
+
+    sccParInit(&par, g, tp);
+
+    // Nodes without any predecessor or successor form singleton
+    // components; the rest starts as one subset
+    borParallelFor(tp, 0, g->node_size, SCC_PAR_GRAIN, sccParTrim, &par);
+    items = sccParRest(&par, &items_size);
+
+    while (items_size > 0){
+        // Small subsets (and subsets without big components) are
+        // finished by sequential Tarjan's algorithm, many of them in
+        // parallel
+        large = BOR_ALLOC_ARR(scc_item_t, items_size);
+        large_size = 0;
+        for (i = 0; i < items_size; ++i){
+            if (!items[i].seq)
+                large[large_size++] = items[i];
+        }
+        par.items = items;
+        borParallelFor(tp, 0, items_size, 1, sccParSmall, &par);
+        BOR_FREE(items);
+
+        // Large subsets are split by forward-backward search with
+        // parallel BFS
+        next = NULL;
+        next_size = 0;
+        for (i = 0; i < large_size; ++i)
+            sccParFWBW(&par, large + i, &next, &next_size);
+        BOR_FREE(large);
+
+        items = next;
+        items_size = next_size;
+    }
+    if (items)
+        BOR_FREE(items);
+
+    sccParOutput(&par, scc);
+    sccParFree(&par);
+}
@@ -14,12 +14,14 @@
  *  See the License for more information.
  */
 
+#include <stdio.h>
 #include <boruvka/gug.h>
 #include <boruvka/alloc.h>
 #include <boruvka/vec.h>
 #include <boruvka/vec3.h>
 #include <boruvka/dbg.h>
 #include <boruvka/nn.h>
+#include <boruvka/parallel.h>
 
 
 struct _bor_gug_cache_t {
@@ -30,20 +32,58 @@ struct _bor_gug_cache_t {
 
     const bor_vec_t *p;
 
+    int own_dist;           /*!< True if .dist was allocated by cache */
     bor_real_t __dist[4];   /*!< Preallocated array on stack for .dist[] to
                                  avoid allocation on heap */
 };
 typedef struct _bor_gug_cache_t bor_gug_cache_t;
 
+/** Shared state of one batch query, see borGUGNearestBatch() */
+struct _bor_gug_batch_t {
+    const bor_gug_t *gug;
+    const bor_vec_t **ps;
+    size_t len;
+    size_t num;
+    bor_gug_el_t **els;
+    size_t *found;
+    size_t *scratch; /*!< 2 * .gug->d scratch positions for each thread */
+    bor_real_t *dist; /*!< .num scratch distances for each thread */
+};
+typedef struct _bor_gug_batch_t bor_gug_batch_t;
+
+/** Minimal number of queries processed by one chunk of batch query */
+#define BATCH_GRAIN 16
+
+/** Maximal number of distances computed at once by SIMD kernels */
+#define NEAREST_BLOCK 16
+/** Minimal number of elements worth of calling a SIMD kernel */
+#define NEAREST_BLOCK_MIN 4
+
 static void cellInit(bor_gug_t *cs, bor_gug_cell_t *c, size_t id);
 
 static void cellsAlloc(bor_gug_t *cs, size_t num_cells);
 
-/** Creates and destroys cache */
+/** Frees packed cells */
+static void packedDel(bor_gug_packed_t *packed, size_t len);
+/** Builds packed cells from the lists of elements in .cells */
+static void packedBuild(bor_gug_t *cs);
+/** Ensures packed cell has room for at least {len} elements */
+static void packedReserve(const bor_gug_t *cs, bor_gug_packed_t *pc,
+                          size_t len);
+/** Returns index of given element in packed cell, exits if the element
+ *  is not there */
+static size_t packedFind(const bor_gug_packed_t *pc, const bor_gug_el_t *el);
+/** Copies coordinates of element into {i}'th position of packed cell */
+_bor_inline void packedSet(const bor_gug_t *cs, bor_gug_packed_t *pc,
+                           size_t i, bor_gug_el_t *el);
+
+/** Creates and destroys cache, {dist} is an optional buffer of {max_len}
+ *  distances used instead of allocating a new one */
 static void cacheInit(bor_gug_cache_t *cache,
                       bor_gug_el_t **els,
                       size_t max_len,
-                      const bor_vec_t *p);
+                      const bor_vec_t *p,
+                      bor_real_t *dist);
 static void cacheDestroy(bor_gug_cache_t *cache);
 
 
@@ -58,13 +98,41 @@ static int nearestInRadius2(const bor_gug_t *cs, bor_gug_cache_t *cache,
 /** Searches only specified cube */
 static void nearestInCell(const bor_gug_t *cs, bor_gug_cache_t *cache,
                           bor_gug_cell_t *c);
+/** Checks block of elements at once */
+static void nearestCheckBlock(const bor_gug_t *cs, bor_gug_cache_t *cache,
+                              bor_gug_el_t **els, const bor_vec_t **ps,
+                              size_t len);
+/** Searches packed copy of the cube */
+static void nearestInPacked(const bor_gug_t *cs, bor_gug_cache_t *cache,
+                            const bor_gug_packed_t *pc);
 /** Checks if given element isn't closer than the ones already stored in
  *  cache. */
 static void nearestCheck(const bor_gug_t *cs, bor_gug_cache_t *cache,
                          bor_gug_el_t *el);
+/** Same as nearestCheck() but with already computed distance */
+_bor_inline void nearestCheckDist(bor_gug_cache_t *cache,
+                                  bor_gug_el_t *el, bor_real_t dist);
 /** Bubble sort. Takes the last element in .els and bubble it towards
  *  smaller ones (according to .dist[] value). */
 static void nearestBubbleUp(bor_gug_cache_t *c);
+/** Runs a range of batch queries, {center} and {pos} are scratch buffers
+ *  of size .d and {dist} is a scratch buffer of .num distances */
+static void nearestBatchRange(const bor_gug_batch_t *b,
+                              size_t from, size_t to,
+                              size_t *center, size_t *pos,
+                              bor_real_t *dist);
+/** borParallelFor() callback running chunk of batch queries */
+static void nearestBatchFor(size_t from, size_t to, void *data,
+                            const bor_task_pool_thinfo_t *thinfo);
+/** Reports all elements of {c}'th cell within radius */
+static size_t rangeInCell(const bor_gug_t *cs, const bor_vec_t *p,
+                          bor_real_t radius2, size_t c,
+                          bor_gug_range_fn cb, void *data);
+/** Returns squared distance between {c} (shifted point) and cell {pos},
+ *  border cells are considered to be unbounded */
+_bor_inline bor_real_t rangeCellDist2(const bor_gug_t *cs,
+                                      const bor_real_t *c,
+                                      const size_t *pos);
 /** Returns distance of initial border. */
 _bor_inline bor_real_t initBorder(const bor_gug_t *cs, const bor_vec_t *p);
 
@@ -87,6 +155,7 @@ void borGUGParamsInit(bor_gug_params_t *p)
     p->expand_rate = BOR_REAL(2.);
     p->aabb        = NULL;
     p->approx      = 0;
+    p->packed      = 0;
 }
 
 
@@ -99,6 +168,7 @@ bor_gug_t *borGUGNew(const bor_gug_params_t *params)
     c->type = BOR_NN_GUG;
 
     c->num_els = 0;
+    c->packed  = NULL;
 
     c->d = params->dim;
     if (params->num_cells > 0){
@@ -130,6 +200,9 @@ bor_gug_t *borGUGNew(const bor_gug_params_t *params)
 
     c->approx = params->approx;
 
+    if (params->packed)
+        packedBuild(c);
+
     return c;
 }
 
@@ -146,16 +219,22 @@ void borGUGDel(bor_gug_t *c)
         BOR_FREE(c->cells);
     }
 
+    if (c->packed)
+        packedDel(c->packed, c->cells_len);
+
     BOR_FREE(c);
 }
 
 
+/** Finds nearest elements using {center} and {pos} as scratch buffers of
+ *  .d length and optional {dist} as scratch buffer of {num} distances */
 static size_t __borGUGNearest(const bor_gug_t *cs, const bor_vec_t *p,
                                   size_t num, bor_gug_el_t **els,
-                                  int approx)
+                                  int approx,
+                                  size_t *center, size_t *pos,
+                                  bor_real_t *dist)
 {
     size_t center_id, retlen;
-    size_t *center, *pos;
     bor_gug_cell_t *cell;
     bor_gug_cache_t cache;
     int radius;
@@ -164,10 +243,7 @@ static size_t __borGUGNearest(const bor_gug_t *cs, const bor_vec_t *p,
     if (borGUGSize(cs) == 0)
         return 0;
 
-    center = BOR_ALLOC_ARR(size_t, cs->d);
-    pos    = BOR_ALLOC_ARR(size_t, cs->d);
-
-    cacheInit(&cache, els, num, p);
+    cacheInit(&cache, els, num, p, dist);
 
     center_id = __borGUGCoordsToID(cs, p);
     __borGUGIDToPos(cs, center_id, center);
@@ -207,29 +283,136 @@ static size_t __borGUGNearest(const bor_gug_t *cs, const bor_vec_t *p,
 
     retlen = cache.len;
 
-    BOR_FREE(center);
-    BOR_FREE(pos);
-
     cacheDestroy(&cache);
 
     return retlen;
 }
 
+static size_t _borGUGNearest(const bor_gug_t *cs, const bor_vec_t *p,
+                             size_t num, bor_gug_el_t **els, int approx)
+{
+    size_t *center, *pos;
+    size_t retlen;
+
+    center = BOR_ALLOC_ARR(size_t, 2 * cs->d);
+    pos    = center + cs->d;
+
+    retlen = __borGUGNearest(cs, p, num, els, approx, center, pos, NULL);
+
+    BOR_FREE(center);
+
+    return retlen;
+}
+
 size_t borGUGNearest(const bor_gug_t *cs, const bor_vec_t *p, size_t num,
                          bor_gug_el_t **els)
 {
-    return __borGUGNearest(cs, p, num, els, cs->approx);
+    return _borGUGNearest(cs, p, num, els, cs->approx);
 }
 
 size_t borGUGNearestApprox(const bor_gug_t *cs, const bor_vec_t *p,
                                size_t num, bor_gug_el_t **els)
 {
-    return __borGUGNearest(cs, p, num, els, 1);
+    return _borGUGNearest(cs, p, num, els, 1);
+}
+
+void borGUGNearestBatch(const bor_gug_t *cs,
+                        const bor_vec_t **ps, size_t len, size_t num,
+                        bor_gug_el_t **els, size_t *found,
+                        bor_task_pool_t *tp)
+{
+    bor_gug_batch_t b;
+    size_t threads;
+
+    if (len == 0 || num == 0)
+        return;
+
+    b.gug   = cs;
+    b.ps    = ps;
+    b.len   = len;
+    b.num   = num;
+    b.els   = els;
+    b.found = found;
+
+    // scratch buffers are indexed by id of the thread running the chunk
+    threads   = (tp ? borTaskPoolSize(tp) : 1);
+    b.scratch = BOR_ALLOC_ARR(size_t, 2 * cs->d * threads);
+    b.dist    = BOR_ALLOC_ARR(bor_real_t, num * threads);
+
+    borParallelFor(tp, 0, len, BATCH_GRAIN, nearestBatchFor, (void *)&b);
+
+    BOR_FREE(b.dist);
+    BOR_FREE(b.scratch);
+}
+
+size_t borGUGRange(const bor_gug_t *cs, const bor_vec_t *p,
+                   bor_real_t radius, bor_gug_range_fn cb, void *data)
+{
+    size_t *lo, *hi, *pos;
+    bor_real_t *c, f, radius2;
+    size_t i, found;
+
+    if (radius < BOR_ZERO || cs->num_els == 0)
+        return 0;
+
+    lo  = BOR_ALLOC_ARR(size_t, 3 * cs->d);
+    hi  = lo + cs->d;
+    pos = hi + cs->d;
+    c   = BOR_ALLOC_ARR(bor_real_t, cs->d);
+
+    // box of cells overlapping the ball
+    for (i = 0; i < cs->d; i++){
+        c[i] = borVecGet(p, i) + cs->shift[i];
+
+        f = (c[i] - radius) * cs->edge_recp;
+        if (f <= BOR_ZERO){
+            lo[i] = 0;
+        }else if (f >= cs->dim[i] - 1){
+            lo[i] = cs->dim[i] - 1;
+        }else{
+            lo[i] = (size_t)f;
+        }
+
+        f = (c[i] + radius) * cs->edge_recp;
+        if (f <= BOR_ZERO){
+            hi[i] = 0;
+        }else if (f >= cs->dim[i] - 1){
+            hi[i] = cs->dim[i] - 1;
+        }else{
+            hi[i] = (size_t)f;
+        }
+
+        pos[i] = lo[i];
+    }
+
+    radius2 = radius * radius;
+    found   = 0;
+    do {
+        // skip corner cells of the box that don't intersect the ball
+        if (rangeCellDist2(cs, c, pos) <= radius2){
+            found += rangeInCell(cs, p, radius2, __borGUGPosToID(cs, pos),
+                                 cb, data);
+        }
+
+        for (i = 0; i < cs->d; i++){
+            if (pos[i] < hi[i]){
+                ++pos[i];
+                break;
+            }
+            pos[i] = lo[i];
+        }
+    } while (i < cs->d);
+
+    BOR_FREE(lo);
+    BOR_FREE(c);
+
+    return found;
 }
 
 void __borGUGExpand(bor_gug_t *cs)
 {
     bor_gug_cell_t *cells;
+    bor_gug_packed_t *packed;
     size_t i, cells_len, newlen;
     bor_list_t *item;
     bor_gug_el_t *el;
@@ -238,6 +421,11 @@ void __borGUGExpand(bor_gug_t *cs)
     cells     = cs->cells;
     cells_len = cs->cells_len;
 
+    // packed cells are not maintained during expansion, they are built
+    // at once when all elements are in their new cells
+    packed     = cs->packed;
+    cs->packed = NULL;
+
     // create new cells
     cs->num_els = 0;
     newlen = cells_len * cs->expand;
@@ -259,9 +447,47 @@ void __borGUGExpand(bor_gug_t *cs)
 
     BOR_FREE(cells);
 
+    if (packed){
+        packedDel(packed, cells_len);
+        packedBuild(cs);
+    }
+
     //DBG("cells: %d", (int)cs->cells_len);
 }
 
+void __borGUGPackedAdd(bor_gug_t *cs, bor_gug_el_t *el)
+{
+    bor_gug_packed_t *pc = &cs->packed[el->cell_id];
+
+    packedReserve(cs, pc, pc->len + 1);
+    packedSet(cs, pc, pc->len, el);
+    pc->len++;
+}
+
+void __borGUGPackedRemove(bor_gug_t *cs, bor_gug_el_t *el)
+{
+    bor_gug_packed_t *pc = &cs->packed[el->cell_id];
+    size_t i, j, last;
+
+    i    = packedFind(pc, el);
+    last = pc->len - 1;
+    if (i != last){
+        // move the last element to the freed position
+        pc->els[i] = pc->els[last];
+        for (j = 0; j < cs->d; j++){
+            pc->coords[j * pc->alloc + i] = pc->coords[j * pc->alloc + last];
+        }
+    }
+    pc->len--;
+}
+
+void __borGUGPackedUpdate(bor_gug_t *cs, bor_gug_el_t *el)
+{
+    bor_gug_packed_t *pc = &cs->packed[el->cell_id];
+
+    packedSet(cs, pc, packedFind(pc, el), el);
+}
+
 static void cellsAlloc(bor_gug_t *c, size_t num_cells)
 {
     size_t i;
@@ -319,18 +545,118 @@ static void cellInit(bor_gug_t *cs, bor_gug_cell_t *c, size_t id)
     borListInit(&c->list);
 }
 
+static void packedDel(bor_gug_packed_t *packed, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++){
+        if (packed[i].coords)
+            BOR_FREE(packed[i].coords);
+        if (packed[i].els)
+            BOR_FREE(packed[i].els);
+    }
+    BOR_FREE(packed);
+}
+
+static void packedBuild(bor_gug_t *cs)
+{
+    bor_gug_packed_t *pc;
+    bor_list_t *list, *item;
+    bor_gug_el_t *el;
+    size_t i, len;
+
+    cs->packed = BOR_CALLOC_ARR(bor_gug_packed_t, cs->cells_len);
+
+    for (i = 0; i < cs->cells_len; i++){
+        pc   = &cs->packed[i];
+        list = &cs->cells[i].list;
+
+        len = 0;
+        BOR_LIST_FOR_EACH(list, item)
+            len++;
+        if (len == 0)
+            continue;
+
+        packedReserve(cs, pc, len);
+        BOR_LIST_FOR_EACH(list, item){
+            el = BOR_LIST_ENTRY(item, bor_gug_el_t, list);
+            packedSet(cs, pc, pc->len++, el);
+        }
+    }
+}
+
+static void packedReserve(const bor_gug_t *cs, bor_gug_packed_t *pc,
+                          size_t len)
+{
+    bor_real_t *coords;
+    size_t alloc, step, i;
+
+    if (len <= pc->alloc)
+        return;
+
+    // keep each row aligned
+    step  = BOR_GUG_PACKED_ALIGN / sizeof(bor_real_t);
+    alloc = BOR_MAX(2 * pc->alloc, len);
+    alloc = ((alloc + step - 1) / step) * step;
+
+    coords = BOR_ALLOC_ALIGN_ARR(bor_real_t, alloc * cs->d,
+                                 BOR_GUG_PACKED_ALIGN);
+    if (pc->coords){
+        for (i = 0; i < cs->d; i++){
+            memcpy(coords + i * alloc, pc->coords + i * pc->alloc,
+                   sizeof(bor_real_t) * pc->len);
+        }
+        BOR_FREE(pc->coords);
+    }
+
+    pc->coords = coords;
+    pc->els    = BOR_REALLOC_ARR(pc->els, bor_gug_el_t *, alloc);
+    pc->alloc  = alloc;
+}
+
+static size_t packedFind(const bor_gug_packed_t *pc, const bor_gug_el_t *el)
+{
+    size_t i;
+
+    for (i = 0; i < pc->len; i++){
+        if (pc->els[i] == el)
+            return i;
+    }
+
+    // this should never happen, the packed cell would be corrupted
+    fprintf(stderr, "GUG Error: Element is not in the packed copy of"
+                    " its cell.\n");
+    exit(-1);
+}
+
+_bor_inline void packedSet(const bor_gug_t *cs, bor_gug_packed_t *pc,
+                           size_t i, bor_gug_el_t *el)
+{
+    size_t j;
+
+    pc->els[i] = el;
+    for (j = 0; j < cs->d; j++){
+        pc->coords[j * pc->alloc + i] = borVecGet(el->p, j);
+    }
+}
+
  
 
 static void cacheInit(bor_gug_cache_t *cache,
                       bor_gug_el_t **els,
                       size_t max_len,
-                      const bor_vec_t *p)
+                      const bor_vec_t *p,
+                      bor_real_t *dist)
 {
     // avoid allocation on heap if possible
-    if (max_len < 4){
+    cache->own_dist = 0;
+    if (dist){
+        cache->dist = dist;
+    }else if (max_len < 4){
         cache->dist = cache->__dist;
     }else{
         cache->dist = BOR_ALLOC_ARR(bor_real_t, max_len);
+        cache->own_dist = 1;
     }
 
     cache->els     = els;
@@ -341,7 +667,7 @@ static void cacheInit(bor_gug_cache_t *cache,
 
 static void cacheDestroy(bor_gug_cache_t *cache)
 {
-    if (cache->dist != cache->__dist)
+    if (cache->own_dist)
         BOR_FREE(cache->dist);
 }
 
@@ -480,12 +806,72 @@ static void nearestInCell(const bor_gug_t *cs, bor_gug_cache_t *cache,
                           bor_gug_cell_t *c)
 {
     bor_list_t *list, *item;
-    bor_gug_el_t *el;
+    bor_gug_el_t *el, *els[NEAREST_BLOCK];
+    const bor_vec_t *ps[NEAREST_BLOCK];
+    size_t i, len;
+
+    if (cs->packed){
+        nearestInPacked(cs, cache, &cs->packed[c - cs->cells]);
+        return;
+    }
+
+    if (cs->d > BOR_VEC_DIST2_BATCH_MAX){
+        BOR_LIST_FOR_EACH(&c->list, item){
+            el = BOR_LIST_ENTRY(item, bor_gug_el_t, list);
+            nearestCheck(cs, cache, el);
+        }
+        return;
+    }
 
+    // Elements are gathered into blocks and distances of a whole block
+    // are computed at once by SIMD kernel. Cells are usually very sparse
+    // so the remainder of the cell that doesn't fill a whole SIMD
+    // register is checked one by one.
+    len  = 0;
     list = &c->list;
     BOR_LIST_FOR_EACH(list, item){
         el = BOR_LIST_ENTRY(item, bor_gug_el_t, list);
-        nearestCheck(cs, cache, el);
+        els[len] = el;
+        ps[len]  = el->p;
+        if (++len == NEAREST_BLOCK){
+            nearestCheckBlock(cs, cache, els, ps, len);
+            len = 0;
+        }
+    }
+
+    if (len >= NEAREST_BLOCK_MIN){
+        nearestCheckBlock(cs, cache, els, ps, len);
+    }else{
+        for (i = 0; i < len; i++)
+            nearestCheck(cs, cache, els[i]);
+    }
+}
+
+static void nearestCheckBlock(const bor_gug_t *cs, bor_gug_cache_t *cache,
+                              bor_gug_el_t **els, const bor_vec_t **ps,
+                              size_t len)
+{
+    bor_real_t dist[NEAREST_BLOCK];
+    size_t i;
+
+    borVecDist2Batch(cs->d, cache->p, ps, len, dist);
+    for (i = 0; i < len; i++)
+        nearestCheckDist(cache, els[i], dist[i]);
+}
+
+static void nearestInPacked(const bor_gug_t *cs, bor_gug_cache_t *cache,
+                            const bor_gug_packed_t *pc)
+{
+    bor_real_t dist[NEAREST_BLOCK];
+    size_t i, k, len;
+
+    for (i = 0; i < pc->len; i += NEAREST_BLOCK){
+        len = BOR_MIN(NEAREST_BLOCK, pc->len - i);
+
+        borVecDist2BatchSoA(cs->d, cache->p, pc->coords + i, pc->alloc,
+                            len, dist);
+        for (k = 0; k < len; k++)
+            nearestCheckDist(cache, pc->els[i + k], dist[k]);
     }
 }
 
@@ -501,6 +887,12 @@ static void nearestCheck(const bor_gug_t *cs, bor_gug_cache_t *c,
     }else{
         dist = borVecDist2(cs->d, c->p, el->p);
     }
+    nearestCheckDist(c, el, dist);
+}
+
+_bor_inline void nearestCheckDist(bor_gug_cache_t *c,
+                                  bor_gug_el_t *el, bor_real_t dist)
+{
     if (c->len < c->max_len){
         c->els[c->len]  = el;
         c->dist[c->len] = dist;
@@ -533,6 +925,115 @@ static void nearestBubbleUp(bor_gug_cache_t *c)
 }
 
 
+static size_t rangeInCell(const bor_gug_t *cs, const bor_vec_t *p,
+                          bor_real_t radius2, size_t c,
+                          bor_gug_range_fn cb, void *data)
+{
+    const bor_gug_packed_t *pc;
+    bor_list_t *item;
+    bor_gug_el_t *el, *els[NEAREST_BLOCK];
+    const bor_vec_t *ps[NEAREST_BLOCK];
+    bor_real_t dist[NEAREST_BLOCK];
+    size_t i, k, len, found = 0;
+
+    if (cs->packed){
+        pc = &cs->packed[c];
+        for (i = 0; i < pc->len; i += NEAREST_BLOCK){
+            len = BOR_MIN(NEAREST_BLOCK, pc->len - i);
+            borVecDist2BatchSoA(cs->d, p, pc->coords + i, pc->alloc,
+                                len, dist);
+            for (k = 0; k < len; k++){
+                if (dist[k] <= radius2){
+                    cb(pc->els[i + k], BOR_SQRT(dist[k]), data);
+                    ++found;
+                }
+            }
+        }
+        return found;
+    }
+
+    len = 0;
+    BOR_LIST_FOR_EACH(&cs->cells[c].list, item){
+        el = BOR_LIST_ENTRY(item, bor_gug_el_t, list);
+        els[len] = el;
+        ps[len]  = el->p;
+        if (++len == NEAREST_BLOCK || item->next == &cs->cells[c].list){
+            if (cs->d <= BOR_VEC_DIST2_BATCH_MAX){
+                borVecDist2Batch(cs->d, p, ps, len, dist);
+            }else{
+                for (k = 0; k < len; k++)
+                    dist[k] = borVecDist2(cs->d, p, ps[k]);
+            }
+            for (k = 0; k < len; k++){
+                if (dist[k] <= radius2){
+                    cb(els[k], BOR_SQRT(dist[k]), data);
+                    ++found;
+                }
+            }
+            len = 0;
+        }
+    }
+
+    return found;
+}
+
+_bor_inline bor_real_t rangeCellDist2(const bor_gug_t *cs,
+                                      const bor_real_t *c,
+                                      const size_t *pos)
+{
+    bor_real_t lo, d, dist = BOR_ZERO;
+    size_t i;
+
+    for (i = 0; i < cs->d; i++){
+        lo = cs->edge * pos[i];
+        if (pos[i] > 0 && c[i] < lo){
+            d = lo - c[i];
+        }else if (pos[i] < cs->dim[i] - 1 && c[i] > lo + cs->edge){
+            d = c[i] - lo - cs->edge;
+        }else{
+            continue;
+        }
+        dist += d * d;
+    }
+
+    return dist;
+}
+
+static void nearestBatchRange(const bor_gug_batch_t *b,
+                              size_t from, size_t to,
+                              size_t *center, size_t *pos,
+                              bor_real_t *dist)
+{
+    const bor_gug_t *cs = b->gug;
+    bor_gug_el_t **els;
+    size_t i, j, len;
+
+    for (i = from; i < to; i++){
+        els = b->els + i * b->num;
+        len = __borGUGNearest(cs, b->ps[i], b->num, els, cs->approx,
+                              center, pos, dist);
+
+        // clear unused slots so that the output array is always defined
+        for (j = len; j < b->num; j++)
+            els[j] = NULL;
+
+        if (b->found)
+            b->found[i] = len;
+    }
+}
+
+static void nearestBatchFor(size_t from, size_t to, void *data,
+                            const bor_task_pool_thinfo_t *thinfo)
+{
+    const bor_gug_batch_t *b = (const bor_gug_batch_t *)data;
+    size_t *center;
+
+    center = b->scratch + 2 * b->gug->d * thinfo->id;
+    nearestBatchRange(b, from, to, center, center + b->gug->d,
+                      b->dist + b->num * thinfo->id);
+}
+
+
 _bor_inline size_t __borGUGPosToID(const bor_gug_t *cs, const size_t *pos)
 {
     size_t id, mul, i;
@@ -0,0 +1,279 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include <boruvka/htable-oa.h>
+#include <boruvka/hfunc.h>
+#include <boruvka/alloc.h>
+
+#define SLOT(t, i) ((t)->slots + (i) * (t)->slot_size)
+#define VAL(t, slot) ((slot) + (t)->val_offset)
+
+/** Returns alignment that suits an element of the given size */
+static size_t align(size_t size)
+{
+    size_t a = 1;
+    while (a < 8 && (size & a) == 0)
+        a <<= 1;
+    return a;
+}
+
+_bor_inline size_t roundUp(size_t v, size_t a)
+{
+    return (v + a - 1) / a * a;
+}
+
+_bor_inline uint64_t hashKey(const bor_htable_oa_t *t, const void *key)
+{
+    if (t->hash == NULL)
+        return borFastHash_64(key, t->key_size, 0);
+    return t->hash(key, t->data);
+}
+
+_bor_inline int eqKey(const bor_htable_oa_t *t,
+                      const void *key1, const void *key2)
+{
+    if (t->eq == NULL){
+        /* Avoid calling memcmp() for the most common key sizes */
+        if (t->key_size == 8){
+            uint64_t a, b;
+            memcpy(&a, key1, 8);
+            memcpy(&b, key2, 8);
+            return a == b;
+        }
+        if (t->key_size == 4){
+            uint32_t a, b;
+            memcpy(&a, key1, 4);
+            memcpy(&b, key2, 4);
+            return a == b;
+        }
+        return memcmp(key1, key2, t->key_size) == 0;
+    }
+    return t->eq(key1, key2, t->data);
+}
+
+static size_t findSlot(const bor_htable_oa_t *t, const void *key,
+                       uint64_t hash);
+static size_t insertSlot(bor_htable_oa_t *t, const void *key, int *found);
+static void rehash(bor_htable_oa_t *t, size_t size);
+
+bor_htable_oa_t *borHTableOANew(size_t key_size, size_t val_size,
+                                bor_htable_oa_hash_fn hash_func,
+                                bor_htable_oa_eq_fn eq_func,
+                                void *userdata)
+{
+    bor_htable_oa_t *t;
+    size_t a;
+
+    t = BOR_ALLOC(bor_htable_oa_t);
+    t->key_size = key_size;
+    t->val_size = val_size;
+
+    /* The value is aligned according to its size within the slot and
+     * slots are padded so that this holds for all of them */
+    a = align(key_size);
+    if (val_size > 0){
+        t->val_offset = roundUp(key_size, align(val_size));
+        a = BOR_MAX(a, align(val_size));
+        t->slot_size = roundUp(t->val_offset + val_size, a);
+    }else{
+        t->val_offset = 0;
+        t->slot_size = roundUp(key_size, a);
+    }
+
+    t->hash = hash_func;
+    t->eq   = eq_func;
+    t->data = userdata;
+
+    t->size = BOR_HTABLE_OA_MIN_SIZE;
+    t->ctrl = __borHTableOACtrlNew(t->size);
+    t->slots = BOR_ALLOC_ARR(char, t->size * t->slot_size);
+    t->num_elements = 0;
+    t->growth_left = __borHTableOACapacity(t->size);
+
+    return t;
+}
+
+void borHTableOADel(bor_htable_oa_t *t)
+{
+    BOR_FREE(t->ctrl);
+    BOR_FREE(t->slots);
+    BOR_FREE(t);
+}
+
+void borHTableOAClear(bor_htable_oa_t *t)
+{
+    memset(t->ctrl, BOR_HTABLE_OA_EMPTY, t->size);
+    t->num_elements = 0;
+    t->growth_left = __borHTableOACapacity(t->size);
+}
+
+void borHTableOAReserve(bor_htable_oa_t *t, size_t num)
+{
+    size_t size = __borHTableOASizeFor(num);
+    if (size > t->size)
+        rehash(t, size);
+}
+
+void *borHTableOAFind(const bor_htable_oa_t *t, const void *key)
+{
+    size_t i = findSlot(t, key, hashKey(t, key));
+    if (i == t->size)
+        return NULL;
+    return VAL(t, SLOT(t, i));
+}
+
+void *borHTableOAInsert(bor_htable_oa_t *t, const void *key, const void *val)
+{
+    int found;
+    size_t i;
+    char *v;
+
+    i = insertSlot(t, key, &found);
+    v = VAL(t, SLOT(t, i));
+    if (val != NULL){
+        memcpy(v, val, t->val_size);
+    }else{
+        memset(v, 0, t->val_size);
+    }
+    return v;
+}
+
+void *borHTableOAInsertUnique(bor_htable_oa_t *t,
+                              const void *key, const void *val)
+{
+    int found;
+    size_t i;
+    char *v;
+
+    i = insertSlot(t, key, &found);
+    v = VAL(t, SLOT(t, i));
+    if (found)
+        return v;
+
+    if (val != NULL){
+        memcpy(v, val, t->val_size);
+    }else{
+        memset(v, 0, t->val_size);
+    }
+    return NULL;
+}
+
+int borHTableOAErase(bor_htable_oa_t *t, const void *key)
+{
+    size_t i = findSlot(t, key, hashKey(t, key));
+    if (i == t->size)
+        return -1;
+
+    if (__borHTableOASetFree(t->ctrl, i))
+        ++t->growth_left;
+    --t->num_elements;
+    return 0;
+}
+
+int borHTableOANext(const bor_htable_oa_t *t, size_t *it,
+                    void **key, void **val)
+{
+    size_t i;
+
+    for (i = *it; i < t->size && t->ctrl[i] < 0; ++i);
+    if (i >= t->size){
+        *it = i;
+        return -1;
+    }
+
+    if (key != NULL)
+        *key = SLOT(t, i);
+    if (val != NULL)
+        *val = VAL(t, SLOT(t, i));
+    *it = i + 1;
+    return 0;
+}
+
+
+static size_t findSlot(const bor_htable_oa_t *t, const void *key,
+                       uint64_t hash)
+{
+    size_t mask = t->size - 1, pos, step = 0, i;
+    int8_t h2 = __borHTableOAH2(hash);
+    unsigned m;
+
+    pos = __borHTableOAH1(hash, t->size);
+    /* Fetch the first group of slots in parallel with the control bytes */
+    __builtin_prefetch(SLOT(t, pos));
+    while (1){
+        m = __borHTableOAMatch(t->ctrl + pos, h2);
+        for (; m; m &= m - 1){
+            i = pos + __borHTableOABit(m);
+            if (eqKey(t, SLOT(t, i), key))
+                return i;
+        }
+        if (__borHTableOAMatchEmpty(t->ctrl + pos))
+            return t->size;
+        step += BOR_HTABLE_OA_GROUP;
+        pos = (pos + step) & mask;
+    }
+}
+
+static size_t insertSlot(bor_htable_oa_t *t, const void *key, int *found)
+{
+    uint64_t hash = hashKey(t, key);
+    size_t i;
+
+    i = findSlot(t, key, hash);
+    *found = (i != t->size);
+    if (*found)
+        return i;
+
+    i = __borHTableOAFindFree(t->ctrl, t->size, hash);
+    if (t->growth_left == 0 && t->ctrl[i] == BOR_HTABLE_OA_EMPTY){
+        rehash(t, __borHTableOANextSize(t->size, t->num_elements));
+        i = __borHTableOAFindFree(t->ctrl, t->size, hash);
+    }
+
+    if (t->ctrl[i] == BOR_HTABLE_OA_EMPTY)
+        --t->growth_left;
+    t->ctrl[i] = __borHTableOAH2(hash);
+    memcpy(SLOT(t, i), key, t->key_size);
+    ++t->num_elements;
+    return i;
+}
+
+static void rehash(bor_htable_oa_t *t, size_t size)
+{
+    int8_t *ctrl;
+    char *slots, *slot;
+    size_t i, j;
+
+    ctrl = __borHTableOACtrlNew(size);
+    slots = BOR_ALLOC_ARR(char, size * t->slot_size);
+    for (i = 0; i < t->size; ++i){
+        if (t->ctrl[i] < 0)
+            continue;
+
+        slot = SLOT(t, i);
+        j = __borHTableOAFindFree(ctrl, size, hashKey(t, slot));
+        ctrl[j] = t->ctrl[i];
+        memcpy(slots + j * t->slot_size, slot, t->slot_size);
+    }
+
+    BOR_FREE(t->ctrl);
+    BOR_FREE(t->slots);
+    t->ctrl = ctrl;
+    t->slots = slots;
+    t->size = size;
+    t->growth_left = __borHTableOACapacity(size) - t->num_elements;
+}
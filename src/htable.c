@@ -27,6 +27,9 @@ struct _bor_htable_el_t {
 };
 
 static int _eq(const bor_list_t *key1, const bor_list_t *key2, void *userdata);
+static void emptyList(bor_list_t *list);
+static void gatherList(bor_list_t *src, bor_list_t *dst);
+static void finishMigration(bor_htable_t *m);
 
 bor_htable_t *borHTableNew(bor_htable_hash_fn hash_func,
                            bor_htable_eq_fn eq_func,
@@ -47,6 +50,11 @@ bor_htable_t *borHTableNew(bor_htable_hash_fn hash_func,
     if (!htable->eq)
         htable->eq = _eq;
 
+    htable->incremental = 0;
+    htable->old_table = NULL;
+    htable->old_size = 0;
+    htable->migrated = 0;
+
     for (i = 0; i < htable->size; i++){
         borListInit(htable->table + i);
     }
@@ -57,14 +65,13 @@ bor_htable_t *borHTableNew(bor_htable_hash_fn hash_func,
 void borHTableDel(bor_htable_t *h)
 {
     size_t i;
-    bor_list_t *list, *item;
 
-    for (i = 0; i < h->size; i++){
-        list = &h->table[i];
-        while (!borListEmpty(list)){
-            item = borListNext(list);
-            borListDel(item);
-        }
+    for (i = 0; i < h->size; i++)
+        emptyList(&h->table[i]);
+    if (h->old_table != NULL){
+        for (i = h->migrated; i < h->old_size; i++)
+            emptyList(&h->old_table[i]);
+        BOR_FREE(h->old_table);
     }
 
     BOR_FREE(h->table);
@@ -74,14 +81,16 @@ void borHTableDel(bor_htable_t *h)
 void borHTableGather(bor_htable_t *m, bor_list_t *list)
 {
     size_t i;
-    bor_list_t *item;
 
-    for (i = 0; i < m->size; i++){
-        while (!borListEmpty(&m->table[i])){
-            item = borListNext(&m->table[i]);
-            borListDel(item);
-            borListAppend(list, item);
-        }
+    for (i = 0; i < m->size; i++)
+        gatherList(&m->table[i], list);
+
+    if (m->old_table != NULL){
+        for (i = m->migrated; i < m->old_size; i++)
+            gatherList(&m->old_table[i], list);
+        BOR_FREE(m->old_table);
+        m->old_table = NULL;
+        m->old_size = m->migrated = 0;
     }
     m->num_elements = 0;
 }
@@ -89,26 +98,38 @@ void borHTableGather(bor_htable_t *m, bor_list_t *list)
 size_t borHTableFindAll(const bor_htable_t *m, const bor_list_t *key1,
                         bor_list_t ***out_arr, size_t *size)
 {
-    bor_list_t *item;
+    bor_list_t *item, *lists[2];
     size_t found_size, bucket;
-    int reallocate = 0;
+    int i, reallocate = 0;
 
     bucket = borHTableBucket(m, key1);
+    lists[0] = &m->table[bucket];
+    lists[1] = NULL;
+    if (m->old_table != NULL){
+        bucket = m->hash(key1, m->data) % (bor_htable_key_t)m->old_size;
+        if (bucket >= m->migrated)
+            lists[1] = &m->old_table[bucket];
+    }
 
     if (*out_arr == 0x0)
         reallocate = 1;
 
     found_size = 0;
-    BOR_LIST_FOR_EACH(&m->table[bucket], item){
-        if (m->eq(key1, item, m->data)){
-            ++found_size;
-            if (reallocate){
-                (*out_arr) = BOR_REALLOC_ARR(*out_arr, bor_list_t *,
-                                             found_size);
-                (*out_arr)[found_size - 1] = item;
-
-            }else if (found_size <= *size){
-                (*out_arr)[found_size - 1] = item;
+    for (i = 0; i < 2; ++i){
+        if (lists[i] == NULL || lists[i]->next == NULL)
+            continue;
+
+        BOR_LIST_FOR_EACH(lists[i], item){
+            if (m->eq(key1, item, m->data)){
+                ++found_size;
+                if (reallocate){
+                    (*out_arr) = BOR_REALLOC_ARR(*out_arr, bor_list_t *,
+                                                 found_size);
+                    (*out_arr)[found_size - 1] = item;
+
+                }else if (found_size <= *size){
+                    (*out_arr)[found_size - 1] = item;
+                }
             }
         }
     }
@@ -125,6 +146,8 @@ void borHTableResize(bor_htable_t *m, size_t size)
     size_t old_size;
     size_t i;
 
+    finishMigration(m);
+
     // remember old table and old size
     old_table = m->table;
     old_size  = m->size;
@@ -139,6 +162,9 @@ void borHTableResize(bor_htable_t *m, size_t size)
     }
 
     for (i = 0; i < old_size; i++){
+        if (old_table[i].next == NULL)
+            continue;
+
         while (!borListEmpty(&old_table[i])){
             // remove item from the old table
             item = borListNext(&old_table[i]);
@@ -152,8 +178,113 @@ void borHTableResize(bor_htable_t *m, size_t size)
     BOR_FREE(old_table);
 }
 
+void borHTableResizeIncremental(bor_htable_t *m, size_t size)
+{
+    finishMigration(m);
+
+    m->old_table = m->table;
+    m->old_size  = m->size;
+    m->migrated  = 0;
+
+    // The buckets are initialized lazily by __borHTableList(), so that
+    // the zeroed memory does not have to be touched all at once.
+    m->table = BOR_CALLOC_ARR(bor_list_t, size);
+    m->size  = size;
+}
+
+int borHTableResizeStep(bor_htable_t *m, size_t num_buckets)
+{
+    bor_list_t *list, *item;
+    size_t end, bucket;
+
+    if (m->old_table == NULL)
+        return 0;
+
+    end = BOR_MIN(m->migrated + num_buckets, m->old_size);
+    for (; m->migrated < end; ++m->migrated){
+        list = &m->old_table[m->migrated];
+        if (list->next == NULL)
+            continue;
+
+        while (!borListEmpty(list)){
+            item = borListNext(list);
+            borListDel(item);
+            bucket = borHTableBucket(m, item);
+            borListAppend(__borHTableList(m, bucket), item);
+        }
+    }
+
+    if (m->migrated == m->old_size){
+        BOR_FREE(m->old_table);
+        m->old_table = NULL;
+        m->old_size = m->migrated = 0;
+        return 0;
+    }
+    return 1;
+}
+
+void borHTableSetIncrementalResize(bor_htable_t *m, int enable)
+{
+    m->incremental = enable;
+    if (!enable)
+        finishMigration(m);
+}
+
+bor_list_t *__borHTableFindOld(const bor_htable_t *m, const bor_list_t *key1)
+{
+    bor_list_t *list, *item;
+    size_t bucket;
+
+    bucket = m->hash(key1, m->data) % (bor_htable_key_t)m->old_size;
+    if (bucket < m->migrated)
+        return NULL;
+
+    list = &m->old_table[bucket];
+    if (list->next == NULL)
+        return NULL;
+
+    BOR_LIST_FOR_EACH(list, item){
+        if (m->eq(key1, item, m->data))
+            return item;
+    }
+    return NULL;
+}
+
 static int _eq(const bor_list_t *key1, const bor_list_t *key2, void *userdata)
 {
     return key1 == key2;
 }
 
+static void emptyList(bor_list_t *list)
+{
+    bor_list_t *item;
+
+    if (list->next == NULL)
+        return;
+
+    while (!borListEmpty(list)){
+        item = borListNext(list);
+        borListDel(item);
+    }
+}
+
+static void gatherList(bor_list_t *src, bor_list_t *dst)
+{
+    bor_list_t *item;
+
+    if (src->next == NULL)
+        return;
+
+    while (!borListEmpty(src)){
+        item = borListNext(src);
+        borListDel(item);
+        borListAppend(dst, item);
+    }
+}
+
+static void finishMigration(bor_htable_t *m)
+{
+    if (m->old_table != NULL)
+        borHTableResizeStep(m, m->old_size);
+}
+
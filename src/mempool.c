@@ -0,0 +1,277 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include "boruvka/mempool.h"
+#include "boruvka/alloc.h"
+
+/** Number of entries of the thread-local table of recently used caches */
+#define CACHE_MEMO 8
+
+/** Header of objects allocated by malloc() */
+struct _large_t {
+    bor_list_t list;
+};
+typedef struct _large_t large_t;
+
+struct _cache_memo_t {
+    uint64_t uid;
+    bor_mempool_cache_t *cache;
+};
+typedef struct _cache_memo_t cache_memo_t;
+
+/** Source of unique IDs of pools (0 is never used) */
+static uint64_t pool_uid = 0;
+/** Caches recently used by this thread */
+static __thread cache_memo_t cache_memo[CACHE_MEMO];
+
+_bor_inline int sizeClass(size_t size)
+{
+    if (size == 0)
+        return 0;
+    return (size + BOR_MEMPOOL_ALIGN - 1) / BOR_MEMPOOL_ALIGN - 1;
+}
+
+_bor_inline size_t classSize(int cls)
+{
+    return (cls + 1) * BOR_MEMPOOL_ALIGN;
+}
+
+_bor_inline void listPush(bor_mempool_list_t *l, void *obj)
+{
+    *(void **)obj = l->head;
+    l->head = obj;
+    ++l->len;
+}
+
+_bor_inline void *listPop(bor_mempool_list_t *l)
+{
+    void *obj = l->head;
+    l->head = *(void **)obj;
+    --l->len;
+    return obj;
+}
+
+/** Carves a new object from the slab, pool must be locked */
+static void *bump(bor_mempool_t *pool, size_t size)
+{
+    void *obj;
+
+    if (pool->bump + size > pool->bump_end){
+        if (pool->slab_cur + 1 == pool->slab_size){
+            ++pool->slab_size;
+            pool->slab = BOR_REALLOC_ARR(pool->slab, char *, pool->slab_size);
+            pool->slab[pool->slab_size - 1]
+                    = BOR_ALLOC_ALIGN_ARR(char, BOR_MEMPOOL_SLAB_SIZE, 64);
+        }
+        ++pool->slab_cur;
+        pool->bump = pool->slab[pool->slab_cur];
+        pool->bump_end = pool->bump + BOR_MEMPOOL_SLAB_SIZE;
+    }
+
+    obj = pool->bump;
+    pool->bump += size;
+    return obj;
+}
+
+/** Returns cache of the calling thread */
+static bor_mempool_cache_t *threadCache(bor_mempool_t *pool)
+{
+    cache_memo_t *memo = cache_memo + (pool->uid % CACHE_MEMO);
+    bor_mempool_cache_t *cache;
+    pthread_t self;
+
+    if (memo->uid == pool->uid)
+        return memo->cache;
+
+    self = pthread_self();
+    pthread_mutex_lock(&pool->lock);
+    for (cache = pool->caches; cache; cache = cache->next){
+        if (pthread_equal(cache->owner, self))
+            break;
+    }
+    if (cache == NULL){
+        cache = BOR_CALLOC_ARR(bor_mempool_cache_t, 1);
+        cache->owner = self;
+        cache->next = pool->caches;
+        pool->caches = cache;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    memo->uid = pool->uid;
+    memo->cache = cache;
+    return cache;
+}
+
+/** Fills the cache's list with a batch of objects */
+static void refill(bor_mempool_t *pool, bor_mempool_list_t *l, int cls)
+{
+    bor_mempool_list_t *shared = pool->free + cls;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < BOR_MEMPOOL_BATCH && shared->head; ++i)
+        listPush(l, listPop(shared));
+    for (; i < BOR_MEMPOOL_BATCH; ++i)
+        listPush(l, bump(pool, classSize(cls)));
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/** Returns a batch of objects from the cache's list to the shared list */
+static void flush(bor_mempool_t *pool, bor_mempool_list_t *l, int cls)
+{
+    bor_mempool_list_t *shared = pool->free + cls;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    for (i = 0; i < BOR_MEMPOOL_BATCH; ++i)
+        listPush(shared, listPop(l));
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void *allocLarge(bor_mempool_t *pool, size_t size)
+{
+    large_t *obj;
+
+    obj = BOR_MALLOC(sizeof(large_t) + size);
+    if (!(pool->flags & BOR_MEMPOOL_SINGLE_THREAD))
+        pthread_mutex_lock(&pool->lock);
+    borListAppend(&pool->large, &obj->list);
+    if (!(pool->flags & BOR_MEMPOOL_SINGLE_THREAD))
+        pthread_mutex_unlock(&pool->lock);
+    return obj + 1;
+}
+
+static void freeLarge(bor_mempool_t *pool, void *ptr)
+{
+    large_t *obj = (large_t *)ptr - 1;
+
+    if (!(pool->flags & BOR_MEMPOOL_SINGLE_THREAD))
+        pthread_mutex_lock(&pool->lock);
+    borListDel(&obj->list);
+    if (!(pool->flags & BOR_MEMPOOL_SINGLE_THREAD))
+        pthread_mutex_unlock(&pool->lock);
+    BOR_FREE(obj);
+}
+
+static void freeAllLarge(bor_mempool_t *pool)
+{
+    large_t *obj;
+
+    while (!borListEmpty(&pool->large)){
+        obj = BOR_LIST_ENTRY(borListNext(&pool->large), large_t, list);
+        borListDel(&obj->list);
+        BOR_FREE(obj);
+    }
+}
+
+bor_mempool_t *borMemPoolNew(int flags)
+{
+    bor_mempool_t *pool;
+
+    pool = BOR_CALLOC_ARR(bor_mempool_t, 1);
+    pool->uid = __atomic_add_fetch(&pool_uid, 1, __ATOMIC_RELAXED);
+    pool->flags = flags;
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->slab_cur = -1;
+    borListInit(&pool->large);
+
+    return pool;
+}
+
+void borMemPoolDel(bor_mempool_t *pool)
+{
+    bor_mempool_cache_t *cache;
+    int i;
+
+    for (i = 0; i < pool->slab_size; ++i)
+        BOR_FREE(pool->slab[i]);
+    if (pool->slab)
+        BOR_FREE(pool->slab);
+
+    while (pool->caches){
+        cache = pool->caches;
+        pool->caches = cache->next;
+        BOR_FREE(cache);
+    }
+
+    freeAllLarge(pool);
+    pthread_mutex_destroy(&pool->lock);
+    BOR_FREE(pool);
+}
+
+void borMemPoolReset(bor_mempool_t *pool)
+{
+    bor_mempool_cache_t *cache;
+
+    bzero(pool->free, sizeof(pool->free));
+    for (cache = pool->caches; cache; cache = cache->next)
+        bzero(cache->free, sizeof(cache->free));
+
+    pool->slab_cur = -1;
+    pool->bump = pool->bump_end = NULL;
+
+    freeAllLarge(pool);
+}
+
+void *borMemPoolAlloc(bor_mempool_t *pool, size_t size)
+{
+    bor_mempool_list_t *l;
+    int cls;
+
+    if (size > BOR_MEMPOOL_MAX_SIZE)
+        return allocLarge(pool, size);
+
+    cls = sizeClass(size);
+    if (pool->flags & BOR_MEMPOOL_SINGLE_THREAD){
+        l = pool->free + cls;
+        if (l->head)
+            return listPop(l);
+        return bump(pool, classSize(cls));
+    }
+
+    l = threadCache(pool)->free + cls;
+    if (bor_unlikely(l->head == NULL))
+        refill(pool, l, cls);
+    return listPop(l);
+}
+
+void borMemPoolFree(bor_mempool_t *pool, void *ptr, size_t size)
+{
+    bor_mempool_list_t *l;
+    int cls;
+
+    if (size > BOR_MEMPOOL_MAX_SIZE){
+        freeLarge(pool, ptr);
+        return;
+    }
+
+    cls = sizeClass(size);
+    if (pool->flags & BOR_MEMPOOL_SINGLE_THREAD){
+        listPush(pool->free + cls, ptr);
+        return;
+    }
+
+    l = threadCache(pool)->free + cls;
+    listPush(l, ptr);
+    if (bor_unlikely(l->len >= 2 * BOR_MEMPOOL_BATCH))
+        flush(pool, l, cls);
+}
+
+size_t borMemPoolAllocated(const bor_mempool_t *pool)
+{
+    return (size_t)pool->slab_size * BOR_MEMPOOL_SLAB_SIZE;
+}
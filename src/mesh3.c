@@ -185,6 +185,11 @@ void borMesh3Del2(bor_mesh3_t *m,
     BOR_FREE(m);
 }
 
+void borMesh3DelShallow(bor_mesh3_t *m)
+{
+    BOR_FREE(m);
+}
+
 void borMesh3AddVertex(bor_mesh3_t *m, bor_mesh3_vertex_t *v)
 {
     borListAppend(&m->verts, &v->list);
@@ -26,6 +26,23 @@ static bor_real_t distL2Norm(int d, const bor_vec_t *v1,
 
 static void bubbleUp(bor_nn_linear_el_t **els, size_t len);
 
+/** Inserts element into sorted array of {len} nearest elements, returns
+ *  new length */
+_bor_inline size_t nearestCheck(bor_nn_linear_el_t **els, size_t len,
+                                size_t num, bor_nn_linear_el_t *el,
+                                bor_real_t dist);
+
+/** Number of distances computed at once when default L2 norm is used */
+#define NEAREST_BLOCK 16
+
+/** Nearest search with default L2 norm computed by batch SIMD kernel */
+static size_t nearestL2(const bor_nn_linear_t *nn, const bor_vec_t *p,
+                        size_t num, bor_nn_linear_el_t **els);
+/** Range search with default L2 norm (that returns squared distance) */
+static size_t rangeL2(const bor_nn_linear_t *nn, const bor_vec_t *p,
+                      bor_real_t radius, bor_nn_linear_range_fn cb,
+                      void *data);
+
 void borNNLinearParamsInit(bor_nn_linear_params_t *p)
 {
     p->dim = 2;
@@ -65,31 +82,119 @@ size_t borNNLinearNearest(const bor_nn_linear_t *nn, const bor_vec_t *p, size_t
     if (num == 0)
         return 0;
 
+    if (nn->params.dist == distL2Norm
+            && nn->params.dim <= BOR_VEC_DIST2_BATCH_MAX)
+        return nearestL2(nn, p, num, els);
+
     dists = BOR_ALLOC_ARR(bor_real_t, num);
     len = 0;
 
     BOR_LIST_FOR_EACH(&nn->list, item){
         el = BOR_LIST_ENTRY(item, bor_nn_linear_el_t, list);
         dist = nn->params.dist(nn->params.dim, p, el->p, nn->params.dist_data);
+        len = nearestCheck(els, len, num, el, dist);
+    }
+
+    BOR_FREE(dists);
+    return len;
+}
+
+size_t borNNLinearRange(const bor_nn_linear_t *nn, const bor_vec_t *p,
+                        bor_real_t radius, bor_nn_linear_range_fn cb,
+                        void *data)
+{
+    bor_list_t *item;
+    bor_nn_linear_el_t *el;
+    bor_real_t dist;
+    size_t found = 0;
 
-        if (len < num){
-            el->dist = dist;
-            els[len] = el;
-            len++;
+    if (radius < BOR_ZERO)
+        return 0;
 
-            bubbleUp(els, len);
-        }else if (dist < els[len - 1]->dist){
-            el->dist = dist;
-            els[len - 1]   = el;
+    if (nn->params.dist == distL2Norm
+            && nn->params.dim <= BOR_VEC_DIST2_BATCH_MAX)
+        return rangeL2(nn, p, radius, cb, data);
 
-            bubbleUp(els, len);
+    BOR_LIST_FOR_EACH(&nn->list, item){
+        el = BOR_LIST_ENTRY(item, bor_nn_linear_el_t, list);
+        dist = nn->params.dist(nn->params.dim, p, el->p, nn->params.dist_data);
+        if (dist <= radius){
+            cb(el, dist, data);
+            ++found;
         }
     }
 
-    BOR_FREE(dists);
+    return found;
+}
+
+static size_t nearestL2(const bor_nn_linear_t *nn, const bor_vec_t *p,
+                        size_t num, bor_nn_linear_el_t **els)
+{
+    bor_list_t *item;
+    bor_nn_linear_el_t *block[NEAREST_BLOCK];
+    const bor_vec_t *ps[NEAREST_BLOCK];
+    bor_real_t dist[NEAREST_BLOCK];
+    size_t i, len, block_len;
+
+    len = block_len = 0;
+    BOR_LIST_FOR_EACH(&nn->list, item){
+        block[block_len] = BOR_LIST_ENTRY(item, bor_nn_linear_el_t, list);
+        ps[block_len]    = block[block_len]->p;
+
+        if (++block_len == NEAREST_BLOCK){
+            borVecDist2Batch(nn->params.dim, p, ps, block_len, dist);
+            for (i = 0; i < block_len; i++)
+                len = nearestCheck(els, len, num, block[i], dist[i]);
+            block_len = 0;
+        }
+    }
+
+    borVecDist2Batch(nn->params.dim, p, ps, block_len, dist);
+    for (i = 0; i < block_len; i++)
+        len = nearestCheck(els, len, num, block[i], dist[i]);
+
     return len;
 }
 
+static size_t rangeL2(const bor_nn_linear_t *nn, const bor_vec_t *p,
+                      bor_real_t radius, bor_nn_linear_range_fn cb,
+                      void *data)
+{
+    bor_list_t *item;
+    bor_nn_linear_el_t *block[NEAREST_BLOCK];
+    const bor_vec_t *ps[NEAREST_BLOCK];
+    bor_real_t dist[NEAREST_BLOCK], radius2;
+    size_t i, found, block_len;
+
+    radius2 = radius * radius;
+    found = block_len = 0;
+    BOR_LIST_FOR_EACH(&nn->list, item){
+        block[block_len] = BOR_LIST_ENTRY(item, bor_nn_linear_el_t, list);
+        ps[block_len]    = block[block_len]->p;
+
+        if (++block_len == NEAREST_BLOCK){
+            borVecDist2Batch(nn->params.dim, p, ps, block_len, dist);
+            for (i = 0; i < block_len; i++){
+                if (dist[i] <= radius2){
+                    cb(block[i], BOR_SQRT(dist[i]), data);
+                    ++found;
+                }
+            }
+            block_len = 0;
+        }
+    }
+
+    borVecDist2Batch(nn->params.dim, p, ps, block_len, dist);
+    for (i = 0; i < block_len; i++){
+        if (dist[i] <= radius2){
+            cb(block[i], BOR_SQRT(dist[i]), data);
+            ++found;
+        }
+    }
+
+    return found;
+}
+
 
 
 static bor_real_t distL2Norm(int d, const bor_vec_t *v1,
@@ -98,6 +203,26 @@ static bor_real_t distL2Norm(int d, const bor_vec_t *v1,
     return borVecDist2(d, v1, v2);
 }
 
+_bor_inline size_t nearestCheck(bor_nn_linear_el_t **els, size_t len,
+                                size_t num, bor_nn_linear_el_t *el,
+                                bor_real_t dist)
+{
+    if (len < num){
+        el->dist = dist;
+        els[len] = el;
+        len++;
+
+        bubbleUp(els, len);
+    }else if (dist < els[len - 1]->dist){
+        el->dist = dist;
+        els[len - 1]   = el;
+
+        bubbleUp(els, len);
+    }
+
+    return len;
+}
+
 static void bubbleUp(bor_nn_linear_el_t **els, size_t len)
 {
     size_t i;
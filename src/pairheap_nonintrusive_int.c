@@ -40,12 +40,13 @@ bor_pairheap_nonintr_int_t *borPairHeapNonIntrIntNew(void)
 
     heap = BOR_ALLOC(bor_pairheap_nonintr_int_t);
     borListInit(&heap->root);
+    heap->nodes = borMemPoolNew(BOR_MEMPOOL_SINGLE_THREAD);
     return heap;
 }
 
 void borPairHeapNonIntrIntDel(bor_pairheap_nonintr_int_t *ph)
 {
-    borPairHeapNonIntrIntClear(ph);
+    borMemPoolDel(ph->nodes);
     BOR_FREE(ph);
 }
 
@@ -67,7 +68,7 @@ void borPairHeapNonIntrIntAdd(bor_pairheap_nonintr_int_t *ph,
 {
     node_t *node;
 
-    node = BOR_ALLOC(node_t);
+    node = BOR_POOL_ALLOC(ph->nodes, node_t);
     node->key = key;
     node->data = data;
     borListInit(&node->children);
@@ -92,32 +93,13 @@ void *borPairHeapNonIntrIntExtractMin(bor_pairheap_nonintr_int_t *ph, int *key)
     return data;
 }
 
-static void recursiveClear(node_t *node)
-{
-    bor_list_t *lnode, *ltmp;
-    node_t *ch_node;
-
-    BOR_LIST_FOR_EACH_SAFE(&node->children, lnode, ltmp){
-        ch_node = BOR_LIST_ENTRY(lnode, node_t, list);
-        recursiveClear(ch_node);
-    }
-
-    borListDel(&node->list);
-    BOR_FREE(node);
-}
-
 void borPairHeapNonIntrIntClear(bor_pairheap_nonintr_int_t *ph)
 {
-    bor_list_t *lnode, *ltmp;
-    node_t *node;
-
-    BOR_LIST_FOR_EACH_SAFE(&ph->root, lnode, ltmp){
-        node = BOR_LIST_ENTRY(lnode, node_t, list);
-        recursiveClear(node);
-    }
+    /* all nodes live in the pool, so there is no need to visit them */
+    borMemPoolReset(ph->nodes);
+    borListInit(&ph->root);
 }
 
-
 static node_t *minNode(bor_pairheap_nonintr_int_t *ph)
 {
     node_t *el;
@@ -156,7 +138,7 @@ static void removeNode(bor_pairheap_nonintr_int_t *ph,
 
     // remove n itself
     borListDel(&node->list);
-    BOR_FREE(node);
+    BOR_POOL_FREE(ph->nodes, node_t, node);
 }
 
 void consolidate(bor_pairheap_nonintr_int_t *ph)
@@ -0,0 +1,182 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include <string.h>
+#include <boruvka/parallel.h>
+#include <boruvka/alloc.h>
+
+struct _parallel_t {
+    size_t next;    /*!< First unclaimed index */
+    size_t to;      /*!< End of range */
+    size_t grain;   /*!< Minimal size of chunk */
+    size_t threads; /*!< Number of threads sharing the range */
+
+    bor_parallel_for_fn fn;
+    bor_parallel_reduce_fn reduce;
+    char *accs;      /*!< Per-thread accumulators */
+    size_t acc_size;
+    void *data;
+};
+typedef struct _parallel_t parallel_t;
+
+/** Returns number of threads that should be used for the range */
+static size_t parallelThreads(bor_task_pool_t *tp, size_t len, size_t grain);
+/** Claims next chunk of range, returns 0 if nothing is left */
+static int parallelClaim(parallel_t *p, size_t *from, size_t *to);
+static void parallelForTask(int id, void *data,
+                            const bor_task_pool_thinfo_t *thinfo);
+static void parallelReduceTask(int id, void *data,
+                               const bor_task_pool_thinfo_t *thinfo);
+/** Runs {task} on {threads} threads and waits for them */
+static void parallelRun(bor_task_pool_t *tp, size_t threads,
+                        bor_task_pool_fn task, parallel_t *p);
+
+void borParallelFor(bor_task_pool_t *tp, size_t from, size_t to,
+                    size_t grain, bor_parallel_for_fn fn, void *data)
+{
+    bor_task_pool_thinfo_t thinfo;
+    parallel_t p;
+    size_t threads;
+
+    if (from >= to)
+        return;
+    if (grain == 0)
+        grain = 1;
+
+    threads = parallelThreads(tp, to - from, grain);
+    if (threads <= 1){
+        thinfo.id = 0;
+        fn(from, to, data, &thinfo);
+        return;
+    }
+
+    p.next    = from;
+    p.to      = to;
+    p.grain   = grain;
+    p.threads = threads;
+    p.fn      = fn;
+    p.data    = data;
+    parallelRun(tp, threads, parallelForTask, &p);
+}
+
+void borParallelReduce(bor_task_pool_t *tp, size_t from, size_t to,
+                       size_t grain, void *acc, size_t acc_size,
+                       bor_parallel_reduce_fn fn, bor_parallel_join_fn join,
+                       void *data)
+{
+    bor_task_pool_thinfo_t thinfo;
+    parallel_t p;
+    size_t i, threads;
+
+    if (from >= to)
+        return;
+    if (grain == 0)
+        grain = 1;
+
+    threads = parallelThreads(tp, to - from, grain);
+    if (threads <= 1){
+        thinfo.id = 0;
+        fn(from, to, acc, data, &thinfo);
+        return;
+    }
+
+    p.next     = from;
+    p.to       = to;
+    p.grain    = grain;
+    p.threads  = threads;
+    p.reduce   = fn;
+    p.acc_size = acc_size;
+    p.data     = data;
+    p.accs     = BOR_ALLOC_ARR(char, acc_size * threads);
+    for (i = 0; i < threads; i++)
+        memcpy(p.accs + i * acc_size, acc, acc_size);
+
+    parallelRun(tp, threads, parallelReduceTask, &p);
+
+    for (i = 0; i < threads; i++)
+        join(acc, p.accs + i * acc_size, data);
+    BOR_FREE(p.accs);
+}
+
+
+static size_t parallelThreads(bor_task_pool_t *tp, size_t len, size_t grain)
+{
+    size_t threads;
+
+    if (!tp)
+        return 1;
+
+    threads = borTaskPoolSize(tp);
+    if (threads > (len + grain - 1) / grain)
+        threads = (len + grain - 1) / grain;
+    return threads;
+}
+
+static int parallelClaim(parallel_t *p, size_t *from, size_t *to)
+{
+    size_t cur, rest, len;
+
+    cur = __atomic_load_n(&p->next, __ATOMIC_RELAXED);
+    do {
+        if (cur >= p->to)
+            return 0;
+
+        rest = p->to - cur;
+        len  = rest / (2 * p->threads);
+        if (len < p->grain)
+            len = p->grain;
+        if (len > rest)
+            len = rest;
+    } while (!__atomic_compare_exchange_n(&p->next, &cur, cur + len, 1,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    *from = cur;
+    *to   = cur + len;
+    return 1;
+}
+
+static void parallelForTask(int id, void *data,
+                            const bor_task_pool_thinfo_t *thinfo)
+{
+    parallel_t *p = (parallel_t *)data;
+    size_t from, to;
+
+    while (parallelClaim(p, &from, &to))
+        p->fn(from, to, p->data, thinfo);
+}
+
+static void parallelReduceTask(int id, void *data,
+                               const bor_task_pool_thinfo_t *thinfo)
+{
+    parallel_t *p = (parallel_t *)data;
+    void *acc = p->accs + id * p->acc_size;
+    size_t from, to;
+
+    while (parallelClaim(p, &from, &to))
+        p->reduce(from, to, acc, p->data, thinfo);
+}
+
+static void parallelRun(bor_task_pool_t *tp, size_t threads,
+                        bor_task_pool_fn task, parallel_t *p)
+{
+    size_t i;
+
+    for (i = 0; i < threads; i++)
+        borTaskPoolAdd(tp, i, task, i, (void *)p);
+    for (i = 0; i < threads; i++)
+        borTaskPoolBarrier(tp, i);
+}
@@ -24,6 +24,28 @@
 #include <boruvka/parse.h>
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
+#include <boruvka/parallel.h>
+
+/** Minimal number of points processed by one chunk of parallel loop */
+#define PAR_GRAIN 4096
+
+/** Table of memory chunks allowing random access from parallel loops */
+struct _pc_chunks_t {
+    const bor_pc_t *pc;
+    bor_pc_mem_t **mem; /*!< Memory chunks in order */
+    size_t *start;      /*!< Index of first point in each chunk */
+    size_t len;         /*!< Number of chunks */
+    size_t elsize;      /*!< Size of one point in bytes */
+};
+typedef struct _pc_chunks_t pc_chunks_t;
+
+static void pcChunksInit(pc_chunks_t *c, const bor_pc_t *pc);
+static void pcChunksFree(pc_chunks_t *c);
+/** Returns index of chunk containing {i}'th point */
+static size_t pcChunksFind(const pc_chunks_t *c, size_t i);
+
+/** Parallel version of borPCPermutate() */
+static void pcPermutatePar(bor_pc_t *pc);
 
 
 bor_pc_t *borPCNew(size_t dim)
@@ -43,6 +65,7 @@ bor_pc_t *borPCNew2(size_t dim, size_t min_chunk_size)
     pc->min_chunk_size = min_chunk_size;
 
     pc->rand = NULL;
+    pc->tp   = NULL;
 
     return pc;
 
@@ -146,6 +169,11 @@ void borPCPermutate(bor_pc_t *pc)
         pc->rand = borRandMTNewAuto();
     }
 
+    if (pc->tp && borTaskPoolSize(pc->tp) > 1 && pc->len > PAR_GRAIN){
+        pcPermutatePar(pc);
+        return;
+    }
+
     pc_len = pc->len;
 
     v = borVecNew(pc->dim);
@@ -247,27 +275,182 @@ size_t borPCAddFromFile(bor_pc_t *pc, const char *filename)
     return added;
 }
 
+static void aabbReduce(size_t from, size_t to, void *acc, void *data,
+                       const bor_task_pool_thinfo_t *thinfo)
+{
+    const pc_chunks_t *c = (const pc_chunks_t *)data;
+    bor_real_t *aabb = (bor_real_t *)acc;
+    const bor_vec_t *v;
+    size_t i, ch, pos, d, dim = c->pc->dim;
+
+    ch  = pcChunksFind(c, from);
+    pos = from - c->start[ch];
+    for (i = from; i < to; i++, pos++){
+        if (pos >= c->mem[ch]->len){
+            ch++;
+            pos = 0;
+        }
+
+        v = borPCMemGet2(c->mem[ch], pos, bor_vec_t, c->elsize);
+        for (d = 0; d < dim; d++){
+            if (borVecGet(v, d) < aabb[2 * d])
+                aabb[2 * d] = borVecGet(v, d);
+            if (borVecGet(v, d) > aabb[2 * d + 1])
+                aabb[2 * d + 1] = borVecGet(v, d);
+        }
+    }
+}
+
+static void aabbJoin(void *acc, const void *acc2, void *data)
+{
+    const pc_chunks_t *c = (const pc_chunks_t *)data;
+    bor_real_t *aabb = (bor_real_t *)acc;
+    const bor_real_t *aabb2 = (const bor_real_t *)acc2;
+    size_t d;
+
+    for (d = 0; d < c->pc->dim; d++){
+        aabb[2 * d]     = BOR_MIN(aabb[2 * d], aabb2[2 * d]);
+        aabb[2 * d + 1] = BOR_MAX(aabb[2 * d + 1], aabb2[2 * d + 1]);
+    }
+}
+
 void borPCAABB(const bor_pc_t *pc, bor_real_t *aabb)
 {
+    pc_chunks_t c;
     size_t i;
-    bor_pc_it_t it;
-    const bor_vec_t *v;
 
     for (i = 0; i < pc->dim; i++){
         aabb[2 * i] = BOR_REAL_MAX;
         aabb[2 * i + 1] = -BOR_REAL_MAX;
     }
 
-    borPCItInit(&it, (bor_pc_t *)pc);
-    while (!borPCItEnd(&it)){
-        v = borPCItGet(&it);
-        for (i = 0; i < pc->dim; i++){
-            if (borVecGet(v, i) < aabb[2 * i])
-                aabb[2 * i] = borVecGet(v, i);
-            if (borVecGet(v, i) > aabb[2 * i + 1])
-                aabb[2 * i + 1] = borVecGet(v, i);
+    if (pc->len == 0)
+        return;
+
+    pcChunksInit(&c, pc);
+    borParallelReduce(pc->tp, 0, pc->len, PAR_GRAIN,
+                      aabb, sizeof(bor_real_t) * 2 * pc->dim,
+                      aabbReduce, aabbJoin, &c);
+    pcChunksFree(&c);
+}
+
+
+
+static void pcChunksInit(pc_chunks_t *c, const bor_pc_t *pc)
+{
+    bor_list_t *item;
+    bor_pc_mem_t *mem;
+    size_t start;
+
+    c->pc     = pc;
+    c->len    = borListSize(&pc->head);
+    c->mem    = BOR_ALLOC_ARR(bor_pc_mem_t *, c->len);
+    c->start  = BOR_ALLOC_ARR(size_t, c->len);
+    c->elsize = sizeof(bor_vec_t) * pc->dim;
+
+    c->len = 0;
+    start  = 0;
+    BOR_LIST_FOR_EACH(&pc->head, item){
+        mem = BOR_LIST_ENTRY(item, bor_pc_mem_t, list);
+        c->mem[c->len]   = mem;
+        c->start[c->len] = start;
+        start += mem->len;
+        c->len++;
+    }
+}
+
+static void pcChunksFree(pc_chunks_t *c)
+{
+    BOR_FREE(c->mem);
+    BOR_FREE(c->start);
+}
+
+static size_t pcChunksFind(const pc_chunks_t *c, size_t i)
+{
+    size_t lo = 0, hi = c->len, mid;
+
+    // last chunk with start <= i
+    while (hi - lo > 1){
+        mid = (lo + hi) / 2;
+        if (c->start[mid] <= i){
+            lo = mid;
+        }else{
+            hi = mid;
         }
+    }
+    return lo;
+}
+
+struct _permutate_t {
+    pc_chunks_t chunks;
+    const size_t *perm; /*!< Source index of each point */
+    char *tmp;          /*!< Temporary copy of points */
+};
+typedef struct _permutate_t permutate_t;
 
-        borPCItNext(&it);
+/** Copies points to .tmp in permutated order */
+static void permutateGather(size_t from, size_t to, void *data,
+                            const bor_task_pool_thinfo_t *thinfo)
+{
+    permutate_t *p = (permutate_t *)data;
+    const pc_chunks_t *c = &p->chunks;
+    const bor_vec_t *v;
+    size_t i, src, ch;
+
+    for (i = from; i < to; i++){
+        src = p->perm[i];
+        ch  = pcChunksFind(c, src);
+        v   = borPCMemGet2(c->mem[ch], src - c->start[ch],
+                           bor_vec_t, c->elsize);
+        memcpy(p->tmp + i * c->elsize, v, c->elsize);
     }
 }
+
+/** Copies points from .tmp back to point cloud */
+static void permutateScatter(size_t from, size_t to, void *data,
+                             const bor_task_pool_thinfo_t *thinfo)
+{
+    permutate_t *p = (permutate_t *)data;
+    const pc_chunks_t *c = &p->chunks;
+    size_t ch, pos, len;
+
+    ch  = pcChunksFind(c, from);
+    pos = from - c->start[ch];
+    while (from < to){
+        len = BOR_MIN(c->mem[ch]->len - pos, to - from);
+        memcpy(borPCMemGet2(c->mem[ch], pos, char, c->elsize),
+               p->tmp + from * c->elsize, len * c->elsize);
+        from += len;
+        ch++;
+        pos = 0;
+    }
+}
+
+static void pcPermutatePar(bor_pc_t *pc)
+{
+    permutate_t p;
+    size_t *perm, i, j, tmp;
+
+    // The same sequence of swaps as in serial version but applied on
+    // indices, points are then moved in parallel.
+    perm = BOR_ALLOC_ARR(size_t, pc->len);
+    for (i = 0; i < pc->len; i++)
+        perm[i] = i;
+    for (i = 0; i + 1 < pc->len; i++){
+        j = borRandMT(pc->rand, (bor_real_t)(i + 1), (bor_real_t)pc->len);
+        if (j >= pc->len)
+            j = pc->len - 1;
+        BOR_SWAP(perm[i], perm[j], tmp);
+    }
+
+    pcChunksInit(&p.chunks, pc);
+    p.perm = perm;
+    p.tmp  = BOR_ALLOC_ARR(char, pc->len * p.chunks.elsize);
+
+    borParallelFor(pc->tp, 0, pc->len, PAR_GRAIN, permutateGather, &p);
+    borParallelFor(pc->tp, 0, pc->len, PAR_GRAIN, permutateScatter, &p);
+
+    BOR_FREE(p.tmp);
+    pcChunksFree(&p.chunks);
+    BOR_FREE(perm);
+}
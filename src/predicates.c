@@ -2620,3 +2620,314 @@ REAL borPredInSphere(const bor_pred_t *pred,
 
   return insphereadapt(pred, pa, pb, pc, pd, pe, permanent);
 }
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Batch predicates.                                                        */
+/*                                                                           */
+/*  Queries are processed in blocks of BATCH_LANES. Coordinates of a block   */
+/*  are gathered into separate arrays (the last block is padded by copies of */
+/*  its first query) and the floating-point filter is computed by loops      */
+/*  without branches over all lanes of the block, which the compiler turns   */
+/*  into SIMD code. The arithmetic of each lane is exactly the same as in    */
+/*  the single-query functions above, so the error bounds stay valid. Lanes  */
+/*  the filter can't decide are passed to the adaptive routines.             */
+/*                                                                           */
+/*****************************************************************************/
+
+#define BATCH_LANES 8
+
+size_t borPredOrient2dBatch(const bor_pred_t *pred,
+                            const bor_vec2_t *pa,
+                            const bor_vec2_t *pb,
+                            const bor_vec2_t *pc, size_t n,
+                            bor_real_t *res)
+{
+  REAL cx[BATCH_LANES], cy[BATCH_LANES];
+  REAL det[BATCH_LANES], detsum[BATCH_LANES];
+  REAL ax, ay, bx, by, acx, bcx, acy, bcy, detleft, detright;
+  size_t i, j, k, len, exact = 0;
+
+  ax = borVec2X(pa);
+  ay = borVec2Y(pa);
+  bx = borVec2X(pb);
+  by = borVec2Y(pb);
+
+  for (i = 0; i < n; i += BATCH_LANES) {
+    len = (n - i < BATCH_LANES ? n - i : BATCH_LANES);
+    for (j = 0; j < BATCH_LANES; j++) {
+      k = i + (j < len ? j : 0);
+      cx[j] = borVec2X(&pc[k]);
+      cy[j] = borVec2Y(&pc[k]);
+    }
+
+    /* Operands of opposite signs (or zero) can't cancel, so the sign is  */
+    /*   certain whenever |det| >= ccwerrboundA * (|left| + |right|).     */
+    for (j = 0; j < BATCH_LANES; j++) {
+      acx = ax - cx[j];
+      bcx = bx - cx[j];
+      acy = ay - cy[j];
+      bcy = by - cy[j];
+      detleft = acx * bcy;
+      detright = acy * bcx;
+      det[j] = detleft - detright;
+      detsum[j] = Absolute(detleft) + Absolute(detright);
+    }
+
+    for (j = 0; j < len; j++) {
+      if ((det[j] >= pred->ccwerrboundA * detsum[j])
+            || (-det[j] >= pred->ccwerrboundA * detsum[j])) {
+        res[i + j] = det[j];
+      } else {
+        res[i + j] = orient2dadapt(pred, pa, pb, &pc[i + j], detsum[j]);
+        exact++;
+      }
+    }
+  }
+
+  return exact;
+}
+
+size_t borPredOrient3dBatch(const bor_pred_t *pred,
+                            const bor_vec3_t *pa,
+                            const bor_vec3_t *pb,
+                            const bor_vec3_t *pc,
+                            const bor_vec3_t *pd, size_t n,
+                            bor_real_t *res)
+{
+  REAL dx[BATCH_LANES], dy[BATCH_LANES], dz[BATCH_LANES];
+  REAL det[BATCH_LANES], permanent[BATCH_LANES];
+  REAL adx, bdx, cdx, ady, bdy, cdy, adz, bdz, cdz;
+  REAL bdxcdy, cdxbdy, cdxady, adxcdy, adxbdy, bdxady;
+  REAL errbound;
+  size_t i, j, k, len, exact = 0;
+
+  for (i = 0; i < n; i += BATCH_LANES) {
+    len = (n - i < BATCH_LANES ? n - i : BATCH_LANES);
+    for (j = 0; j < BATCH_LANES; j++) {
+      k = i + (j < len ? j : 0);
+      dx[j] = borVec3X(&pd[k]);
+      dy[j] = borVec3Y(&pd[k]);
+      dz[j] = borVec3Z(&pd[k]);
+    }
+
+    for (j = 0; j < BATCH_LANES; j++) {
+      adx = borVec3X(pa) - dx[j];
+      bdx = borVec3X(pb) - dx[j];
+      cdx = borVec3X(pc) - dx[j];
+      ady = borVec3Y(pa) - dy[j];
+      bdy = borVec3Y(pb) - dy[j];
+      cdy = borVec3Y(pc) - dy[j];
+      adz = borVec3Z(pa) - dz[j];
+      bdz = borVec3Z(pb) - dz[j];
+      cdz = borVec3Z(pc) - dz[j];
+
+      bdxcdy = bdx * cdy;
+      cdxbdy = cdx * bdy;
+
+      cdxady = cdx * ady;
+      adxcdy = adx * cdy;
+
+      adxbdy = adx * bdy;
+      bdxady = bdx * ady;
+
+      det[j] = adz * (bdxcdy - cdxbdy)
+             + bdz * (cdxady - adxcdy)
+             + cdz * (adxbdy - bdxady);
+
+      permanent[j] = (Absolute(bdxcdy) + Absolute(cdxbdy)) * Absolute(adz)
+                   + (Absolute(cdxady) + Absolute(adxcdy)) * Absolute(bdz)
+                   + (Absolute(adxbdy) + Absolute(bdxady)) * Absolute(cdz);
+    }
+
+    for (j = 0; j < len; j++) {
+      errbound = pred->o3derrboundA * permanent[j];
+      if ((det[j] > errbound) || (-det[j] > errbound)) {
+        res[i + j] = det[j];
+      } else {
+        res[i + j] = orient3dadapt(pred, pa, pb, pc, &pd[i + j],
+                                   permanent[j]);
+        exact++;
+      }
+    }
+  }
+
+  return exact;
+}
+
+size_t borPredInCircleBatch(const bor_pred_t *pred,
+                            const bor_vec2_t *pa,
+                            const bor_vec2_t *pb,
+                            const bor_vec2_t *pc,
+                            const bor_vec2_t *pd, size_t n,
+                            bor_real_t *res)
+{
+  REAL dx[BATCH_LANES], dy[BATCH_LANES];
+  REAL det[BATCH_LANES], permanent[BATCH_LANES];
+  REAL adx, bdx, cdx, ady, bdy, cdy;
+  REAL bdxcdy, cdxbdy, cdxady, adxcdy, adxbdy, bdxady;
+  REAL alift, blift, clift;
+  REAL errbound;
+  size_t i, j, k, len, exact = 0;
+
+  for (i = 0; i < n; i += BATCH_LANES) {
+    len = (n - i < BATCH_LANES ? n - i : BATCH_LANES);
+    for (j = 0; j < BATCH_LANES; j++) {
+      k = i + (j < len ? j : 0);
+      dx[j] = borVec2X(&pd[k]);
+      dy[j] = borVec2Y(&pd[k]);
+    }
+
+    for (j = 0; j < BATCH_LANES; j++) {
+      adx = borVec2X(pa) - dx[j];
+      bdx = borVec2X(pb) - dx[j];
+      cdx = borVec2X(pc) - dx[j];
+      ady = borVec2Y(pa) - dy[j];
+      bdy = borVec2Y(pb) - dy[j];
+      cdy = borVec2Y(pc) - dy[j];
+
+      bdxcdy = bdx * cdy;
+      cdxbdy = cdx * bdy;
+      alift = adx * adx + ady * ady;
+
+      cdxady = cdx * ady;
+      adxcdy = adx * cdy;
+      blift = bdx * bdx + bdy * bdy;
+
+      adxbdy = adx * bdy;
+      bdxady = bdx * ady;
+      clift = cdx * cdx + cdy * cdy;
+
+      det[j] = alift * (bdxcdy - cdxbdy)
+             + blift * (cdxady - adxcdy)
+             + clift * (adxbdy - bdxady);
+
+      permanent[j] = (Absolute(bdxcdy) + Absolute(cdxbdy)) * alift
+                   + (Absolute(cdxady) + Absolute(adxcdy)) * blift
+                   + (Absolute(adxbdy) + Absolute(bdxady)) * clift;
+    }
+
+    for (j = 0; j < len; j++) {
+      errbound = pred->iccerrboundA * permanent[j];
+      if ((det[j] > errbound) || (-det[j] > errbound)) {
+        res[i + j] = det[j];
+      } else {
+        res[i + j] = incircleadapt(pred, pa, pb, pc, &pd[i + j],
+                                   permanent[j]);
+        exact++;
+      }
+    }
+  }
+
+  return exact;
+}
+
+size_t borPredInSphereBatch(const bor_pred_t *pred,
+                            const bor_vec3_t *pa,
+                            const bor_vec3_t *pb,
+                            const bor_vec3_t *pc,
+                            const bor_vec3_t *pd,
+                            const bor_vec3_t *pe, size_t n,
+                            bor_real_t *res)
+{
+  REAL ex[BATCH_LANES], ey[BATCH_LANES], ez[BATCH_LANES];
+  REAL det[BATCH_LANES], permanent[BATCH_LANES];
+  REAL aex, bex, cex, dex;
+  REAL aey, bey, cey, dey;
+  REAL aez, bez, cez, dez;
+  REAL aexbey, bexaey, bexcey, cexbey, cexdey, dexcey, dexaey, aexdey;
+  REAL aexcey, cexaey, bexdey, dexbey;
+  REAL alift, blift, clift, dlift;
+  REAL ab, bc, cd, da, ac, bd;
+  REAL abc, bcd, cda, dab;
+  REAL errbound;
+  size_t i, j, k, len, exact = 0;
+
+  for (i = 0; i < n; i += BATCH_LANES) {
+    len = (n - i < BATCH_LANES ? n - i : BATCH_LANES);
+    for (j = 0; j < BATCH_LANES; j++) {
+      k = i + (j < len ? j : 0);
+      ex[j] = borVec3X(&pe[k]);
+      ey[j] = borVec3Y(&pe[k]);
+      ez[j] = borVec3Z(&pe[k]);
+    }
+
+    for (j = 0; j < BATCH_LANES; j++) {
+      aex = borVec3X(pa) - ex[j];
+      bex = borVec3X(pb) - ex[j];
+      cex = borVec3X(pc) - ex[j];
+      dex = borVec3X(pd) - ex[j];
+      aey = borVec3Y(pa) - ey[j];
+      bey = borVec3Y(pb) - ey[j];
+      cey = borVec3Y(pc) - ey[j];
+      dey = borVec3Y(pd) - ey[j];
+      aez = borVec3Z(pa) - ez[j];
+      bez = borVec3Z(pb) - ez[j];
+      cez = borVec3Z(pc) - ez[j];
+      dez = borVec3Z(pd) - ez[j];
+
+      aexbey = aex * bey;
+      bexaey = bex * aey;
+      ab = aexbey - bexaey;
+      bexcey = bex * cey;
+      cexbey = cex * bey;
+      bc = bexcey - cexbey;
+      cexdey = cex * dey;
+      dexcey = dex * cey;
+      cd = cexdey - dexcey;
+      dexaey = dex * aey;
+      aexdey = aex * dey;
+      da = dexaey - aexdey;
+
+      aexcey = aex * cey;
+      cexaey = cex * aey;
+      ac = aexcey - cexaey;
+      bexdey = bex * dey;
+      dexbey = dex * bey;
+      bd = bexdey - dexbey;
+
+      abc = aez * bc - bez * ac + cez * ab;
+      bcd = bez * cd - cez * bd + dez * bc;
+      cda = cez * da + dez * ac + aez * cd;
+      dab = dez * ab + aez * bd + bez * da;
+
+      alift = aex * aex + aey * aey + aez * aez;
+      blift = bex * bex + bey * bey + bez * bez;
+      clift = cex * cex + cey * cey + cez * cez;
+      dlift = dex * dex + dey * dey + dez * dez;
+
+      det[j] = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+      permanent[j] = ((Absolute(cexdey) + Absolute(dexcey)) * Absolute(bez)
+                      + (Absolute(dexbey) + Absolute(bexdey)) * Absolute(cez)
+                      + (Absolute(bexcey) + Absolute(cexbey)) * Absolute(dez))
+                   * alift
+                   + ((Absolute(dexaey) + Absolute(aexdey)) * Absolute(cez)
+                      + (Absolute(aexcey) + Absolute(cexaey)) * Absolute(dez)
+                      + (Absolute(cexdey) + Absolute(dexcey)) * Absolute(aez))
+                   * blift
+                   + ((Absolute(aexbey) + Absolute(bexaey)) * Absolute(dez)
+                      + (Absolute(bexdey) + Absolute(dexbey)) * Absolute(aez)
+                      + (Absolute(dexaey) + Absolute(aexdey)) * Absolute(bez))
+                   * clift
+                   + ((Absolute(bexcey) + Absolute(cexbey)) * Absolute(aez)
+                      + (Absolute(cexaey) + Absolute(aexcey)) * Absolute(bez)
+                      + (Absolute(aexbey) + Absolute(bexaey)) * Absolute(cez))
+                   * dlift;
+    }
+
+    for (j = 0; j < len; j++) {
+      errbound = pred->isperrboundA * permanent[j];
+      if ((det[j] > errbound) || (-det[j] > errbound)) {
+        res[i + j] = det[j];
+      } else {
+        res[i + j] = insphereadapt(pred, pa, pb, pc, pd, &pe[i + j],
+                                   permanent[j]);
+        exact++;
+      }
+    }
+  }
+
+  return exact;
+}
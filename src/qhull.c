@@ -1,35 +1,52 @@
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
+#include <spawn.h>
 #include <sys/wait.h>
 #include <boruvka/qhull.h>
+#include <boruvka/delaunay.h>
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
 
 
-/** Maximal length of line  */
-#define BOR_QHULL_OUTPUT_LINE_MAX_LEN 1024
+extern char **environ;
 
-/** Creates new qhull mesh3 */
-static bor_qhull_mesh3_t *borQHullMesh3New(size_t vertices);
+/** vvvv */
+/** Size of I/O buffer of qdelaunay bridge */
+#define BOR_QHULL_BUF_SIZE (1024 * 1024)
+/** Maximal length of one number on qhull's input or output */
+#define BOR_QHULL_NUM_MAX_LEN 32
+/** ^^^^ */
 
-/** Deletes dymanically allocated vertices, edges and faces */
-static void mesh3DelVert(bor_mesh3_vertex_t *v, void *data);
-static void mesh3DelEdge(bor_mesh3_edge_t *e, void *data);
-static void mesh3DelFace(bor_mesh3_face_t *f, void *data);
+/** Buffered reader of qhull's output */
+struct _reader_t {
+    int fd;
+    char *buf, *pos, *end;
+    size_t size;
+    int eof;
+};
+typedef struct _reader_t reader_t;
 
 /** Writes point cloud into fd in format qhull accepts.
  *  Returns 0 on success */
-static int writePC33(bor_pc_t *pc, int fd);
-/** Parses input from fd into Mesh3 */
-static bor_qhull_mesh3_t *qdelaunayToMesh3(int fd);
+static int writePC33(bor_qdelaunay_t *q, const bor_pc_t *pc, int fd);
+/** Parses output of qdelaunay from fd into Mesh3 with vertices from pc */
+static bor_qhull_mesh3_t *qdelaunayToMesh3(bor_qdelaunay_t *q,
+                                           const bor_pc_t *pc, int fd);
 
 
 void borQHullMesh3Del(bor_qhull_mesh3_t *m)
 {
     if (m->mesh){
-        borMesh3Del2(m->mesh, mesh3DelVert, NULL,
-                              mesh3DelEdge, NULL,
-                              mesh3DelFace, NULL);
+        // elements living in the pool are released all at once below
+        if (m->pool){
+            borMesh3DelShallow(m->mesh);
+        }else{
+            borMesh3Del(m->mesh);
+        }
+    }
+    if (m->pool){
+        borMemPoolDel(m->pool);
     }
 
     if (m->vecs){
@@ -47,6 +64,7 @@ bor_qdelaunay_t *borQDelaunayNew(void)
     q = BOR_ALLOC(bor_qdelaunay_t);
 
     q->bin_path = BOR_STRDUP(BOR_QDELAUNAY_BIN_PATH);
+    q->buf = NULL;
 
     return q;
 }
@@ -55,6 +73,8 @@ void borQDelaunayDel(bor_qdelaunay_t *q)
 {
     if (q->bin_path)
         BOR_FREE(q->bin_path);
+    if (q->buf)
+        BOR_FREE(q->buf);
     BOR_FREE(q);
 }
 
@@ -65,77 +85,86 @@ void borQDelaunaySetPath(bor_qdelaunay_t *q, const char *path)
     q->bin_path = BOR_STRDUP(path);
 }
 
+/** Spawns qdelaunay with stdin and stdout connected to given fds.
+ *  Returns pid of the child or -1 on error. */
+static pid_t spawnQDelaunay(bor_qdelaunay_t *q, int pipe_points[2],
+                            int pipe_result[2])
+{
+    posix_spawn_file_actions_t fa;
+    char *argv[] = { q->bin_path, "Qt", "i", NULL };
+    pid_t pid;
+    int ret;
+
+    // posix_spawn() does not duplicate address space of the caller (as
+    // fork() does) so the cost of starting qdelaunay does not depend on
+    // the size of this process
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, pipe_points[0], 0);
+    posix_spawn_file_actions_adddup2(&fa, pipe_result[1], 1);
+    posix_spawn_file_actions_addclose(&fa, pipe_points[0]);
+    posix_spawn_file_actions_addclose(&fa, pipe_points[1]);
+    posix_spawn_file_actions_addclose(&fa, pipe_result[0]);
+    posix_spawn_file_actions_addclose(&fa, pipe_result[1]);
+
+    ret = posix_spawn(&pid, q->bin_path, &fa, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&fa);
+
+    if (ret != 0){
+        ERR("posix_spawn(\"%s\") failed: %s", q->bin_path, strerror(ret));
+        return -1;
+    }
+    return pid;
+}
+
 bor_qhull_mesh3_t *borQDelaunayMesh3(bor_qdelaunay_t *q, const bor_pc_t *pc)
 {
     int pipe_points[2];
     int pipe_result[2];
-    int pid;
+    pid_t pid;
     bor_qhull_mesh3_t *mesh;
 
+    if (!q->bin_path || access(q->bin_path, X_OK) != 0)
+        return borDelaunayMesh3(pc);
+
+    if (!q->buf)
+        q->buf = BOR_ALLOC_ARR(char, BOR_QHULL_BUF_SIZE);
+
     // open pipes for communication between qdelaunay program and this
     // program
-    if (pipe(pipe_points) != 0
-            || pipe(pipe_result) != 0){
+    if (pipe(pipe_points) != 0){
         ERR2("Can't open pipes.\n");
         return NULL;
     }
-
-    // fork process - child process will run qdelaunay
-    pid = fork();
-    if (pid == 0){
-        // child process
-
-        // close write end of points pipe and read end of result pipe
-        close(pipe_points[1]);
-        close(pipe_result[0]);
-
-        // duplicate read end of pipe_points to stdin
-        if (dup2(pipe_points[0], 0) != 0){
-            ERR2("Can't connect pipe to stdin!");
-            exit(-1);
-        }
-
-        // and duplicate write end of pipe_result to stdout
-        if (dup2(pipe_result[1], 1) != 1){
-            perror("");
-            ERR2("Can't connect pipe to stdout!");
-            exit(-1);
-        }
-
-        execl(q->bin_path, q->bin_path, "o", NULL);
-
-        perror("");
-        ERR("execl(\"%s\", \"%s\", \"o\") failed!", q->bin_path, q->bin_path);
-        exit(-1);
-
-    }else if (pid < 0){
-        ERR2("Fork failed!\n");
+    if (pipe(pipe_result) != 0){
+        ERR2("Can't open pipes.\n");
         close(pipe_points[0]);
         close(pipe_points[1]);
-        close(pipe_result[0]);
-        close(pipe_result[1]);
         return NULL;
     }
 
-    // parent process
+    pid = spawnQDelaunay(q, pipe_points, pipe_result);
 
-    // close read end of pipe_points
+    // close read end of pipe_points and write end of pipe_result
     close(pipe_points[0]);
-    // and write end of pipe_result
     close(pipe_result[1]);
 
-    // write points on qdelaunay stdin
-    if (writePC33((bor_pc_t *)pc, pipe_points[1]) != 0){
-        ERR2("Can't open write end of pipe using stdio.");
+    if (pid < 0){
         close(pipe_points[1]);
+        close(pipe_result[0]);
+        return NULL;
     }
 
+    // write points on qdelaunay stdin -- qdelaunay reads whole input
+    // before it writes anything, so this can't deadlock
+    if (writePC33(q, pc, pipe_points[1]) != 0)
+        ERR2("Can't write points to qdelaunay.");
+    close(pipe_points[1]);
+
     // read result from qdelaunay
-    mesh = qdelaunayToMesh3(pipe_result[0]);
-    if (!mesh){
-        ERR2("Can't open read end of pipe using stdio.");
-        close(pipe_result[0]);
-    }
+    mesh = qdelaunayToMesh3(q, pc, pipe_result[0]);
+    if (!mesh)
+        ERR2("Can't read output of qdelaunay.");
+    close(pipe_result[0]);
 
     // wait for child process
     waitpid(pid, NULL, 0);
@@ -143,7 +172,7 @@ bor_qhull_mesh3_t *borQDelaunayMesh3(bor_qdelaunay_t *q, const bor_pc_t *pc)
     return mesh;
 }
 
-static bor_qhull_mesh3_t *borQHullMesh3New(size_t vertices)
+bor_qhull_mesh3_t *borQHullMesh3New(size_t vertices)
 {
     bor_qhull_mesh3_t *m;
 
@@ -154,113 +183,226 @@ static bor_qhull_mesh3_t *borQHullMesh3New(size_t vertices)
     m->vecs = borVec3ArrNew(vertices);
     m->vecs_len = vertices;
 
+    m->pool = borMemPoolNew(BOR_MEMPOOL_SINGLE_THREAD);
+
     return m;
 }
 
-static void mesh3DelVert(bor_mesh3_vertex_t *v, void *data)
+/** Writes whole buffer into fd */
+static int writeAll(int fd, const char *buf, size_t len)
 {
-    BOR_FREE(v);
+    ssize_t n;
+
+    while (len > 0){
+        n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
 }
 
-static void mesh3DelEdge(bor_mesh3_edge_t *e, void *data)
+/** Writes exact hexadecimal representation of x (as accepted by strtod())
+ *  into s and returns number of written characters. Contrary to decimal
+ *  formatting this needs no arithmetic and does not lose precision. */
+static int writeHexReal(char *s, double x)
 {
-    BOR_FREE(e);
-}
+    static const char digits[] = "0123456789abcdef";
+    uint64_t bits, man;
+    int exp, i, len;
+    char *start = s;
 
-static void mesh3DelFace(bor_mesh3_face_t *f, void *data)
-{
-    BOR_FREE(f);
+    memcpy(&bits, &x, sizeof(bits));
+    man = bits & ((1ull << 52) - 1);
+    exp = (int)((bits >> 52) & 0x7ff);
+
+    if (bits >> 63)
+        *s++ = '-';
+
+    if (exp == 0 && man == 0){
+        *s++ = '0';
+        return s - start;
+    }
+
+    *s++ = '0';
+    *s++ = 'x';
+    if (exp == 0){
+        // subnormal number
+        *s++ = '0';
+        exp = -1022;
+    }else{
+        *s++ = '1';
+        exp -= 1023;
+    }
+
+    if (man){
+        // 13 hex digits of mantissa without trailing zeros
+        for (len = 13; (man & 0xf) == 0; --len)
+            man >>= 4;
+        *s++ = '.';
+        for (i = len - 1; i >= 0; --i){
+            s[i] = digits[man & 0xf];
+            man >>= 4;
+        }
+        s += len;
+    }
+
+    *s++ = 'p';
+    if (exp < 0){
+        *s++ = '-';
+        exp = -exp;
+    }
+    if (exp >= 1000)
+        *s++ = '0' + exp / 1000;
+    if (exp >= 100)
+        *s++ = '0' + (exp / 100) % 10;
+    if (exp >= 10)
+        *s++ = '0' + (exp / 10) % 10;
+    *s++ = '0' + exp % 10;
+
+    return s - start;
 }
 
-static int writePC33(bor_pc_t *pc, int fd)
+static int writePC33(bor_qdelaunay_t *q, const bor_pc_t *pc, int fd)
 {
-    FILE *fout;
     bor_pc_it_t pcit;
-    bor_vec3_t *v;
-
-    fout = fdopen(fd, "w");
-    if (!fout)
-        return -1;
-
-    // first print dimensions
-    fprintf(fout, "3\n");
+    bor_vec_t *v;
+    char *buf = q->buf;
+    size_t len;
+    int i;
 
-    // then write number of points
-    fprintf(fout, "%d\n", (int)borPCLen(pc));
+    // dimension and number of points
+    len = sprintf(buf, "3\n%d\n", (int)borPCLen(pc));
 
-    // and write all points
     borPCItInit(&pcit, (bor_pc_t *)pc);
     while (!borPCItEnd(&pcit)){
-        v = (bor_vec3_t *)borPCItGet(&pcit);
-        fprintf(fout, "%g %g %g\n", borVec3X(v), borVec3Y(v), borVec3Z(v));
+        if (len + 3 * BOR_QHULL_NUM_MAX_LEN > BOR_QHULL_BUF_SIZE){
+            if (writeAll(fd, buf, len) != 0)
+                return -1;
+            len = 0;
+        }
+
+        v = borPCItGet(&pcit);
+        for (i = 0; i < 3; ++i){
+            len += writeHexReal(buf + len, borVecGet(v, i));
+            buf[len++] = (i == 2 ? '\n' : ' ');
+        }
 
         borPCItNext(&pcit);
     }
 
-    fclose(fout);
+    return writeAll(fd, buf, len);
+}
 
+/** Makes sure there is at least one whole number in the buffer unless
+ *  the end of input was reached */
+static void readerFill(reader_t *r)
+{
+    ssize_t n;
+    size_t len;
+
+    if (r->end - r->pos >= BOR_QHULL_NUM_MAX_LEN || r->eof)
+        return;
+
+    len = r->end - r->pos;
+    memmove(r->buf, r->pos, len);
+    r->pos = r->buf;
+    r->end = r->buf + len;
+
+    while (!r->eof && r->end - r->pos < BOR_QHULL_NUM_MAX_LEN){
+        n = read(r->fd, r->end, r->size - (r->end - r->buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0){
+            r->eof = 1;
+        }else{
+            r->end += n;
+        }
+    }
+}
+
+/** Parses next non-negative integer directly from the read buffer.
+ *  Returns 0 on success */
+static int readerInt(reader_t *r, int *val)
+{
+    int v;
+
+    while (1){
+        readerFill(r);
+        while (r->pos < r->end
+                && (*r->pos == ' ' || *r->pos == '\n'
+                        || *r->pos == '\r' || *r->pos == '\t'))
+            ++r->pos;
+        if (r->pos < r->end)
+            break;
+        if (r->eof)
+            return -1;
+    }
+
+    if (*r->pos < '0' || *r->pos > '9')
+        return -1;
+
+    for (v = 0; r->pos < r->end && *r->pos >= '0' && *r->pos <= '9'; ++r->pos)
+        v = 10 * v + (*r->pos - '0');
+    *val = v;
     return 0;
 }
 
-static bor_qhull_mesh3_t *qdelaunayToMesh3(int fd)
+static bor_qhull_mesh3_t *qdelaunayToMesh3(bor_qdelaunay_t *q,
+                                           const bor_pc_t *pc, int fd)
 {
-    FILE *fin;
-    int vertices, faces, tmp;
+    reader_t r;
+    int vertices, faces;
     int i, j, k;
-    double x, y, z, w;
     int id[4];
+    bor_pc_it_t pcit;
+    bor_vec_t *v;
     bor_qhull_mesh3_t *qmesh;
     bor_mesh3_t *mesh;
     bor_mesh3_vertex_t **verts;
     bor_mesh3_vertex_t *vert;
     bor_mesh3_edge_t *edge;
-    //bor_mesh3_face_t *face;
 
-    fin = fdopen(fd, "r");
-    if (!fin)
-        return NULL;
-
-    // first line is number of facets 
-    if (fscanf(fin, "%d", &tmp) != 1){
-        fclose(fin);
-        return NULL;
-    }
+    r.fd = fd;
+    r.buf = r.pos = r.end = q->buf;
+    r.size = BOR_QHULL_BUF_SIZE;
+    r.eof = 0;
 
-    // second line contains number of points, facets and ridges - the last
-    // one can be ignored
-    if (fscanf(fin, "%d %d %d", &vertices, &faces, &tmp) != 3){
-        fclose(fin);
+    // output of "qdelaunay i" starts with number of tetrahedra
+    if (readerInt(&r, &faces) != 0)
         return NULL;
-    }
 
-    // alloc mesh
+    // alloc mesh, vertices are taken directly from the point cloud
+    vertices = borPCLen(pc);
     qmesh = borQHullMesh3New(vertices);
     mesh = borQHullMesh3(qmesh);
 
     // allocate index array for vertices
-    verts = BOR_ALLOC_ARR(bor_mesh3_vertex_t *, vertices);
+    verts = BOR_ALLOC_ARR(bor_mesh3_vertex_t *, vertices + 1);
 
-    // read points and create vertices
-    for (i = 0; i < vertices; i++){
-        if (fscanf(fin, "%lg %lg %lg %lg", &x, &y, &z, &w) != 4){
-            break;
-        }
-
-        borVec3Set(&qmesh->vecs[i], x, y, z);
+    borPCItInit(&pcit, (bor_pc_t *)pc);
+    for (i = 0; i < vertices; i++, borPCItNext(&pcit)){
+        v = borPCItGet(&pcit);
+        borVec3Set(&qmesh->vecs[i], borVecGet(v, 0), borVecGet(v, 1),
+                                    borVecGet(v, 2));
 
-        vert = BOR_ALLOC(bor_mesh3_vertex_t);
+        vert = BOR_POOL_ALLOC(qmesh->pool, bor_mesh3_vertex_t);
         borMesh3VertexSetCoords(vert, &qmesh->vecs[i]);
         borMesh3AddVertex(mesh, vert);
         verts[i] = vert;
-
-        //fprintf(stdout, "[%d] %lg %lg %lg\n", i, x, y, z);
     }
 
-    // read tetrahedrons
+    // read tetrahedrons, each is given by indices of its four vertices
     for (i = 0; i < faces; i++){
-        if (fscanf(fin, "%d %d %d %d", &id[0], &id[1], &id[2], &id[3]) != 4){
-            break;
+        for (j = 0; j < 4; j++){
+            if (readerInt(&r, &id[j]) != 0 || id[j] >= vertices)
+                break;
         }
+        if (j < 4)
+            break;
 
         // create edges
         for (j = 0; j < 3; j++){
@@ -268,18 +410,15 @@ static bor_qhull_mesh3_t *qdelaunayToMesh3(int fd)
                 // create new edge only if it is not already there
                 edge = borMesh3VertexCommonEdge(verts[id[j]], verts[id[k]]);
                 if (!edge){
-                    edge = BOR_ALLOC(bor_mesh3_edge_t);
+                    edge = BOR_POOL_ALLOC(qmesh->pool, bor_mesh3_edge_t);
                     borMesh3AddEdge(mesh, edge, verts[id[j]], verts[id[k]]);
                 }
             }
         }
-
-        //fprintf(stdout, "[%d] %d %d %d %d\n", i, id[0], id[1], id[2], id[3]);
     }
 
     if (verts)
         BOR_FREE(verts);
 
-    fclose(fin);
     return qmesh;
 }
@@ -0,0 +1,81 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include <boruvka/radixheap.h>
+#include <boruvka/alloc.h>
+
+bor_radixheap_t *borRadixHeapNew(void)
+{
+    bor_radixheap_t *h;
+
+    h = BOR_ALLOC(bor_radixheap_t);
+    borRadixHeapClear(h);
+    return h;
+}
+
+void borRadixHeapDel(bor_radixheap_t *h)
+{
+    BOR_FREE(h);
+}
+
+void borRadixHeapClear(bor_radixheap_t *h)
+{
+    int i;
+
+    for (i = 0; i < BOR_RADIXHEAP_BUCKETS; ++i)
+        borListInit(&h->bucket[i]);
+    h->last = 0;
+    h->size = 0;
+}
+
+bor_radixheap_node_t *borRadixHeapExtractMin(bor_radixheap_t *h)
+{
+    bor_radixheap_node_t *n;
+    bor_list_t *item, *tmp, *bucket;
+    uint64_t min;
+    int i, b;
+
+    if (borListEmpty(&h->bucket[0])){
+        // find the first non-empty bucket
+        for (i = 1; borListEmpty(&h->bucket[i]); ++i);
+
+        bucket = &h->bucket[i];
+        min = UINT64_MAX;
+        BOR_LIST_FOR_EACH(bucket, item){
+            n = BOR_LIST_ENTRY(item, bor_radixheap_node_t, list);
+            if (n->key < min)
+                min = n->key;
+        }
+
+        // All keys of bucket i share the bits above the (i-1)-th bit with
+        // the minimum, so redistributing relative to the minimum moves
+        // all of them to lower buckets.
+        h->last = min;
+        BOR_LIST_FOR_EACH_SAFE(bucket, item, tmp){
+            n = BOR_LIST_ENTRY(item, bor_radixheap_node_t, list);
+            b = __borRadixHeapBucket(h, n->key);
+            borListDel(item);
+            borListAppend(&h->bucket[b], item);
+            n->bucket = b;
+        }
+    }
+
+    item = borListNext(&h->bucket[0]);
+    borListDel(item);
+    --h->size;
+    return BOR_LIST_ENTRY(item, bor_radixheap_node_t, list);
+}
@@ -0,0 +1,364 @@
+/***
+ * Boruvka
+ * --------
+ * Copyright (c)2016 Daniel Fiser <danfis@danfis.cz>
+ *
+ *  This file is part of Boruvka.
+ *
+ *  Distributed under the OSI-approved BSD License (the "License");
+ *  see accompanying file BDS-LICENSE for details or see
+ *  <http://www.opensource.org/licenses/bsd-license.php>.
+ *
+ *  This software is distributed WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *  See the License for more information.
+ */
+
+
+#include <limits.h>
+#include <time.h>
+#include <sched.h>
+#ifdef __linux__
+# include <unistd.h>
+# include <sys/syscall.h>
+# include <linux/futex.h>
+#endif /* __linux__ */
+#include "boruvka/alloc.h"
+#include "boruvka/ring_queue_mpmc.h"
+
+/** Number of busy-wait attempts of blocking calls */
+#define BLOCK_SPIN 128
+/** Number of attempts with yielding the CPU before going to sleep */
+#define BLOCK_YIELD 16
+
+_bor_inline void cpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/** Backoff of {i}'th failed attempt of blocking call.
+ *  Returns -1 when it is time to go to sleep. */
+_bor_inline int backoff(int i)
+{
+    if (i < BLOCK_SPIN){
+        cpuRelax();
+    }else if (i < BLOCK_SPIN + BLOCK_YIELD){
+        sched_yield();
+    }else{
+        return -1;
+    }
+    return 0;
+}
+
+static void futexWait(uint32_t *addr, uint32_t val,
+                      const struct timespec *timeout)
+{
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, timeout, NULL, 0);
+#else /* __linux__ */
+    struct timespec ts;
+
+    ts.tv_sec  = 0;
+    ts.tv_nsec = 100000L;
+    if (timeout && timeout->tv_sec == 0 && timeout->tv_nsec < ts.tv_nsec)
+        ts = *timeout;
+    if (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val)
+        nanosleep(&ts, NULL);
+#endif /* __linux__ */
+}
+
+static void futexWake(uint32_t *addr, int num)
+{
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, num, NULL, NULL, 0);
+#endif /* __linux__ */
+}
+
+/** Wakes up to {num} threads sleeping on {futex} if there are any */
+_bor_inline void notify(uint32_t *futex, int *waiters, int num)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED) > 0){
+        __atomic_add_fetch(futex, 1, __ATOMIC_SEQ_CST);
+        futexWake(futex, num);
+    }
+}
+
+/** Sets {rel} to time remaining to {deadline}, returns -1 if it passed */
+static int remaining(const struct timespec *deadline, struct timespec *rel)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rel->tv_sec  = deadline->tv_sec - now.tv_sec;
+    rel->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (rel->tv_nsec < 0){
+        rel->tv_nsec += 1000L * 1000L * 1000L;
+        rel->tv_sec -= 1;
+    }
+    if (rel->tv_sec < 0 || (rel->tv_sec == 0 && rel->tv_nsec == 0))
+        return -1;
+    return 0;
+}
+
+void borRingQueueMPMCInit(bor_ring_queue_mpmc_t *q, size_t size)
+{
+    size_t i, len;
+
+    len = 2;
+    while (len < size)
+        len *= 2;
+
+    q->buf = BOR_ALLOC_ARR(bor_ring_queue_mpmc_cell_t, len);
+    for (i = 0; i < len; ++i)
+        q->buf[i].seq = i;
+    q->mask = len - 1;
+    q->tail = q->head = 0;
+    q->pop_futex = q->push_futex = 0;
+    q->pop_waiters = q->push_waiters = 0;
+}
+
+void borRingQueueMPMCFree(bor_ring_queue_mpmc_t *q)
+{
+    if (q->buf)
+        BOR_FREE(q->buf);
+    q->buf = NULL;
+}
+
+_bor_inline int queuePush(bor_ring_queue_mpmc_t *q, void *data)
+{
+    bor_ring_queue_mpmc_cell_t *cell;
+    size_t pos, seq;
+    intptr_t dif;
+
+    pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    while (1){
+        cell = q->buf + (pos & q->mask);
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0){
+            if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+                break;
+        }else if (dif < 0){
+            // the slot still holds element from previous lap
+            return -1;
+        }else{
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->data = data;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+_bor_inline int queuePop(bor_ring_queue_mpmc_t *q, void **data)
+{
+    bor_ring_queue_mpmc_cell_t *cell;
+    size_t pos, seq;
+    intptr_t dif;
+
+    pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    while (1){
+        cell = q->buf + (pos & q->mask);
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0){
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+                break;
+        }else if (dif < 0){
+            // the slot was not written yet
+            return -1;
+        }else{
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    *data = cell->data;
+    __atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int borRingQueueMPMCPush(bor_ring_queue_mpmc_t *q, void *data)
+{
+    if (queuePush(q, data) != 0)
+        return -1;
+    notify(&q->pop_futex, &q->pop_waiters, 1);
+    return 0;
+}
+
+int borRingQueueMPMCPop(bor_ring_queue_mpmc_t *q, void **data)
+{
+    if (queuePop(q, data) != 0)
+        return -1;
+    notify(&q->push_futex, &q->push_waiters, 1);
+    return 0;
+}
+
+size_t borRingQueueMPMCPushBatch(bor_ring_queue_mpmc_t *q,
+                                 void **data, size_t len)
+{
+    bor_ring_queue_mpmc_cell_t *cell;
+    size_t pos, seq, n, i;
+
+    if (len == 0)
+        return 0;
+
+    pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    while (1){
+        // count consecutive slots that are already free in this lap,
+        // the same way as queuePush() checks a single slot
+        for (n = 0; n < len; ++n){
+            cell = q->buf + ((pos + n) & q->mask);
+            seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+            if (seq != pos + n)
+                break;
+        }
+
+        if (n > 0){
+            if (__atomic_compare_exchange_n(&q->tail, &pos, pos + n, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+                break;
+        }else if ((intptr_t)seq - (intptr_t)pos < 0){
+            // the slot still holds element from previous lap
+            return 0;
+        }else{
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (i = 0; i < n; ++i){
+        cell = q->buf + ((pos + i) & q->mask);
+        cell->data = data[i];
+        __atomic_store_n(&cell->seq, pos + i + 1, __ATOMIC_RELEASE);
+    }
+
+    notify(&q->pop_futex, &q->pop_waiters, (n > INT_MAX ? INT_MAX : n));
+    return n;
+}
+
+size_t borRingQueueMPMCPopBatch(bor_ring_queue_mpmc_t *q,
+                                void **data, size_t len)
+{
+    bor_ring_queue_mpmc_cell_t *cell;
+    size_t pos, seq, n, i;
+
+    if (len == 0)
+        return 0;
+
+    pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    while (1){
+        // count consecutive slots that are already written, the same
+        // way as queuePop() checks a single slot
+        for (n = 0; n < len; ++n){
+            cell = q->buf + ((pos + n) & q->mask);
+            seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+            if (seq != pos + n + 1)
+                break;
+        }
+
+        if (n > 0){
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + n, 1,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+                break;
+        }else if ((intptr_t)seq - (intptr_t)(pos + 1) < 0){
+            // the slot was not written yet
+            return 0;
+        }else{
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (i = 0; i < n; ++i){
+        cell = q->buf + ((pos + i) & q->mask);
+        data[i] = cell->data;
+        __atomic_store_n(&cell->seq, pos + i + q->mask + 1, __ATOMIC_RELEASE);
+    }
+
+    notify(&q->push_futex, &q->push_waiters, (n > INT_MAX ? INT_MAX : n));
+    return n;
+}
+
+void borRingQueueMPMCPushBlock(bor_ring_queue_mpmc_t *q, void *data)
+{
+    uint32_t val;
+    int i;
+
+    for (i = 0;; ++i){
+        if (borRingQueueMPMCPush(q, data) == 0)
+            return;
+        if (backoff(i) != 0)
+            break;
+    }
+
+    while (1){
+        val = __atomic_load_n(&q->push_futex, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&q->push_waiters, 1, __ATOMIC_SEQ_CST);
+        if (borRingQueueMPMCPush(q, data) == 0){
+            __atomic_sub_fetch(&q->push_waiters, 1, __ATOMIC_SEQ_CST);
+            return;
+        }
+        futexWait(&q->push_futex, val, NULL);
+        __atomic_sub_fetch(&q->push_waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void *borRingQueueMPMCPopBlock(bor_ring_queue_mpmc_t *q)
+{
+    void *data = NULL;
+    borRingQueueMPMCPopBlockTimeout(q, -1, &data);
+    return data;
+}
+
+int borRingQueueMPMCPopBlockTimeout(bor_ring_queue_mpmc_t *q,
+                                    int time_in_ms, void **data)
+{
+    struct timespec deadline, rel;
+    uint32_t val;
+    int i;
+
+    for (i = 0;; ++i){
+        if (borRingQueueMPMCPop(q, data) == 0)
+            return 0;
+        if (backoff(i) != 0)
+            break;
+    }
+
+    if (time_in_ms >= 0){
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += time_in_ms / 1000;
+        deadline.tv_nsec += (time_in_ms % 1000L) * 1000L * 1000L;
+        if (deadline.tv_nsec >= 1000L * 1000L * 1000L){
+            deadline.tv_nsec -= 1000L * 1000L * 1000L;
+            deadline.tv_sec += 1;
+        }
+    }
+
+    while (1){
+        val = __atomic_load_n(&q->pop_futex, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&q->pop_waiters, 1, __ATOMIC_SEQ_CST);
+        if (borRingQueueMPMCPop(q, data) == 0){
+            __atomic_sub_fetch(&q->pop_waiters, 1, __ATOMIC_SEQ_CST);
+            return 0;
+        }
+
+        if (time_in_ms >= 0){
+            if (remaining(&deadline, &rel) != 0){
+                __atomic_sub_fetch(&q->pop_waiters, 1, __ATOMIC_SEQ_CST);
+                return -1;
+            }
+            futexWait(&q->pop_futex, val, &rel);
+        }else{
+            futexWait(&q->pop_futex, val, NULL);
+        }
+        __atomic_sub_fetch(&q->pop_waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
@@ -17,13 +17,22 @@
 #include "boruvka/scc.h"
 #include "boruvka/alloc.h"
 
+/** Frame of the explicit DFS stack */
+struct _scc_frame_t {
+    int node; /*!< Expanded node */
+    long it;  /*!< Iterator over its neighbors */
+};
+typedef struct _scc_frame_t scc_frame_t;
+
 struct _scc_dfs_t {
-    int cur_index;
-    int *index;
-    int *lowlink;
-    int *in_stack;
+    size_t cur_index;
+    size_t *index;
+    size_t *lowlink;
+    char *in_stack;
     int *stack;
-    int stack_size;
+    size_t stack_size;
+    scc_frame_t *frame; /*!< DFS stack replacing recursion */
+    size_t frame_size;
 };
 typedef struct _scc_dfs_t scc_dfs_t;
 
@@ -32,76 +41,108 @@ static int cmpInt(const void *a, const void *b)
     return (*(int *)a) - (*(int *)b);
 }
 
-static void sccTarjanStrongconnect(bor_scc_t *scc, scc_dfs_t *dfs, int node)
+static void sccTarjanPush(bor_scc_t *scc, scc_dfs_t *dfs, int node)
 {
-    int i, w;
-    long it;
-    bor_scc_comp_t *comp;
+    scc_frame_t *f;
 
     dfs->index[node] = dfs->lowlink[node] = dfs->cur_index++;
     dfs->stack[dfs->stack_size++] = node;
     dfs->in_stack[node] = 1;
 
-    it = scc->it(node, scc->userdata);
-    while ((w = scc->next(node, &it, scc->userdata)) >= 0){
-        if (dfs->index[w] == -1){
-            sccTarjanStrongconnect(scc, dfs, w);
-            dfs->lowlink[node] = BOR_MIN(dfs->lowlink[node], dfs->lowlink[w]);
-        }else if (dfs->in_stack[w]){
-            dfs->lowlink[node] = BOR_MIN(dfs->lowlink[node], dfs->lowlink[w]);
-        }
-    }
+    f = dfs->frame + dfs->frame_size++;
+    f->node = node;
+    f->it = scc->it(node, scc->userdata);
+}
+
+static void sccTarjanComp(bor_scc_t *scc, scc_dfs_t *dfs, int node)
+{
+    bor_scc_comp_t *comp;
+    size_t i;
 
-    if (dfs->index[node] == dfs->lowlink[node]){
-        // Find how deep unroll stack
-        for (i = dfs->stack_size - 1; dfs->stack[i] != node; --i)
-            dfs->in_stack[dfs->stack[i]] = 0;
+    // Find how deep unroll stack
+    for (i = dfs->stack_size - 1; dfs->stack[i] != node; --i)
         dfs->in_stack[dfs->stack[i]] = 0;
+    dfs->in_stack[dfs->stack[i]] = 0;
+
+    // Create new component
+    ++scc->comp_size;
+    scc->comp = BOR_REALLOC_ARR(scc->comp, bor_scc_comp_t, scc->comp_size);
+    comp = scc->comp + scc->comp_size - 1;
+    comp->node_size = dfs->stack_size - i;
+    comp->node = BOR_ALLOC_ARR(int, comp->node_size);
+
+    // Copy node IDs from stack to the component
+    memcpy(comp->node, dfs->stack + i, sizeof(int) * comp->node_size);
+    if (comp->node_size > 1)
+        qsort(comp->node, comp->node_size, sizeof(int), cmpInt);
+
+    // Shrink stack
+    dfs->stack_size = i;
+}
 
-        // Create new component
-        ++scc->comp_size;
-        scc->comp = BOR_REALLOC_ARR(scc->comp, bor_scc_comp_t, scc->comp_size);
-        comp = scc->comp + scc->comp_size - 1;
-        comp->node_size = dfs->stack_size - i;
-        comp->node = BOR_ALLOC_ARR(int, comp->node_size);
+static void sccTarjanStrongconnect(bor_scc_t *scc, scc_dfs_t *dfs, int root)
+{
+    scc_frame_t *f;
+    int node, w;
+
+    sccTarjanPush(scc, dfs, root);
+    while (dfs->frame_size > 0){
+        f = dfs->frame + dfs->frame_size - 1;
+        node = f->node;
+
+        w = scc->next(node, &f->it, scc->userdata);
+        if (w >= 0){
+            if (dfs->index[w] == (size_t)-1){
+                sccTarjanPush(scc, dfs, w);
+            }else if (dfs->in_stack[w]){
+                dfs->lowlink[node] = BOR_MIN(dfs->lowlink[node],
+                                             dfs->lowlink[w]);
+            }
+            continue;
+        }
 
-        // Copy node IDs from stack to the component
-        memcpy(comp->node, dfs->stack + i, sizeof(int) * comp->node_size);
-        if (comp->node_size > 1)
-            qsort(comp->node, comp->node_size, sizeof(int), cmpInt);
+        // All neighbors processed -- return to the parent
+        --dfs->frame_size;
+        if (dfs->frame_size > 0){
+            w = dfs->frame[dfs->frame_size - 1].node;
+            dfs->lowlink[w] = BOR_MIN(dfs->lowlink[w], dfs->lowlink[node]);
+        }
 
-        // Shrink stack
-        dfs->stack_size = i;
+        if (dfs->index[node] == dfs->lowlink[node])
+            sccTarjanComp(scc, dfs, node);
     }
 }
 
 static void sccTarjan(bor_scc_t *scc, int start_node)
 {
     scc_dfs_t dfs;
-    int i, node;
+    size_t size = scc->node_size;
+    int node;
 
     // Initialize structure for Tarjan's algorithm
     dfs.cur_index = 0;
-    dfs.index    = BOR_ALLOC_ARR(int, 4 * scc->node_size);
-    dfs.lowlink  = dfs.index + scc->node_size;
-    dfs.in_stack = dfs.lowlink + scc->node_size;
-    dfs.stack    = dfs.in_stack + scc->node_size;
+    dfs.index    = BOR_ALLOC_ARR(size_t, 2 * size);
+    dfs.lowlink  = dfs.index + size;
+    dfs.in_stack = BOR_CALLOC_ARR(char, size);
+    dfs.stack    = BOR_ALLOC_ARR(int, size);
     dfs.stack_size = 0;
-    for (i = 0; i < scc->node_size; ++i){
-        dfs.index[i] = dfs.lowlink[i] = -1;
-        dfs.in_stack[i] = 0;
-    }
+    dfs.frame    = BOR_ALLOC_ARR(scc_frame_t, size);
+    dfs.frame_size = 0;
+    memset(dfs.index, 0xff, sizeof(size_t) * size);
 
     if (start_node >= 0){
         sccTarjanStrongconnect(scc, &dfs, start_node);
     }else{
         for (node = 0; node < scc->node_size; ++node){
-            if (dfs.index[node] == -1)
+            if (dfs.index[node] == (size_t)-1)
                 sccTarjanStrongconnect(scc, &dfs, node);
         }
     }
 
     BOR_FREE(dfs.index);
+    BOR_FREE(dfs.in_stack);
+    BOR_FREE(dfs.stack);
+    BOR_FREE(dfs.frame);
 }
 
 
@@ -131,7 +131,7 @@ void borRadixSort(bor_radix_sort_t *rs, bor_radix_sort_t *rs_tmp, size_t rslen)
 {
     bor_radix_sort_t *src, *dst, *tmp;
     uint32_t shift, i, len;
-    uint32_t counter[RADIX_SORT_MASK], negative;
+    uint32_t counter[RADIX_SORT_MASK + 1], negative;
 
 
     len = (bor_uint_t)sizeof(bor_real_t) - 1;
@@ -277,7 +277,7 @@ void borRadixSortPtr(void **arr, void **tmp_arr, size_t arrlen,
 {
     void **src, **dst, **tmp;
     uint32_t shift, i, len;
-    uint32_t counter[RADIX_SORT_MASK], negative;
+    uint32_t counter[RADIX_SORT_MASK + 1], negative;
 
 
     len = (bor_uint_t)sizeof(bor_real_t) - 1;
@@ -43,7 +43,7 @@ typedef struct _bor_task_pool_task_t bor_task_pool_task_t;
 
 
 static bor_task_pool_task_t *taskNew(bor_task_pool_t *t, bor_task_pool_fn fn, void *data, int id);
-static void taskDel(bor_task_pool_task_t *task);
+static void taskDel(bor_task_pool_t *t, bor_task_pool_task_t *task);
 
 
 static void _borTaskPoolAdd(bor_task_pool_t *t, int tid,
@@ -63,6 +63,7 @@ bor_task_pool_t *borTaskPoolNew(size_t num_threads)
     }
 
     t->started = 0;
+    t->tasks = borMemPoolNew(0);
 
     return t;
 }
@@ -89,6 +90,7 @@ void borTaskPoolDel(bor_task_pool_t *t)
     }
     BOR_FREE(t->threads);
 
+    borMemPoolDel(t->tasks);
     BOR_FREE(t);
 }
 
@@ -123,7 +125,7 @@ int borTaskPoolPending(bor_task_pool_t *t, int id)
 void borTaskPoolBarrier(bor_task_pool_t *t, int id)
 {
     pthread_mutex_lock(&t->threads[id]->lock);
-    if (t->threads[id]->pending != 0)
+    while (t->threads[id]->pending != 0)
         pthread_cond_wait(&t->threads[id]->pending_cond,
                           &t->threads[id]->lock);
     pthread_mutex_unlock(&t->threads[id]->lock);
@@ -162,7 +164,7 @@ static void threadDel(bor_task_pool_thread_t *th)
         item = borListNext(&th->tasks);
         borListDel(item);
         task = BOR_LIST_ENTRY(item, bor_task_pool_task_t, list);
-        taskDel(task);
+        taskDel(th->task_pool, task);
     }
 
     pthread_mutex_destroy(&th->lock);
@@ -217,7 +219,7 @@ static void *threadMain(void *_th)
         }
 
         // delete task
-        taskDel(task);
+        taskDel(th->task_pool, task);
 
         // another task finished...
         pthread_mutex_lock(&th->lock);
@@ -237,7 +239,7 @@ static bor_task_pool_task_t *taskNew(bor_task_pool_t *t, bor_task_pool_fn fn, vo
 {
     bor_task_pool_task_t *task;
 
-    task = BOR_ALLOC(bor_task_pool_task_t);
+    task = BOR_POOL_ALLOC(t->tasks, bor_task_pool_task_t);
     task->fn     = fn;
     task->data   = data;
     task->id     = id;
@@ -246,9 +248,9 @@ static bor_task_pool_task_t *taskNew(bor_task_pool_t *t, bor_task_pool_fn fn, vo
     return task;
 }
 
-static void taskDel(bor_task_pool_task_t *task)
+static void taskDel(bor_task_pool_t *t, bor_task_pool_task_t *task)
 {
-    BOR_FREE(task);
+    BOR_POOL_FREE(t->tasks, bor_task_pool_task_t, task);
 }
 
 
@@ -14,75 +14,126 @@
  *  See the License for more information.
  */
 
-#include <limits.h>
+#include <sched.h>
 #include <boruvka/tasks.h>
 #include <boruvka/alloc.h>
 
-/** Maximal queue size */
-#define QUEUE_SIZE SEM_VALUE_MAX
+/** Initial size of deque (must be power of two) */
+#define DEQUE_INIT_SIZE 256
+/** Number of rounds idle thread looks for work before it goes to sleep */
+#define IDLE_SPIN 64
+/** Maximal number of descriptors in per-thread pool */
+#define FREE_MAX 1024
+/** Number of descriptors moved between thread's and global pool at once */
+#define FREE_BATCH 512
+
+/** Returned from dequeSteal() if it lost race with other thread */
+#define DEQUE_ABORT ((bor_tasks_task_t *)1)
+
+
+/** Single task */
+struct _bor_tasks_task_t {
+    bor_tasks_fn fn;          /*!< Callback */
+    void *data;               /*!< Data for callback */
+    int id;                   /*!< ID of task */
+    bor_tasks_group_t *group; /*!< Group the task belongs to or NULL */
+    bor_list_t list;          /*!< Connection into tasks.inject */
+    struct _bor_tasks_task_t *next; /*!< Next in pool of descriptors */
+};
+typedef struct _bor_tasks_task_t bor_tasks_task_t;
+
+
+/** Circular array of deque. Arrays replaced by larger ones are kept in
+ *  .prev list until deque is deleted because thieves may still read
+ *  from them. */
+struct _bor_tasks_deque_arr_t {
+    long size;
+    struct _bor_tasks_deque_arr_t *prev;
+    bor_tasks_task_t *buf[];
+};
+typedef struct _bor_tasks_deque_arr_t bor_tasks_deque_arr_t;
+
+/** Chase-Lev work-stealing deque. Owner pushes and takes at bottom,
+ *  thieves steal from top. */
+struct _bor_tasks_deque_t {
+    long top;
+    long bottom;
+    bor_tasks_deque_arr_t *arr;
+};
+typedef struct _bor_tasks_deque_t bor_tasks_deque_t;
+
+static void dequeInit(bor_tasks_deque_t *q);
+static void dequeFree(bor_tasks_deque_t *q);
+static void dequePush(bor_tasks_deque_t *q, bor_tasks_task_t *task);
+static bor_tasks_task_t *dequeTake(bor_tasks_deque_t *q);
+static bor_tasks_task_t *dequeSteal(bor_tasks_deque_t *q);
+
 
 /** Single thread */
 struct _bor_tasks_thread_t {
     pthread_t th;            /*!< Posix thread */
     bor_tasks_thinfo_t info; /*!< Thread info, see tasks.h */
     bor_tasks_t *tasks;      /*!< Reference to task queue */
-    bor_list_t list;         /*!< Connection into task.threads list */
+    bor_tasks_deque_t deque; /*!< Thread's own deque */
+    bor_tasks_task_t *free;  /*!< Thread's pool of descriptors */
+    int free_len;            /*!< Number of descriptors in .free */
+    unsigned int rand;       /*!< State for choosing victim of stealing */
 };
 typedef struct _bor_tasks_thread_t bor_tasks_thread_t;
 
-static bor_tasks_thread_t *threadNew(bor_tasks_t *t);
+/** Thread currently executing the calling code or NULL */
+static __thread bor_tasks_thread_t *cur_thread = NULL;
+
+static bor_tasks_thread_t *threadNew(bor_tasks_t *t, int id);
 static void threadDel(bor_tasks_thread_t *th);
-//static void threadCancel(bor_tasks_thread_t *th);
 static void threadJoin(bor_tasks_thread_t *th);
 static void threadRun(bor_tasks_thread_t *th);
 static void *threadMain(void *_th);
+/** Finds task to run: own deque, injection queue, other deques */
+static bor_tasks_task_t *threadFindTask(bor_tasks_thread_t *th);
+/** Runs task and releases its descriptor */
+static void threadRunTask(bor_tasks_thread_t *th, bor_tasks_task_t *task);
 
 
-/** Single task */
-struct _bor_tasks_task_t {
-    bor_tasks_fn fn; /*!< Callback */
-    void *data;      /*!< Data for callback */
-    int id;          /*!< ID of task */
-    int finish;      /*!< If set to 1 - thread will be closed immediatelly */
-    bor_list_t list; /*!< List for connection info tasks.tasks */
-    bor_tasks_t *tasks; /*!< Reference to main struct */
-};
-typedef struct _bor_tasks_task_t bor_tasks_task_t;
-
+static bor_tasks_task_t *taskAlloc(bor_tasks_t *t, bor_tasks_thread_t *th);
+static void taskRelease(bor_tasks_thread_t *th, bor_tasks_task_t *task);
+/** Marks task from group {g} as finished (pending counters) */
+static void taskDone(bor_tasks_t *t, bor_tasks_group_t *g);
 
-static bor_tasks_task_t *taskNew(bor_tasks_t *t, bor_tasks_fn fn, void *data, int id);
-static void taskDel(bor_tasks_task_t *task);
+/** Wakes up one sleeping thread, if there is any */
+static void wakeOne(bor_tasks_t *t);
 
-
-static void _borTasksAdd(bor_tasks_t *t, bor_tasks_fn fn, void *data, int id,
-                         int finish);
+static void _borTasksAdd(bor_tasks_t *t, bor_tasks_group_t *g,
+                         bor_tasks_fn fn, void *data, int id);
 
 bor_tasks_t *borTasksNew(size_t num_threads)
 {
     bor_tasks_t *t;
-    bor_tasks_thread_t *th;
     size_t i;
 
     t = BOR_ALLOC(bor_tasks_t);
-    borListInit(&t->tasks);
-    borListInit(&t->threads);
-    t->threads_len = 0;
-    t->next_id     = 1;
+    t->threads_len = num_threads;
+    t->threads = BOR_ALLOC_ARR(bor_tasks_thread_t *, num_threads);
+    t->running = 0;
+    t->quit    = 0;
+    t->cancel  = 0;
 
     if (pthread_mutex_init(&t->lock, NULL) != 0)
         return NULL;
-    if (sem_init(&t->full, 0, 0) != 0)
-        return NULL;
-    if (sem_init(&t->empty, 0, QUEUE_SIZE) != 0)
-        return NULL;
+    borListInit(&t->inject);
+    t->inject_len = 0;
+    t->free       = NULL;
+
+    t->sleeping = 0;
+    t->epoch    = 0;
+    pthread_cond_init(&t->wake, NULL);
 
     for (i = 0; i < num_threads; i++){
-        th = threadNew(t);
-        borListAppend(&t->threads, &th->list);
-        t->threads_len++;
+        t->threads[i] = threadNew(t, i + 1);
     }
 
     pthread_cond_init(&t->pending_cond, NULL);
+    pthread_cond_init(&t->group_cond, NULL);
     t->pending = 0;
 
     return t;
@@ -90,43 +141,36 @@ bor_tasks_t *borTasksNew(size_t num_threads)
 
 void borTasksDel(bor_tasks_t *t)
 {
-    bor_list_t *item;
-    bor_tasks_thread_t *th;
     bor_tasks_task_t *task;
     size_t i;
 
-    // add special tasks
-    for (i = 0; i < t->threads_len; i++){
-        _borTasksAdd(t, NULL, NULL, -1, 1);
-    }
+    if (!t->running)
+        borTasksRun(t);
 
-    // join threads
-    BOR_LIST_FOR_EACH(&t->threads, item){
-        th = BOR_LIST_ENTRY(item, bor_tasks_thread_t, list);
-        threadJoin(th);
-    }
+    // wait for all tasks and then let threads terminate
+    borTasksBarrier(t);
 
-    // delete threads
-    while (!borListEmpty(&t->threads)){
-        item = borListNext(&t->threads);
-        borListDel(item);
-        th = BOR_LIST_ENTRY(item, bor_tasks_thread_t, list);
-        threadDel(th);
-    }
+    pthread_mutex_lock(&t->lock);
+    t->quit = 1;
+    pthread_cond_broadcast(&t->wake);
+    pthread_mutex_unlock(&t->lock);
 
-    // delete tasks
-    while (!borListEmpty(&t->tasks)){
-        item = borListNext(&t->tasks);
-        borListDel(item);
-        task = BOR_LIST_ENTRY(item, bor_tasks_task_t, list);
-        taskDel(task);
+    for (i = 0; i < t->threads_len; i++)
+        threadJoin(t->threads[i]);
+    for (i = 0; i < t->threads_len; i++)
+        threadDel(t->threads[i]);
+    BOR_FREE(t->threads);
+
+    while (t->free){
+        task = t->free;
+        t->free = task->next;
+        BOR_FREE(task);
     }
 
     pthread_mutex_destroy(&t->lock);
-    sem_destroy(&t->full);
-    sem_destroy(&t->empty);
-
+    pthread_cond_destroy(&t->wake);
     pthread_cond_destroy(&t->pending_cond);
+    pthread_cond_destroy(&t->group_cond);
 
     BOR_FREE(t);
 }
@@ -135,83 +179,230 @@ void borTasksCancelDel(bor_tasks_t *t)
 {
     bor_list_t *item;
     bor_tasks_task_t *task;
+    bor_tasks_group_t *g;
+
+    // tasks already in deques are dropped by threads
+    __atomic_store_n(&t->cancel, 1, __ATOMIC_SEQ_CST);
 
-    // empty task queue
+    // empty injection queue
     pthread_mutex_lock(&t->lock);
-    while (!borListEmpty(&t->tasks)){
-        item = borListNext(&t->tasks);
+    while (!borListEmpty(&t->inject)){
+        item = borListNext(&t->inject);
         borListDel(item);
         task = BOR_LIST_ENTRY(item, bor_tasks_task_t, list);
-        taskDel(task);
+        __atomic_sub_fetch(&t->inject_len, 1, __ATOMIC_RELEASE);
+        g = task->group;
+        task->next = t->free;
+        t->free = task;
+        pthread_mutex_unlock(&t->lock);
+        taskDone(t, g);
+        pthread_mutex_lock(&t->lock);
     }
     pthread_mutex_unlock(&t->lock);
 
-    // reset semaphores - do we need this ?
-    // TODO: may be problem in .pending* staff!
-
     borTasksDel(t);
 }
 
 void borTasksAdd(bor_tasks_t *t, bor_tasks_fn fn, int id, void *data)
 {
-    _borTasksAdd(t, fn, data, id, 0);
+    _borTasksAdd(t, NULL, fn, data, id);
 }
 
 void borTasksRun(bor_tasks_t *t)
 {
-    bor_list_t *item;
-    bor_tasks_thread_t *th;
+    size_t i;
 
-    BOR_LIST_FOR_EACH(&t->threads, item){
-        th = BOR_LIST_ENTRY(item, bor_tasks_thread_t, list);
-        threadRun(th);
-    }
+    if (t->running)
+        return;
+    t->running = 1;
+
+    for (i = 0; i < t->threads_len; i++)
+        threadRun(t->threads[i]);
 }
 
 int borTasksPending(bor_tasks_t *t)
 {
-    int p;
-
-    pthread_mutex_lock(&t->lock);
-    p = t->pending;
-    pthread_mutex_unlock(&t->lock);
-
-    return p;
+    return __atomic_load_n(&t->pending, __ATOMIC_SEQ_CST);
 }
 
 void borTasksRunBlock(bor_tasks_t *t)
 {
-    pthread_mutex_lock(&t->lock);
     borTasksRun(t);
-    pthread_cond_wait(&t->pending_cond, &t->lock);
-    pthread_mutex_unlock(&t->lock);
+    borTasksBarrier(t);
 }
 
 void borTasksBarrier(bor_tasks_t *t)
 {
     pthread_mutex_lock(&t->lock);
-    if (t->pending != 0)
+    while (__atomic_load_n(&t->pending, __ATOMIC_ACQUIRE) != 0)
         pthread_cond_wait(&t->pending_cond, &t->lock);
     pthread_mutex_unlock(&t->lock);
 }
 
+void borTasksSpawn(bor_tasks_t *t, bor_tasks_group_t *g,
+                   bor_tasks_fn fn, int id, void *data)
+{
+    __atomic_add_fetch(&g->pending, 1, __ATOMIC_RELAXED);
+    _borTasksAdd(t, g, fn, data, id);
+}
+
+void borTasksJoin(bor_tasks_t *t, bor_tasks_group_t *g)
+{
+    bor_tasks_thread_t *th = cur_thread;
+    bor_tasks_task_t *task;
+
+    if (th && th->tasks == t){
+        // help with other tasks while waiting
+        while (__atomic_load_n(&g->pending, __ATOMIC_ACQUIRE) != 0){
+            task = threadFindTask(th);
+            if (task){
+                threadRunTask(th, task);
+            }else{
+                sched_yield();
+            }
+        }
+
+    }else{
+        pthread_mutex_lock(&t->lock);
+        while (__atomic_load_n(&g->pending, __ATOMIC_ACQUIRE) != 0)
+            pthread_cond_wait(&t->group_cond, &t->lock);
+        pthread_mutex_unlock(&t->lock);
+    }
+}
+
+
+
+
+static void dequeInit(bor_tasks_deque_t *q)
+{
+    q->top = q->bottom = 0;
+    q->arr = BOR_MALLOC(sizeof(bor_tasks_deque_arr_t)
+                            + sizeof(bor_tasks_task_t *) * DEQUE_INIT_SIZE);
+    q->arr->size = DEQUE_INIT_SIZE;
+    q->arr->prev = NULL;
+}
+
+static void dequeFree(bor_tasks_deque_t *q)
+{
+    bor_tasks_deque_arr_t *arr, *prev;
+
+    for (arr = q->arr; arr; arr = prev){
+        prev = arr->prev;
+        BOR_FREE(arr);
+    }
+}
+
+static bor_tasks_deque_arr_t *dequeGrow(bor_tasks_deque_t *q,
+                                        bor_tasks_deque_arr_t *arr,
+                                        long top, long bottom)
+{
+    bor_tasks_deque_arr_t *narr;
+    long i;
+
+    narr = BOR_MALLOC(sizeof(bor_tasks_deque_arr_t)
+                        + sizeof(bor_tasks_task_t *) * 2 * arr->size);
+    narr->size = 2 * arr->size;
+    narr->prev = arr;
+    for (i = top; i < bottom; i++)
+        narr->buf[i & (narr->size - 1)] = arr->buf[i & (arr->size - 1)];
+    __atomic_store_n(&q->arr, narr, __ATOMIC_RELEASE);
+    return narr;
+}
+
+static void dequePush(bor_tasks_deque_t *q, bor_tasks_task_t *task)
+{
+    bor_tasks_deque_arr_t *arr;
+    long b, t;
+
+    b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED);
+    t = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    arr = __atomic_load_n(&q->arr, __ATOMIC_RELAXED);
+    if (b - t > arr->size - 1)
+        arr = dequeGrow(q, arr, t, b);
+
+    __atomic_store_n(&arr->buf[b & (arr->size - 1)], task, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+}
+
+static bor_tasks_task_t *dequeTake(bor_tasks_deque_t *q)
+{
+    bor_tasks_deque_arr_t *arr;
+    bor_tasks_task_t *task;
+    long b, t;
+
+    b = __atomic_load_n(&q->bottom, __ATOMIC_RELAXED) - 1;
+    arr = __atomic_load_n(&q->arr, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    t = __atomic_load_n(&q->top, __ATOMIC_RELAXED);
 
+    if (t > b){
+        // empty deque
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
 
+    task = __atomic_load_n(&arr->buf[b & (arr->size - 1)], __ATOMIC_RELAXED);
+    if (t == b){
+        // last element -- race with thieves
+        if (!__atomic_compare_exchange_n(&q->top, &t, t + 1, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            task = NULL;
+        __atomic_store_n(&q->bottom, b + 1, __ATOMIC_RELAXED);
+    }
 
-static bor_tasks_thread_t *threadNew(bor_tasks_t *t)
+    return task;
+}
+
+static bor_tasks_task_t *dequeSteal(bor_tasks_deque_t *q)
+{
+    bor_tasks_deque_arr_t *arr;
+    bor_tasks_task_t *task;
+    long b, t;
+
+    t = __atomic_load_n(&q->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    b = __atomic_load_n(&q->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b)
+        return NULL;
+
+    arr = __atomic_load_n(&q->arr, __ATOMIC_ACQUIRE);
+    task = __atomic_load_n(&arr->buf[t & (arr->size - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&q->top, &t, t + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return DEQUE_ABORT;
+    return task;
+}
+
+
+
+
+static bor_tasks_thread_t *threadNew(bor_tasks_t *t, int id)
 {
     bor_tasks_thread_t *th;
 
     th = BOR_ALLOC(bor_tasks_thread_t);
-    th->info.id    = t->next_id++;
-    th->tasks      = t;
-    borListInit(&th->list);
+    th->info.id  = id;
+    th->tasks    = t;
+    dequeInit(&th->deque);
+    th->free     = NULL;
+    th->free_len = 0;
+    th->rand     = 2654435761u * (unsigned int)id;
 
     return th;
 }
 
 static void threadDel(bor_tasks_thread_t *th)
 {
+    bor_tasks_task_t *task;
+
+    while (th->free){
+        task = th->free;
+        th->free = task->next;
+        BOR_FREE(task);
+    }
+    dequeFree(&th->deque);
     BOR_FREE(th);
 }
 
@@ -220,14 +411,6 @@ static void threadJoin(bor_tasks_thread_t *th)
     pthread_join(th->th, NULL);
 }
 
-#if 0
-static void threadCancel(bor_tasks_thread_t *th)
-{
-    pthread_cancel(th->th);
-}
-#endif
-
-
 static void threadRun(bor_tasks_thread_t *th)
 {
     pthread_attr_t attr;
@@ -239,87 +422,227 @@ static void threadRun(bor_tasks_thread_t *th)
 static void *threadMain(void *_th)
 {
     bor_tasks_thread_t *th = (bor_tasks_thread_t *)_th;
+    bor_tasks_t *t = th->tasks;
     bor_tasks_task_t *task;
-    bor_list_t *item;
-    int finish = 0;
+    unsigned long epoch;
+    int spin = 0;
 
-    while (!finish) {
-        // wait for available task
-        sem_wait(&th->tasks->full);
+    cur_thread = th;
 
-        // pick up task
-        pthread_mutex_lock(&th->tasks->lock);
-        item = borListNext(&th->tasks->tasks);
-        borListDel(item);
-        task = BOR_LIST_ENTRY(item, bor_tasks_task_t, list);
-        pthread_mutex_unlock(&th->tasks->lock);
+    while (1){
+        epoch = __atomic_load_n(&t->epoch, __ATOMIC_SEQ_CST);
 
-        // let know that there is free room in queue
-        sem_post(&th->tasks->empty);
+        task = threadFindTask(th);
+        if (task){
+            threadRunTask(th, task);
+            spin = 0;
+            continue;
+        }
 
-        if (task->finish){
-            // finish this thread
-            finish = 1;
-        }else{
-            // run task
-            task->fn(task->id, task->data, &th->info);
+        if (++spin < IDLE_SPIN){
+            sched_yield();
+            continue;
         }
+        spin = 0;
+
+        // Nothing to do -- go to sleep unless something was published
+        // since the search started.
+        pthread_mutex_lock(&t->lock);
+        if (t->quit){
+            pthread_mutex_unlock(&t->lock);
+            break;
+        }
+        __atomic_add_fetch(&t->sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&t->epoch, __ATOMIC_SEQ_CST) == epoch)
+            pthread_cond_wait(&t->wake, &t->lock);
+        __atomic_sub_fetch(&t->sleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&t->lock);
+    }
 
-        // delete task
-        taskDel(task);
+    cur_thread = NULL;
+    return NULL;
+}
 
-        // another task finished...
-        pthread_mutex_lock(&th->tasks->lock);
-        --th->tasks->pending;
-        if (th->tasks->pending == 0)
-            pthread_cond_broadcast(&th->tasks->pending_cond);
-        pthread_mutex_unlock(&th->tasks->lock);
+static bor_tasks_task_t *threadFindTask(bor_tasks_thread_t *th)
+{
+    bor_tasks_t *t = th->tasks;
+    bor_tasks_task_t *task;
+    bor_list_t *item;
+    size_t i, start, victim;
+    int retry;
+
+    task = dequeTake(&th->deque);
+    if (task)
+        return task;
+
+    if (__atomic_load_n(&t->inject_len, __ATOMIC_ACQUIRE) > 0){
+        pthread_mutex_lock(&t->lock);
+        if (!borListEmpty(&t->inject)){
+            item = borListNext(&t->inject);
+            borListDel(item);
+            task = BOR_LIST_ENTRY(item, bor_tasks_task_t, list);
+            __atomic_sub_fetch(&t->inject_len, 1, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&t->lock);
+        if (task)
+            return task;
     }
 
+    if (t->threads_len < 2)
+        return NULL;
+
+    // steal from other threads starting at random victim
+    th->rand ^= th->rand << 13;
+    th->rand ^= th->rand >> 17;
+    th->rand ^= th->rand << 5;
+    start = th->rand % t->threads_len;
+    do {
+        retry = 0;
+        for (i = 0; i < t->threads_len; i++){
+            victim = (start + i) % t->threads_len;
+            if (t->threads[victim] == th)
+                continue;
+
+            task = dequeSteal(&t->threads[victim]->deque);
+            if (task == DEQUE_ABORT){
+                retry = 1;
+            }else if (task){
+                return task;
+            }
+        }
+    } while (retry);
+
     return NULL;
 }
 
+static void threadRunTask(bor_tasks_thread_t *th, bor_tasks_task_t *task)
+{
+    bor_tasks_group_t *g = task->group;
+
+    if (!__atomic_load_n(&th->tasks->cancel, __ATOMIC_RELAXED))
+        task->fn(task->id, task->data, &th->info);
+    taskRelease(th, task);
+    taskDone(th->tasks, g);
+}
+
 
 
 
-static bor_tasks_task_t *taskNew(bor_tasks_t *t, bor_tasks_fn fn, void *data, int id)
+static bor_tasks_task_t *taskAlloc(bor_tasks_t *t, bor_tasks_thread_t *th)
 {
     bor_tasks_task_t *task;
+    int i;
+
+    if (!th){
+        // t->lock is held by caller
+        if (t->free){
+            task = t->free;
+            t->free = task->next;
+            return task;
+        }
+        return BOR_ALLOC(bor_tasks_task_t);
+    }
 
-    task = BOR_ALLOC(bor_tasks_task_t);
-    task->fn     = fn;
-    task->data   = data;
-    task->id     = id;
-    task->finish = 0;
-    task->tasks  = t;
-    borListInit(&task->list);
-    return task;
+    if (!th->free && __atomic_load_n(&t->free, __ATOMIC_RELAXED)){
+        pthread_mutex_lock(&t->lock);
+        for (i = 0; i < FREE_BATCH && t->free; i++){
+            task = t->free;
+            t->free = task->next;
+            task->next = th->free;
+            th->free = task;
+            ++th->free_len;
+        }
+        pthread_mutex_unlock(&t->lock);
+    }
+
+    if (th->free){
+        task = th->free;
+        th->free = task->next;
+        --th->free_len;
+        return task;
+    }
+    return BOR_ALLOC(bor_tasks_task_t);
 }
 
-static void taskDel(bor_tasks_task_t *task)
+static void taskRelease(bor_tasks_thread_t *th, bor_tasks_task_t *task)
 {
-    BOR_FREE(task);
+    bor_tasks_t *t = th->tasks;
+    int i;
+
+    task->next = th->free;
+    th->free = task;
+    ++th->free_len;
+
+    if (th->free_len > FREE_MAX){
+        // give descriptors back so that external producers can reuse them
+        pthread_mutex_lock(&t->lock);
+        for (i = 0; i < FREE_BATCH; i++){
+            task = th->free;
+            th->free = task->next;
+            task->next = t->free;
+            t->free = task;
+        }
+        pthread_mutex_unlock(&t->lock);
+        th->free_len -= FREE_BATCH;
+    }
 }
 
+static void taskDone(bor_tasks_t *t, bor_tasks_group_t *g)
+{
+    // Global counter goes first so that no task of the group is pending
+    // once borTasksJoin() returns.
+    if (__atomic_sub_fetch(&t->pending, 1, __ATOMIC_ACQ_REL) == 0){
+        pthread_mutex_lock(&t->lock);
+        pthread_cond_broadcast(&t->pending_cond);
+        pthread_mutex_unlock(&t->lock);
+    }
 
+    if (g && __atomic_sub_fetch(&g->pending, 1, __ATOMIC_ACQ_REL) == 0){
+        pthread_mutex_lock(&t->lock);
+        pthread_cond_broadcast(&t->group_cond);
+        pthread_mutex_unlock(&t->lock);
+    }
+}
 
-static void _borTasksAdd(bor_tasks_t *t, bor_tasks_fn fn, void *data, int id,
-                         int finish)
+static void wakeOne(bor_tasks_t *t)
 {
-    bor_tasks_task_t *task;
+    __atomic_add_fetch(&t->epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&t->sleeping, __ATOMIC_SEQ_CST) > 0){
+        pthread_mutex_lock(&t->lock);
+        pthread_cond_signal(&t->wake);
+        pthread_mutex_unlock(&t->lock);
+    }
+}
 
-    task = taskNew(t, fn, data, id);
-    task->finish = finish;
 
-    // reserve item in queue
-    sem_wait(&t->empty);
 
-    // add to queue
-    pthread_mutex_lock(&t->lock);
-    borListAppend(&t->tasks, &task->list);
-    ++t->pending;
-    pthread_mutex_unlock(&t->lock);
+static void _borTasksAdd(bor_tasks_t *t, bor_tasks_group_t *g,
+                         bor_tasks_fn fn, void *data, int id)
+{
+    bor_tasks_thread_t *th = cur_thread;
+    bor_tasks_task_t *task;
+
+    __atomic_add_fetch(&t->pending, 1, __ATOMIC_SEQ_CST);
+
+    if (th && th->tasks == t){
+        task = taskAlloc(t, th);
+        task->fn    = fn;
+        task->data  = data;
+        task->id    = id;
+        task->group = g;
+        dequePush(&th->deque, task);
+
+    }else{
+        pthread_mutex_lock(&t->lock);
+        task = taskAlloc(t, NULL);
+        task->fn    = fn;
+        task->data  = data;
+        task->id    = id;
+        task->group = g;
+        borListAppend(&t->inject, &task->list);
+        __atomic_add_fetch(&t->inject_len, 1, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&t->lock);
+    }
 
-    // unblock waiting thread
-    sem_post(&t->full);
+    wakeOne(t);
 }
@@ -20,6 +20,24 @@
 #include <boruvka/vec.h>
 #include <boruvka/dbg.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define VEC_X86
+# include <immintrin.h>
+#endif /* __GNUC__ && x86 */
+
+/** Signatures of batch kernels */
+typedef void (*dist2_batch_fn)(size_t size, const bor_vec_t *p,
+                               const bor_vec_t **vs, size_t len,
+                               bor_real_t *dist);
+typedef void (*dist2_soa_fn)(size_t size, const bor_vec_t *p,
+                             const bor_real_t *coords, size_t stride,
+                             size_t len, bor_real_t *dist);
+
+/** Currently selected implementation */
+static int simd_impl = BOR_VEC_SIMD_AUTO;
+static dist2_batch_fn dist2_batch = NULL;
+static dist2_soa_fn dist2_soa = NULL;
+
 bor_vec_t *borVecNew(size_t size)
 {
     bor_vec_t *v;
@@ -45,3 +63,274 @@ void borVecSetN(size_t size, bor_vec_t *v, ...)
     }
     va_end(ap);
 }
+
+
+
+/*** Batch kernels ***/
+static void dist2BatchScalar(size_t size, const bor_vec_t *p,
+                             const bor_vec_t **vs, size_t len,
+                             bor_real_t *dist)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        dist[i] = borVecDist2(size, p, vs[i]);
+}
+
+static void dist2SoAScalar(size_t size, const bor_vec_t *p,
+                           const bor_real_t *coords, size_t stride,
+                           size_t len, bor_real_t *dist)
+{
+    const bor_real_t *row;
+    bor_real_t f;
+    size_t i, j;
+
+    for (i = 0; i < len; i++)
+        dist[i] = BOR_ZERO;
+
+    for (j = 0; j < size; j++){
+        row = coords + j * stride;
+        for (i = 0; i < len; i++){
+            f = row[i] - p[j];
+            dist[i] += BOR_SQ(f);
+        }
+    }
+}
+
+#ifdef VEC_X86
+/* The kernels are written once for both precisions, following macros
+ * select the right intrinsics. */
+# ifdef BOR_SINGLE
+#  define SSE_T            __m128
+#  define SSE_ZERO()       _mm_setzero_ps()
+#  define SSE_SET1(x)      _mm_set1_ps(x)
+#  define SSE_LOADU(p)     _mm_loadu_ps(p)
+#  define SSE_STOREU(p, x) _mm_storeu_ps((p), (x))
+#  define SSE_SUB(a, b)    _mm_sub_ps((a), (b))
+#  define SSE_MUL(a, b)    _mm_mul_ps((a), (b))
+#  define SSE_ADD(a, b)    _mm_add_ps((a), (b))
+#  define AVX_T            __m256
+#  define AVX_ZERO()       _mm256_setzero_ps()
+#  define AVX_SET1(x)      _mm256_set1_ps(x)
+#  define AVX_LOADU(p)     _mm256_loadu_ps(p)
+#  define AVX_STOREU(p, x) _mm256_storeu_ps((p), (x))
+#  define AVX_SUB(a, b)    _mm256_sub_ps((a), (b))
+#  define AVX_MUL(a, b)    _mm256_mul_ps((a), (b))
+#  define AVX_ADD(a, b)    _mm256_add_ps((a), (b))
+# else /* BOR_SINGLE */
+#  define SSE_T            __m128d
+#  define SSE_ZERO()       _mm_setzero_pd()
+#  define SSE_SET1(x)      _mm_set1_pd(x)
+#  define SSE_LOADU(p)     _mm_loadu_pd(p)
+#  define SSE_STOREU(p, x) _mm_storeu_pd((p), (x))
+#  define SSE_SUB(a, b)    _mm_sub_pd((a), (b))
+#  define SSE_MUL(a, b)    _mm_mul_pd((a), (b))
+#  define SSE_ADD(a, b)    _mm_add_pd((a), (b))
+#  define AVX_T            __m256d
+#  define AVX_ZERO()       _mm256_setzero_pd()
+#  define AVX_SET1(x)      _mm256_set1_pd(x)
+#  define AVX_LOADU(p)     _mm256_loadu_pd(p)
+#  define AVX_STOREU(p, x) _mm256_storeu_pd((p), (x))
+#  define AVX_SUB(a, b)    _mm256_sub_pd((a), (b))
+#  define AVX_MUL(a, b)    _mm256_mul_pd((a), (b))
+#  define AVX_ADD(a, b)    _mm256_add_pd((a), (b))
+# endif /* BOR_SINGLE */
+
+# define SSE_LANES (16 / sizeof(bor_real_t))
+# define AVX_LANES (32 / sizeof(bor_real_t))
+
+# define SSE_ATTR __attribute__((target("sse2")))
+# define AVX_ATTR __attribute__((target("avx2")))
+# define SSE_INLINE static inline __attribute__((always_inline, target("sse2")))
+# define AVX_INLINE static inline __attribute__((always_inline, target("avx2")))
+
+/* Generic kernels are inlined with constant {size} for the most common
+ * dimensions so that the compiler can unroll the inner loops.
+ *
+ * The AoS kernel has to gather coordinates of the points one by one, so it
+ * pays off only up to BOR_VEC_DIST2_BATCH_MAX dimensions (measured by
+ * testsuites/bench-dist), bigger ones use the plain loop. The gather is
+ * also the bottleneck of the wider AVX2 variant which wasn't faster than
+ * SSE, so the AVX2 implementation uses the SSE kernel for AoS layout. */
+SSE_INLINE void _dist2BatchSSE(size_t size, const bor_vec_t *p,
+                               const bor_vec_t **vs, size_t len,
+                               bor_real_t *dist)
+{
+    bor_real_t tmp[SSE_LANES] bor_aligned(16);
+    SSE_T x, d, acc;
+    size_t i, j, k;
+
+    for (i = 0; i + SSE_LANES <= len; i += SSE_LANES){
+        acc = SSE_ZERO();
+        for (j = 0; j < size; j++){
+            for (k = 0; k < SSE_LANES; k++)
+                tmp[k] = vs[i + k][j];
+            x   = SSE_LOADU(tmp);
+            d   = SSE_SUB(x, SSE_SET1(p[j]));
+            acc = SSE_ADD(acc, SSE_MUL(d, d));
+        }
+        SSE_STOREU(dist + i, acc);
+    }
+
+    dist2BatchScalar(size, p, vs + i, len - i, dist + i);
+}
+
+SSE_ATTR static void dist2BatchSSE(size_t size, const bor_vec_t *p,
+                                   const bor_vec_t **vs, size_t len,
+                                   bor_real_t *dist)
+{
+    if (size == 2){
+        _dist2BatchSSE(2, p, vs, len, dist);
+    }else if (size == 3){
+        _dist2BatchSSE(3, p, vs, len, dist);
+    }else if (size <= BOR_VEC_DIST2_BATCH_MAX){
+        _dist2BatchSSE(size, p, vs, len, dist);
+    }else{
+        dist2BatchScalar(size, p, vs, len, dist);
+    }
+}
+
+SSE_INLINE void _dist2SoASSE(size_t size, const bor_vec_t *p,
+                             const bor_real_t *coords, size_t stride,
+                             size_t len, bor_real_t *dist)
+{
+    SSE_T x, d, acc;
+    size_t i, j;
+
+    for (i = 0; i + SSE_LANES <= len; i += SSE_LANES){
+        acc = SSE_ZERO();
+        for (j = 0; j < size; j++){
+            x   = SSE_LOADU(coords + j * stride + i);
+            d   = SSE_SUB(x, SSE_SET1(p[j]));
+            acc = SSE_ADD(acc, SSE_MUL(d, d));
+        }
+        SSE_STOREU(dist + i, acc);
+    }
+
+    dist2SoAScalar(size, p, coords + i, stride, len - i, dist + i);
+}
+
+SSE_ATTR static void dist2SoASSE(size_t size, const bor_vec_t *p,
+                                 const bor_real_t *coords, size_t stride,
+                                 size_t len, bor_real_t *dist)
+{
+    if (size == 2){
+        _dist2SoASSE(2, p, coords, stride, len, dist);
+    }else if (size == 3){
+        _dist2SoASSE(3, p, coords, stride, len, dist);
+    }else{
+        _dist2SoASSE(size, p, coords, stride, len, dist);
+    }
+}
+
+AVX_INLINE void _dist2SoAAVX2(size_t size, const bor_vec_t *p,
+                              const bor_real_t *coords, size_t stride,
+                              size_t len, bor_real_t *dist)
+{
+    AVX_T x, d, acc;
+    size_t i, j;
+
+    for (i = 0; i + AVX_LANES <= len; i += AVX_LANES){
+        acc = AVX_ZERO();
+        for (j = 0; j < size; j++){
+            x   = AVX_LOADU(coords + j * stride + i);
+            d   = AVX_SUB(x, AVX_SET1(p[j]));
+            acc = AVX_ADD(acc, AVX_MUL(d, d));
+        }
+        AVX_STOREU(dist + i, acc);
+    }
+
+    dist2SoAScalar(size, p, coords + i, stride, len - i, dist + i);
+}
+
+AVX_ATTR static void dist2SoAAVX2(size_t size, const bor_vec_t *p,
+                                  const bor_real_t *coords, size_t stride,
+                                  size_t len, bor_real_t *dist)
+{
+    if (size == 2){
+        _dist2SoAAVX2(2, p, coords, stride, len, dist);
+    }else if (size == 3){
+        _dist2SoAAVX2(3, p, coords, stride, len, dist);
+    }else{
+        _dist2SoAAVX2(size, p, coords, stride, len, dist);
+    }
+}
+#endif /* VEC_X86 */
+
+void borVecDist2Batch(size_t size, const bor_vec_t *p,
+                      const bor_vec_t **vs, size_t len, bor_real_t *dist)
+{
+    dist2_batch_fn fn;
+
+    fn = __atomic_load_n(&dist2_batch, __ATOMIC_ACQUIRE);
+    if (bor_unlikely(fn == NULL)){
+        borVecSIMDSet(BOR_VEC_SIMD_AUTO);
+        fn = __atomic_load_n(&dist2_batch, __ATOMIC_ACQUIRE);
+    }
+    fn(size, p, vs, len, dist);
+}
+
+void borVecDist2BatchSoA(size_t size, const bor_vec_t *p,
+                         const bor_real_t *coords, size_t stride,
+                         size_t len, bor_real_t *dist)
+{
+    dist2_soa_fn fn;
+
+    fn = __atomic_load_n(&dist2_soa, __ATOMIC_ACQUIRE);
+    if (bor_unlikely(fn == NULL)){
+        borVecSIMDSet(BOR_VEC_SIMD_AUTO);
+        fn = __atomic_load_n(&dist2_soa, __ATOMIC_ACQUIRE);
+    }
+    fn(size, p, coords, stride, len, dist);
+}
+
+int borVecSIMDSet(int impl)
+{
+    dist2_batch_fn batch;
+    dist2_soa_fn soa;
+    int best = BOR_VEC_SIMD_NONE;
+
+#ifdef VEC_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")){
+        best = BOR_VEC_SIMD_AVX2;
+    }else if (__builtin_cpu_supports("sse2")){
+        best = BOR_VEC_SIMD_SSE;
+    }
+#endif /* VEC_X86 */
+
+    if (impl == BOR_VEC_SIMD_AUTO || impl > best)
+        impl = best;
+
+#ifdef VEC_X86
+    if (impl == BOR_VEC_SIMD_AVX2){
+        soa   = dist2SoAAVX2;
+        batch = dist2BatchSSE;
+    }else if (impl == BOR_VEC_SIMD_SSE){
+        soa   = dist2SoASSE;
+        batch = dist2BatchSSE;
+    }else
+#endif /* VEC_X86 */
+    {
+        impl  = BOR_VEC_SIMD_NONE;
+        soa   = dist2SoAScalar;
+        batch = dist2BatchScalar;
+    }
+
+    // Kernels may be selected lazily by several threads at once, atomic
+    // stores make it safe (all of them store the same values).
+    __atomic_store_n(&dist2_soa, soa, __ATOMIC_RELEASE);
+    __atomic_store_n(&dist2_batch, batch, __ATOMIC_RELEASE);
+    __atomic_store_n(&simd_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+int borVecSIMD(void)
+{
+    int impl;
+
+    impl = __atomic_load_n(&simd_impl, __ATOMIC_ACQUIRE);
+    if (impl == BOR_VEC_SIMD_AUTO)
+        impl = borVecSIMDSet(BOR_VEC_SIMD_AUTO);
+    return impl;
+}
@@ -20,6 +20,15 @@
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
 #include <boruvka/nn.h>
+#include <boruvka/parallel.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define HAMMING_X86
+# include <immintrin.h>
+# if defined(__clang__) || __GNUC__ >= 8
+#  define HAMMING_AVX512
+# endif
+#endif /* __GNUC__ && x86 */
 
 /* DEBUG:
 static char bin_buf[33];
@@ -36,12 +45,20 @@ static const char *binUInt32(const unsigned char *_v)
 }
 */
 
-/** Hamming distance between two bytes */
-static int hammingDistByte(unsigned char a, unsigned char b);
+/** Signature of Hamming distance kernels */
+typedef int (*hamming_dist_fn)(const unsigned char *p1,
+                               const unsigned char *p2, size_t size);
+
+/** Currently selected implementation */
+static int hamming_impl = BOR_VPTREE_HAMMING_AUTO;
+static hamming_dist_fn hamming_dist = NULL;
+
+/** Returns the selected kernel, the kernel is selected on first use */
+_bor_inline hamming_dist_fn hammingDistFn(void);
 /** Returns Hamming distance between two points */
-static int hammingDist(const unsigned char *p1,
-                       const unsigned char *p2,
-                       size_t size);
+_bor_inline int hammingDist(const unsigned char *p1,
+                            const unsigned char *p2,
+                            size_t size);
 
 /** Finds out radius and variance */
 static void radiusVar(bor_vptree_hamming_t *vp,
@@ -212,15 +229,29 @@ void borVPTreeHammingUpdate(bor_vptree_hamming_t *vp,
 
 
 /** Nearest */
+/** Pending subtree: {left} or right child of {par} that is visited only
+ *  if it can contain element closer than the current radius */
+struct _nearest_stack_t {
+    const _bor_vptree_hamming_node_t *par;
+    int d;    /*!< Distance between query point and par->vp */
+    int left;
+};
+typedef struct _nearest_stack_t nearest_stack_t;
+
 struct _nearest_t {
     const bor_vptree_hamming_t *vp;
     const unsigned char *p;
     size_t num;
+    hamming_dist_fn dist_fn;
 
     int radius;
     bor_vptree_hamming_el_t **els;
     int *dist;
     size_t els_len;
+
+    nearest_stack_t *stack; /*!< Traversal stack, reused between queries */
+    size_t stack_len;
+    size_t stack_alloc;
 };
 typedef struct _nearest_t nearest_t;
 
@@ -253,102 +284,457 @@ static void nearestAdd(nearest_t *n, bor_vptree_hamming_el_t *el, int dist)
     }
 }
 
-static void nearest(nearest_t *n, const _bor_vptree_hamming_node_t *node)
+_bor_inline void nearestPush(nearest_t *n,
+                             const _bor_vptree_hamming_node_t *par,
+                             int d, int left)
+{
+    if (n->stack_len == n->stack_alloc){
+        n->stack_alloc *= 2;
+        n->stack = BOR_REALLOC_ARR(n->stack, nearest_stack_t, n->stack_alloc);
+    }
+    n->stack[n->stack_len].par  = par;
+    n->stack[n->stack_len].d    = d;
+    n->stack[n->stack_len].left = left;
+    ++n->stack_len;
+}
+
+static void nearestInit(nearest_t *n, const bor_vptree_hamming_t *vp,
+                        size_t num)
+{
+    n->vp  = vp;
+    n->num = num;
+    n->dist_fn = hammingDistFn();
+
+    n->dist = BOR_ALLOC_ARR(int, num);
+
+    n->stack_len   = 0;
+    n->stack_alloc = 32;
+    n->stack = BOR_ALLOC_ARR(nearest_stack_t, n->stack_alloc);
+}
+
+static void nearestFree(nearest_t *n)
+{
+    BOR_FREE(n->dist);
+    BOR_FREE(n->stack);
+}
+
+/** Children are visited in the same order and with the same pruning
+ *  conditions as in recursive search, the conditions are only evaluated
+ *  at the time the child is popped from the stack. */
+static size_t nearest(nearest_t *n, const unsigned char *p,
+                      bor_vptree_hamming_el_t **els)
 {
+    const _bor_vptree_hamming_node_t *node;
+    const nearest_stack_t *s;
     bor_list_t *item;
     bor_vptree_hamming_el_t *el;
-    int d, d2, dist;
-
-    if (!node->left && !node->right){
-        // node is leaf node, try to add all elements
-        BOR_LIST_FOR_EACH(&node->els, item){
-            el = BOR_LIST_ENTRY(item, bor_vptree_hamming_el_t, list);
-            dist = hammingDist(n->p, el->p, n->vp->params.size);
-            if (dist < n->radius){
-                nearestAdd(n, el, dist);
-                n->radius = n->dist[n->num - 1];
-            }
+    size_t size = n->vp->params.size;
+    int d, dist, max_dist;
+    size_t i;
+
+    max_dist = size * 8 + 1;
+
+    n->p       = p;
+    n->radius  = max_dist;
+    n->els     = els;
+    n->els_len = 0;
+    for (i = 0; i < n->num; i++)
+        n->dist[i] = max_dist;
+
+    if (!n->vp->root || n->num == 0)
+        return 0;
+
+    n->stack_len = 0;
+    nearestPush(n, NULL, 0, 0);
+    while (n->stack_len > 0){
+        s = &n->stack[--n->stack_len];
+        if (s->par == NULL){
+            node = n->vp->root;
+        }else if (s->left){
+            if (s->d >= s->par->radius + n->radius)
+                continue;
+            node = s->par->left;
+        }else{
+            if (s->d < s->par->radius - n->radius)
+                continue;
+            node = s->par->right;
         }
-    }else{
-        d = hammingDist(n->p, node->vp, n->vp->params.size);
-        if (d < node->radius){
-            if (d < node->radius + n->radius){
-                nearest(n, node->left);
-            }
 
-            d2 = node->radius - n->radius;
-            if (d >= d2){
-                nearest(n, node->right);
-            }
-        }else{ // d >= node->radius
-            d2 = node->radius - n->radius;
-            if (d >= d2){
-                nearest(n, node->right);
+        if (!node->left && !node->right){
+            // node is leaf node, try to add all elements
+            BOR_LIST_FOR_EACH(&node->els, item){
+                el = BOR_LIST_ENTRY(item, bor_vptree_hamming_el_t, list);
+                dist = n->dist_fn(p, el->p, size);
+                if (dist < n->radius){
+                    nearestAdd(n, el, dist);
+                    n->radius = n->dist[n->num - 1];
+                }
             }
-
-            if (d < node->radius + n->radius){
-                nearest(n, node->left);
+        }else{
+            // push the child that is visited second first
+            d = n->dist_fn(p, node->vp, size);
+            if (d < node->radius){
+                nearestPush(n, node, d, 0);
+                nearestPush(n, node, d, 1);
+            }else{
+                nearestPush(n, node, d, 1);
+                nearestPush(n, node, d, 0);
             }
         }
     }
+
+    return n->els_len;
 }
+
 size_t borVPTreeHammingNearest(const bor_vptree_hamming_t *vp,
                                const unsigned char *p, size_t num,
                                bor_vptree_hamming_el_t **els)
 {
     nearest_t n;
-    size_t i;
-    int max_dist;
-   
-    max_dist = vp->params.size * 8 + 1;
+    size_t found;
 
-    n.vp  = vp;
-    n.p   = p;
-    n.num = num;
+    nearestInit(&n, vp, num);
+    found = nearest(&n, p, els);
+    nearestFree(&n);
 
-    n.radius  = max_dist;
-    n.els     = els;
-    n.els_len = 0;
+    return found;
+}
+
+/** Batch of queries shared by all threads */
+struct _nearest_batch_t {
+    const bor_vptree_hamming_t *vp;
+    const unsigned char **ps;
+    size_t len;
+    size_t num;
+    bor_vptree_hamming_el_t **els;
+    size_t *found;
+    nearest_t *n; /*!< Search state of each thread */
+};
+typedef struct _nearest_batch_t nearest_batch_t;
 
-    n.dist    = BOR_ALLOC_ARR(int, num);
-    for (i = 0; i < num; i++)
-        n.dist[i] = max_dist;
+/** Minimal number of queries processed by one chunk of batch query */
+#define BATCH_GRAIN 16
 
-    nearest(&n, vp->root);
+static void nearestBatchRange(const nearest_batch_t *b, nearest_t *n,
+                              size_t from, size_t to)
+{
+    size_t i, j, found;
+
+    for (i = from; i < to; i++){
+        found = nearest(n, b->ps[i], b->els + i * b->num);
+        for (j = found; j < b->num; j++)
+            b->els[i * b->num + j] = NULL;
+        if (b->found)
+            b->found[i] = found;
+    }
+}
 
-    BOR_FREE(n.dist);
+static void nearestBatchFor(size_t from, size_t to, void *data,
+                            const bor_task_pool_thinfo_t *thinfo)
+{
+    const nearest_batch_t *b = (const nearest_batch_t *)data;
 
-    return n.els_len;
+    nearestBatchRange(b, &b->n[thinfo->id], from, to);
 }
 
+void borVPTreeHammingNearestBatch(const bor_vptree_hamming_t *vp,
+                                  const unsigned char **ps, size_t len,
+                                  size_t num,
+                                  bor_vptree_hamming_el_t **els,
+                                  size_t *found,
+                                  bor_task_pool_t *tp)
+{
+    nearest_batch_t b;
+    size_t i, threads;
 
+    if (num == 0){
+        if (found){
+            for (i = 0; i < len; i++)
+                found[i] = 0;
+        }
+        return;
+    }
+    if (len == 0)
+        return;
+
+    b.vp    = vp;
+    b.ps    = ps;
+    b.len   = len;
+    b.num   = num;
+    b.els   = els;
+    b.found = found;
+
+    // search state is indexed by id of the thread running the chunk
+    threads = (tp ? borTaskPoolSize(tp) : 1);
+    b.n = BOR_ALLOC_ARR(nearest_t, threads);
+    for (i = 0; i < threads; i++)
+        nearestInit(&b.n[i], vp, num);
+
+    borParallelFor(tp, 0, len, BATCH_GRAIN, nearestBatchFor, (void *)&b);
+
+    for (i = 0; i < threads; i++)
+        nearestFree(&b.n[i]);
+    BOR_FREE(b.n);
+}
 
-static int hammingDistByte(unsigned char a, unsigned char b)
+
+
+/** Loads 64-bit word from possibly unaligned memory */
+_bor_inline uint64_t hammingLoad64(const unsigned char *p)
 {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+/** Loads last {size} < 8 bytes zero-padded to 64-bit word */
+_bor_inline uint64_t hammingLoadTail(const unsigned char *p, size_t size)
+{
+    uint64_t v = 0;
+    memcpy(&v, p, size);
+    return v;
+}
+
+/** Population count of 64-bit word without special instructions */
+_bor_inline int popcount64(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+_bor_inline int _hammingDistScalar(const unsigned char *p1,
+                                   const unsigned char *p2,
+                                   size_t size)
+{
+    size_t i;
     int dist = 0;
-    unsigned char val = a ^ b;
 
-    while(val){
-        ++dist; 
-        val &= val - 1;
+    for (i = 0; i + 8 <= size; i += 8)
+        dist += popcount64(hammingLoad64(p1 + i) ^ hammingLoad64(p2 + i));
+    if (i < size){
+        dist += popcount64(hammingLoadTail(p1 + i, size - i)
+                            ^ hammingLoadTail(p2 + i, size - i));
     }
 
     return dist;
 }
 
-static int hammingDist(const unsigned char *p1,
-                       const unsigned char *p2,
-                       size_t size)
+static int hammingDistScalar(const unsigned char *p1,
+                             const unsigned char *p2,
+                             size_t size)
 {
-    int i;
+    if (size == 32)
+        return _hammingDistScalar(p1, p2, 32);
+    if (size == 64)
+        return _hammingDistScalar(p1, p2, 64);
+    return _hammingDistScalar(p1, p2, size);
+}
+
+#ifdef HAMMING_X86
+# define POPCNT_INLINE static inline \
+    __attribute__((always_inline, target("popcnt")))
+
+POPCNT_INLINE int _hammingDistPopcnt(const unsigned char *p1,
+                                     const unsigned char *p2,
+                                     size_t size)
+{
+    size_t i;
     int dist = 0;
 
-    for (i = 0; i < size; i++){
-        dist += hammingDistByte(p1[i], p2[i]);
+    for (i = 0; i + 8 <= size; i += 8){
+        dist += __builtin_popcountll(hammingLoad64(p1 + i)
+                                        ^ hammingLoad64(p2 + i));
+    }
+    if (i < size){
+        dist += __builtin_popcountll(hammingLoadTail(p1 + i, size - i)
+                                        ^ hammingLoadTail(p2 + i, size - i));
+    }
+
+    return dist;
+}
+
+__attribute__((target("popcnt")))
+static int hammingDistPopcnt(const unsigned char *p1,
+                             const unsigned char *p2,
+                             size_t size)
+{
+    if (size == 32)
+        return _hammingDistPopcnt(p1, p2, 32);
+    if (size == 64)
+        return _hammingDistPopcnt(p1, p2, 64);
+    return _hammingDistPopcnt(p1, p2, size);
+}
+
+/* Nibble lookup with pshufb, see W. Mula, N. Kurz, D. Lemire: Faster
+ * Population Counts Using AVX2 Instructions (2016). */
+__attribute__((target("avx2,popcnt")))
+static int hammingDistAVX2(const unsigned char *p1,
+                           const unsigned char *p2,
+                           size_t size)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                         1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3,
+                                         1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc, x, cnt;
+    size_t i;
+    int dist;
+
+    acc = _mm256_setzero_si256();
+    for (i = 0; i + 32 <= size; i += 32){
+        x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(p1 + i)),
+                             _mm256_loadu_si256((const __m256i *)(p2 + i)));
+        cnt = _mm256_add_epi8(
+                _mm256_shuffle_epi8(lut, _mm256_and_si256(x, low)),
+                _mm256_shuffle_epi8(lut, _mm256_and_si256(
+                                            _mm256_srli_epi16(x, 4), low)));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt,
+                                                    _mm256_setzero_si256()));
+    }
+
+    dist  = _mm256_extract_epi64(acc, 0);
+    dist += _mm256_extract_epi64(acc, 1);
+    dist += _mm256_extract_epi64(acc, 2);
+    dist += _mm256_extract_epi64(acc, 3);
+
+    if (i < size)
+        dist += _hammingDistPopcnt(p1 + i, p2 + i, size - i);
+    return dist;
+}
+
+# ifdef HAMMING_AVX512
+__attribute__((target("avx512f,avx512vl,avx512vpopcntdq,popcnt")))
+static int hammingDistAVX512(const unsigned char *p1,
+                             const unsigned char *p2,
+                             size_t size)
+{
+    __m512i acc, x;
+    __m256i acc2, y;
+    size_t i;
+    int dist;
+
+    acc = _mm512_setzero_si512();
+    for (i = 0; i + 64 <= size; i += 64){
+        x = _mm512_xor_si512(_mm512_loadu_si512((const void *)(p1 + i)),
+                             _mm512_loadu_si512((const void *)(p2 + i)));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+    }
+    dist = _mm512_reduce_add_epi64(acc);
+
+    // 256-bit keys and remainders of longer keys
+    if (i + 32 <= size){
+        y = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(p1 + i)),
+                             _mm256_loadu_si256((const __m256i *)(p2 + i)));
+        acc2 = _mm256_popcnt_epi64(y);
+        dist += _mm256_extract_epi64(acc2, 0);
+        dist += _mm256_extract_epi64(acc2, 1);
+        dist += _mm256_extract_epi64(acc2, 2);
+        dist += _mm256_extract_epi64(acc2, 3);
+        i += 32;
     }
 
+    if (i < size)
+        dist += _hammingDistPopcnt(p1 + i, p2 + i, size - i);
     return dist;
 }
+# endif /* HAMMING_AVX512 */
+#endif /* HAMMING_X86 */
+
+static int implSupported(int impl)
+{
+#ifdef HAMMING_X86
+    __builtin_cpu_init();
+    if (impl == BOR_VPTREE_HAMMING_POPCNT)
+        return __builtin_cpu_supports("popcnt");
+    if (impl == BOR_VPTREE_HAMMING_AVX2)
+        return __builtin_cpu_supports("avx2")
+                && __builtin_cpu_supports("popcnt");
+# ifdef HAMMING_AVX512
+    if (impl == BOR_VPTREE_HAMMING_AVX512)
+        return __builtin_cpu_supports("avx512vpopcntdq")
+                && __builtin_cpu_supports("avx512vl")
+                && __builtin_cpu_supports("popcnt");
+# endif /* HAMMING_AVX512 */
+#endif /* HAMMING_X86 */
+    return impl == BOR_VPTREE_HAMMING_NONE;
+}
+
+int borVPTreeHammingImplSet(int impl)
+{
+    // AVX2 nibble lookup is slower than POPCNT for keys up to 512 bits
+    // so it is used only if explicitly requested
+    static const int pref[] = { BOR_VPTREE_HAMMING_AVX512,
+                                BOR_VPTREE_HAMMING_POPCNT,
+                                BOR_VPTREE_HAMMING_NONE };
+    hamming_dist_fn fn;
+    size_t i;
+
+    if (impl == BOR_VPTREE_HAMMING_AUTO || !implSupported(impl)){
+        for (i = 0; !implSupported(pref[i]); i++);
+        impl = pref[i];
+    }
+
+#ifdef HAMMING_X86
+# ifdef HAMMING_AVX512
+    if (impl == BOR_VPTREE_HAMMING_AVX512){
+        fn = hammingDistAVX512;
+    }else
+# endif /* HAMMING_AVX512 */
+    if (impl == BOR_VPTREE_HAMMING_AVX2){
+        fn = hammingDistAVX2;
+    }else if (impl == BOR_VPTREE_HAMMING_POPCNT){
+        fn = hammingDistPopcnt;
+    }else
+#endif /* HAMMING_X86 */
+    {
+        impl = BOR_VPTREE_HAMMING_NONE;
+        fn = hammingDistScalar;
+    }
+
+    // The kernel may be selected lazily by several threads at once,
+    // atomic stores make it safe (all of them store the same values).
+    __atomic_store_n(&hamming_dist, fn, __ATOMIC_RELEASE);
+    __atomic_store_n(&hamming_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+int borVPTreeHammingImpl(void)
+{
+    int impl;
+
+    impl = __atomic_load_n(&hamming_impl, __ATOMIC_ACQUIRE);
+    if (impl == BOR_VPTREE_HAMMING_AUTO)
+        impl = borVPTreeHammingImplSet(BOR_VPTREE_HAMMING_AUTO);
+    return impl;
+}
+
+int borVPTreeHammingDist(const unsigned char *p1, const unsigned char *p2,
+                         size_t size)
+{
+    return hammingDist(p1, p2, size);
+}
+
+_bor_inline hamming_dist_fn hammingDistFn(void)
+{
+    hamming_dist_fn fn;
+
+    fn = __atomic_load_n(&hamming_dist, __ATOMIC_ACQUIRE);
+    if (bor_unlikely(fn == NULL)){
+        borVPTreeHammingImplSet(BOR_VPTREE_HAMMING_AUTO);
+        fn = __atomic_load_n(&hamming_dist, __ATOMIC_ACQUIRE);
+    }
+    return fn;
+}
+
+_bor_inline int hammingDist(const unsigned char *p1,
+                            const unsigned char *p2,
+                            size_t size)
+{
+    return hammingDistFn()(p1, p2, size);
+}
 
 
 static int radiusVarCmp(const void *a, const void *b)
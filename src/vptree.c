@@ -19,6 +19,7 @@
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
 #include <boruvka/nn.h>
+#include <boruvka/task-pool.h>
 
 
 /** Finds out radius and variance */
@@ -57,17 +58,54 @@ static void nodeAddSplit(bor_vptree_t *vp,
                          _bor_vptree_node_t *n,
                          bor_vptree_el_t *el);
 
+/** Frozen tree **/
+/** Counts nodes, inner nodes and elements in subtree */
+static void flatCount(const _bor_vptree_node_t *n, size_t *nodes_len,
+                      size_t *inner_len, size_t *els_len);
+/** Frees frozen representation */
+static void flatDel(_bor_vptree_flat_t *flat);
+/** Rebuilds dynamic subtree from {i}'th node of the frozen tree */
+static _bor_vptree_node_t *flatThaw(bor_vptree_t *vp,
+                                    _bor_vptree_node_t *par, size_t i);
+
 /** Build **/
 struct _build_t {
     bor_vptree_t *vp;
     bor_rand_mt_t *rand;
     bor_real_t *dist;
-    bor_vptree_el_t **els;
     bor_vptree_el_t **ps;
     bor_vptree_el_t **ds;
 };
 typedef struct _build_t build_t;
 
+/** Subtree that is built independently of the rest of the tree */
+struct _build_task_t {
+    _bor_vptree_node_t *node; /*!< Already allocated root of subtree */
+    bor_vptree_el_t **els;
+    size_t els_len;
+    uint32_t seed;            /*!< Seed of random generator for the subtree */
+    size_t cur;               /*!< Output: size of left part or 0 if
+                                   .node wasn't split */
+};
+typedef struct _build_task_t build_task_t;
+
+/** Shared data of one level of parallel build */
+struct _build_level_t {
+    build_t *build;      /*!< Per-thread build structures */
+    build_task_t *tasks;
+    size_t len;
+    int *owner;          /*!< Thread assigned to each task */
+};
+typedef struct _build_level_t build_level_t;
+
+static void buildInit(build_t *build, bor_vptree_t *vp);
+static void buildFree(build_t *build);
+/** Processes one subtree: large subtrees are split one level, small
+ *  subtrees are built as a whole */
+static void buildTask(build_t *build, build_task_t *task);
+static void buildLevelTask(int id, void *data,
+                           const bor_task_pool_thinfo_t *thinfo);
+
 /** Adds all elements from els to node */
 static void buildAddEls(bor_vptree_t *vp,
                         _bor_vptree_node_t *node,
@@ -75,9 +113,14 @@ static void buildAddEls(bor_vptree_t *vp,
 /** Fills {els} with len samples from {els_in} */
 static void buildSampleEls(build_t *build, bor_vptree_el_t **els_in, size_t els_len,
                            bor_vptree_el_t **els, size_t len);
-/** Builds one level of vp-tree */
-static _bor_vptree_node_t *buildNode(build_t *build,
-                                     bor_vptree_el_t **els, size_t els_len);
+/** Finds vantage point of node and reorganizes els[] accordingly.
+ *  Returns number of elements in the left part or 0 if node became
+ *  leaf. */
+static size_t buildSplit(build_t *build, _bor_vptree_node_t *node,
+                         bor_vptree_el_t **els, size_t els_len);
+/** Recursively builds subtree rooted in {node} */
+static void buildNode(build_t *build, _bor_vptree_node_t *node,
+                      bor_vptree_el_t **els, size_t els_len);
 
 
 /** Returns distance between v1 and v2 */
@@ -97,6 +140,14 @@ void borVPTreeParamsInit(bor_vptree_params_t *params)
     params->maxsize = 2;
 
     params->samplesize = 5;
+
+    params->approx        = 0;
+    params->approx_eps    = BOR_ZERO;
+    params->approx_leaves = 0;
+
+    params->seed    = 0;
+    params->tp      = NULL;
+    params->parsize = 10000;
 }
 
 void borVPTreeElInit(bor_vptree_el_t *el, const bor_vec_t *p)
@@ -116,10 +167,13 @@ bor_vptree_t *borVPTreeNew(const bor_vptree_params_t *params)
     vp->params = *params;
 
     vp->root = NULL;
+    vp->flat = NULL;
 
     vp->els_size = vp->params.maxsize + 1;
     vp->els = BOR_ALLOC_ARR(bor_vptree_el_t *, vp->els_size);
 
+    vp->nodes = borMemPoolNew(0);
+
     return vp;
 }
 
@@ -127,8 +181,11 @@ void borVPTreeDel(bor_vptree_t *vp)
 {
     if (vp->root)
         nodeDel(vp, vp->root);
+    if (vp->flat)
+        flatDel(vp->flat);
     if (vp->els)
         BOR_FREE(vp->els);
+    borMemPoolDel(vp->nodes);
     BOR_FREE(vp);
 }
 
@@ -137,6 +194,9 @@ void borVPTreeAdd(bor_vptree_t *vp, bor_vptree_el_t *el)
 {
     _bor_vptree_node_t *node;
 
+    if (vp->flat)
+        borVPTreeThaw(vp);
+
     if (!vp->root){
         vp->root = nodeNew(vp);
         nodeAdd(vp, vp->root, el);
@@ -157,6 +217,9 @@ void borVPTreeRemove(bor_vptree_t *vp, bor_vptree_el_t *el)
 {
     _bor_vptree_node_t *node, *par, *other;
 
+    if (vp->flat)
+        borVPTreeThaw(vp);
+
     // get parent node
     node = el->node;
 
@@ -226,6 +289,12 @@ struct _nearest_t {
     bor_vptree_el_t **els;
     bor_real_t *dist;
     size_t els_len;
+
+    bor_real_t shrink; /*!< 1 / (1 + eps), 1 for exact search */
+    bor_real_t prune;  /*!< Radius used for pruning subtrees, i.e.,
+                            .radius * .shrink */
+    size_t leaves;     /*!< Remaining number of leaves that can be
+                            visited */
 };
 typedef struct _nearest_t nearest_t;
 
@@ -265,42 +334,183 @@ static void nearest(nearest_t *n, const _bor_vptree_node_t *node)
     bor_vptree_el_t *el;
     bor_real_t dist;
 
+    if (n->leaves == 0)
+        return;
+
     if (!node->left && !node->right){
         // node is leaf node, try to add all elements
+        --n->leaves;
         BOR_LIST_FOR_EACH(&node->els, item){
             el = BOR_LIST_ENTRY(item, bor_vptree_el_t, list);
             dist = borVPTreeDist(n->vp, n->p, el->p);
             if (dist < n->radius){
                 nearestAdd(n, el, dist);
                 n->radius = n->dist[n->num - 1];
+                n->prune  = n->radius * n->shrink;
             }
         }
     }else{
         d = borVPTreeDist(n->vp, n->p, node->vp);
         if (d < node->radius){
-            if (d < node->radius + n->radius)
+            if (d < node->radius + n->prune)
                 nearest(n, node->left);
 
-            d2 = node->radius - n->radius;
+            d2 = node->radius - n->prune;
             if (borEq(d, d2) || d > d2)
                 nearest(n, node->right);
         }else{
-            d2 = node->radius - n->radius;
+            d2 = node->radius - n->prune;
             if (borEq(d, d2) || d > d2)
                 nearest(n, node->right);
 
-            if (d < node->radius + n->radius)
+            if (d < node->radius + n->prune)
                 nearest(n, node->left);
         }
     }
 }
 
-size_t borVPTreeNearest(const bor_vptree_t *vp, const bor_vec_t *p, size_t num,
-                        bor_vptree_el_t **els)
+static void nearestFlat(nearest_t *n, uint32_t i)
+{
+    const _bor_vptree_flat_t *flat = n->vp->flat;
+    const _bor_vptree_fnode_t *node = flat->nodes + i;
+    const bor_real_t *pt;
+    int dim = n->vp->params.dim;
+    bor_real_t d, d2, dist;
+    uint32_t j;
+
+    if (n->leaves == 0)
+        return;
+
+    if (node->child == 0){
+        --n->leaves;
+        pt = flat->pts + (size_t)node->off * dim;
+        for (j = node->off; j < node->off + node->len; j++, pt += dim){
+            dist = borVPTreeDist(n->vp, n->p, pt);
+            if (dist < n->radius){
+                nearestAdd(n, flat->els[j], dist);
+                n->radius = n->dist[n->num - 1];
+                n->prune  = n->radius * n->shrink;
+            }
+        }
+    }else{
+        d = borVPTreeDist(n->vp, n->p, flat->vps + (size_t)node->off * dim);
+        if (d < node->radius){
+            if (d < node->radius + n->prune)
+                nearestFlat(n, node->child);
+
+            d2 = node->radius - n->prune;
+            if (borEq(d, d2) || d > d2)
+                nearestFlat(n, node->child + 1);
+        }else{
+            d2 = node->radius - n->prune;
+            if (borEq(d, d2) || d > d2)
+                nearestFlat(n, node->child + 1);
+
+            if (d < node->radius + n->prune)
+                nearestFlat(n, node->child);
+        }
+    }
+}
+
+/** Range */
+struct _range_t {
+    const bor_vptree_t *vp;
+    const bor_vec_t *p;
+    bor_real_t radius;
+    bor_vptree_range_fn cb;
+    void *data;
+    size_t found;
+};
+typedef struct _range_t range_t;
+
+static void range(range_t *r, const _bor_vptree_node_t *node)
+{
+    bor_list_t *item;
+    bor_vptree_el_t *el;
+    bor_real_t d;
+
+    if (!node->left && !node->right){
+        BOR_LIST_FOR_EACH(&node->els, item){
+            el = BOR_LIST_ENTRY(item, bor_vptree_el_t, list);
+            d = borVPTreeDist(r->vp, r->p, el->p);
+            if (d <= r->radius){
+                r->cb(el, d, r->data);
+                ++r->found;
+            }
+        }
+    }else{
+        // left subtree contains elements closer than node->radius to
+        // the vantage point
+        d = borVPTreeDist(r->vp, r->p, node->vp);
+        if (d < node->radius + r->radius)
+            range(r, node->left);
+        if (d + r->radius >= node->radius)
+            range(r, node->right);
+    }
+}
+
+static void rangeFlat(range_t *r, uint32_t i)
+{
+    const _bor_vptree_flat_t *flat = r->vp->flat;
+    const _bor_vptree_fnode_t *node = flat->nodes + i;
+    const bor_real_t *pt;
+    int dim = r->vp->params.dim;
+    bor_real_t d;
+    uint32_t j;
+
+    if (node->child == 0){
+        pt = flat->pts + (size_t)node->off * dim;
+        for (j = node->off; j < node->off + node->len; j++, pt += dim){
+            d = borVPTreeDist(r->vp, r->p, pt);
+            if (d <= r->radius){
+                r->cb(flat->els[j], d, r->data);
+                ++r->found;
+            }
+        }
+    }else{
+        d = borVPTreeDist(r->vp, r->p, flat->vps + (size_t)node->off * dim);
+        if (d < node->radius + r->radius)
+            rangeFlat(r, node->child);
+        if (d + r->radius >= node->radius)
+            rangeFlat(r, node->child + 1);
+    }
+}
+
+size_t borVPTreeRange(const bor_vptree_t *vp, const bor_vec_t *p,
+                      bor_real_t radius, bor_vptree_range_fn cb, void *data)
+{
+    range_t r;
+
+    if (radius < BOR_ZERO)
+        return 0;
+
+    r.vp     = vp;
+    r.p      = p;
+    r.radius = radius;
+    r.cb     = cb;
+    r.data   = data;
+    r.found  = 0;
+
+    if (vp->flat){
+        if (vp->flat->nodes_len > 0)
+            rangeFlat(&r, 0);
+    }else if (vp->root){
+        range(&r, vp->root);
+    }
+
+    return r.found;
+}
+
+static size_t _borVPTreeNearest(const bor_vptree_t *vp, const bor_vec_t *p,
+                                size_t num, bor_vptree_el_t **els,
+                                int approx)
 {
     nearest_t n;
     size_t i;
 
+    if (num == 0 || (!vp->root && (!vp->flat || vp->flat->nodes_len == 0)))
+        return 0;
+
     n.vp  = vp;
     n.p   = p;
     n.num = num;
@@ -309,17 +519,42 @@ size_t borVPTreeNearest(const bor_vptree_t *vp, const bor_vec_t *p, size_t num,
     n.els     = els;
     n.els_len = 0;
 
+    n.shrink = BOR_ONE;
+    n.leaves = (size_t)-1;
+    if (approx){
+        n.shrink = BOR_ONE / (BOR_ONE + vp->params.approx_eps);
+        if (vp->params.approx_leaves > 0)
+            n.leaves = vp->params.approx_leaves;
+    }
+    n.prune = n.radius;
+
     n.dist    = BOR_ALLOC_ARR(bor_real_t, num);
     for (i = 0; i < num; i++)
         n.dist[i] = BOR_REAL_MAX;
 
-    nearest(&n, vp->root);
+    if (vp->flat){
+        nearestFlat(&n, 0);
+    }else{
+        nearest(&n, vp->root);
+    }
 
     BOR_FREE(n.dist);
 
     return n.els_len;
 }
 
+size_t borVPTreeNearest(const bor_vptree_t *vp, const bor_vec_t *p, size_t num,
+                        bor_vptree_el_t **els)
+{
+    return _borVPTreeNearest(vp, p, num, els, vp->params.approx);
+}
+
+size_t borVPTreeNearestApprox(const bor_vptree_t *vp, const bor_vec_t *p,
+                              size_t num, bor_vptree_el_t **els)
+{
+    return _borVPTreeNearest(vp, p, num, els, 1);
+}
+
 
 static void dump(bor_vptree_t *vp, _bor_vptree_node_t *n, _bor_vptree_node_t *par,
                  int level, FILE *out)
@@ -352,10 +587,174 @@ static void dump(bor_vptree_t *vp, _bor_vptree_node_t *n, _bor_vptree_node_t *pa
     }
 
 }
+static void dumpFlat(bor_vptree_t *vp, uint32_t i, int level, FILE *out)
+{
+    const _bor_vptree_flat_t *flat = vp->flat;
+    const _bor_vptree_fnode_t *n = flat->nodes + i;
+    int dim = vp->params.dim;
+    uint32_t j;
+    int k;
+
+    for (k = 0; k < 4 * level; k++)
+        fprintf(out, " ");
+
+    if (n->child != 0){
+        fprintf(out, "vp: (");
+        borVecPrint(dim, flat->vps + (size_t)n->off * dim, out);
+        fprintf(out, "), %f", n->radius);
+        fprintf(out, " [%u]\n", (unsigned int)i);
+
+        dumpFlat(vp, n->child, level + 1, out);
+        dumpFlat(vp, n->child + 1, level + 1, out);
+    }else{
+        for (j = n->off; j < n->off + n->len; j++){
+            fprintf(out, "(");
+            borVecPrint(dim, flat->pts + (size_t)j * dim, out);
+            fprintf(out, ") ");
+        }
+        fprintf(out, " [%u]\n", (unsigned int)i);
+    }
+}
+
 void borVPTreeDump(bor_vptree_t *vp, FILE *out)
 {
     if (vp->root)
         dump(vp, vp->root, NULL, 0, out);
+    if (vp->flat && vp->flat->nodes_len > 0)
+        dumpFlat(vp, 0, 0, out);
+}
+
+
+void borVPTreeFreeze(bor_vptree_t *vp)
+{
+    _bor_vptree_flat_t *flat;
+    _bor_vptree_node_t **queue, *node;
+    _bor_vptree_fnode_t *fn;
+    bor_list_t *item;
+    bor_vptree_el_t *el;
+    size_t nodes_len, inner_len, els_len;
+    size_t head, tail, inner, i;
+    int dim = vp->params.dim;
+
+    if (vp->flat)
+        return;
+
+    nodes_len = inner_len = els_len = 0;
+    if (vp->root)
+        flatCount(vp->root, &nodes_len, &inner_len, &els_len);
+
+    flat = BOR_ALLOC(_bor_vptree_flat_t);
+    flat->nodes_len = nodes_len;
+    flat->els_len   = els_len;
+    flat->nodes = BOR_ALLOC_ARR(_bor_vptree_fnode_t, BOR_MAX(nodes_len, 1));
+    flat->vps   = BOR_ALLOC_ARR(bor_real_t, BOR_MAX(inner_len * dim, 1));
+    flat->pts   = BOR_ALLOC_ARR(bor_real_t, BOR_MAX(els_len * dim, 1));
+    flat->els   = BOR_ALLOC_ARR(bor_vptree_el_t *, BOR_MAX(els_len, 1));
+
+    // Nodes are laid out in breadth-first order so that both children
+    // of a node lie next to each other and the top levels of the tree
+    // that are visited by every query share few cache lines.
+    queue = BOR_ALLOC_ARR(_bor_vptree_node_t *, BOR_MAX(nodes_len, 1));
+    queue[0] = vp->root;
+    tail  = (vp->root ? 1 : 0);
+    inner = els_len = 0;
+    for (head = 0; head < tail; head++){
+        node = queue[head];
+        fn   = flat->nodes + head;
+
+        if (node->left && node->right){
+            fn->radius = node->radius;
+            fn->off    = inner;
+            fn->len    = 0;
+            fn->child  = tail;
+            borVecCopy(dim, flat->vps + inner * dim, node->vp);
+            ++inner;
+
+            queue[tail++] = node->left;
+            queue[tail++] = node->right;
+        }else{
+            fn->radius = BOR_ZERO;
+            fn->off    = els_len;
+            fn->len    = node->size;
+            fn->child  = 0;
+            BOR_LIST_FOR_EACH(&node->els, item){
+                el = BOR_LIST_ENTRY(item, bor_vptree_el_t, list);
+                flat->els[els_len] = el;
+                borVecCopy(dim, flat->pts + els_len * dim, el->p);
+                ++els_len;
+            }
+        }
+    }
+    BOR_FREE(queue);
+
+    // elements are no longer connected to any node
+    for (i = 0; i < els_len; i++){
+        borListInit(&flat->els[i]->list);
+        flat->els[i]->node = NULL;
+    }
+
+    if (vp->root)
+        nodeDel(vp, vp->root);
+    vp->root = NULL;
+    vp->flat = flat;
+}
+
+void borVPTreeThaw(bor_vptree_t *vp)
+{
+    if (!vp->flat)
+        return;
+
+    if (vp->flat->nodes_len > 0)
+        vp->root = flatThaw(vp, NULL, 0);
+    flatDel(vp->flat);
+    vp->flat = NULL;
+}
+
+static void flatCount(const _bor_vptree_node_t *n, size_t *nodes_len,
+                      size_t *inner_len, size_t *els_len)
+{
+    ++*nodes_len;
+    if (n->left && n->right){
+        ++*inner_len;
+        flatCount(n->left, nodes_len, inner_len, els_len);
+        flatCount(n->right, nodes_len, inner_len, els_len);
+    }else{
+        *els_len += n->size;
+    }
+}
+
+static void flatDel(_bor_vptree_flat_t *flat)
+{
+    BOR_FREE(flat->nodes);
+    BOR_FREE(flat->vps);
+    BOR_FREE(flat->pts);
+    BOR_FREE(flat->els);
+    BOR_FREE(flat);
+}
+
+static _bor_vptree_node_t *flatThaw(bor_vptree_t *vp,
+                                    _bor_vptree_node_t *par, size_t i)
+{
+    const _bor_vptree_fnode_t *fn = vp->flat->nodes + i;
+    _bor_vptree_node_t *node;
+    int dim = vp->params.dim;
+    uint32_t j;
+
+    node = nodeNew(vp);
+    node->parent = par;
+
+    if (fn->child == 0){
+        for (j = fn->off; j < fn->off + fn->len; j++)
+            nodeAdd(vp, node, vp->flat->els[j]);
+    }else{
+        node->radius = fn->radius;
+        node->vp = borVecNew(dim);
+        borVecCopy(dim, node->vp, vp->flat->vps + (size_t)fn->off * dim);
+        node->left  = flatThaw(vp, node, fn->child);
+        node->right = flatThaw(vp, node, fn->child + 1);
+    }
+
+    return node;
 }
 
 
@@ -480,7 +879,7 @@ static _bor_vptree_node_t *nodeNew(bor_vptree_t *vp)
 {
     _bor_vptree_node_t *node;
 
-    node = BOR_ALLOC(_bor_vptree_node_t);
+    node = BOR_POOL_ALLOC(vp->nodes, _bor_vptree_node_t);
     node->vp   = NULL;
     node->radius = BOR_ZERO;
     node->parent = node->left = node->right = NULL;
@@ -498,7 +897,7 @@ static void nodeDel(bor_vptree_t *vp, _bor_vptree_node_t *n)
         borVecDel(n->vp);
     }
 
-    BOR_FREE(n);
+    BOR_POOL_FREE(vp->nodes, _bor_vptree_node_t, n);
 }
 
 static void nodeAdd(bor_vptree_t *vp, _bor_vptree_node_t *n,
@@ -593,34 +992,170 @@ bor_vptree_t *borVPTreeBuild(const bor_vptree_params_t *params,
                              bor_vptree_el_t *_els, size_t els_len, size_t stride)
 {
     bor_vptree_t *vp;
-    build_t build;
-    size_t i;
+    bor_vptree_el_t **els;
+    bor_rand_mt_t *rand;
+    build_level_t level;
+    build_task_t *tasks, *next;
+    size_t *load;
+    size_t i, len, next_len, threads, parsize, t;
 
     vp = borVPTreeNew(params);
     vp->type = BOR_NN_VPTREE;
 
-    build.vp   = vp;
-    build.els  = BOR_ALLOC_ARR(bor_vptree_el_t *, els_len);
-    build.ps   = BOR_ALLOC_ARR(bor_vptree_el_t *, vp->params.samplesize);
-    build.ds   = BOR_ALLOC_ARR(bor_vptree_el_t *, vp->params.samplesize);
-    build.dist = BOR_ALLOC_ARR(bor_real_t, els_len);
-    build.rand = borRandMTNewAuto();
+    if (els_len == 0)
+        return vp;
+
+    els = BOR_ALLOC_ARR(bor_vptree_el_t *, els_len);
     for (i = 0; i < els_len; i++){
-        build.els[i] = _els;
+        els[i] = _els;
         _els = (bor_vptree_el_t *)((char *)_els + stride);
     }
 
-    vp->root = buildNode(&build, build.els, els_len);
+    if (vp->params.seed != 0){
+        rand = borRandMTNew(vp->params.seed);
+    }else{
+        rand = borRandMTNewAuto();
+    }
+
+    threads = (vp->params.tp ? borTaskPoolSize(vp->params.tp) : 1);
+    parsize = BOR_MAX(vp->params.parsize, vp->params.maxsize + 1);
+
+    level.build = BOR_ALLOC_ARR(build_t, threads);
+    for (i = 0; i < threads; i++)
+        buildInit(level.build + i, vp);
+    load = BOR_ALLOC_ARR(size_t, threads);
+
+    // The tree is built level by level. Each subtree on the level has
+    // its own random generator seeded from its parent, so the resulting
+    // tree depends only on the seed and .parsize and not on the number
+    // of threads or on the order in which subtrees are processed.
+    tasks = BOR_ALLOC(build_task_t);
+    tasks[0].node    = nodeNew(vp);
+    tasks[0].els     = els;
+    tasks[0].els_len = els_len;
+    tasks[0].seed    = borRandMTInt(rand);
+    len = 1;
+    vp->root = tasks[0].node;
+
+    while (len > 0){
+        level.tasks = tasks;
+        level.len   = len;
+
+        if (threads <= 1 || len == 1){
+            for (i = 0; i < len; i++)
+                buildTask(level.build, tasks + i);
+        }else{
+            // assign each subtree to the least loaded thread
+            level.owner = BOR_ALLOC_ARR(int, len);
+            bzero(load, sizeof(size_t) * threads);
+            for (i = 0; i < len; i++){
+                level.owner[i] = 0;
+                for (t = 1; t < threads; t++){
+                    if (load[t] < load[level.owner[i]])
+                        level.owner[i] = t;
+                }
+                load[level.owner[i]] += tasks[i].els_len;
+            }
+
+            for (t = 0; t < threads; t++){
+                borTaskPoolAdd(vp->params.tp, t, buildLevelTask, t,
+                               (void *)&level);
+            }
+            for (t = 0; t < threads; t++){
+                borTaskPoolBarrier(vp->params.tp, t);
+            }
+            BOR_FREE(level.owner);
+        }
 
-    BOR_FREE(build.els);
-    BOR_FREE(build.dist);
-    BOR_FREE(build.ps);
-    BOR_FREE(build.ds);
-    borRandMTDel(build.rand);
+        // collect large subtrees for the next level
+        next = BOR_ALLOC_ARR(build_task_t, 2 * len);
+        next_len = 0;
+        for (i = 0; i < len; i++){
+            if (tasks[i].els_len <= parsize || tasks[i].cur == 0)
+                continue;
+
+            next[next_len].node    = tasks[i].node->left;
+            next[next_len].els     = tasks[i].els;
+            next[next_len].els_len = tasks[i].cur;
+            next[next_len].seed    = borRandMTInt(rand);
+            ++next_len;
+
+            next[next_len].node    = tasks[i].node->right;
+            next[next_len].els     = tasks[i].els + tasks[i].cur;
+            next[next_len].els_len = tasks[i].els_len - tasks[i].cur;
+            next[next_len].seed    = borRandMTInt(rand);
+            ++next_len;
+        }
+
+        BOR_FREE(tasks);
+        tasks = next;
+        len   = next_len;
+    }
+    BOR_FREE(tasks);
+
+    for (i = 0; i < threads; i++)
+        buildFree(level.build + i);
+    BOR_FREE(level.build);
+    BOR_FREE(load);
+    BOR_FREE(els);
+    borRandMTDel(rand);
 
     return vp;
 }
 
+static void buildInit(build_t *build, bor_vptree_t *vp)
+{
+    build->vp   = vp;
+    build->ps   = BOR_ALLOC_ARR(bor_vptree_el_t *, vp->params.samplesize);
+    build->ds   = BOR_ALLOC_ARR(bor_vptree_el_t *, vp->params.samplesize);
+    build->dist = BOR_ALLOC_ARR(bor_real_t, vp->params.samplesize);
+    build->rand = borRandMTNew(0);
+}
+
+static void buildFree(build_t *build)
+{
+    BOR_FREE(build->ps);
+    BOR_FREE(build->ds);
+    BOR_FREE(build->dist);
+    borRandMTDel(build->rand);
+}
+
+static void buildTask(build_t *build, build_task_t *task)
+{
+    _bor_vptree_node_t *node = task->node;
+    size_t parsize;
+
+    borRandMTReseed(build->rand, task->seed);
+
+    parsize = BOR_MAX(build->vp->params.parsize,
+                      build->vp->params.maxsize + 1);
+    if (task->els_len <= parsize){
+        buildNode(build, node, task->els, task->els_len);
+        task->cur = 0;
+        return;
+    }
+
+    task->cur = buildSplit(build, node, task->els, task->els_len);
+    if (task->cur > 0){
+        node->left  = nodeNew(build->vp);
+        node->left->parent = node;
+        node->right = nodeNew(build->vp);
+        node->right->parent = node;
+    }
+}
+
+static void buildLevelTask(int id, void *data,
+                           const bor_task_pool_thinfo_t *thinfo)
+{
+    build_level_t *level = (build_level_t *)data;
+    size_t i;
+
+    for (i = 0; i < level->len; i++){
+        if (level->owner[i] == id)
+            buildTask(level->build + id, level->tasks + i);
+    }
+}
+
 static void buildAddEls(bor_vptree_t *vp,
                         _bor_vptree_node_t *node,
                         bor_vptree_el_t **els,
@@ -645,53 +1180,64 @@ static void buildSampleEls(build_t *build, bor_vptree_el_t **els_in, size_t els_
 }
 
 
-static _bor_vptree_node_t *buildNode(build_t *build,
-                                     bor_vptree_el_t **els, size_t els_len)
+static size_t buildSplit(build_t *build, _bor_vptree_node_t *node,
+                         bor_vptree_el_t **els, size_t els_len)
 {
-    _bor_vptree_node_t *node;
     size_t i, cur, len;
 
-    node = nodeNew(build->vp);
-
     if (els_len <= build->vp->params.maxsize){
         // all elements can fit to current node
         buildAddEls(build->vp, node, els, els_len);
+        return 0;
+    }
+
+    // create vantage point
+    node->vp = borVecNew(build->vp->params.dim);
+
+    // generate random sample of VPs and datas
+    if (build->vp->params.samplesize < els_len){
+        len = build->vp->params.samplesize;
+        buildSampleEls(build, els, els_len, build->ps, len);
+        buildSampleEls(build, els, els_len, build->ds, len);
     }else{
-        // create vantage point
-        node->vp = borVecNew(build->vp->params.dim);
-
-        // generate random sample of VPs and datas
-        if (build->vp->params.samplesize < els_len){
-            len = build->vp->params.samplesize;
-            buildSampleEls(build, els, els_len, build->ps, len);
-            buildSampleEls(build, els, els_len, build->ds, len);
-        }else{
-            len = els_len;
-            for (i = 0; i < len; i++){
-                build->ps[i] = els[i];
-                build->ds[i] = els[i];
-            }
+        len = els_len;
+        for (i = 0; i < len; i++){
+            build->ps[i] = els[i];
+            build->ds[i] = els[i];
         }
+    }
 
-        // find out best vantage point
-        bestVP(build->vp, build->ps, len, build->ds, len, build->dist,
-               node->vp, &node->radius);
+    // find out best vantage point
+    bestVP(build->vp, build->ps, len, build->ds, len, build->dist,
+           node->vp, &node->radius);
 
-        // reorganize elements
-        cur = reorganizeEls(build->vp, node->vp, node->radius, els, els_len);
+    // reorganize elements
+    cur = reorganizeEls(build->vp, node->vp, node->radius, els, els_len);
 
-        if (cur == 0 || cur == els_len){
-            buildAddEls(build->vp, node, els, els_len);
-            borVecDel(node->vp);
-            node->vp = NULL;
-        }else{
-            // create left and right descendants
-            node->left  = buildNode(build, els, cur);
-            node->left->parent = node;
-            node->right = buildNode(build, els + cur, els_len - cur);
-            node->right->parent = node;
-        }
+    if (cur == 0 || cur == els_len){
+        buildAddEls(build->vp, node, els, els_len);
+        borVecDel(node->vp);
+        node->vp = NULL;
+        return 0;
     }
 
-    return node;
+    return cur;
+}
+
+static void buildNode(build_t *build, _bor_vptree_node_t *node,
+                      bor_vptree_el_t **els, size_t els_len)
+{
+    size_t cur;
+
+    cur = buildSplit(build, node, els, els_len);
+    if (cur > 0){
+        // create left and right descendants
+        node->left  = nodeNew(build->vp);
+        node->left->parent = node;
+        buildNode(build, node->left, els, cur);
+
+        node->right = nodeNew(build->vp);
+        node->right->parent = node;
+        buildNode(build, node->right, els + cur, els_len - cur);
+    }
 }
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <boruvka/chull3.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/timer.h>
+#include "data.h"
+
+static bor_pc_t *sphere(size_t len)
+{
+    bor_rand_mt_t *rnd;
+    bor_pc_t *pc;
+    bor_vec_t *w;
+    bor_real_t x, y, z, d;
+
+    rnd = borRandMTNew(1234);
+    w = borVecNew(3);
+    pc = borPCNew(3);
+    while (borPCLen(pc) < len){
+        x = borRandMT(rnd, -1., 1.);
+        y = borRandMT(rnd, -1., 1.);
+        z = borRandMT(rnd, -1., 1.);
+        d = x * x + y * y + z * z;
+        if (d > 1. || d < 1e-6)
+            continue;
+        d = BOR_SQRT(d);
+        borVecSet(w, 0, x / d);
+        borVecSet(w, 1, y / d);
+        borVecSet(w, 2, z / d);
+        borPCAdd(pc, w);
+    }
+    borVecDel(w);
+    borRandMTDel(rnd);
+    return pc;
+}
+
+static bor_pc_t *bunny(void)
+{
+    bor_pc_t *pc;
+    bor_vec_t *w;
+    size_t i;
+
+    w = borVecNew(3);
+    pc = borPCNew(3);
+    for (i = 0; i < bunny_coords_len; i++){
+        borVecSet(w, 0, borVec3X(&bunny_coords[i]));
+        borVecSet(w, 1, borVec3Y(&bunny_coords[i]));
+        borVecSet(w, 2, borVec3Z(&bunny_coords[i]));
+        borPCAdd(pc, w);
+    }
+    borVecDel(w);
+    return pc;
+}
+
+static void report(const char *name, const char *method,
+                   bor_timer_t *timer, bor_chull3_t *h)
+{
+    borTimerStop(timer);
+    printf("%s %-16s %10lu us, %8d vertices\n", name, method,
+           borTimerElapsedInUs(timer), (int)borCHull3NumPoints(h));
+    borCHull3Del(h);
+}
+
+static void run(const char *name, bor_pc_t *pc, int threads, int add)
+{
+    bor_timer_t timer;
+    bor_chull3_t *h;
+    bor_task_pool_t *tp;
+    bor_pc_it_t pcit;
+    bor_vec_t *w;
+    bor_vec3_t v;
+    char method[32];
+
+    if (add){
+        borTimerStart(&timer);
+        h = borCHull3New();
+        borPCItInit(&pcit, pc);
+        for (; !borPCItEnd(&pcit); borPCItNext(&pcit)){
+            w = borPCItGet(&pcit);
+            borVec3Set(&v, borVecGet(w, 0), borVecGet(w, 1), borVecGet(w, 2));
+            borCHull3Add(h, &v);
+        }
+        report(name, "Add", &timer, h);
+    }
+
+    borTimerStart(&timer);
+    h = borCHull3New();
+    borCHull3AddPoints(h, pc);
+    report(name, "AddPoints", &timer, h);
+
+    borTimerStart(&timer);
+    h = borCHull3NewQuickhull(pc, NULL);
+    report(name, "Quickhull", &timer, h);
+
+    tp = borTaskPoolNew(threads);
+    borTaskPoolRun(tp);
+    borTimerStart(&timer);
+    h = borCHull3NewQuickhull(pc, tp);
+    sprintf(method, "Quickhull-%dth", threads);
+    report(name, method, &timer, h);
+    borTaskPoolDel(tp);
+}
+
+int main(int argc, char *argv[])
+{
+    bor_pc_t *pc;
+    size_t len = 10000;
+    int threads = 4;
+
+    if (argc > 1)
+        len = atol(argv[1]);
+    if (argc > 2)
+        threads = atoi(argv[2]);
+
+    pc = bunny();
+    run("bunny ", pc, threads, 1);
+    borPCDel(pc);
+
+    pc = sphere(len);
+    run("sphere", pc, threads, len <= 10000);
+    borPCDel(pc);
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <boruvka/dij.h>
+#include <boruvka/graph-csr.h>
+#include <boruvka/alloc.h>
+#include <boruvka/timer.h>
+
+/** Graph in adjacency arrays */
+struct _graph_t {
+    int num_nodes;
+    bor_dij_node_t *node;
+    int *edge_begin;     /*!< Edges of node i are in [edge_begin[i],
+                              edge_begin[i + 1]) */
+    int *edge_to;
+    bor_real_t *edge_w;
+    int num_edges;
+    int alloc_edges;
+};
+typedef struct _graph_t graph_t;
+
+static void graphInit(graph_t *g, int num_nodes)
+{
+    g->num_nodes = num_nodes;
+    g->node = BOR_ALLOC_ARR(bor_dij_node_t, num_nodes);
+    g->edge_begin = BOR_CALLOC_ARR(int, num_nodes + 1);
+    g->num_edges = 0;
+    g->alloc_edges = 4 * num_nodes;
+    g->edge_to = BOR_ALLOC_ARR(int, g->alloc_edges);
+    g->edge_w = BOR_ALLOC_ARR(bor_real_t, g->alloc_edges);
+}
+
+static void graphFree(graph_t *g)
+{
+    BOR_FREE(g->node);
+    BOR_FREE(g->edge_begin);
+    BOR_FREE(g->edge_to);
+    BOR_FREE(g->edge_w);
+}
+
+/** Edges must be added in order of their source nodes */
+static void graphAddEdge(graph_t *g, int from, int to, bor_real_t w)
+{
+    if (g->num_edges == g->alloc_edges){
+        g->alloc_edges *= 2;
+        g->edge_to = BOR_REALLOC_ARR(g->edge_to, int, g->alloc_edges);
+        g->edge_w = BOR_REALLOC_ARR(g->edge_w, bor_real_t, g->alloc_edges);
+    }
+    g->edge_to[g->num_edges] = to;
+    g->edge_w[g->num_edges] = w;
+    ++g->num_edges;
+    g->edge_begin[from + 1] = g->num_edges;
+}
+
+static void graphFinalize(graph_t *g)
+{
+    int i;
+    for (i = 1; i <= g->num_nodes; ++i){
+        if (g->edge_begin[i] < g->edge_begin[i - 1])
+            g->edge_begin[i] = g->edge_begin[i - 1];
+    }
+}
+
+static void expand(bor_dij_node_t *n, bor_list_t *list, void *data)
+{
+    graph_t *g = data;
+    int id, i, to;
+
+    id = n - g->node;
+    for (i = g->edge_begin[id]; i < g->edge_begin[id + 1]; ++i){
+        to = g->edge_to[i];
+        if (!borDijNodeClosed(&g->node[to]))
+            borDijNodeAdd(&g->node[to], list, g->edge_w[i]);
+    }
+}
+
+/** Grid with 4-neighborhood and random integer weights from [1, 100] */
+static void gridGraph(graph_t *g, int side)
+{
+    int x, y, id;
+
+    graphInit(g, side * side);
+    for (y = 0; y < side; ++y){
+        for (x = 0; x < side; ++x){
+            id = y * side + x;
+            if (x > 0)
+                graphAddEdge(g, id, id - 1, 1 + rand() % 100);
+            if (x < side - 1)
+                graphAddEdge(g, id, id + 1, 1 + rand() % 100);
+            if (y > 0)
+                graphAddEdge(g, id, id - side, 1 + rand() % 100);
+            if (y < side - 1)
+                graphAddEdge(g, id, id + side, 1 + rand() % 100);
+        }
+    }
+    graphFinalize(g);
+}
+
+/**
+ * Road-like graph: nodes are jittered grid points, local roads connect
+ * neighbors (some are missing), every 32nd row and column is a faster
+ * highway. Weights are travel times (real numbers).
+ */
+static void roadGraph(graph_t *g, int side)
+{
+    static const int dx[4] = { -1, 1, 0, 0 };
+    static const int dy[4] = { 0, 0, -1, 1 };
+    bor_real_t *px, *py, w, speed;
+    int x, y, nx, ny, id, nid, i;
+
+    px = BOR_ALLOC_ARR(bor_real_t, side * side);
+    py = BOR_ALLOC_ARR(bor_real_t, side * side);
+    for (i = 0; i < side * side; ++i){
+        px[i] = i % side + 0.4 * rand() / (bor_real_t)RAND_MAX;
+        py[i] = i / side + 0.4 * rand() / (bor_real_t)RAND_MAX;
+    }
+
+    graphInit(g, side * side);
+    for (y = 0; y < side; ++y){
+        for (x = 0; x < side; ++x){
+            id = y * side + x;
+            for (i = 0; i < 4; ++i){
+                nx = x + dx[i];
+                ny = y + dy[i];
+                if (nx < 0 || nx >= side || ny < 0 || ny >= side)
+                    continue;
+
+                speed = 1.;
+                if ((dx[i] != 0 && y % 32 == 0) || (dy[i] != 0 && x % 32 == 0)){
+                    speed = 4.;
+                }else if ((id * 7 + i * 13) % 10 == 0){
+                    // missing local road
+                    continue;
+                }
+
+                nid = ny * side + nx;
+                w = BOR_SQRT(BOR_SQ(px[id] - px[nid])
+                                + BOR_SQ(py[id] - py[nid]));
+                graphAddEdge(g, id, nid, w / speed);
+            }
+        }
+    }
+    graphFinalize(g);
+
+    BOR_FREE(px);
+    BOR_FREE(py);
+}
+
+static void run(const char *name, graph_t *g, int heap, bor_real_t scale,
+                bor_real_t *check)
+{
+    static const char *heap_name[] = { "pairing", "bucket", "radix" };
+    bor_dij_ops_t ops;
+    bor_dij_t *dij;
+    bor_timer_t timer;
+    bor_real_t d;
+    int i;
+
+    for (i = 0; i < g->num_nodes; ++i)
+        borDijNodeInit(&g->node[i]);
+
+    borDijOpsInit(&ops);
+    ops.expand = expand;
+    ops.data = g;
+    dij = borDijNew(&ops);
+    borDijSetHeap(dij, heap, scale);
+
+    borTimerStart(&timer);
+    borDijRun(dij, &g->node[0], NULL);
+    borTimerStop(&timer);
+
+    d = borDijDist(&g->node[g->num_nodes - 1]);
+    if (*check < 0)
+        *check = d;
+    printf("%-6s %-8s %8lu us  dist: %f (diff %g)\n", name, heap_name[heap],
+           borTimerElapsedInUs(&timer), (double)d, (double)(d - *check));
+
+    borDijDel(dij);
+}
+
+static void runCSR(const char *name, graph_t *g, bor_real_t *check)
+{
+    bor_graph_csr_t *csr;
+    bor_timer_t timer;
+    bor_real_t *dist;
+    int *src, i, j;
+
+    src = BOR_ALLOC_ARR(int, g->num_edges);
+    for (i = 0; i < g->num_nodes; ++i){
+        for (j = g->edge_begin[i]; j < g->edge_begin[i + 1]; ++j)
+            src[j] = i;
+    }
+    csr = borGraphCSRNew(g->num_nodes, g->num_edges, src, g->edge_to,
+                         g->edge_w);
+    dist = BOR_ALLOC_ARR(bor_real_t, g->num_nodes);
+
+    borTimerStart(&timer);
+    borGraphCSRDij(csr, 0, -1, dist, NULL);
+    borTimerStop(&timer);
+
+    printf("%-6s %-8s %8lu us  dist: %f (diff %g)\n", name, "csr",
+           borTimerElapsedInUs(&timer), (double)dist[g->num_nodes - 1],
+           (double)(dist[g->num_nodes - 1] - *check));
+
+    BOR_FREE(dist);
+    BOR_FREE(src);
+    borGraphCSRDel(csr);
+}
+
+int main(int argc, char *argv[])
+{
+    graph_t g;
+    bor_real_t check;
+    int side = 1000;
+
+    if (argc > 1)
+        side = atoi(argv[1]);
+
+    srand(1234);
+    gridGraph(&g, side);
+    check = -1;
+    run("grid", &g, BOR_DIJ_HEAP_PAIRING, 1, &check);
+    run("grid", &g, BOR_DIJ_HEAP_BUCKET, 1, &check);
+    run("grid", &g, BOR_DIJ_HEAP_RADIX, 1, &check);
+    runCSR("grid", &g, &check);
+    graphFree(&g);
+
+    roadGraph(&g, side);
+    check = -1;
+    run("road", &g, BOR_DIJ_HEAP_PAIRING, 1, &check);
+    run("road", &g, BOR_DIJ_HEAP_BUCKET, 1000, &check);
+    run("road", &g, BOR_DIJ_HEAP_RADIX, 1000, &check);
+    runCSR("road", &g, &check);
+    graphFree(&g);
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <string.h>
+#include <boruvka/vec.h>
+#include <boruvka/rand.h>
+#include <boruvka/alloc.h>
+#include <boruvka/timer.h>
+
+static const char *impl_name[] = { "auto", "scalar", "sse", "avx2" };
+
+/** Block of candidates passed to the kernel at once, the same value
+ *  is used by GUG and nn-linear */
+#define BLOCK 16
+
+/** Each measurement is repeated and the fastest run is reported to
+ *  filter out noise. All variants are run in each round, so they are
+ *  measured under the same conditions. */
+#define REPEAT 9
+
+#define LOOP   0
+#define BATCH  1
+#define SOA    2
+
+struct _bench_t {
+    size_t dim, len, loops;
+    bor_vec_t *p, *pts, *soa;
+    const bor_vec_t **ps;
+    bor_real_t *dist;
+    bor_real_t sum;
+};
+typedef struct _bench_t bench_t;
+
+static unsigned long run(bench_t *b, int type)
+{
+    bor_timer_t timer;
+    size_t i, l;
+
+    b->sum = BOR_ZERO;
+    borTimerStart(&timer);
+    for (l = 0; l < b->loops; l++){
+        if (type == LOOP){
+            // reference scalar loop as used before batch kernels
+            for (i = 0; i < b->len; i++)
+                b->dist[i] = borVecDist2(b->dim, b->p, b->ps[i]);
+        }else if (type == BATCH){
+            for (i = 0; i < b->len; i += BLOCK)
+                borVecDist2Batch(b->dim, b->p, b->ps + i,
+                                 BOR_MIN(BLOCK, b->len - i), b->dist + i);
+        }else{
+            for (i = 0; i < b->len; i += BLOCK)
+                borVecDist2BatchSoA(b->dim, b->p, b->soa + i, b->len,
+                                    BOR_MIN(BLOCK, b->len - i),
+                                    b->dist + i);
+        }
+        b->sum += b->dist[l % b->len];
+    }
+    borTimerStop(&timer);
+
+    return borTimerElapsedInUs(&timer);
+}
+
+/** Runs variant {type} with implementation {impl} (-1 means no change)
+ *  and keeps the best time in {best} */
+static void runBest(bench_t *b, int type, int impl, unsigned long *best)
+{
+    unsigned long t;
+
+    if (impl != -1 && borVecSIMDSet(impl) != impl
+            && impl != BOR_VEC_SIMD_AUTO)
+        return;
+    t = run(b, type);
+    if (t < *best)
+        *best = t;
+}
+
+static void bench(size_t dim, size_t len, size_t loops)
+{
+    bench_t b;
+    bor_rand_t r;
+    unsigned long loop, batch[4], soa[4], autob;
+    size_t i, j;
+    int impl, rep;
+
+    borRandInit(&r);
+    b.dim   = dim;
+    b.len   = len;
+    b.loops = loops;
+    b.p     = borVecNew(dim);
+    b.pts   = borVecNew(dim * len);
+    b.soa   = borVecNew(dim * len);
+    b.ps    = BOR_ALLOC_ARR(const bor_vec_t *, len);
+    b.dist  = BOR_ALLOC_ARR(bor_real_t, len);
+
+    for (j = 0; j < dim; j++)
+        borVecSet(b.p, j, borRand(&r, -10., 10.));
+    for (i = 0; i < len; i++){
+        b.ps[i] = b.pts + i * dim;
+        for (j = 0; j < dim; j++){
+            b.pts[i * dim + j] = borRand(&r, -10., 10.);
+            b.soa[j * len + i] = b.pts[i * dim + j];
+        }
+    }
+
+    loop = autob = (unsigned long)-1;
+    for (impl = 0; impl < 4; impl++)
+        batch[impl] = soa[impl] = (unsigned long)-1;
+
+    for (rep = 0; rep < REPEAT; rep++){
+        runBest(&b, LOOP, -1, &loop);
+        for (impl = BOR_VEC_SIMD_NONE; impl <= BOR_VEC_SIMD_AVX2; impl++){
+            runBest(&b, BATCH, impl, &batch[impl]);
+            runBest(&b, SOA, impl, &soa[impl]);
+        }
+        runBest(&b, BATCH, BOR_VEC_SIMD_AUTO, &autob);
+    }
+
+    printf(" - d: %2d - borVecDist2 loop      - %8lu us\n", (int)dim, loop);
+    for (impl = BOR_VEC_SIMD_NONE; impl <= BOR_VEC_SIMD_AVX2; impl++){
+        if (batch[impl] == (unsigned long)-1)
+            continue;
+        printf(" - d: %2d - batch %-6s          - %8lu us\n",
+               (int)dim, impl_name[impl], batch[impl]);
+        printf(" - d: %2d - batch SoA %-6s      - %8lu us\n",
+               (int)dim, impl_name[impl], soa[impl]);
+    }
+
+    // the path selected automatically must not be slower than the plain
+    // loop, neither the inlined one nor the one compiled in the library
+    borVecSIMDSet(BOR_VEC_SIMD_AUTO);
+    printf(" - d: %2d - batch auto (%-6s)   - %8lu us - %.2fx of loop,"
+           " %.2fx of batch scalar\n",
+           (int)dim, impl_name[borVecSIMD()], autob,
+           (double)autob / loop, (double)autob / batch[BOR_VEC_SIMD_NONE]);
+
+    borVecDel(b.p);
+    borVecDel(b.pts);
+    borVecDel(b.soa);
+    BOR_FREE(b.ps);
+    BOR_FREE(b.dist);
+}
+
+int main(int argc, char *argv[])
+{
+    static const size_t dims[] = { 2, 3, 4, 6, 8, 12, 16, 32 };
+    size_t len, loops, i;
+
+    if (argc != 3){
+        fprintf(stderr, "Usage: %s num_points loops\n", argv[0]);
+        return -1;
+    }
+    len   = atoi(argv[1]);
+    loops = atoi(argv[2]);
+
+    for (i = 0; i < sizeof(dims) / sizeof(dims[0]); i++)
+        bench(dims[i], len, loops);
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <boruvka/predicates.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/timer.h>
+#include <boruvka/alloc.h>
+
+#define RANDOM 0
+#define NEAR   1
+#define EXACT  2
+static const char *regime_name[] = { "random", "near-degen", "degenerate" };
+
+static bor_vec2_t a2, b2, c2;
+static bor_vec3_t a3, b3, c3, d3;
+
+/** Fixed points lie on the line x + y = 1 (a2, b2), the unit circle
+ *  (a2, b2, c2), the plane x + y + z = 1 (a3, b3, c3) and the unit
+ *  sphere (a3, b3, c3, d3). */
+static void fixedPoints(void)
+{
+    borVec2Set(&a2, 1., 0.);
+    borVec2Set(&b2, 0., 1.);
+    borVec2Set(&c2, -1., 0.);
+    borVec3Set(&a3, 1., 0., 0.);
+    borVec3Set(&b3, 0., 1., 0.);
+    borVec3Set(&c3, 0., 0., 1.);
+    borVec3Set(&d3, -1., 0., 0.);
+}
+
+/** Queries for the orientation predicates and for the in-circle/sphere
+ *  predicates. Near degenerate points are computed in floating-point so
+ *  they lie on the line/plane/circle/sphere only up to rounding. */
+static void queries(bor_rand_mt_t *rnd, int regime, size_t n,
+                    bor_vec2_t *o2, bor_vec3_t *o3,
+                    bor_vec2_t *s2, bor_vec3_t *s3)
+{
+    static const bor_real_t unit[6][3] = { { 1., 0., 0. }, { 0., 1., 0. },
+                                           { 0., 0., 1. }, { -1., 0., 0. },
+                                           { 0., -1., 0. }, { 0., 0., -1. } };
+    bor_real_t x, y, z, len;
+    size_t i;
+    int k, m;
+
+    for (i = 0; i < n; i++){
+        if (regime == RANDOM){
+            borVec2Set(&o2[i], borRandMT(rnd, -1., 1.),
+                               borRandMT(rnd, -1., 1.));
+            borVec3Set(&o3[i], borRandMT(rnd, -1., 1.),
+                               borRandMT(rnd, -1., 1.),
+                               borRandMT(rnd, -1., 1.));
+            borVec2Copy(&s2[i], &o2[i]);
+            borVec3Copy(&s3[i], &o3[i]);
+
+        }else if (regime == NEAR){
+            x = borRandMT(rnd, -1., 1.);
+            y = borRandMT(rnd, -1., 1.);
+            borVec2Set(&o2[i], x, BOR_ONE - x);
+            borVec3Set(&o3[i], x, y, BOR_ONE - x - y);
+
+            x = borRandMT(rnd, -1., 1.);
+            borVec2Set(&s2[i], BOR_COS(x * M_PI), BOR_SIN(x * M_PI));
+            do {
+                x = borRandMT(rnd, -1., 1.);
+                y = borRandMT(rnd, -1., 1.);
+                z = borRandMT(rnd, -1., 1.);
+                len = BOR_SQRT(x * x + y * y + z * z);
+            } while (len < 0.1 || len > 1.);
+            borVec3Set(&s3[i], x / len, y / len, z / len);
+
+        }else{
+            k = (int)borRandMT(rnd, -100., 100.);
+            m = (int)borRandMT(rnd, -100., 100.);
+            borVec2Set(&o2[i], k, 1 - k);
+            borVec3Set(&o3[i], k, m, 1 - k - m);
+
+            k = i % 6;
+            borVec2Set(&s2[i], unit[k % 4][0], unit[k % 4][1]);
+            borVec3Set(&s3[i], unit[k][0], unit[k][1], unit[k][2]);
+        }
+    }
+}
+
+static int sgn(bor_real_t v)
+{
+    return (v > BOR_ZERO) - (v < BOR_ZERO);
+}
+
+static void report(const char *pred, int regime, size_t n,
+                   unsigned long scalar_us, unsigned long batch_us,
+                   size_t exact, size_t mismatch)
+{
+    printf("%-10s %-10s %9.2f ns/q scalar, %9.2f ns/q batch,"
+           " exact %8lu (%6.2f%%)%s\n",
+           pred, regime_name[regime],
+           1000. * scalar_us / n, 1000. * batch_us / n,
+           (unsigned long)exact, 100. * exact / n,
+           (mismatch ? "  MISMATCH" : ""));
+}
+
+#define BENCH(name, SCALAR, BATCH) \
+    do { \
+        borTimerStart(&timer); \
+        for (i = 0; i < n; i++) \
+            sres[i] = SCALAR; \
+        borTimerStop(&timer); \
+        scalar_us = borTimerElapsedInUs(&timer); \
+        \
+        borTimerStart(&timer); \
+        exact = BATCH; \
+        borTimerStop(&timer); \
+        batch_us = borTimerElapsedInUs(&timer); \
+        \
+        for (mismatch = 0, i = 0; i < n; i++) \
+            mismatch += (sgn(sres[i]) != sgn(bres[i])); \
+        report(name, regime, n, scalar_us, batch_us, exact, mismatch); \
+    } while (0)
+
+int main(int argc, char *argv[])
+{
+    bor_pred_t pred;
+    bor_rand_mt_t *rnd;
+    bor_timer_t timer;
+    bor_vec2_t *o2, *s2;
+    bor_vec3_t *o3, *s3;
+    bor_real_t *sres, *bres;
+    unsigned long scalar_us, batch_us;
+    size_t i, n = 1000000, exact, mismatch;
+    int regime;
+
+    if (argc > 1)
+        n = atol(argv[1]);
+
+    borPredInit(&pred);
+    fixedPoints();
+    rnd = borRandMTNew(1234);
+
+    o2 = BOR_ALLOC_ALIGN_ARR(bor_vec2_t, n, 16);
+    s2 = BOR_ALLOC_ALIGN_ARR(bor_vec2_t, n, 16);
+    o3 = borVec3ArrNew(n);
+    s3 = borVec3ArrNew(n);
+    sres = BOR_ALLOC_ARR(bor_real_t, n);
+    bres = BOR_ALLOC_ARR(bor_real_t, n);
+
+    for (regime = RANDOM; regime <= EXACT; regime++){
+        queries(rnd, regime, n, o2, o3, s2, s3);
+
+        BENCH("orient2d",
+              borPredOrient2d(&pred, &a2, &b2, &o2[i]),
+              borPredOrient2dBatch(&pred, &a2, &b2, o2, n, bres));
+        BENCH("orient3d",
+              borPredOrient3d(&pred, &a3, &b3, &c3, &o3[i]),
+              borPredOrient3dBatch(&pred, &a3, &b3, &c3, o3, n, bres));
+        BENCH("incircle",
+              borPredInCircle(&pred, &a2, &b2, &c2, &s2[i]),
+              borPredInCircleBatch(&pred, &a2, &b2, &c2, s2, n, bres));
+        BENCH("insphere",
+              borPredInSphere(&pred, &a3, &b3, &c3, &d3, &s3[i]),
+              borPredInSphereBatch(&pred, &a3, &b3, &c3, &d3, s3, n, bres));
+    }
+
+    BOR_FREE(bres);
+    BOR_FREE(sres);
+    borVec3ArrDel(s3);
+    borVec3ArrDel(o3);
+    BOR_FREE(s2);
+    BOR_FREE(o2);
+    borRandMTDel(rnd);
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <boruvka/qhull.h>
+#include <boruvka/delaunay.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/timer.h>
+
+static bor_pc_t *cube(size_t len)
+{
+    bor_rand_mt_t *rnd;
+    bor_pc_t *pc;
+    bor_vec_t *w;
+    size_t i;
+
+    rnd = borRandMTNew(1234);
+    w = borVecNew(3);
+    pc = borPCNew(3);
+    for (i = 0; i < len; i++){
+        borVecSet(w, 0, borRandMT(rnd, -1., 1.));
+        borVecSet(w, 1, borRandMT(rnd, -1., 1.));
+        borVecSet(w, 2, borRandMT(rnd, -1., 1.));
+        borPCAdd(pc, w);
+    }
+    borVecDel(w);
+    borRandMTDel(rnd);
+    return pc;
+}
+
+static void report(size_t len, const char *method,
+                   bor_timer_t *timer, bor_qhull_mesh3_t *m)
+{
+    borTimerStop(timer);
+    if (!m){
+        printf("%8d %-10s failed\n", (int)len, method);
+        return;
+    }
+    printf("%8d %-10s %10lu us, %8.3f us/point, %9d edges\n",
+           (int)len, method, borTimerElapsedInUs(timer),
+           (double)borTimerElapsedInUs(timer) / len,
+           (int)borMesh3EdgesLen(borQHullMesh3(m)));
+    borQHullMesh3Del(m);
+}
+
+int main(int argc, char *argv[])
+{
+    bor_qdelaunay_t *q;
+    bor_timer_t timer;
+    bor_pc_t *pc;
+    size_t len, max_len = 100000;
+    int external;
+
+    if (argc > 1)
+        max_len = atol(argv[1]);
+
+    q = borQDelaunayNew();
+    if (argc > 2)
+        borQDelaunaySetPath(q, argv[2]);
+    external = (access(borQDelaunayPath(q), X_OK) == 0);
+    if (!external)
+        fprintf(stderr, "%s not found, qdelaunay bridge is skipped\n",
+                borQDelaunayPath(q));
+
+    for (len = 1000; len <= max_len; len *= 10){
+        pc = cube(len);
+
+        borTimerStart(&timer);
+        report(len, "in-process", &timer, borDelaunayMesh3(pc));
+
+        if (external){
+            borTimerStart(&timer);
+            report(len, "qdelaunay", &timer, borQDelaunayMesh3(q, pc));
+        }
+
+        borPCDel(pc);
+    }
+
+    borQDelaunayDel(q);
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <boruvka/ring_queue.h>
+#include <boruvka/ring_queue_mpmc.h>
+#include <boruvka/timer.h>
+
+/** Size of the ring buffer */
+#define QUEUE_SIZE 1024
+/** Number of elements moved at once in batch mode */
+#define BATCH 16
+
+struct _bench_t {
+    int impl;                 /*!< 0: bor_ring_queue_t, 1: MPMC,
+                                   2: MPMC with batches */
+    bor_ring_queue_t rq;
+    bor_ring_queue_mpmc_t mq;
+    long per_producer;        /*!< Messages sent by each producer */
+    long sum[64];
+};
+typedef struct _bench_t bench_t;
+
+struct _th_t {
+    bench_t *b;
+    int id;
+};
+typedef struct _th_t th_t;
+
+static void push(bench_t *b, void *d)
+{
+    if (b->impl == 0){
+        borRingQueuePush(&b->rq, d);
+    }else{
+        borRingQueueMPMCPushBlock(&b->mq, d);
+    }
+}
+
+static void *producer(void *_th)
+{
+    th_t *th = (th_t *)_th;
+    bench_t *b = th->b;
+    void *batch[BATCH];
+    long i, j, len;
+
+    if (b->impl == 2){
+        for (i = 0; i < b->per_producer;){
+            len = BATCH;
+            if (b->per_producer - i < len)
+                len = b->per_producer - i;
+            for (j = 0; j < len; ++j)
+                batch[j] = (void *)(i + j + 1);
+            j = borRingQueueMPMCPushBatch(&b->mq, batch, len);
+            if (j == 0)
+                borRingQueueMPMCPushBlock(&b->mq, batch[j++]);
+            i += j;
+        }
+    }else{
+        for (i = 0; i < b->per_producer; ++i)
+            push(b, (void *)(i + 1));
+    }
+    return NULL;
+}
+
+static void *consumer(void *_th)
+{
+    th_t *th = (th_t *)_th;
+    bench_t *b = th->b;
+    void *batch[BATCH];
+    long sum = 0;
+    size_t i, len;
+    int stop = 0;
+    void *d;
+
+    while (!stop){
+        if (b->impl == 2){
+            len = borRingQueueMPMCPopBatch(&b->mq, batch, BATCH);
+            if (len == 0){
+                batch[0] = borRingQueueMPMCPopBlock(&b->mq);
+                len = 1;
+            }
+            for (i = 0; i < len; ++i){
+                if (batch[i] == NULL){
+                    if (stop++)
+                        push(b, NULL);
+                }else{
+                    sum += (long)batch[i];
+                }
+            }
+
+        }else{
+            if (b->impl == 0){
+                d = borRingQueuePopBlock(&b->rq);
+            }else{
+                d = borRingQueueMPMCPopBlock(&b->mq);
+            }
+            if (d == NULL)
+                break;
+            sum += (long)d;
+        }
+    }
+
+    b->sum[th->id] = sum;
+    return NULL;
+}
+
+static void bench(int impl, int producers, int consumers, long msgs)
+{
+    static const char *name[] = { "ring-queue", "mpmc", "mpmc-batch" };
+    bench_t b;
+    pthread_t th[64];
+    th_t thd[64];
+    bor_timer_t timer;
+    long sum, expected;
+    int i;
+
+    b.impl = impl;
+    b.per_producer = msgs / producers;
+    if (impl == 0){
+        borRingQueueInit(&b.rq, QUEUE_SIZE);
+    }else{
+        borRingQueueMPMCInit(&b.mq, QUEUE_SIZE);
+    }
+
+    borTimerStart(&timer);
+    for (i = 0; i < consumers; ++i){
+        thd[i].b = &b;
+        thd[i].id = i;
+        pthread_create(th + i, NULL, consumer, thd + i);
+    }
+    for (i = 0; i < producers; ++i){
+        thd[consumers + i].b = &b;
+        thd[consumers + i].id = consumers + i;
+        pthread_create(th + consumers + i, NULL, producer, thd + consumers + i);
+    }
+    for (i = 0; i < producers; ++i)
+        pthread_join(th[consumers + i], NULL);
+    for (i = 0; i < consumers; ++i)
+        push(&b, NULL);
+    for (i = 0; i < consumers; ++i)
+        pthread_join(th[i], NULL);
+    borTimerStop(&timer);
+
+    sum = 0;
+    for (i = 0; i < consumers; ++i)
+        sum += b.sum[i];
+    expected = producers * (b.per_producer * (b.per_producer + 1) / 2);
+
+    printf("%-10s P: %2d, C: %2d, msgs: %ld, time: %8lu us, %7.2f Mmsg/s%s\n",
+           name[impl], producers, consumers, producers * b.per_producer,
+           borTimerElapsedInUs(&timer),
+           (double)(producers * b.per_producer)
+                / (double)borTimerElapsedInUs(&timer),
+           (sum == expected ? "" : " [WRONG SUM]"));
+    fflush(stdout);
+
+    if (impl == 0){
+        borRingQueueFree(&b.rq);
+    }else{
+        borRingQueueMPMCFree(&b.mq);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    long msgs;
+    int threads, impl;
+
+    if (argc != 2){
+        fprintf(stderr, "Usage: %s num_messages\n", argv[0]);
+        return -1;
+    }
+    msgs = atol(argv[1]);
+
+    // total number of threads 2, 4, ..., 32 split equally between
+    // producers and consumers
+    for (threads = 1; threads <= 16; threads *= 2){
+        for (impl = 0; impl < 3; ++impl)
+            bench(impl, threads, threads, msgs);
+    }
+
+    return 0;
+}
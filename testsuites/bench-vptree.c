@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <string.h>
+#include <boruvka/vptree.h>
+#include <boruvka/rand.h>
+#include <boruvka/alloc.h>
+#include <boruvka/timer.h>
+
+/** Counts distance evaluations, i.e., visited elements and inner nodes */
+static size_t dist_evals;
+
+static bor_real_t distCB(int d, const bor_vec_t *v1, const bor_vec_t *v2,
+                         void *data)
+{
+    ++dist_evals;
+    return BOR_SQRT(borVecDist2(d, v1, v2));
+}
+
+/** Returns number of elements from {els} that are also in {exact} */
+static size_t hits(bor_vptree_el_t **exact, size_t exact_len,
+                   bor_vptree_el_t **els, size_t len)
+{
+    size_t i, j, num = 0;
+
+    for (i = 0; i < len; i++){
+        for (j = 0; j < exact_len; j++){
+            if (els[i] == exact[j]){
+                ++num;
+                break;
+            }
+        }
+    }
+    return num;
+}
+
+static void bench(int dim, size_t len, size_t queries, size_t num,
+                  int frozen)
+{
+    static const bor_real_t eps[] = { 0., 0.2, 0.5, 1., 2. };
+    static const size_t leaves[] = { 0, 256, 64, 16, 4, 1 };
+    bor_rand_t r;
+    bor_vptree_params_t params;
+    bor_vptree_t *vp;
+    bor_vptree_el_t *els, **exact, **nn;
+    bor_vec_t *pts, *qs;
+    size_t *exact_len;
+    size_t i, j, e, l, found, hit, total;
+    bor_timer_t timer;
+    double exact_time;
+    size_t exact_evals;
+
+    borRandInit(&r);
+    pts = borVecNew(dim * len);
+    qs  = borVecNew(dim * queries);
+    els = BOR_ALLOC_ARR(bor_vptree_el_t, len);
+    exact = BOR_ALLOC_ARR(bor_vptree_el_t *, queries * num);
+    exact_len = BOR_ALLOC_ARR(size_t, queries);
+    nn = BOR_ALLOC_ARR(bor_vptree_el_t *, num);
+
+    for (i = 0; i < len; i++){
+        for (j = 0; j < dim; j++)
+            pts[i * dim + j] = borRand(&r, -10., 10.);
+        borVPTreeElInit(els + i, pts + i * dim);
+    }
+    for (i = 0; i < queries * dim; i++)
+        qs[i] = borRand(&r, -10., 10.);
+
+    borVPTreeParamsInit(&params);
+    params.dim = dim;
+    params.maxsize = 8;
+    params.dist = distCB;
+    vp = borVPTreeBuild(&params, els, len, sizeof(bor_vptree_el_t));
+    if (frozen)
+        borVPTreeFreeze(vp);
+
+    dist_evals = 0;
+    borTimerStart(&timer);
+    for (i = 0; i < queries; i++){
+        exact_len[i] = borVPTreeNearest(vp, qs + i * dim, num,
+                                        exact + i * num);
+    }
+    borTimerStop(&timer);
+    exact_time  = borTimerElapsedInUs(&timer) / (double)queries;
+    exact_evals = dist_evals / queries;
+    fprintf(stdout, "# dim: %d, points: %lu, queries: %lu, k: %lu%s\n",
+            dim, (unsigned long)len, (unsigned long)queries,
+            (unsigned long)num, (frozen ? ", frozen" : ""));
+    fprintf(stdout, "#  eps leaves  recall  dist-evals  us/query\n");
+    fprintf(stdout, "  exact     -  1.0000  %10lu  %8.2f\n",
+            (unsigned long)exact_evals, exact_time);
+
+    for (e = 0; e < sizeof(eps) / sizeof(bor_real_t); e++){
+        for (l = 0; l < sizeof(leaves) / sizeof(size_t); l++){
+            vp->params.approx_eps    = eps[e];
+            vp->params.approx_leaves = leaves[l];
+
+            hit = total = 0;
+            dist_evals = 0;
+            borTimerStart(&timer);
+            for (i = 0; i < queries; i++){
+                found = borVPTreeNearestApprox(vp, qs + i * dim, num, nn);
+                hit += hits(exact + i * num, exact_len[i], nn, found);
+                total += exact_len[i];
+            }
+            borTimerStop(&timer);
+
+            fprintf(stdout, "  %4.1f  %5lu  %6.4f  %10lu  %8.2f\n",
+                    (double)eps[e], (unsigned long)leaves[l],
+                    (double)hit / (double)total,
+                    (unsigned long)(dist_evals / queries),
+                    borTimerElapsedInUs(&timer) / (double)queries);
+        }
+    }
+
+    borVPTreeDel(vp);
+    borVecDel(pts);
+    borVecDel(qs);
+    BOR_FREE(els);
+    BOR_FREE(exact);
+    BOR_FREE(exact_len);
+    BOR_FREE(nn);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t len, queries, num;
+
+    if (argc != 5){
+        fprintf(stderr, "Usage: %s dim num_points num_queries k\n", argv[0]);
+        return -1;
+    }
+    len     = atoi(argv[2]);
+    queries = atoi(argv[3]);
+    num     = atoi(argv[4]);
+
+    bench(atoi(argv[1]), len, queries, num, 0);
+    bench(atoi(argv[1]), len, queries, num, 1);
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include <cu/cu.h>
+#include <boruvka/chtable.h>
+#include <boruvka/task-pool.h>
+#include <boruvka/alloc.h>
+
+#define NUM_KEYS 50000
+#define NUM_THREADS 4
+
+TEST(chtableBasic)
+{
+    bor_chtable_t *t;
+    uint64_t key, val;
+    uint32_t key32;
+
+    t = borCHTableNew(sizeof(uint64_t), sizeof(uint64_t), 1,
+                      NULL, NULL, NULL);
+
+    for (key = 0; key < NUM_KEYS; ++key){
+        val = 3 * key;
+        assertEquals(borCHTableInsert(t, 0, &key, &val), 0);
+    }
+    assertEquals(borCHTableNumElements(t), NUM_KEYS);
+
+    for (key = 0; key < NUM_KEYS; ++key){
+        val = 1;
+        assertEquals(borCHTableInsert(t, 0, &key, &val), -1);
+        assertEquals(borCHTableFind(t, 0, &key, &val), 0);
+        assertEquals(val, 3 * key);
+    }
+    key = NUM_KEYS;
+    assertEquals(borCHTableFind(t, 0, &key, &val), -1);
+    assertEquals(borCHTableErase(t, 0, &key), -1);
+
+    for (key = 0; key < NUM_KEYS; key += 2)
+        assertEquals(borCHTableErase(t, 0, &key), 0);
+    assertEquals(borCHTableNumElements(t), NUM_KEYS / 2);
+    for (key = 0; key < NUM_KEYS; ++key){
+        if (key % 2 == 0){
+            assertEquals(borCHTableFind(t, 0, &key, NULL), -1);
+        }else{
+            assertEquals(borCHTableFind(t, 0, &key, NULL), 0);
+        }
+    }
+
+    borCHTableDel(t);
+
+    /* set of 4-byte keys with default hashing */
+    t = borCHTableNew(sizeof(uint32_t), 0, 1, NULL, NULL, NULL);
+    for (key32 = 0; key32 < 1000; ++key32)
+        assertEquals(borCHTableInsert(t, 0, &key32, NULL), 0);
+    for (key32 = 0; key32 < 1000; ++key32)
+        assertEquals(borCHTableInsert(t, 0, &key32, NULL), -1);
+    borCHTableDel(t);
+}
+
+
+struct _th_t {
+    bor_chtable_t *t;
+    int inserted[NUM_THREADS];
+    int found[NUM_THREADS];
+    int erased[NUM_THREADS];
+};
+typedef struct _th_t th_t;
+
+static void thInsert(int id, void *data, const bor_task_pool_thinfo_t *thinfo)
+{
+    th_t *th = data;
+    uint64_t i, key, val;
+
+    /* all threads insert the same keys, each in a different order */
+    for (i = 0; i < NUM_KEYS; ++i){
+        key = (i * (2 * id + 1) + id) % NUM_KEYS;
+        val = key + 1;
+        if (borCHTableInsert(th->t, thinfo->id, &key, &val) == 0)
+            ++th->inserted[id];
+    }
+}
+
+static void thEraseFind(int id, void *data,
+                        const bor_task_pool_thinfo_t *thinfo)
+{
+    th_t *th = data;
+    uint64_t key, val;
+
+    if (id % 2 == 0){
+        /* erase the keys of the form 4k + id */
+        for (key = id; key < NUM_KEYS; key += 4){
+            if (borCHTableErase(th->t, thinfo->id, &key) == 0)
+                ++th->erased[id];
+        }
+    }else{
+        /* odd keys are never erased */
+        for (key = 1; key < NUM_KEYS; key += 2){
+            if (borCHTableFind(th->t, thinfo->id, &key, &val) == 0
+                    && val == key + 1)
+                ++th->found[id];
+        }
+    }
+}
+
+TEST(chtableThreads)
+{
+    bor_task_pool_t *tp;
+    th_t th;
+    uint64_t key;
+    int i, sum;
+
+    memset(&th, 0, sizeof(th));
+    th.t = borCHTableNew(sizeof(uint64_t), sizeof(uint64_t), NUM_THREADS,
+                         NULL, NULL, NULL);
+    tp = borTaskPoolNew(NUM_THREADS);
+    borTaskPoolRun(tp);
+
+    for (i = 0; i < NUM_THREADS; ++i)
+        borTaskPoolAdd(tp, i, thInsert, i, &th);
+    for (i = 0; i < NUM_THREADS; ++i)
+        borTaskPoolBarrier(tp, i);
+
+    sum = 0;
+    for (i = 0; i < NUM_THREADS; ++i)
+        sum += th.inserted[i];
+    assertEquals(sum, NUM_KEYS);
+    assertEquals(borCHTableNumElements(th.t), NUM_KEYS);
+
+    for (i = 0; i < NUM_THREADS; ++i)
+        borTaskPoolAdd(tp, i, thEraseFind, i, &th);
+    for (i = 0; i < NUM_THREADS; ++i)
+        borTaskPoolBarrier(tp, i);
+
+    assertEquals(th.erased[0] + th.erased[2], NUM_KEYS / 2);
+    assertEquals(th.found[1], NUM_KEYS / 2);
+    assertEquals(th.found[3], NUM_KEYS / 2);
+    assertEquals(borCHTableNumElements(th.t), NUM_KEYS / 2);
+    for (key = 0; key < NUM_KEYS; ++key){
+        assertEquals(borCHTableFind(th.t, 0, &key, NULL),
+                     (key % 2 == 0 ? -1 : 0));
+    }
+
+    borTaskPoolDel(tp);
+    borCHTableDel(th.t);
+}
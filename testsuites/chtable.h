@@ -0,0 +1,13 @@
+#ifndef TEST_CHTABLE_H
+#define TEST_CHTABLE_H
+
+TEST(chtableBasic);
+TEST(chtableThreads);
+
+TEST_SUITE(TSCHTable) {
+    TEST_ADD(chtableBasic),
+    TEST_ADD(chtableThreads),
+    TEST_SUITE_CLOSURE
+};
+
+#endif
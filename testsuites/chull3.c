@@ -1,6 +1,8 @@
 #include <cu/cu.h>
 #include <boruvka/chull3.h>
 #include <boruvka/dbg.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/alloc.h>
 #include "data.h"
 
 TEST(testCHull)
@@ -725,3 +727,153 @@ TEST(testCHullBunny)
     borCHull3DumpSVT(h, stdout, "bunny");
     borCHull3Del(h);
 }
+
+static int cmpCoords(const void *a, const void *b)
+{
+    const bor_real_t *x = a, *y = b;
+    int i;
+
+    for (i = 0; i < 3; i++){
+        if (x[i] < y[i])
+            return -1;
+        if (x[i] > y[i])
+            return 1;
+    }
+    return 0;
+}
+
+static bor_real_t *hullCoords(bor_chull3_t *h)
+{
+    bor_mesh3_t *mesh = borCHull3Mesh(h);
+    bor_list_t *item;
+    bor_mesh3_vertex_t *v;
+    bor_real_t *coords;
+    size_t i;
+
+    coords = BOR_ALLOC_ARR(bor_real_t, 3 * borMesh3VerticesLen(mesh));
+    i = 0;
+    BOR_LIST_FOR_EACH(borMesh3Vertices(mesh), item){
+        v = BOR_LIST_ENTRY(item, bor_mesh3_vertex_t, list);
+        coords[i++] = borVec3X(borMesh3VertexCoords(v));
+        coords[i++] = borVec3Y(borMesh3VertexCoords(v));
+        coords[i++] = borVec3Z(borMesh3VertexCoords(v));
+    }
+    qsort(coords, borMesh3VerticesLen(mesh), 3 * sizeof(bor_real_t), cmpCoords);
+    return coords;
+}
+
+static void checkSameHull(bor_chull3_t *h1, bor_chull3_t *h2)
+{
+    bor_mesh3_t *m1, *m2;
+    bor_real_t *c1, *c2;
+    size_t i;
+
+    m1 = borCHull3Mesh(h1);
+    m2 = borCHull3Mesh(h2);
+    assertEquals(borMesh3VerticesLen(m1), borMesh3VerticesLen(m2));
+    assertEquals(borMesh3FacesLen(m2), 2 * borMesh3VerticesLen(m2) - 4);
+    assertEquals(borMesh3EdgesLen(m2), 3 * borMesh3VerticesLen(m2) - 6);
+
+    if (borMesh3VerticesLen(m1) == borMesh3VerticesLen(m2)){
+        c1 = hullCoords(h1);
+        c2 = hullCoords(h2);
+        for (i = 0; i < 3 * borMesh3VerticesLen(m1); i++)
+            assertTrue(borEq(c1[i], c2[i]));
+        BOR_FREE(c1);
+        BOR_FREE(c2);
+    }
+}
+
+static void checkAddPoints(bor_pc_t *pc)
+{
+    bor_chull3_t *h1, *h2;
+    bor_task_pool_t *tp;
+    bor_pc_it_t pcit;
+    bor_vec3_t v;
+    bor_vec_t *w;
+
+    h1 = borCHull3New();
+    borPCItInit(&pcit, pc);
+    for (; !borPCItEnd(&pcit); borPCItNext(&pcit)){
+        w = borPCItGet(&pcit);
+        borVec3Set(&v, borVecGet(w, 0), borVecGet(w, 1), borVecGet(w, 2));
+        borCHull3Add(h1, &v);
+    }
+
+    h2 = borCHull3New();
+    borCHull3AddPoints(h2, pc);
+    checkSameHull(h1, h2);
+    borCHull3Del(h2);
+
+    h2 = borCHull3NewQuickhull(pc, NULL);
+    checkSameHull(h1, h2);
+    borCHull3Del(h2);
+
+    tp = borTaskPoolNew(4);
+    borTaskPoolRun(tp);
+    h2 = borCHull3NewQuickhull(pc, tp);
+    checkSameHull(h1, h2);
+    borCHull3Del(h2);
+    borTaskPoolDel(tp);
+
+    borCHull3Del(h1);
+}
+
+TEST(testCHullAddPoints)
+{
+    bor_chull3_t *h;
+    bor_rand_mt_t *rnd;
+    bor_pc_t *pc;
+    bor_vec_t *w;
+    bor_real_t x, y, z;
+    size_t i;
+
+    rnd = borRandMTNew(1234);
+    w = borVecNew(3);
+
+    // random points in ball
+    pc = borPCNew(3);
+    while (borPCLen(pc) < 5000){
+        x = borRandMT(rnd, -1., 1.);
+        y = borRandMT(rnd, -1., 1.);
+        z = borRandMT(rnd, -1., 1.);
+        if (x * x + y * y + z * z > 1.)
+            continue;
+        borVecSet(w, 0, x);
+        borVecSet(w, 1, y);
+        borVecSet(w, 2, z);
+        borPCAdd(pc, w);
+    }
+    checkAddPoints(pc);
+    borPCDel(pc);
+
+    // bunny
+    pc = borPCNew(3);
+    for (i = 0; i < bunny_coords_len; i++){
+        borVecSet(w, 0, borVec3X(&bunny_coords[i]));
+        borVecSet(w, 1, borVec3Y(&bunny_coords[i]));
+        borVecSet(w, 2, borVec3Z(&bunny_coords[i]));
+        borPCAdd(pc, w);
+    }
+    checkAddPoints(pc);
+    borPCDel(pc);
+
+    // grid: points on faces and edges of the cube aren't part of the hull
+    // built with exact predicates
+    pc = borPCNew(3);
+    for (i = 0; i < 125; i++){
+        borVecSet(w, 0, i % 5);
+        borVecSet(w, 1, (i / 5) % 5);
+        borVecSet(w, 2, i / 25);
+        borPCAdd(pc, w);
+    }
+    h = borCHull3NewQuickhull(pc, NULL);
+    assertEquals(borMesh3VerticesLen(borCHull3Mesh(h)), 8);
+    assertEquals(borMesh3EdgesLen(borCHull3Mesh(h)), 18);
+    assertEquals(borMesh3FacesLen(borCHull3Mesh(h)), 12);
+    borCHull3Del(h);
+    borPCDel(pc);
+
+    borVecDel(w);
+    borRandMTDel(rnd);
+}
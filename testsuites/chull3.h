@@ -10,6 +10,7 @@ TEST(testCHull6);
 TEST(testCHull7);
 TEST(testCHull8);
 TEST(testCHullBunny);
+TEST(testCHullAddPoints);
 
 TEST_SUITE(TSCHull3){
     TEST_ADD(testCHull),
@@ -21,6 +22,7 @@ TEST_SUITE(TSCHull3){
     TEST_ADD(testCHull7),
     TEST_ADD(testCHull8),
     TEST_ADD(testCHullBunny),
+    TEST_ADD(testCHullAddPoints),
 
     TEST_SUITE_CLOSURE
 };
@@ -0,0 +1,229 @@
+#include <string.h>
+#include <cu/cu.h>
+#include <boruvka/delaunay.h>
+#include <boruvka/predicates.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/alloc.h>
+
+static bor_pc_t *randPC(int len, uint32_t seed)
+{
+    bor_pc_t *pc;
+    bor_rand_mt_t *rnd;
+    BOR_VEC(v, 3);
+    int i, j;
+
+    pc = borPCNew(3);
+    rnd = borRandMTNew(seed);
+    for (i = 0; i < len; ++i){
+        for (j = 0; j < 3; ++j)
+            borVecSet(v, j, borRandMT(rnd, -1., 1.));
+        borPCAdd(pc, v);
+    }
+    borRandMTDel(rnd);
+
+    return pc;
+}
+
+/** Returns adjacency matrix of mesh vertices (indexed as points) */
+static char *adjacency(bor_qhull_mesh3_t *m)
+{
+    bor_list_t *item;
+    bor_mesh3_edge_t *e;
+    char *adj;
+    int u, w, len;
+
+    len = m->vecs_len;
+    adj = BOR_CALLOC_ARR(char, len * len);
+    BOR_LIST_FOR_EACH(borMesh3Edges(borQHullMesh3(m)), item){
+        e = BOR_LIST_ENTRY(item, bor_mesh3_edge_t, list);
+        u = borMesh3VertexCoords(borMesh3EdgeVertex(e, 0)) - m->vecs;
+        w = borMesh3VertexCoords(borMesh3EdgeVertex(e, 1)) - m->vecs;
+        adj[u * len + w] = adj[w * len + u] = 1;
+    }
+
+    return adj;
+}
+
+TEST(delaunayBrute)
+{
+    bor_pred_t pred;
+    bor_pc_t *pc;
+    bor_qhull_mesh3_t *m;
+    const bor_vec3_t *v;
+    char *adj, *brute;
+    int len = 40;
+    int i, j, k, l, p, tmp, empty, diff;
+    int t[4];
+
+    borPredInit(&pred);
+    pc = randPC(len, 123);
+    m = borDelaunayMesh3(pc);
+    assertEquals(borMesh3VerticesLen(borQHullMesh3(m)), len);
+    adj = adjacency(m);
+
+    // edges of all tetrahedra with empty circumsphere
+    v = m->vecs;
+    brute = BOR_CALLOC_ARR(char, len * len);
+    for (i = 0; i < len; ++i){
+    for (j = i + 1; j < len; ++j){
+    for (k = j + 1; k < len; ++k){
+    for (l = k + 1; l < len; ++l){
+        t[0] = i; t[1] = j; t[2] = k; t[3] = l;
+        if (borPredOrient3d(&pred, &v[i], &v[j], &v[k], &v[l]) < 0.){
+            BOR_SWAP(t[0], t[1], tmp);
+        }
+
+        empty = 1;
+        for (p = 0; p < len && empty; ++p){
+            if (borPredInSphere(&pred, &v[t[0]], &v[t[1]], &v[t[2]],
+                                &v[t[3]], &v[p]) > 0.)
+                empty = 0;
+        }
+
+        if (empty){
+            brute[i * len + j] = brute[j * len + i] = 1;
+            brute[i * len + k] = brute[k * len + i] = 1;
+            brute[i * len + l] = brute[l * len + i] = 1;
+            brute[j * len + k] = brute[k * len + j] = 1;
+            brute[j * len + l] = brute[l * len + j] = 1;
+            brute[k * len + l] = brute[l * len + k] = 1;
+        }
+    }
+    }
+    }
+    }
+
+    diff = 0;
+    for (i = 0; i < len * len; ++i)
+        diff += (adj[i] != brute[i]);
+    assertEquals(diff, 0);
+
+    BOR_FREE(adj);
+    BOR_FREE(brute);
+    borQHullMesh3Del(m);
+    borPCDel(pc);
+}
+
+TEST(delaunayGrid)
+{
+    bor_pc_t *pc;
+    bor_qhull_mesh3_t *m;
+    bor_list_t *item;
+    bor_mesh3_edge_t *e;
+    bor_mesh3_vertex_t *u, *w;
+    bor_vec3_t d;
+    BOR_VEC(v, 3);
+    char *adj;
+    int x, y, z, i, len, units, far;
+
+    // 5x5x5 grid (highly degenerate input) and each point twice
+    pc = borPCNew(3);
+    for (i = 0; i < 2; ++i){
+        for (x = 0; x < 5; ++x){
+            for (y = 0; y < 5; ++y){
+                for (z = 0; z < 5; ++z){
+                    borVecSet(v, 0, x);
+                    borVecSet(v, 1, y);
+                    borVecSet(v, 2, z);
+                    borPCAdd(pc, v);
+                }
+            }
+        }
+    }
+    len = borPCLen(pc);
+
+    m = borDelaunayMesh3(pc);
+    assertEquals(borMesh3VerticesLen(borQHullMesh3(m)), len);
+
+    // exactly one of duplicate points is connected
+    adj = adjacency(m);
+    for (i = 0; i < len / 2; ++i){
+        x = y = 0;
+        for (z = 0; z < len; ++z){
+            x += adj[i * len + z];
+            y += adj[(i + len / 2) * len + z];
+        }
+        assertTrue((x > 0) != (y > 0));
+    }
+    BOR_FREE(adj);
+
+    // all tetrahedra lie in unit cells and all unit edges are Delaunay
+    units = far = 0;
+    BOR_LIST_FOR_EACH(borMesh3Edges(borQHullMesh3(m)), item){
+        e = BOR_LIST_ENTRY(item, bor_mesh3_edge_t, list);
+        u = borMesh3EdgeVertex(e, 0);
+        w = borMesh3EdgeVertex(e, 1);
+        borVec3Sub2(&d, borMesh3VertexCoords(u), borMesh3VertexCoords(w));
+        if (BOR_FABS(borVec3X(&d)) > 1. || BOR_FABS(borVec3Y(&d)) > 1.
+                || BOR_FABS(borVec3Z(&d)) > 1.)
+            ++far;
+        if (borEq(borVec3Len2(&d), 1.))
+            ++units;
+    }
+    assertEquals(far, 0);
+    assertEquals(units, 3 * 4 * 25);
+
+    borQHullMesh3Del(m);
+    borPCDel(pc);
+}
+
+TEST(delaunayCoplanar)
+{
+    bor_pc_t *pc;
+    bor_qhull_mesh3_t *m;
+    BOR_VEC(v, 3);
+    int i;
+
+    pc = borPCNew(3);
+    for (i = 0; i < 100; ++i){
+        borVecSet(v, 0, i % 10);
+        borVecSet(v, 1, i / 10);
+        borVecSet(v, 2, 1.);
+        borPCAdd(pc, v);
+    }
+
+    m = borDelaunayMesh3(pc);
+    assertEquals(borMesh3VerticesLen(borQHullMesh3(m)), 100);
+    assertEquals(borMesh3EdgesLen(borQHullMesh3(m)), 0);
+    borQHullMesh3Del(m);
+    borPCDel(pc);
+
+    pc = borPCNew(3);
+    m = borDelaunayMesh3(pc);
+    assertEquals(borMesh3VerticesLen(borQHullMesh3(m)), 0);
+    borQHullMesh3Del(m);
+    borPCDel(pc);
+}
+
+TEST(delaunayQHull)
+{
+    bor_pc_t *pc;
+    bor_qdelaunay_t *q;
+    bor_qhull_mesh3_t *m, *m2;
+    char *adj, *adj2;
+    int len = 2000;
+
+    pc = randPC(len, 321);
+
+    // without qdelaunay binary the in-process triangulation is used
+    q = borQDelaunayNew();
+    borQDelaunaySetPath(q, "/nonexistent/qdelaunay");
+    m = borQDelaunayMesh3(q, pc);
+    m2 = borDelaunayMesh3(pc);
+    assertTrue(m != NULL);
+    assertEquals(borMesh3VerticesLen(borQHullMesh3(m)), len);
+    assertEquals(borMesh3EdgesLen(borQHullMesh3(m)),
+                 borMesh3EdgesLen(borQHullMesh3(m2)));
+
+    // insertion order is random but the triangulation is unique
+    adj = adjacency(m);
+    adj2 = adjacency(m2);
+    assertTrue(memcmp(adj, adj2, len * len) == 0);
+
+    BOR_FREE(adj);
+    BOR_FREE(adj2);
+    borQHullMesh3Del(m);
+    borQHullMesh3Del(m2);
+    borQDelaunayDel(q);
+    borPCDel(pc);
+}
@@ -0,0 +1,18 @@
+#ifndef TEST_DELAUNAY_H
+#define TEST_DELAUNAY_H
+
+TEST(delaunayBrute);
+TEST(delaunayGrid);
+TEST(delaunayCoplanar);
+TEST(delaunayQHull);
+
+TEST_SUITE(TSDelaunay){
+    TEST_ADD(delaunayBrute),
+    TEST_ADD(delaunayGrid),
+    TEST_ADD(delaunayCoplanar),
+    TEST_ADD(delaunayQHull),
+
+    TEST_SUITE_CLOSURE
+};
+
+#endif
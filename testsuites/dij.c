@@ -1,11 +1,16 @@
 #include <cu/cu.h>
 #include <boruvka/dij.h>
 #include <boruvka/vec2.h>
+#include <boruvka/alloc.h>
 
 #define NUM_NODES 20
 
 
 static void expand(bor_dij_node_t *n, bor_list_t *list, void *);
+static void gridExpand(bor_dij_node_t *n, bor_list_t *list, void *);
+static void gridExpandRev(bor_dij_node_t *n, bor_list_t *list, void *);
+static bor_real_t gridHeur(const bor_dij_node_t *n,
+                           const bor_dij_node_t *end, void *);
 
 struct _node_t {
     bor_vec2_t v;
@@ -149,6 +154,217 @@ TEST(dij1)
     borDijDel(dij);
 }
 
+#define GRID 40
+
+struct _grid_t {
+    bor_dij_node_t dij[GRID * GRID];
+    int weight[GRID * GRID][4]; /*!< Weights of edges to the 4 neighbors */
+};
+typedef struct _grid_t grid_t;
+
+static void gridExpand(bor_dij_node_t *_n, bor_list_t *list, void *_g)
+{
+    static const int dx[4] = { 1, -1, 0, 0 };
+    static const int dy[4] = { 0, 0, 1, -1 };
+    grid_t *g = _g;
+    int id, x, y, nx, ny, i;
+
+    id = _n - g->dij;
+    x = id % GRID;
+    y = id / GRID;
+    for (i = 0; i < 4; ++i){
+        nx = x + dx[i];
+        ny = y + dy[i];
+        if (nx < 0 || nx >= GRID || ny < 0 || ny >= GRID)
+            continue;
+        if (!borDijNodeClosed(&g->dij[ny * GRID + nx]))
+            borDijNodeAdd(&g->dij[ny * GRID + nx], list, g->weight[id][i]);
+    }
+}
+
+TEST(dijHeaps)
+{
+    static const int heaps[3] = { BOR_DIJ_HEAP_PAIRING,
+                                  BOR_DIJ_HEAP_BUCKET,
+                                  BOR_DIJ_HEAP_RADIX };
+    bor_dij_t *dij;
+    bor_dij_ops_t ops;
+    grid_t *g;
+    bor_real_t *dist;
+    int i, j;
+
+    g = BOR_ALLOC(grid_t);
+    dist = BOR_ALLOC_ARR(bor_real_t, GRID * GRID);
+    srand(1234);
+    for (i = 0; i < GRID * GRID; ++i){
+        for (j = 0; j < 4; ++j)
+            g->weight[i][j] = 1 + rand() % 100;
+    }
+
+    borDijOpsInit(&ops);
+    ops.expand = gridExpand;
+    ops.data = g;
+    dij = borDijNew(&ops);
+
+    for (j = 0; j < 3; ++j){
+        borDijSetHeap(dij, heaps[j], 1);
+        for (i = 0; i < GRID * GRID; ++i)
+            borDijNodeInit(&g->dij[i]);
+        assertEquals(borDijRun(dij, &g->dij[0], NULL), -1);
+
+        for (i = 0; i < GRID * GRID; ++i){
+            assertTrue(borDijNodeClosed(&g->dij[i]));
+            if (j == 0){
+                dist[i] = borDijDist(&g->dij[i]);
+            }else{
+                assertTrue(borEq(dist[i], borDijDist(&g->dij[i])));
+            }
+        }
+    }
+
+    // fixed-point keys
+    borDijSetHeap(dij, BOR_DIJ_HEAP_RADIX, 1000);
+    for (i = 0; i < GRID * GRID; ++i)
+        borDijNodeInit(&g->dij[i]);
+    borDijRun(dij, &g->dij[0], &g->dij[GRID * GRID - 1]);
+    assertTrue(borEq(dist[GRID * GRID - 1],
+                     borDijDist(&g->dij[GRID * GRID - 1])));
+
+    borDijDel(dij);
+    BOR_FREE(dist);
+    BOR_FREE(g);
+}
+
+static void gridExpandRev(bor_dij_node_t *_n, bor_list_t *list, void *_g)
+{
+    static const int dx[4] = { 1, -1, 0, 0 };
+    static const int dy[4] = { 0, 0, 1, -1 };
+    grid_t *g = _g;
+    int id, x, y, nx, ny, i;
+
+    id = _n - g->dij;
+    x = id % GRID;
+    y = id / GRID;
+    for (i = 0; i < 4; ++i){
+        nx = x + dx[i];
+        ny = y + dy[i];
+        if (nx < 0 || nx >= GRID || ny < 0 || ny >= GRID)
+            continue;
+        // weight of the edge from the neighbor back to this node
+        if (!borDijNodeClosedRev(&g->dij[ny * GRID + nx]))
+            borDijNodeAdd(&g->dij[ny * GRID + nx], list,
+                          g->weight[ny * GRID + nx][i ^ 1]);
+    }
+}
+
+static bor_real_t gridHeur(const bor_dij_node_t *n,
+                           const bor_dij_node_t *end, void *_g)
+{
+    grid_t *g = _g;
+    int id1, id2;
+
+    // Manhattan distance times the minimal weight (1)
+    id1 = n - g->dij;
+    id2 = end - g->dij;
+    return abs(id1 % GRID - id2 % GRID) + abs(id1 / GRID - id2 / GRID);
+}
+
+/** Checks that the path stored in the grid leads from start to end and
+ *  has the length of end's distance */
+static void gridCheckPath(grid_t *g, int start, int end)
+{
+    bor_list_t list, *item;
+    bor_dij_node_t *n, *prev;
+    int id, pid, len, i;
+
+    borListInit(&list);
+    borDijPath(&g->dij[end], &list);
+
+    prev = NULL;
+    len = 0;
+    BOR_LIST_FOR_EACH(&list, item){
+        n = borDijNodeFromList(item);
+        if (prev == NULL){
+            assertEquals(n, &g->dij[start]);
+        }else{
+            id = n - g->dij;
+            pid = prev - g->dij;
+            if (id == pid + 1){
+                i = 0;
+            }else if (id == pid - 1){
+                i = 1;
+            }else if (id == pid + GRID){
+                i = 2;
+            }else{
+                assertEquals(id, pid - GRID);
+                i = 3;
+            }
+            len += g->weight[pid][i];
+        }
+        prev = n;
+    }
+    assertEquals(prev, &g->dij[end]);
+    assertTrue(borEq(len, borDijDist(&g->dij[end])));
+}
+
+TEST(dijAStarBidir)
+{
+    static const int heaps[3] = { BOR_DIJ_HEAP_PAIRING,
+                                  BOR_DIJ_HEAP_BUCKET,
+                                  BOR_DIJ_HEAP_RADIX };
+    bor_dij_t *dij;
+    bor_dij_ops_t ops;
+    grid_t *g;
+    bor_real_t dist;
+    int i, j, k, start, end;
+
+    g = BOR_ALLOC(grid_t);
+    srand(4321);
+    for (i = 0; i < GRID * GRID; ++i){
+        for (j = 0; j < 4; ++j)
+            g->weight[i][j] = 1 + rand() % 20;
+    }
+
+    borDijOpsInit(&ops);
+    ops.expand = gridExpand;
+    ops.expand_rev = gridExpandRev;
+    ops.heuristic = gridHeur;
+    ops.data = g;
+    dij = borDijNew(&ops);
+
+    for (k = 0; k < 30; ++k){
+        start = rand() % (GRID * GRID);
+        end = rand() % (GRID * GRID);
+        if (k == 0)
+            end = start;
+
+        borDijSetHeap(dij, BOR_DIJ_HEAP_PAIRING, 1);
+        for (i = 0; i < GRID * GRID; ++i)
+            borDijNodeInit(&g->dij[i]);
+        assertEquals(borDijRun(dij, &g->dij[start], &g->dij[end]), 0);
+        dist = borDijDist(&g->dij[end]);
+
+        for (j = 0; j < 3; ++j){
+            borDijSetHeap(dij, heaps[j], 1);
+
+            for (i = 0; i < GRID * GRID; ++i)
+                borDijNodeInit(&g->dij[i]);
+            assertEquals(borDijRunAStar(dij, &g->dij[start], &g->dij[end]), 0);
+            assertTrue(borEq(dist, borDijDist(&g->dij[end])));
+            gridCheckPath(g, start, end);
+
+            for (i = 0; i < GRID * GRID; ++i)
+                borDijNodeInit(&g->dij[i]);
+            assertEquals(borDijRunBidir(dij, &g->dij[start], &g->dij[end]), 0);
+            assertTrue(borEq(dist, borDijDist(&g->dij[end])));
+            gridCheckPath(g, start, end);
+        }
+    }
+
+    borDijDel(dij);
+    BOR_FREE(g);
+}
+
 static void expand(bor_dij_node_t *_n, bor_list_t *list, void *_)
 {
     size_t i;
@@ -3,9 +3,13 @@
 
 
 TEST(dij1);
+TEST(dijHeaps);
+TEST(dijAStarBidir);
 
 TEST_SUITE(TSDij) {
     TEST_ADD(dij1),
+    TEST_ADD(dijHeaps),
+    TEST_ADD(dijAStarBidir),
 
     TEST_SUITE_CLOSURE
 };
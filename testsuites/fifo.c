@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <cu/cu.h>
+#include <pthread.h>
 #include <boruvka/fifo.h>
+#include <boruvka/fifo-sem.h>
 #include <boruvka/alloc.h>
 #include <boruvka/rand.h>
 
@@ -57,3 +59,59 @@ TEST(fifo1)
 
     borFifoDel(fifo);
 }
+
+#define SPSC_LEN 100000
+
+struct _spsc_el_t {
+    int i;
+    int x[2];
+};
+typedef struct _spsc_el_t spsc_el_t;
+
+static void *spscProducer(void *_fifo)
+{
+    bor_fifo_sem_t *fifo = (bor_fifo_sem_t *)_fifo;
+    spsc_el_t el;
+    int i;
+
+    for (i = 0; i < SPSC_LEN; ++i){
+        el.i = i;
+        el.x[0] = -i;
+        el.x[1] = 2 * i;
+        borFifoSemPush(fifo, &el);
+    }
+    return NULL;
+}
+
+TEST(fifoSemSPSC)
+{
+    bor_fifo_sem_t *fifo;
+    pthread_t th;
+    spsc_el_t el;
+    int i, ret;
+
+    fifo = borFifoSemNewSPSC(sizeof(spsc_el_t), 100);
+    assertTrue(borFifoSemEmpty(fifo));
+    assertEquals(borFifoSemPop(fifo, &el), -1);
+    assertEquals(borFifoSemPopBlockTimeout(fifo, 10, &el), -1);
+
+    pthread_create(&th, NULL, spscProducer, fifo);
+    for (i = 0; i < SPSC_LEN; ++i){
+        if (i % 3 == 0){
+            ret = borFifoSemPopBlock(fifo, &el);
+        }else if (i % 3 == 1){
+            ret = borFifoSemPopBlockTimeout(fifo, 10000, &el);
+        }else{
+            while ((ret = borFifoSemPop(fifo, &el)) != 0);
+        }
+        assertEquals(ret, 0);
+        assertEquals(el.i, i);
+        assertEquals(el.x[0], -i);
+        assertEquals(el.x[1], 2 * i);
+    }
+    pthread_join(th, NULL);
+
+    assertTrue(borFifoSemEmpty(fifo));
+    assertEquals(borFifoSemPopBlockTimeout(fifo, 1, &el), -1);
+    borFifoSemDel(fifo);
+}
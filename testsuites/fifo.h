@@ -2,9 +2,11 @@
 #define TEST_FIFO_H
 
 TEST(fifo1);
+TEST(fifoSemSPSC);
 
 TEST_SUITE(TSFifo) {
     TEST_ADD(fifo1),
+    TEST_ADD(fifoSemSPSC),
     TEST_SUITE_CLOSURE
 };
 
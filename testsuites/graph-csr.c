@@ -0,0 +1,308 @@
+#include <cu/cu.h>
+#include <boruvka/graph-csr.h>
+#include <boruvka/dij.h>
+#include <boruvka/alloc.h>
+#include <boruvka/task-pool.h>
+
+#define NODES 500
+#define EDGES 2000
+
+struct _edges_t {
+    int src[EDGES];
+    int dst[EDGES];
+    bor_real_t w[EDGES];
+};
+typedef struct _edges_t edges_t;
+
+/** Random directed graph without parallel edges (bor_dij_t can't add the
+ *  same node into the list twice) */
+static void randEdges(edges_t *e, int node_size, int edge_size)
+{
+    int i, j;
+
+    for (i = 0; i < edge_size; ++i){
+        e->src[i] = rand() % node_size;
+        e->dst[i] = rand() % node_size;
+        e->w[i] = 1 + rand() % 50;
+        for (j = 0; j < i; ++j){
+            if (e->src[j] == e->src[i] && e->dst[j] == e->dst[i]){
+                --i;
+                break;
+            }
+        }
+    }
+}
+
+struct _dij_graph_t {
+    const bor_graph_csr_t *g;
+    bor_dij_node_t node[NODES];
+};
+typedef struct _dij_graph_t dij_graph_t;
+
+static void dijExpand(bor_dij_node_t *n, bor_list_t *list, void *data)
+{
+    dij_graph_t *dg = data;
+    int id, i;
+
+    id = n - dg->node;
+    for (i = dg->g->beg[id]; i < dg->g->beg[id + 1]; ++i){
+        if (!borDijNodeClosed(&dg->node[dg->g->dst[i]]))
+            borDijNodeAdd(&dg->node[dg->g->dst[i]], list, dg->g->weight[i]);
+    }
+}
+
+TEST(graphCSRDij)
+{
+    edges_t *e;
+    bor_graph_csr_t *g;
+    dij_graph_t *dg;
+    bor_dij_ops_t ops;
+    bor_dij_t *dij;
+    bor_real_t *dist;
+    int *prev, i, k, start, n;
+
+    e = BOR_ALLOC(edges_t);
+    dg = BOR_ALLOC(dij_graph_t);
+    dist = BOR_ALLOC_ARR(bor_real_t, NODES);
+    prev = BOR_ALLOC_ARR(int, NODES);
+
+    srand(2016);
+    randEdges(e, NODES, EDGES);
+    g = borGraphCSRNew(NODES, EDGES, e->src, e->dst, e->w);
+    assertEquals(g->node_size, NODES);
+    assertEquals(g->edge_size, EDGES);
+    assertEquals(g->beg[NODES], EDGES);
+
+    dg->g = g;
+    borDijOpsInit(&ops);
+    ops.expand = dijExpand;
+    ops.data = dg;
+    dij = borDijNew(&ops);
+
+    for (k = 0; k < 10; ++k){
+        start = rand() % NODES;
+        for (i = 0; i < NODES; ++i)
+            borDijNodeInit(&dg->node[i]);
+        borDijRun(dij, &dg->node[start], NULL);
+
+        assertEquals(borGraphCSRDij(g, start, -1, dist, prev), 0);
+        for (i = 0; i < NODES; ++i){
+            assertTrue(borEq(dist[i], borDijDist(&dg->node[i])));
+            if (i == start || dist[i] == BOR_REAL_MAX){
+                assertEquals(prev[i], -1);
+            }else{
+                assertTrue(prev[i] >= 0);
+                assertTrue(dist[prev[i]] < dist[i]);
+            }
+        }
+
+        // early termination
+        n = rand() % NODES;
+        if (dist[n] == BOR_REAL_MAX){
+            assertEquals(borGraphCSRDij(g, start, n, dist, NULL), -1);
+        }else{
+            assertEquals(borGraphCSRDij(g, start, n, dist, NULL), 0);
+            assertTrue(borEq(dist[n], borDijDist(&dg->node[n])));
+        }
+    }
+
+    borDijDel(dij);
+    borGraphCSRDel(g);
+    BOR_FREE(prev);
+    BOR_FREE(dist);
+    BOR_FREE(dg);
+    BOR_FREE(e);
+}
+
+static long sccIt(int node_id, void *ud)
+{
+    const bor_graph_csr_t *g = ud;
+    return g->beg[node_id];
+}
+
+static int sccNext(int node_id, long *it, void *ud)
+{
+    const bor_graph_csr_t *g = ud;
+    if (*it >= g->beg[node_id + 1])
+        return -1;
+    return g->dst[(*it)++];
+}
+
+static void sccCmp(const bor_scc_t *s1, const bor_scc_t *s2)
+{
+    int i, j;
+
+    assertEquals(s1->comp_size, s2->comp_size);
+    for (i = 0; i < s1->comp_size && i < s2->comp_size; ++i){
+        assertEquals(s1->comp[i].node_size, s2->comp[i].node_size);
+        if (s1->comp[i].node_size != s2->comp[i].node_size)
+            continue;
+        for (j = 0; j < s1->comp[i].node_size; ++j)
+            assertEquals(s1->comp[i].node[j], s2->comp[i].node[j]);
+    }
+}
+
+static int cmpComp(const void *a, const void *b)
+{
+    const bor_scc_comp_t *c1 = a, *c2 = b;
+    return c1->node[0] - c2->node[0];
+}
+
+/** Checks that both search give the same components, {s2} is ordered by
+ *  the smallest node */
+static void sccCmpPar(bor_scc_t *s1, const bor_scc_t *s2)
+{
+    qsort(s1->comp, s1->comp_size, sizeof(bor_scc_comp_t), cmpComp);
+    sccCmp(s1, s2);
+}
+
+TEST(graphCSRSCC)
+{
+    edges_t *e;
+    bor_graph_csr_t *g;
+    bor_scc_t scc, scc2;
+    int k, edge_size;
+
+    e = BOR_ALLOC(edges_t);
+    srand(61);
+    for (k = 0; k < 10; ++k){
+        // sparse graphs have many small components, dense ones a big one
+        edge_size = NODES / 2 + k * (EDGES - NODES / 2) / 10;
+        randEdges(e, NODES, edge_size);
+        g = borGraphCSRNew(NODES, edge_size, e->src, e->dst, NULL);
+
+        borSCCInit(&scc, NODES, sccIt, sccNext, g);
+        borSCC(&scc);
+        borGraphCSRSCC(g, &scc2);
+        sccCmp(&scc, &scc2);
+        borSCCFree(&scc2);
+
+        borGraphCSRSCCPar(g, &scc2, NULL);
+        sccCmpPar(&scc, &scc2);
+        borSCCFree(&scc);
+        borSCCFree(&scc2);
+
+        borGraphCSRDel(g);
+    }
+    BOR_FREE(e);
+}
+
+TEST(graphCSRSCCPar)
+{
+    static const int nodes[] = { 20000, 50000, 50000, 30000 };
+    static const int degree[] = { 1, 1, 2, 0 };
+    bor_task_pool_t *tp;
+    bor_graph_csr_t *g;
+    bor_scc_t scc, scc2;
+    int *src, *dst, edge_size, i, k, n;
+
+    tp = borTaskPoolNew(4);
+    borTaskPoolRun(tp);
+
+    srand(1016);
+    for (k = 0; k < 4; ++k){
+        n = nodes[k];
+        src = BOR_ALLOC_ARR(int, (degree[k] + 2) * n);
+        dst = BOR_ALLOC_ARR(int, (degree[k] + 2) * n);
+        edge_size = 0;
+
+        if (degree[k] == 0){
+            // long chain with a cycle in the middle and backward edges
+            // at the end
+            for (i = 0; i < n - 1; ++i){
+                src[edge_size] = i + 1;
+                dst[edge_size++] = i;
+            }
+            src[edge_size] = n / 3;
+            dst[edge_size++] = 2 * n / 3;
+            for (i = n - 100; i < n; i += 10){
+                src[edge_size] = i - 10;
+                dst[edge_size++] = i;
+            }
+
+        }else{
+            // random graph with a big component
+            for (i = 0; i < degree[k] * n + n / 2; ++i){
+                src[edge_size] = rand() % n;
+                dst[edge_size++] = rand() % n;
+            }
+        }
+
+        g = borGraphCSRNew(n, edge_size, src, dst, NULL);
+        borGraphCSRSCC(g, &scc);
+        borGraphCSRSCCPar(g, &scc2, tp);
+        sccCmpPar(&scc, &scc2);
+        borSCCFree(&scc);
+        borSCCFree(&scc2);
+        borGraphCSRDel(g);
+
+        BOR_FREE(src);
+        BOR_FREE(dst);
+    }
+
+    borTaskPoolDel(tp);
+}
+
+static bor_real_t netWeight(const bor_net_edge_t *e, void *ud)
+{
+    bor_net_node_t **nodes = ud;
+    int i, j;
+
+    for (i = 0; nodes[i] != e->n[0]; ++i);
+    for (j = 0; nodes[j] != e->n[1]; ++j);
+    return 1 + i + j;
+}
+
+static void delNode(bor_net_node_t *n, void *_)
+{
+    borNetNodeDel(n);
+}
+
+static void delEdge(bor_net_edge_t *e, void *_)
+{
+    borNetEdgeDel(e);
+}
+
+TEST(graphCSRNet)
+{
+    bor_net_t *net;
+    bor_net_node_t *nodes[5], *ids[5];
+    bor_net_edge_t *edge;
+    bor_graph_csr_t *g;
+    bor_real_t dist[5];
+    static const int edges[][2] = { {0, 1}, {1, 2}, {2, 3}, {0, 3}, {3, 4} };
+    int i;
+
+    net = borNetNew();
+    for (i = 0; i < 5; ++i){
+        nodes[i] = borNetNodeNew();
+        borNetAddNode(net, nodes[i]);
+    }
+    for (i = 0; i < 5; ++i){
+        edge = borNetEdgeNew();
+        borNetAddEdge(net, edge, nodes[edges[i][0]], nodes[edges[i][1]]);
+    }
+
+    g = borGraphCSRNewNet(net, 1, netWeight, nodes, ids);
+    assertEquals(g->node_size, 5);
+    assertEquals(g->edge_size, 5);
+    for (i = 0; i < 5; ++i)
+        assertEquals(ids[i], nodes[i]);
+    assertEquals(borGraphCSRDegree(g, 0), 2);
+    assertEquals(borGraphCSRDegree(g, 4), 0);
+    borGraphCSRDij(g, 0, -1, dist, NULL);
+    assertTrue(borEq(dist[3], 4.));
+    assertTrue(borEq(dist[4], 12.));
+    assertEquals(borGraphCSRDij(g, 4, 0, dist, NULL), -1);
+    borGraphCSRDel(g);
+
+    g = borGraphCSRNewNet(net, 0, NULL, NULL, NULL);
+    assertEquals(g->edge_size, 10);
+    assertTrue(g->weight == NULL);
+    assertEquals(borGraphCSRDegree(g, 3), 3);
+    assertEquals(borGraphCSRDij(g, 4, 1, dist, NULL), 0);
+    assertTrue(borEq(dist[1], 3.));
+    borGraphCSRDel(g);
+
+    borNetDel2(net, delNode, NULL, delEdge, NULL);
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_GRAPH_CSR_H
+#define TEST_GRAPH_CSR_H
+
+TEST(graphCSRDij);
+TEST(graphCSRSCC);
+TEST(graphCSRSCCPar);
+TEST(graphCSRNet);
+
+TEST_SUITE(TSGraphCSR) {
+    TEST_ADD(graphCSRDij),
+    TEST_ADD(graphCSRSCC),
+    TEST_ADD(graphCSRSCCPar),
+    TEST_ADD(graphCSRNet),
+    TEST_SUITE_CLOSURE
+};
+
+#endif /* TEST_GRAPH_CSR_H */
@@ -3,6 +3,7 @@
 #include <boruvka/vec2.h>
 #include <boruvka/rand.h>
 #include <boruvka/nearest-linear.h>
+#include <boruvka/task-pool.h>
 #include <boruvka/dbg.h>
 
 static bor_rand_t r;
@@ -293,3 +294,121 @@ TEST(gugNearest6)
 
     printf("------ gug6Nearest\n\n");
 }
+
+
+#define BATCH_LEN 1000
+#define BATCH_NUM 4
+TEST(gugNearestBatch2)
+{
+    bor_vec2_t vs[BATCH_LEN];
+    const bor_vec_t *ps[BATCH_LEN];
+    bor_list_t head;
+    el_t ns[N_LEN];
+    bor_gug_el_t *nsc[BATCH_NUM];
+    bor_gug_el_t *els[BATCH_LEN * BATCH_NUM];
+    size_t found[BATCH_LEN];
+    bor_gug_t *cs;
+    bor_gug_params_t params;
+    bor_task_pool_t *tp;
+    bor_real_t range[4] = { -9., 9., -11., 7. };
+    size_t i, j, len;
+
+    borGUGParamsInit(&params);
+    params.dim = 2;
+    params.num_cells = 0;
+    params.max_dens = 1;
+    params.expand_rate = 2.;
+    params.aabb = range;
+    cs = borGUGNew(&params);
+    elNew(ns, N_LEN, &head);
+    elAdd(cs, ns, N_LEN);
+
+    for (i = 0; i < BATCH_LEN; i++){
+        borVec2Set(&vs[i], borRand(&r, -10., 10.), borRand(&r, -10, 10));
+        ps[i] = (const bor_vec_t *)&vs[i];
+    }
+
+    // single threaded
+    borGUGNearestBatch(cs, ps, BATCH_LEN, BATCH_NUM, els, found, NULL);
+    for (i = 0; i < BATCH_LEN; i++){
+        len = borGUGNearest(cs, ps[i], BATCH_NUM, nsc);
+        assertEquals(found[i], len);
+        for (j = 0; j < len; j++){
+            assertEquals(els[i * BATCH_NUM + j], nsc[j]);
+        }
+    }
+
+    // multi threaded
+    tp = borTaskPoolNew(4);
+    borTaskPoolRun(tp);
+    borGUGNearestBatch(cs, ps, BATCH_LEN, BATCH_NUM, els, found, tp);
+    for (i = 0; i < BATCH_LEN; i++){
+        len = borGUGNearest(cs, ps[i], BATCH_NUM, nsc);
+        assertEquals(found[i], len);
+        for (j = 0; j < len; j++){
+            assertEquals(els[i * BATCH_NUM + j], nsc[j]);
+        }
+    }
+    borTaskPoolDel(tp);
+
+    borGUGDel(cs);
+}
+
+TEST(gugNearestPacked)
+{
+    bor_vec2_t v;
+    bor_list_t head;
+    el_t ns[N_LEN];
+    bor_gug_el_t *nsc[5];
+    bor_list_t *nsl[5];
+    el_t *near[2];
+    bor_gug_t *cs;
+    bor_gug_params_t params;
+    bor_real_t range[4] = { -9., 9., -11., 7. };
+    size_t i, j, k;
+
+    borGUGParamsInit(&params);
+    params.dim = 2;
+    params.num_cells = 0;
+    params.max_dens = 1;
+    params.expand_rate = 2.;
+    params.aabb = range;
+    params.packed = 1;
+    cs = borGUGNew(&params);
+    elNew(ns, N_LEN, &head);
+    elAdd(cs, ns, N_LEN);
+
+    // remove every fifth element, move every fifth one to a random
+    // position (usually another cell) and every fifth one only slightly
+    // (usually within the same cell)
+    for (i = 0; i < N_LEN; i += 5){
+        borGUGRemove(cs, &ns[i].c);
+        borListDel(&ns[i].list);
+    }
+    for (i = 1; i < N_LEN; i += 5){
+        borVec2Set(&ns[i].v, borRand(&r, -10., 10.), borRand(&r, -10, 10));
+        borGUGUpdate(cs, &ns[i].c);
+    }
+    for (i = 2; i < N_LEN; i += 5){
+        borVec2Add(&ns[i].v, &ns[i].v);
+        borVec2Scale(&ns[i].v, 0.5001);
+        borGUGUpdate(cs, &ns[i].c);
+    }
+
+    for (k = 0; k < 5; k++){
+        for (i=0; i < N_LOOPS; i++){
+            borVec2Set(&v, borRand(&r, -10., 10.), borRand(&r, -10, 10));
+
+            borGUGNearest(cs, (const bor_vec_t *)&v, k + 1, nsc);
+            borNearestLinear(&head, &v, dist2, nsl, k + 1, NULL);
+
+            for (j = 0; j < k + 1; j++){
+                near[0] = bor_container_of(nsc[j], el_t, c);
+                near[1] = BOR_LIST_ENTRY(nsl[j], el_t, list);
+                assertEquals(near[0], near[1]);
+            }
+        }
+    }
+
+    borGUGDel(cs);
+}
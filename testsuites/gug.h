@@ -9,6 +9,8 @@ TEST(gugNew2);
 TEST(gugEl2);
 TEST(gugNearest2);
 TEST(gugNearest6);
+TEST(gugNearestBatch2);
+TEST(gugNearestPacked);
 /*
 TEST(gugNearest);
 */
@@ -20,6 +22,8 @@ TEST_SUITE(TSGUG) {
     TEST_ADD(gugEl2),
     TEST_ADD(gugNearest2),
     TEST_ADD(gugNearest6),
+    TEST_ADD(gugNearestBatch2),
+    TEST_ADD(gugNearestPacked),
     /*
     TEST_ADD(gugNearest),
     */
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <cu/cu.h>
 #include <boruvka/htable.h>
+#include <boruvka/htable-oa.h>
 #include <boruvka/hfunc.h>
 #include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
@@ -205,3 +206,251 @@ TEST(htableInsertUnique)
 
     printf("---- htableInsertUnique END ----\n");
 }
+
+static int cmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+/** Returns number of occurences of {val} in sorted array */
+static uint64_t countU32(const uint32_t *sorted, size_t len, uint32_t val)
+{
+    const uint32_t *f;
+    uint64_t cnt = 0;
+
+    f = bsearch(&val, sorted, len, sizeof(uint32_t), cmpU32);
+    if (f == NULL)
+        return 0;
+    while (f > sorted && *(f - 1) == val)
+        --f;
+    for (; f < sorted + len && *f == val; ++f)
+        ++cnt;
+    return cnt;
+}
+
+/** Returns sorted values of the first {len} elements */
+static uint32_t *sortedVals(size_t len)
+{
+    uint32_t *vals;
+    size_t i;
+
+    vals = BOR_ALLOC_ARR(uint32_t, len);
+    for (i = 0; i < len; ++i)
+        vals[i] = els[i].val;
+    qsort(vals, len, sizeof(uint32_t), cmpU32);
+    return vals;
+}
+
+TEST(htableOA)
+{
+    bor_htable_oa_t *h;
+    uint32_t *sorted, *erased, key;
+    uint64_t *val, one = 1;
+    void *k, *v;
+    size_t i, it, num;
+
+    sorted = sortedVals(els_len);
+    erased = sortedVals(els_len / 2);
+    h = borHTableOANew(sizeof(uint32_t), sizeof(uint64_t), NULL, NULL, NULL);
+
+    for (i = 0; i < els_len; ++i){
+        val = borHTableOAInsertUnique(h, &els[i].val, &one);
+        if (val != NULL)
+            ++*val;
+        assertTrue(borHTableOANumElements(h) <= borHTableOASize(h));
+    }
+
+    for (i = 0; i < els_len; ++i){
+        val = borHTableOAFind(h, &els[i].val);
+        assertNotEquals(val, NULL);
+        if (val == NULL)
+            continue;
+        assertEquals(((uintptr_t)val) % sizeof(uint64_t), 0);
+        assertEquals(*val, countU32(sorted, els_len, els[i].val));
+    }
+
+    key = 121;
+    assertEquals(borHTableOAFind(h, &key), NULL);
+    assertEquals(borHTableOAErase(h, &key), -1);
+
+    num = 0;
+    it = 0;
+    while (borHTableOANext(h, &it, &k, &v) == 0){
+        assertEquals(*(uint64_t *)v, countU32(sorted, els_len,
+                                              *(uint32_t *)k));
+        ++num;
+    }
+    assertEquals(num, borHTableOANumElements(h));
+
+    for (i = 0; i < els_len / 2; ++i){
+        if (borHTableOAErase(h, &els[i].val) == 0)
+            --num;
+        assertEquals(num, borHTableOANumElements(h));
+        assertEquals(borHTableOAFind(h, &els[i].val), NULL);
+    }
+    for (i = els_len / 2; i < els_len; ++i){
+        val = borHTableOAFind(h, &els[i].val);
+        if (countU32(erased, els_len / 2, els[i].val) > 0){
+            assertEquals(val, NULL);
+        }else{
+            assertNotEquals(val, NULL);
+        }
+    }
+
+    /* Reinsert into the table with tombstones */
+    for (i = 0; i < els_len / 2; ++i){
+        val = borHTableOAInsert(h, &els[i].val, NULL);
+        assertEquals(*val, 0);
+    }
+    for (i = 0; i < els_len; ++i)
+        assertNotEquals(borHTableOAFind(h, &els[i].val), NULL);
+
+    borHTableOAClear(h);
+    assertEquals(borHTableOANumElements(h), 0);
+    assertEquals(borHTableOAFind(h, &els[0].val), NULL);
+
+    borHTableOADel(h);
+    BOR_FREE(sorted);
+    BOR_FREE(erased);
+}
+
+_bor_inline uint64_t oaHash(const uint32_t *key)
+{
+    return *key * 0x9e3779b97f4a7c15ull;
+}
+
+#define oaEq(k1, k2) (*(k1) == *(k2))
+
+BOR_HTABLE_OA_DECL(uint32_t, uint64_t, oa_u32_t, oaU32, oaHash, oaEq)
+
+TEST(htableOATyped)
+{
+    oa_u32_t h;
+    uint32_t *sorted, *erased, key;
+    uint64_t *val, one = 1;
+    size_t i, num;
+
+    sorted = sortedVals(els_len);
+    erased = sortedVals(els_len / 2);
+    oaU32Init(&h, 0);
+
+    for (i = 0; i < els_len; ++i){
+        val = oaU32InsertUnique(&h, &els[i].val, &one);
+        if (val != NULL)
+            ++*val;
+    }
+
+    num = 0;
+    for (i = 0; i < h.size; ++i){
+        if (h.ctrl[i] < 0)
+            continue;
+        assertEquals(h.slots[i].val,
+                     countU32(sorted, els_len, h.slots[i].key));
+        ++num;
+    }
+    assertEquals(num, h.num_elements);
+
+    for (i = 0; i < els_len; ++i){
+        val = oaU32Find(&h, &els[i].val);
+        assertNotEquals(val, NULL);
+        if (val != NULL){
+            assertEquals(*val, countU32(sorted, els_len, els[i].val));
+        }
+    }
+
+    for (i = 0; i < els_len / 2; ++i){
+        oaU32Erase(&h, &els[i].val);
+        assertEquals(oaU32Find(&h, &els[i].val), NULL);
+    }
+    for (i = els_len / 2; i < els_len; ++i){
+        if (countU32(erased, els_len / 2, els[i].val) == 0){
+            assertNotEquals(oaU32Find(&h, &els[i].val), NULL);
+        }
+    }
+
+    key = 121;
+    assertEquals(oaU32Erase(&h, &key), -1);
+    val = oaU32Insert(&h, &key, &one);
+    assertEquals(*val, 1);
+    val = oaU32Insert(&h, &key, NULL);
+    assertEquals(*val, 0);
+
+    oaU32Free(&h);
+    BOR_FREE(sorted);
+    BOR_FREE(erased);
+}
+
+TEST(htableIncremental)
+{
+    bor_htable_t *h;
+    bor_list_t **fels, list, *item;
+    uint32_t *sorted;
+    size_t i, size, found, num;
+    int resized = 0;
+
+    sorted = sortedVals(els_len);
+    h = borHTableNew(hash, eq, NULL);
+    borHTableSetIncrementalResize(h, 1);
+
+    for (i = 0; i < els_len; ++i){
+        borHTableInsert(h, &els[i].htable);
+        assertEquals(i + 1, h->num_elements);
+        resized |= borHTableResizing(h);
+
+        // elements inserted before the resize must be still reachable
+        if (borHTableResizing(h)){
+            assertNotEquals(borHTableFind(h, &els[i / 2].htable), NULL);
+        }
+    }
+    assertTrue(resized);
+
+    for (i = 0; i < els_len; ++i){
+        size = 0;
+        fels = NULL;
+        found = borHTableFindAll(h, &els[i].htable, &fels, &size);
+        assertEquals(found, countU32(sorted, els_len, els[i].val));
+        if (fels)
+            BOR_FREE(fels);
+    }
+
+    for (i = 0; i < els_len / 2; ++i){
+        assertEquals(borHTableErase(h, &els[i].htable), 0);
+        assertEquals(els_len - i - 1, h->num_elements);
+    }
+    for (i = els_len / 2; i < els_len; ++i){
+        assertNotEquals(borHTableFind(h, &els[i].htable), NULL);
+    }
+
+    // start another resize and leave it unfinished
+    borHTableResizeIncremental(h, borHTableNextPrime(4 * h->size));
+    assertTrue(borHTableResizing(h));
+    assertTrue(borHTableResizeStep(h, 1));
+    for (i = els_len / 2; i < els_len; ++i){
+        assertNotEquals(borHTableFind(h, &els[i].htable), NULL);
+    }
+
+    borListInit(&list);
+    borHTableGather(h, &list);
+    assertFalse(borHTableResizing(h));
+    num = 0;
+    BOR_LIST_FOR_EACH(&list, item)
+        ++num;
+    assertEquals(num, els_len - els_len / 2);
+    assertEquals(h->num_elements, 0);
+
+    for (i = 0; i < els_len; ++i){
+        borListInit(&els[i].htable);
+        borHTableInsert(h, &els[i].htable);
+    }
+    while (borHTableResizeStep(h, 1000));
+    assertFalse(borHTableResizing(h));
+    borHTableSetIncrementalResize(h, 0);
+    for (i = 0; i < els_len; ++i){
+        assertNotEquals(borHTableFind(h, &els[i].htable), NULL);
+    }
+
+    borHTableDel(h);
+    BOR_FREE(sorted);
+}
@@ -6,6 +6,9 @@ TEST(htableTearDown);
 TEST(htableBasic);
 TEST(htableFindAll);
 TEST(htableInsertUnique);
+TEST(htableOA);
+TEST(htableOATyped);
+TEST(htableIncremental);
 
 TEST_SUITE(TSHTable) {
     TEST_ADD(htableSetUp),
@@ -13,6 +16,9 @@ TEST_SUITE(TSHTable) {
     TEST_ADD(htableBasic),
     TEST_ADD(htableFindAll),
     TEST_ADD(htableInsertUnique),
+    TEST_ADD(htableOA),
+    TEST_ADD(htableOATyped),
+    TEST_ADD(htableIncremental),
 
     TEST_ADD(htableTearDown),
     TEST_SUITE_CLOSURE
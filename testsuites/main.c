@@ -19,8 +19,12 @@
 #include "splaytree.h"
 #include "splaytree_int.h"
 #include "bucketheap.h"
+#include "radixheap.h"
 #include "dij.h"
+#include "graph-csr.h"
 #include "chull3.h"
+#include "delaunay.h"
+#include "predicates.h"
 #include "tasks.h"
 #include "task-pool.h"
 #include "vptree.h"
@@ -35,6 +39,9 @@
 #include "multimap.h"
 #include "fifo.h"
 #include "lifo.h"
+#include "ring_queue_mpmc.h"
+#include "chtable.h"
+#include "mempool.h"
 #ifdef BOR_HDF5
 #ifdef BOR_GSL
 # include "thdf5.h"
@@ -67,8 +74,12 @@ TEST_SUITES {
     TEST_SUITE_ADD(TSSplayTree),
     TEST_SUITE_ADD(TSSplayTreeInt),
     TEST_SUITE_ADD(TSBucketHeap),
+    TEST_SUITE_ADD(TSRadixHeap),
     TEST_SUITE_ADD(TSDij),
+    TEST_SUITE_ADD(TSGraphCSR),
     TEST_SUITE_ADD(TSCHull3),
+    TEST_SUITE_ADD(TSDelaunay),
+    TEST_SUITE_ADD(TSPredicates),
     TEST_SUITE_ADD(TSTasks),
     TEST_SUITE_ADD(TSTaskPool),
     TEST_SUITE_ADD(TSCfg),
@@ -80,6 +91,9 @@ TEST_SUITES {
     TEST_SUITE_ADD(TSMultiMap),
     TEST_SUITE_ADD(TSFifo),
     TEST_SUITE_ADD(TSLifo),
+    TEST_SUITE_ADD(TSRingQueueMPMC),
+    TEST_SUITE_ADD(TSCHTable),
+    TEST_SUITE_ADD(TSMemPool),
 #ifdef BOR_HDF5
 #ifdef BOR_GSL
     TEST_SUITE_ADD(TSHDF5),
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <cu/cu.h>
+#include <boruvka/mempool.h>
+#include <boruvka/alloc.h>
+#include <boruvka/rand-mt.h>
+
+#define OBJS 20000
+#define THREADS 4
+
+struct _obj_t {
+    unsigned char *p;
+    size_t size;
+};
+typedef struct _obj_t obj_t;
+
+static void objFill(obj_t *o)
+{
+    size_t i;
+    for (i = 0; i < o->size; ++i)
+        o->p[i] = (unsigned char)(((uintptr_t)o->p >> 4) + i);
+}
+
+static int objCheck(const obj_t *o)
+{
+    size_t i;
+    for (i = 0; i < o->size; ++i){
+        if (o->p[i] != (unsigned char)(((uintptr_t)o->p >> 4) + i))
+            return 0;
+    }
+    return 1;
+}
+
+static void objAlloc(bor_mempool_t *pool, obj_t *o, size_t size)
+{
+    o->size = size;
+    o->p = borMemPoolAlloc(pool, size);
+    assertEquals((uintptr_t)o->p % BOR_MEMPOOL_ALIGN, 0);
+    objFill(o);
+}
+
+static void allocFree(bor_mempool_t *pool, bor_rand_mt_t *rnd, obj_t *objs)
+{
+    int i, j, ok;
+
+    for (i = 0; i < OBJS; ++i)
+        objAlloc(pool, objs + i, borRandMT(rnd, 0, 2 * BOR_MEMPOOL_MAX_SIZE));
+
+    for (i = 0; i < OBJS; i += 2)
+        borMemPoolFree(pool, objs[i].p, objs[i].size);
+    for (i = 0; i < OBJS; i += 2)
+        objAlloc(pool, objs + i, borRandMT(rnd, 1, 200));
+
+    ok = 1;
+    for (i = 0; i < OBJS; ++i)
+        ok = ok && objCheck(objs + i);
+    assertTrue(ok);
+
+    // no two live objects may overlap
+    for (i = 1; i < OBJS; ++i){
+        for (j = i - 1; j >= 0 && j >= i - 64; --j){
+            if (objs[i].p < objs[j].p){
+                ok = ok && objs[i].p + objs[i].size <= objs[j].p;
+            }else{
+                ok = ok && objs[j].p + objs[j].size <= objs[i].p;
+            }
+        }
+    }
+    assertTrue(ok);
+}
+
+TEST(memPoolSingle)
+{
+    bor_mempool_t *pool;
+    bor_rand_mt_t *rnd;
+    obj_t *objs;
+    int i;
+
+    rnd = borRandMTNewAuto();
+    objs = BOR_ALLOC_ARR(obj_t, OBJS);
+
+    pool = borMemPoolNew(BOR_MEMPOOL_SINGLE_THREAD);
+    allocFree(pool, rnd, objs);
+    for (i = 0; i < OBJS; i += 3)
+        borMemPoolFree(pool, objs[i].p, objs[i].size);
+    // the rest is freed by the pool
+    borMemPoolDel(pool);
+
+    pool = borMemPoolNew(0);
+    allocFree(pool, rnd, objs);
+    borMemPoolDel(pool);
+
+    BOR_FREE(objs);
+    borRandMTDel(rnd);
+}
+
+TEST(memPoolReset)
+{
+    bor_mempool_t *pool;
+    obj_t *objs;
+    size_t allocated;
+    int i, ok;
+
+    objs = BOR_ALLOC_ARR(obj_t, OBJS);
+    pool = borMemPoolNew(BOR_MEMPOOL_SINGLE_THREAD);
+
+    for (i = 0; i < OBJS; ++i)
+        objAlloc(pool, objs + i, 24 + (i % 5) * 40);
+    objAlloc(pool, objs, 4 * BOR_MEMPOOL_MAX_SIZE);
+    allocated = borMemPoolAllocated(pool);
+    assertTrue(allocated > 0);
+
+    // the same allocations after reset must fit into the same slabs
+    borMemPoolReset(pool);
+    for (i = 0; i < OBJS; ++i)
+        objAlloc(pool, objs + i, 24 + (i % 5) * 40);
+    assertEquals(borMemPoolAllocated(pool), allocated);
+
+    ok = 1;
+    for (i = 0; i < OBJS; ++i)
+        ok = ok && objCheck(objs + i);
+    assertTrue(ok);
+
+    borMemPoolDel(pool);
+    BOR_FREE(objs);
+}
+
+
+struct _th_t {
+    pthread_t th;
+    int id;
+    bor_mempool_t *pool;
+    obj_t *objs;
+    int ok;
+};
+typedef struct _th_t th_t;
+
+static void *thAlloc(void *_th)
+{
+    th_t *th = _th;
+    bor_rand_mt_t *rnd;
+    int i;
+
+    rnd = borRandMTNew(th->id + 1);
+    for (i = 0; i < OBJS; ++i){
+        th->objs[i].size = borRandMT(rnd, 0, BOR_MEMPOOL_MAX_SIZE + 100);
+        th->objs[i].p = borMemPoolAlloc(th->pool, th->objs[i].size);
+        objFill(th->objs + i);
+        if (i % 3 == 0){
+            borMemPoolFree(th->pool, th->objs[i].p, th->objs[i].size);
+            th->objs[i].p = NULL;
+        }
+    }
+    borRandMTDel(rnd);
+    return NULL;
+}
+
+static void *thFree(void *_th)
+{
+    th_t *th = _th;
+    int i;
+
+    th->ok = 1;
+    for (i = 0; i < OBJS; ++i){
+        if (th->objs[i].p == NULL)
+            continue;
+        th->ok = th->ok && objCheck(th->objs + i);
+        if (i % 3 == 1)
+            borMemPoolFree(th->pool, th->objs[i].p, th->objs[i].size);
+    }
+    return NULL;
+}
+
+TEST(memPoolThreads)
+{
+    bor_mempool_t *pool;
+    th_t th[THREADS];
+    obj_t *objs[THREADS];
+    int i;
+
+    pool = borMemPoolNew(0);
+    for (i = 0; i < THREADS; ++i){
+        objs[i] = BOR_ALLOC_ARR(obj_t, OBJS);
+        th[i].id = i;
+        th[i].pool = pool;
+        th[i].objs = objs[i];
+        pthread_create(&th[i].th, NULL, thAlloc, th + i);
+    }
+    for (i = 0; i < THREADS; ++i)
+        pthread_join(th[i].th, NULL);
+
+    // free objects allocated by the other threads
+    for (i = 0; i < THREADS; ++i){
+        th[i].objs = objs[(i + 1) % THREADS];
+        pthread_create(&th[i].th, NULL, thFree, th + i);
+    }
+    for (i = 0; i < THREADS; ++i)
+        pthread_join(th[i].th, NULL);
+
+    for (i = 0; i < THREADS; ++i)
+        assertTrue(th[i].ok);
+
+    // and once again with the objects that are back in the pool
+    for (i = 0; i < THREADS; ++i){
+        th[i].id = THREADS + i;
+        th[i].objs = objs[i];
+        pthread_create(&th[i].th, NULL, thAlloc, th + i);
+    }
+    for (i = 0; i < THREADS; ++i)
+        pthread_join(th[i].th, NULL);
+    for (i = 0; i < THREADS; ++i){
+        th[i].objs = objs[(i + 2) % THREADS];
+        pthread_create(&th[i].th, NULL, thFree, th + i);
+    }
+    for (i = 0; i < THREADS; ++i){
+        pthread_join(th[i].th, NULL);
+        assertTrue(th[i].ok);
+    }
+
+    borMemPoolDel(pool);
+    for (i = 0; i < THREADS; ++i)
+        BOR_FREE(objs[i]);
+}
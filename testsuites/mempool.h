@@ -0,0 +1,15 @@
+#ifndef TEST_MEMPOOL_H
+#define TEST_MEMPOOL_H
+
+TEST(memPoolSingle);
+TEST(memPoolReset);
+TEST(memPoolThreads);
+
+TEST_SUITE(TSMemPool) {
+    TEST_ADD(memPoolSingle),
+    TEST_ADD(memPoolReset),
+    TEST_ADD(memPoolThreads),
+    TEST_SUITE_CLOSURE
+};
+
+#endif /* TEST_MEMPOOL_H */
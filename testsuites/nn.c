@@ -184,3 +184,101 @@ TEST(nnAddRm)
     _nnAddRm(BOR_NN_VPTREE, &params);
     _nnAddRm(BOR_NN_GUG, &params);
 }
+
+#define RANGE_ELS_LEN 5000
+#define RANGE_NUM_TESTS 200
+
+static void rangeCB(bor_nn_el_t *nel, bor_real_t dist, void *data)
+{
+    el_t *el = bor_container_of(nel, el_t, el);
+    int *count = (int *)data;
+
+    ++el->added;
+    ++*count;
+}
+
+static void _nnRange(uint8_t type, bor_nn_params_t *params, int freeze)
+{
+    bor_rand_mt_t *rand;
+    bor_nn_t *nn;
+    bor_nn_range_buf_t buf;
+    static el_t els[RANGE_ELS_LEN];
+    bor_vec2_t p;
+    bor_real_t radius, d;
+    size_t found;
+    int i, j, count, count2;
+    el_t *el;
+
+    rand = borRandMTNewAuto();
+    params->type = type;
+    nn = borNNNew(params);
+    borNNRangeBufInit(&buf);
+
+    for (i = 0; i < RANGE_ELS_LEN; i++){
+        borVec2Set(&els[i].w, borRandMT(rand, -3, 3), borRandMT(rand, -3, 3));
+        borNNElInit(nn, &els[i].el, (const bor_vec_t *)&els[i].w);
+        borNNAdd(nn, &els[i].el);
+    }
+    if (freeze)
+        borVPTreeFreeze((bor_vptree_t *)nn);
+
+    for (i = 0; i < RANGE_NUM_TESTS; i++){
+        // include points outside of the covered space
+        borVec2Set(&p, borRandMT(rand, -4, 4), borRandMT(rand, -4, 4));
+        radius = borRandMT(rand, 0, 1.5);
+
+        for (j = 0; j < RANGE_ELS_LEN; j++)
+            els[j].added = 0;
+
+        count = 0;
+        found = borNNRange(nn, (const bor_vec_t *)&p, radius, rangeCB, &count);
+        assertEquals(found, count);
+
+        count2 = 0;
+        for (j = 0; j < RANGE_ELS_LEN; j++){
+            d = borVec2Dist(&p, &els[j].w);
+            if (d < radius - BOR_EPS){
+                assertEquals(els[j].added, 1);
+            }else if (d > radius + BOR_EPS){
+                assertEquals(els[j].added, 0);
+            }
+            count2 += els[j].added;
+        }
+        assertEquals(count, count2);
+
+        found = borNNRangeBuf(nn, (const bor_vec_t *)&p, radius, &buf);
+        assertEquals(found, count);
+        assertEquals(buf.len, count);
+        for (j = 0; j < buf.len; j++){
+            el = bor_container_of(buf.els[j], el_t, el);
+            assertEquals(el->added, 1);
+            assertTrue(borEq(buf.dist[j], borVec2Dist(&p, &el->w)));
+        }
+    }
+
+    assertEquals(borNNRange(nn, (const bor_vec_t *)&p, -1, rangeCB, &count), 0);
+
+    borNNRangeBufFree(&buf);
+    borNNDel(nn);
+    borRandMTDel(rand);
+}
+
+TEST(nnRange)
+{
+    bor_nn_params_t params;
+    bor_real_t aabb[4] = {-3, 3, -3, 3};
+
+    borNNParamsInit(&params);
+    borNNParamsSetDim(&params, 2);
+    params.gug.aabb = aabb;
+    params.gug.max_dens = 0.1;
+    params.gug.expand_rate = 1.3;
+
+    _nnRange(BOR_NN_LINEAR, &params, 0);
+    _nnRange(BOR_NN_VPTREE, &params, 0);
+    _nnRange(BOR_NN_VPTREE, &params, 1);
+    _nnRange(BOR_NN_GUG, &params, 0);
+
+    params.gug.packed = 1;
+    _nnRange(BOR_NN_GUG, &params, 0);
+}
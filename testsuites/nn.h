@@ -4,10 +4,12 @@
 
 TEST(nnAdd);
 TEST(nnAddRm);
+TEST(nnRange);
 
 TEST_SUITE(TSNN) {
     TEST_ADD(nnAdd),
     TEST_ADD(nnAddRm),
+    TEST_ADD(nnRange),
 
     TEST_SUITE_CLOSURE
 };
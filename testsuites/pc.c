@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <cu/cu.h>
 #include <boruvka/pc.h>
+#include <boruvka/alloc.h>
 #include <boruvka/dbg.h>
 
 TEST(ppcSetUp)
@@ -124,3 +125,48 @@ TEST(ppcFromFile)
 
     borPCDel(pc);
 }
+
+TEST(ppcParallel)
+{
+    bor_task_pool_t *tp;
+    bor_pc_t *pc;
+    bor_vec2_t v;
+    bor_real_t aabb[4], aabb2[4];
+    int *seen;
+    size_t i, id;
+
+    tp = borTaskPoolNew(4);
+    borTaskPoolRun(tp);
+
+    pc = borPCNew2(2, 1000);
+    for (i = 0; i < 20000; i++){
+        borVec2Set(&v, i, -BOR_REAL(0.5) * i);
+        borPCAdd(pc, (bor_vec_t *)&v);
+    }
+
+    borPCAABB(pc, aabb);
+    borPCSetTaskPool(pc, tp);
+    borPCAABB(pc, aabb2);
+    assertTrue(borEq(aabb[0], 0.));
+    assertTrue(borEq(aabb[1], 19999.));
+    assertTrue(borEq(aabb[2], -0.5 * 19999.));
+    assertTrue(borEq(aabb[3], 0.));
+    for (i = 0; i < 4; i++)
+        assertTrue(borEq(aabb[i], aabb2[i]));
+
+    borPCPermutate(pc);
+    assertEquals(borPCLen(pc), 20000);
+
+    seen = BOR_CALLOC_ARR(int, 20000);
+    for (i = 0; i < 20000; i++){
+        id = borVecGet(borPCGet(pc, i), 0);
+        assertTrue(borEq(borVecGet(borPCGet(pc, i), 1), -0.5 * id));
+        seen[id]++;
+    }
+    for (i = 0; i < 20000; i++)
+        assertEquals(seen[i], 1);
+    BOR_FREE(seen);
+
+    borPCDel(pc);
+    borTaskPoolDel(tp);
+}
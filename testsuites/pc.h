@@ -6,6 +6,7 @@ TEST(ppcTearDown);
 
 TEST(ppcPermutate);
 TEST(ppcFromFile);
+TEST(ppcParallel);
 
 
 TEST_SUITE(TSPC) {
@@ -13,6 +14,7 @@ TEST_SUITE(TSPC) {
 
     TEST_ADD(ppcPermutate),
     TEST_ADD(ppcFromFile),
+    TEST_ADD(ppcParallel),
 
     TEST_ADD(ppcTearDown),
     TEST_SUITE_CLOSURE
@@ -0,0 +1,121 @@
+#include <cu/cu.h>
+#include <boruvka/predicates.h>
+#include <boruvka/rand-mt.h>
+#include <boruvka/alloc.h>
+
+static int sgn(bor_real_t x)
+{
+    return (x > 0.) - (x < 0.);
+}
+
+TEST(predBatchRandom)
+{
+    bor_pred_t pred;
+    bor_rand_mt_t *rnd;
+    bor_vec2_t *p2;
+    bor_vec3_t *p3;
+    bor_real_t *res;
+    size_t n = 1003, i;
+    int diff;
+
+    borPredInit(&pred);
+    rnd = borRandMTNew(111);
+    p2 = BOR_ALLOC_ALIGN_ARR(bor_vec2_t, n, 16);
+    p3 = borVec3ArrNew(n);
+    res = BOR_ALLOC_ARR(bor_real_t, n);
+    for (i = 0; i < n; i++){
+        borVec2Set(&p2[i], borRandMT(rnd, -1., 1.), borRandMT(rnd, -1., 1.));
+        borVec3Set(&p3[i], borRandMT(rnd, -1., 1.), borRandMT(rnd, -1., 1.),
+                           borRandMT(rnd, -1., 1.));
+    }
+
+    // the first points are the fixed ones, all points are queries
+    borPredOrient2dBatch(&pred, &p2[0], &p2[1], p2, n, res);
+    for (diff = 0, i = 0; i < n; i++)
+        diff += sgn(res[i]) != sgn(borPredOrient2d(&pred, &p2[0], &p2[1],
+                                                   &p2[i]));
+    assertEquals(diff, 0);
+
+    borPredInCircleBatch(&pred, &p2[0], &p2[1], &p2[2], p2, n, res);
+    for (diff = 0, i = 0; i < n; i++)
+        diff += sgn(res[i]) != sgn(borPredInCircle(&pred, &p2[0], &p2[1],
+                                                   &p2[2], &p2[i]));
+    assertEquals(diff, 0);
+
+    borPredOrient3dBatch(&pred, &p3[0], &p3[1], &p3[2], p3, n, res);
+    for (diff = 0, i = 0; i < n; i++)
+        diff += sgn(res[i]) != sgn(borPredOrient3d(&pred, &p3[0], &p3[1],
+                                                   &p3[2], &p3[i]));
+    assertEquals(diff, 0);
+
+    borPredInSphereBatch(&pred, &p3[0], &p3[1], &p3[2], &p3[3], p3, n, res);
+    for (diff = 0, i = 0; i < n; i++)
+        diff += sgn(res[i]) != sgn(borPredInSphere(&pred, &p3[0], &p3[1],
+                                                   &p3[2], &p3[3], &p3[i]));
+    assertEquals(diff, 0);
+
+    BOR_FREE(res);
+    BOR_FREE(p2);
+    borVec3ArrDel(p3);
+    borRandMTDel(rnd);
+}
+
+TEST(predBatchDegenerate)
+{
+    bor_pred_t pred;
+    bor_vec2_t a2, b2, c2, q2[8];
+    bor_vec3_t a3, b3, c3, d3, q3[9];
+    bor_real_t res[9];
+    size_t exact;
+    int i;
+
+    borPredInit(&pred);
+
+    // collinear and cocircular points (circle of radius 5)
+    borVec2Set(&a2, 5., 0.);
+    borVec2Set(&b2, 0., 5.);
+    borVec2Set(&c2, -3., 4.);
+    for (i = 0; i < 8; i++)
+        borVec2Set(&q2[i], 5. - 5. * (i + 2), 5. * (i + 2));
+
+    exact = borPredOrient2dBatch(&pred, &a2, &b2, q2, 8, res);
+    assertEquals(exact, 8);
+    for (i = 0; i < 8; i++)
+        assertEquals(sgn(res[i]), 0);
+
+    borVec2Set(&q2[0], 3., 4.);
+    borVec2Set(&q2[1], -4., -3.);
+    borVec2Set(&q2[2], 0., -5.);
+    borVec2Set(&q2[3], -5., 0.);
+    borVec2Set(&q2[4], 0., 0.);
+    exact = borPredInCircleBatch(&pred, &a2, &b2, &c2, q2, 5, res);
+    assertEquals(exact, 4);
+    for (i = 0; i < 4; i++)
+        assertEquals(sgn(res[i]), 0);
+    assertEquals(sgn(res[4]), 1);
+
+    // coplanar and cospherical points (sphere of radius 5)
+    borVec3Set(&a3, 5., 0., 0.);
+    borVec3Set(&b3, 0., 5., 0.);
+    borVec3Set(&c3, 0., 0., 5.);
+    borVec3Set(&d3, -3., -4., 0.);
+    for (i = 0; i < 9; i++)
+        borVec3Set(&q3[i], 5. - 5. * (i % 3), 5. * (i % 3) - 5. * (i / 3),
+                           5. * (i / 3));
+
+    exact = borPredOrient3dBatch(&pred, &a3, &b3, &c3, q3, 9, res);
+    assertEquals(exact, 9);
+    for (i = 0; i < 9; i++)
+        assertEquals(sgn(res[i]), 0);
+
+    borVec3Set(&q3[0], 0., 3., 4.);
+    borVec3Set(&q3[1], 4., 0., -3.);
+    borVec3Set(&q3[2], 0., 0., -5.);
+    borVec3Set(&q3[3], -5., 0., 0.);
+    borVec3Set(&q3[4], 0., 0., 0.);
+    exact = borPredInSphereBatch(&pred, &a3, &b3, &c3, &d3, q3, 5, res);
+    assertEquals(exact, 4);
+    for (i = 0; i < 4; i++)
+        assertEquals(sgn(res[i]), 0);
+    assertTrue(sgn(res[4]) != 0);
+}
@@ -0,0 +1,14 @@
+#ifndef TEST_PREDICATES_H
+#define TEST_PREDICATES_H
+
+TEST(predBatchRandom);
+TEST(predBatchDegenerate);
+
+TEST_SUITE(TSPredicates){
+    TEST_ADD(predBatchRandom),
+    TEST_ADD(predBatchDegenerate),
+
+    TEST_SUITE_CLOSURE
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include "cu.h"
+#include <boruvka/radixheap.h>
+#include <boruvka/rand.h>
+#include <boruvka/alloc.h>
+
+#define NUM 3000
+
+struct _el_t {
+    bor_radixheap_node_t node;
+    int in_heap;
+};
+typedef struct _el_t el_t;
+
+/** Returns minimal key of elements in heap */
+static uint64_t minKey(const el_t *els, size_t num)
+{
+    uint64_t min = UINT64_MAX;
+    size_t i;
+
+    for (i = 0; i < num; ++i){
+        if (els[i].in_heap && els[i].node.key < min)
+            min = els[i].node.key;
+    }
+    return min;
+}
+
+TEST(radixheap1)
+{
+    bor_radixheap_t *h;
+    bor_radixheap_node_t *n;
+    bor_rand_t r;
+    el_t *els, *el;
+    uint64_t last;
+    size_t i;
+
+    borRandInit(&r);
+    els = BOR_ALLOC_ARR(el_t, NUM);
+    h = borRadixHeapNew();
+    assertTrue(borRadixHeapEmpty(h));
+
+    for (i = 0; i < NUM / 2; ++i){
+        borRadixHeapAdd(h, &els[i].node, borRand(&r, 0., 1E9));
+        els[i].in_heap = 1;
+    }
+
+    // Interleave extraction with insertion of keys not lower than the last
+    // extracted key
+    last = 0;
+    for (i = NUM / 2; i < NUM; ++i){
+        n = borRadixHeapExtractMin(h);
+        el = bor_container_of(n, el_t, node);
+        assertEquals(borRadixHeapKey(n), minKey(els, i));
+        assertTrue(borRadixHeapKey(n) >= last);
+        last = borRadixHeapKey(n);
+        el->in_heap = 0;
+
+        borRadixHeapAdd(h, &els[i].node,
+                        last + (uint64_t)borRand(&r, 0., 1000.));
+        els[i].in_heap = 1;
+    }
+
+    while (!borRadixHeapEmpty(h)){
+        n = borRadixHeapExtractMin(h);
+        el = bor_container_of(n, el_t, node);
+        assertEquals(borRadixHeapKey(n), minKey(els, NUM));
+        el->in_heap = 0;
+    }
+
+    borRadixHeapDel(h);
+    BOR_FREE(els);
+}
+
+TEST(radixheapDecreaseKey)
+{
+    bor_radixheap_t *h;
+    bor_radixheap_node_t *n;
+    bor_rand_t r;
+    el_t *els, *el;
+    uint64_t key, last;
+    size_t i, j;
+
+    borRandInit(&r);
+    els = BOR_ALLOC_ARR(el_t, NUM);
+    h = borRadixHeapNew();
+
+    for (i = 0; i < NUM; ++i){
+        borRadixHeapAdd(h, &els[i].node, borRand(&r, 0., 1E6));
+        els[i].in_heap = 1;
+    }
+
+    last = 0;
+    while (!borRadixHeapEmpty(h)){
+        // decrease keys of a few random elements, never below last
+        for (j = 0; j < 3; ++j){
+            el = els + (size_t)borRand(&r, 0., NUM);
+            if (!el->in_heap || el->node.key == last)
+                continue;
+            key = last + (el->node.key - last) / 2;
+            borRadixHeapDecreaseKey(h, &el->node, key);
+        }
+
+        // and remove some
+        el = els + (size_t)borRand(&r, 0., NUM);
+        if (el->in_heap && borRand(&r, 0., 1.) < 0.1){
+            borRadixHeapRemove(h, &el->node);
+            el->in_heap = 0;
+            continue;
+        }
+
+        n = borRadixHeapExtractMin(h);
+        el = bor_container_of(n, el_t, node);
+        assertEquals(borRadixHeapKey(n), minKey(els, NUM));
+        assertTrue(borRadixHeapKey(n) >= last);
+        last = borRadixHeapKey(n);
+        el->in_heap = 0;
+    }
+
+    for (i = 0; i < NUM; ++i)
+        assertFalse(els[i].in_heap);
+
+    borRadixHeapDel(h);
+    BOR_FREE(els);
+}
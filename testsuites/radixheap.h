@@ -0,0 +1,15 @@
+#ifndef TEST_RADIXHEAP_H
+#define TEST_RADIXHEAP_H
+
+
+TEST(radixheap1);
+TEST(radixheapDecreaseKey);
+
+TEST_SUITE(TSRadixHeap) {
+    TEST_ADD(radixheap1),
+    TEST_ADD(radixheapDecreaseKey),
+
+    TEST_SUITE_CLOSURE
+};
+
+#endif
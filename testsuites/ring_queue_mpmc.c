@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <cu/cu.h>
+#include <boruvka/ring_queue_mpmc.h>
+
+TEST(ringQueueMPMC1)
+{
+    bor_ring_queue_mpmc_t q;
+    void *d;
+    long i;
+
+    borRingQueueMPMCInit(&q, 100);
+    assertEquals(borRingQueueMPMCSize(&q), 128);
+    assertEquals(borRingQueueMPMCPop(&q, &d), -1);
+
+    for (i = 0; i < 128; ++i)
+        assertEquals(borRingQueueMPMCPush(&q, (void *)(i + 1)), 0);
+    assertEquals(borRingQueueMPMCPush(&q, (void *)1000L), -1);
+
+    for (i = 0; i < 50; ++i){
+        assertEquals(borRingQueueMPMCPop(&q, &d), 0);
+        assertEquals((long)d, i + 1);
+    }
+    for (i = 128; i < 178; ++i)
+        assertEquals(borRingQueueMPMCPush(&q, (void *)(i + 1)), 0);
+    assertEquals(borRingQueueMPMCPush(&q, (void *)1000L), -1);
+
+    for (i = 50; i < 178; ++i){
+        assertEquals(borRingQueueMPMCPop(&q, &d), 0);
+        assertEquals((long)d, i + 1);
+    }
+    assertEquals(borRingQueueMPMCPop(&q, &d), -1);
+    assertEquals(borRingQueueMPMCPopBlockTimeout(&q, 10, &d), -1);
+
+    borRingQueueMPMCFree(&q);
+}
+
+TEST(ringQueueMPMCBatch)
+{
+    bor_ring_queue_mpmc_t q;
+    void *in[100], *out[100];
+    long i, next = 0;
+    size_t len;
+
+    for (i = 0; i < 100; ++i)
+        in[i] = (void *)i;
+
+    borRingQueueMPMCInit(&q, 64);
+    assertEquals(borRingQueueMPMCPushBatch(&q, in, 40), 40);
+    assertEquals(borRingQueueMPMCPushBatch(&q, in + 40, 40), 24);
+    assertEquals(borRingQueueMPMCPushBatch(&q, in, 1), 0);
+
+    len = borRingQueueMPMCPopBatch(&q, out, 30);
+    assertEquals(len, 30);
+    for (i = 0; i < 30; ++i)
+        assertEquals((long)out[i], next++);
+
+    assertEquals(borRingQueueMPMCPush(&q, (void *)64L), 0);
+    assertEquals(borRingQueueMPMCPushBatch(&q, in + 65, 35), 29);
+
+    len = borRingQueueMPMCPopBatch(&q, out, 100);
+    assertEquals(len, 64);
+    for (i = 0; i < 64; ++i)
+        assertEquals((long)out[i], next++);
+    assertEquals(borRingQueueMPMCPopBatch(&q, out, 100), 0);
+
+    borRingQueueMPMCFree(&q);
+}
+
+
+#define THREADS_PROD 4
+#define THREADS_CONS 4
+#define THREADS_ITEMS 100000L
+
+struct _th_t {
+    bor_ring_queue_mpmc_t *q;
+    int id;
+    long sum;
+    long len;
+};
+typedef struct _th_t th_t;
+
+static void *producer(void *_th)
+{
+    th_t *th = (th_t *)_th;
+    void *batch[8];
+    long i, j;
+    size_t done;
+
+    for (i = 0; i < THREADS_ITEMS;){
+        if (th->id % 2 == 0 || THREADS_ITEMS - i < 8){
+            borRingQueueMPMCPushBlock(th->q, (void *)(i + 1));
+            ++i;
+        }else{
+            for (j = 0; j < 8; ++j)
+                batch[j] = (void *)(i + j + 1);
+            done = borRingQueueMPMCPushBatch(th->q, batch, 8);
+            i += done;
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *_th)
+{
+    th_t *th = (th_t *)_th;
+    void *batch[8];
+    size_t i, len;
+    int stop = 0;
+    void *d;
+
+    while (!stop){
+        if (th->id % 2 == 0){
+            d = borRingQueueMPMCPopBlock(th->q);
+            if (d == NULL)
+                break;
+            th->sum += (long)d;
+            ++th->len;
+        }else{
+            len = borRingQueueMPMCPopBatch(th->q, batch, 8);
+            for (i = 0; i < len; ++i){
+                if (batch[i] == NULL){
+                    // give terminators of other consumers back
+                    if (stop++)
+                        borRingQueueMPMCPushBlock(th->q, NULL);
+                    continue;
+                }
+                th->sum += (long)batch[i];
+                ++th->len;
+            }
+        }
+    }
+    return NULL;
+}
+
+TEST(ringQueueMPMCThreads)
+{
+    bor_ring_queue_mpmc_t q;
+    pthread_t prod[THREADS_PROD], cons[THREADS_CONS];
+    th_t prod_th[THREADS_PROD], cons_th[THREADS_CONS];
+    long sum, len;
+    int i;
+
+    borRingQueueMPMCInit(&q, 256);
+
+    for (i = 0; i < THREADS_CONS; ++i){
+        cons_th[i].q = &q;
+        cons_th[i].id = i;
+        cons_th[i].sum = cons_th[i].len = 0;
+        pthread_create(cons + i, NULL, consumer, cons_th + i);
+    }
+    for (i = 0; i < THREADS_PROD; ++i){
+        prod_th[i].q = &q;
+        prod_th[i].id = i;
+        pthread_create(prod + i, NULL, producer, prod_th + i);
+    }
+
+    for (i = 0; i < THREADS_PROD; ++i)
+        pthread_join(prod[i], NULL);
+    // NULL terminates consumers
+    for (i = 0; i < THREADS_CONS; ++i)
+        borRingQueueMPMCPushBlock(&q, NULL);
+    for (i = 0; i < THREADS_CONS; ++i)
+        pthread_join(cons[i], NULL);
+
+    sum = len = 0;
+    for (i = 0; i < THREADS_CONS; ++i){
+        sum += cons_th[i].sum;
+        len += cons_th[i].len;
+    }
+    assertEquals(len, THREADS_PROD * THREADS_ITEMS);
+    assertEquals(sum, THREADS_PROD * (THREADS_ITEMS * (THREADS_ITEMS + 1) / 2));
+
+    borRingQueueMPMCFree(&q);
+}
+
+
+#define STRESS_THREADS 4
+#define STRESS_ITEMS 100000L
+#define STRESS_SIZE 16
+#define STRESS_BATCH 15
+
+/** Each thread is both producer and consumer and uses batches close to
+ *  the capacity of the queue, so reservation of more slots than there
+ *  is free room would end up in a deadlock. */
+static void *stressWorker(void *_th)
+{
+    th_t *th = (th_t *)_th;
+    void *batch[STRESS_BATCH];
+    long i, j, len;
+    size_t k, popped;
+
+    for (i = 0; i < STRESS_ITEMS;){
+        len = BOR_MIN(STRESS_BATCH, STRESS_ITEMS - i);
+        for (j = 0; j < len; ++j)
+            batch[j] = (void *)(i + j + 1);
+        i += borRingQueueMPMCPushBatch(th->q, batch, len);
+
+        popped = borRingQueueMPMCPopBatch(th->q, batch, STRESS_BATCH);
+        for (k = 0; k < popped; ++k)
+            th->sum += (long)batch[k];
+        th->len += popped;
+    }
+    return NULL;
+}
+
+TEST(ringQueueMPMCBatchStress)
+{
+    bor_ring_queue_mpmc_t q;
+    pthread_t th[STRESS_THREADS];
+    th_t th_data[STRESS_THREADS];
+    void *batch[STRESS_BATCH];
+    long sum, len;
+    size_t k, popped;
+    int i;
+
+    borRingQueueMPMCInit(&q, STRESS_SIZE);
+    for (i = 0; i < STRESS_THREADS; ++i){
+        th_data[i].q = &q;
+        th_data[i].id = i;
+        th_data[i].sum = th_data[i].len = 0;
+        pthread_create(th + i, NULL, stressWorker, th_data + i);
+    }
+    for (i = 0; i < STRESS_THREADS; ++i)
+        pthread_join(th[i], NULL);
+
+    sum = len = 0;
+    for (i = 0; i < STRESS_THREADS; ++i){
+        sum += th_data[i].sum;
+        len += th_data[i].len;
+    }
+    while ((popped = borRingQueueMPMCPopBatch(&q, batch, STRESS_BATCH)) > 0){
+        for (k = 0; k < popped; ++k)
+            sum += (long)batch[k];
+        len += popped;
+    }
+
+    assertEquals(len, STRESS_THREADS * STRESS_ITEMS);
+    assertEquals(sum, STRESS_THREADS * (STRESS_ITEMS * (STRESS_ITEMS + 1) / 2));
+
+    borRingQueueMPMCFree(&q);
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_RING_QUEUE_MPMC_H
+#define TEST_RING_QUEUE_MPMC_H
+
+TEST(ringQueueMPMC1);
+TEST(ringQueueMPMCBatch);
+TEST(ringQueueMPMCThreads);
+TEST(ringQueueMPMCBatchStress);
+
+TEST_SUITE(TSRingQueueMPMC) {
+    TEST_ADD(ringQueueMPMC1),
+    TEST_ADD(ringQueueMPMCBatch),
+    TEST_ADD(ringQueueMPMCThreads),
+    TEST_ADD(ringQueueMPMCBatchStress),
+    TEST_SUITE_CLOSURE
+};
+
+#endif
@@ -73,3 +73,34 @@ TEST(testSCC)
     print(&scc, stdout, "graph1 - 5");
     borSCCFree(&scc);
 }
+
+static long cycleIt(int node_id, void *ud)
+{
+    return 0;
+}
+
+static int cycleNext(int node_id, long *it, void *ud)
+{
+    int size = *(int *)ud;
+
+    if (*it > 0)
+        return -1;
+    *it = 1;
+    return (node_id + 1) % size;
+}
+
+TEST(testSCCDeep)
+{
+    bor_scc_t scc;
+    int size = 1000000;
+    int i;
+
+    // the DFS goes 10^6 nodes deep
+    borSCCInit(&scc, size, cycleIt, cycleNext, &size);
+    borSCC(&scc);
+    assertEquals(scc.comp_size, 1);
+    assertEquals(scc.comp[0].node_size, size);
+    for (i = 0; i < size; ++i)
+        assertEquals(scc.comp[0].node[i], i);
+    borSCCFree(&scc);
+}
@@ -2,9 +2,11 @@
 #define TEST_SCC_H
 
 TEST(testSCC);
+TEST(testSCCDeep);
 
 TEST_SUITE(TSSCC) {
     TEST_ADD(testSCC),
+    TEST_ADD(testSCCDeep),
     TEST_SUITE_CLOSURE
 };
 
@@ -1,5 +1,6 @@
 #include <cu/cu.h>
 #include <boruvka/task-pool.h>
+#include <boruvka/parallel.h>
 #include <boruvka/vec3.h>
 #include <boruvka/dbg.h>
 
@@ -72,3 +73,56 @@ TEST(taskpool2)
 
     printf(" === taskpool2 end ===\n");
 }
+
+static void parFor(size_t from, size_t to, void *data,
+                   const bor_task_pool_thinfo_t *info)
+{
+    int *cnt = (int *)data;
+    size_t i;
+
+    for (i = from; i < to; i++)
+        cnt[i]++;
+}
+
+static void parSum(size_t from, size_t to, void *acc, void *data,
+                   const bor_task_pool_thinfo_t *info)
+{
+    size_t i;
+
+    for (i = from; i < to; i++)
+        *(long *)acc += i;
+}
+
+static void parSumJoin(void *acc, const void *acc2, void *data)
+{
+    *(long *)acc += *(const long *)acc2;
+}
+
+TEST(taskpoolParallel)
+{
+    bor_task_pool_t *t;
+    int cnt[10000];
+    long sum;
+    size_t i, grain;
+
+    t = borTaskPoolNew(4);
+    borTaskPoolRun(t);
+
+    for (grain = 0; grain < 20000; grain = grain * 10 + 1){
+        for (i = 0; i < 10000; i++)
+            cnt[i] = 0;
+        borParallelFor(t, 10, 10000, grain, parFor, cnt);
+        borParallelFor(NULL, 10, 10000, grain, parFor, cnt);
+        for (i = 0; i < 10; i++)
+            assertEquals(cnt[i], 0);
+        for (i = 10; i < 10000; i++)
+            assertEquals(cnt[i], 2);
+
+        sum = 0;
+        borParallelReduce(t, 0, 10000, grain, &sum, sizeof(sum),
+                          parSum, parSumJoin, NULL);
+        assertEquals(sum, 10000L * 9999L / 2L);
+    }
+
+    borTaskPoolDel(t);
+}
@@ -3,10 +3,12 @@
 
 TEST(taskpool1);
 TEST(taskpool2);
+TEST(taskpoolParallel);
 
 TEST_SUITE(TSTaskPool) {
     TEST_ADD(taskpool1),
     //TEST_ADD(taskpool2),
+    TEST_ADD(taskpoolParallel),
     TEST_SUITE_CLOSURE
 };
 
@@ -48,3 +48,113 @@ TEST(tasks1)
     fflush(stdout);
     borTasksDel(t);
 }
+
+static void taskCount(int id, void *data, const bor_tasks_thinfo_t *info)
+{
+    int *cnt = (int *)data;
+    __atomic_add_fetch(cnt + id, 1, __ATOMIC_RELAXED);
+}
+
+static void taskSub(int id, void *data, const bor_tasks_thinfo_t *info)
+{
+    int *cnt = (int *)data;
+    __atomic_add_fetch(cnt + id, 1, __ATOMIC_RELAXED);
+}
+
+static bor_tasks_t *tasks_sub = NULL;
+
+static void taskSpawnSub(int id, void *data, const bor_tasks_thinfo_t *info)
+{
+    int i;
+
+    for (i = 0; i < 10; i++)
+        borTasksAdd(tasks_sub, taskSub, id * 10 + i, data);
+}
+
+TEST(tasksSubtasks)
+{
+    bor_tasks_t *t;
+    int cnt[1000];
+    int i;
+
+    for (i = 0; i < 1000; i++)
+        cnt[i] = 0;
+
+    t = borTasksNew(4);
+    tasks_sub = t;
+    borTasksRun(t);
+
+    for (i = 0; i < 1000; i++)
+        borTasksAdd(t, taskCount, i, cnt);
+    borTasksBarrier(t);
+    assertEquals(borTasksPending(t), 0);
+    for (i = 0; i < 1000; i++)
+        assertEquals(cnt[i], 1);
+
+    for (i = 0; i < 100; i++)
+        borTasksAdd(t, taskSpawnSub, i, cnt);
+    borTasksBarrier(t);
+    assertEquals(borTasksPending(t), 0);
+    for (i = 0; i < 1000; i++)
+        assertEquals(cnt[i], 2);
+
+    borTasksDel(t);
+}
+
+
+struct _fib_t {
+    bor_tasks_t *tasks;
+    int n;
+    long res;
+};
+typedef struct _fib_t fib_t;
+
+static void taskFib(int id, void *data, const bor_tasks_thinfo_t *info)
+{
+    fib_t *f = (fib_t *)data;
+    fib_t a, b;
+    bor_tasks_group_t g;
+
+    if (f->n < 2){
+        f->res = f->n;
+        return;
+    }
+
+    a.tasks = b.tasks = f->tasks;
+    a.n = f->n - 1;
+    b.n = f->n - 2;
+
+    borTasksGroupInit(&g);
+    borTasksSpawn(f->tasks, &g, taskFib, 0, &a);
+    borTasksSpawn(f->tasks, &g, taskFib, 0, &b);
+    borTasksJoin(f->tasks, &g);
+
+    f->res = a.res + b.res;
+}
+
+TEST(tasksForkJoin)
+{
+    bor_tasks_t *t;
+    bor_tasks_group_t g;
+    fib_t f[4];
+    int i;
+
+    t = borTasksNew(4);
+    borTasksRun(t);
+
+    borTasksGroupInit(&g);
+    for (i = 0; i < 4; i++){
+        f[i].tasks = t;
+        f[i].n = 15 + i;
+        borTasksSpawn(t, &g, taskFib, i, f + i);
+    }
+    borTasksJoin(t, &g);
+
+    assertEquals(f[0].res, 610);
+    assertEquals(f[1].res, 987);
+    assertEquals(f[2].res, 1597);
+    assertEquals(f[3].res, 2584);
+    assertEquals(borTasksPending(t), 0);
+
+    borTasksDel(t);
+}
@@ -2,9 +2,13 @@
 #define TEST_TASKS2_H
 
 TEST(tasks1);
+TEST(tasksSubtasks);
+TEST(tasksForkJoin);
 
 TEST_SUITE(TSTasks) {
     //TEST_ADD(tasks1),
+    TEST_ADD(tasksSubtasks),
+    TEST_ADD(tasksForkJoin),
     TEST_SUITE_CLOSURE
 };
 
@@ -1,7 +1,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <boruvka/nn.h>
+#include <boruvka/task-pool.h>
 #include <boruvka/alloc.h>
 #include <boruvka/rand.h>
 #include <boruvka/timer.h>
@@ -208,10 +210,88 @@ static void bench(void)
     close(devnull);
 }
 
+static void benchBatch(void)
+{
+    bor_nn_params_t params;
+    bor_real_t range[4] = { -15., 15., -18., 17. };
+    el_t *ns;
+    bor_nn_el_t *el[50];
+    bor_gug_el_t **els;
+    bor_vec2_t *vs;
+    const bor_vec_t **ps;
+    size_t *found;
+    int i, k, threads;
+    bor_task_pool_t *tp;
+    bor_timer_t timer;
+
+    borNNParamsInit(&params);
+    borNNParamsSetDim(&params, 2);
+    params.gug.num_cells = 0;
+    params.gug.max_dens = 1;
+    params.gug.expand_rate = 2.;
+    params.gug.aabb = range;
+
+    params.type = BOR_NN_LINEAR;
+    linear = borNNNew(&params);
+    params.type = BOR_NN_GUG;
+    gug    = borNNNew(&params);
+    params.type = BOR_NN_VPTREE;
+    vp     = borNNNew(&params);
+
+    ns = elsNew(arr_len);
+
+    vs    = BOR_ALLOC_ARR(bor_vec2_t, loops);
+    ps    = BOR_ALLOC_ARR(const bor_vec_t *, loops);
+    found = BOR_ALLOC_ARR(size_t, loops);
+    els   = BOR_ALLOC_ARR(bor_gug_el_t *, loops * nearest_len);
+    for (i = 0; i < loops; i++){
+        borVec2Set(&vs[i], borRand(&r, -10., 10.), borRand(&r, -10, 10));
+        ps[i] = (const bor_vec_t *)&vs[i];
+    }
+
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1)
+        threads = 1;
+    tp = borTaskPoolNew(threads);
+    borTaskPoolRun(tp);
+
+    for (k = 0; k < nearest_len; k++){
+        borTimerStart(&timer);
+        for (i = 0; i < loops; i++){
+            borNNNearest(gug, ps[i], k + 1, el);
+        }
+        borTimerStop(&timer);
+        borTimerPrintElapsed(&timer, stderr, " - [%d] - gug loop -                \n", k);
+
+        borTimerStart(&timer);
+        borGUGNearestBatch((const bor_gug_t *)gug, ps, loops, k + 1,
+                           els, found, NULL);
+        borTimerStop(&timer);
+        borTimerPrintElapsed(&timer, stderr, " - [%d] - gug batch -                \n", k);
+
+        borTimerStart(&timer);
+        borGUGNearestBatch((const bor_gug_t *)gug, ps, loops, k + 1,
+                           els, found, tp);
+        borTimerStop(&timer);
+        borTimerPrintElapsed(&timer, stderr, " - [%d] - gug batch (%d threads) -                \n", k, threads);
+    }
+
+    borTaskPoolDel(tp);
+
+    BOR_FREE(vs);
+    BOR_FREE(ps);
+    BOR_FREE(found);
+    BOR_FREE(els);
+    BOR_FREE(ns);
+    borNNDel(linear);
+    borNNDel(gug);
+    borNNDel(vp);
+}
+
 int main(int argc, char *argv[])
 {
     if (argc != 5){
-        fprintf(stderr, "Usage: %s test|bench arr_len loops nearest_len<50\n", argv[0]);
+        fprintf(stderr, "Usage: %s test|bench|bench-batch arr_len loops nearest_len<50\n", argv[0]);
         return -1;
     }
     arr_len     = atoi(argv[2]);
@@ -222,6 +302,8 @@ int main(int argc, char *argv[])
 
     if (strcmp(argv[1], "test") == 0){
         testCorrect();
+    }else if (strcmp(argv[1], "bench-batch") == 0){
+        benchBatch();
     }else{
         bench();
     }
@@ -2,6 +2,7 @@
 #include "cu.h"
 
 #include <boruvka/vec.h>
+#include <boruvka/rand.h>
 
 TEST(vecSetUp)
 {
@@ -90,3 +91,56 @@ TEST(vecOperators)
     borVecMulComp(6, u, w);
     prVec(6, "u .*= w    ", u);
 }
+
+
+#define DIST_LEN 37
+static void checkDist2Batch(size_t dim)
+{
+    bor_rand_t r;
+    bor_vec_t *p, *pts, *soa;
+    const bor_vec_t *ps[DIST_LEN];
+    bor_real_t dist[DIST_LEN], dist_soa[DIST_LEN], d;
+    size_t i, j;
+    int impl;
+
+    borRandInit(&r);
+    p   = borVecNew(dim);
+    pts = borVecNew(dim * DIST_LEN);
+    soa = borVecNew(dim * DIST_LEN);
+
+    for (j = 0; j < dim; j++)
+        borVecSet(p, j, borRand(&r, -10., 10.));
+    for (i = 0; i < DIST_LEN; i++){
+        ps[i] = pts + i * dim;
+        for (j = 0; j < dim; j++){
+            pts[i * dim + j] = borRand(&r, -10., 10.);
+            soa[j * DIST_LEN + i] = pts[i * dim + j];
+        }
+    }
+
+    for (impl = BOR_VEC_SIMD_NONE; impl <= BOR_VEC_SIMD_AVX2; impl++){
+        if (borVecSIMDSet(impl) != impl)
+            continue;
+
+        borVecDist2Batch(dim, p, ps, DIST_LEN, dist);
+        borVecDist2BatchSoA(dim, p, soa, DIST_LEN, DIST_LEN, dist_soa);
+        for (i = 0; i < DIST_LEN; i++){
+            d = borVecDist2(dim, p, ps[i]);
+            // order of summation may differ, allow for rounding errors
+            assertTrue(BOR_FABS(d - dist[i]) < 1E-4 * d);
+            assertTrue(BOR_FABS(d - dist_soa[i]) < 1E-4 * d);
+        }
+    }
+    borVecSIMDSet(BOR_VEC_SIMD_AUTO);
+
+    borVecDel(p);
+    borVecDel(pts);
+    borVecDel(soa);
+}
+
+TEST(vecDist2Batch)
+{
+    checkDist2Batch(2);
+    checkDist2Batch(3);
+    checkDist2Batch(7);
+}
@@ -8,6 +8,7 @@ TEST(vecTearDown);
 
 TEST(vecInit);
 TEST(vecOperators);
+TEST(vecDist2Batch);
 
 TEST_SUITE(TSVec)
 {
@@ -15,6 +16,7 @@ TEST_SUITE(TSVec)
 
     TEST_ADD(vecInit),
     TEST_ADD(vecOperators),
+    TEST_ADD(vecDist2Batch),
 
     TEST_ADD(vecTearDown),
     TEST_SUITE_CLOSURE
@@ -181,3 +181,127 @@ TEST(vptreeHammingAddRm)
     borRandMTDel(rand);
 }
 
+
+static int hammingDistBytes(const unsigned char *a, const unsigned char *b,
+                            size_t size)
+{
+    size_t i;
+    int dist = 0;
+
+    for (i = 0; i < size; i++)
+        dist += hammingDist(a[i], b[i]);
+    return dist;
+}
+
+#define DIST_MAXSIZE 130
+TEST(vptreeHammingDist)
+{
+    bor_rand_mt_t *rand;
+    unsigned char a[DIST_MAXSIZE + 1], b[DIST_MAXSIZE + 1];
+    int impl, i, j, size;
+
+    rand = borRandMTNewAuto();
+
+    for (impl = BOR_VPTREE_HAMMING_NONE; impl <= BOR_VPTREE_HAMMING_AVX512;
+            impl++){
+        borVPTreeHammingImplSet(impl);
+        assertTrue(borVPTreeHammingImpl() <= impl);
+
+        for (size = 1; size <= DIST_MAXSIZE; size++){
+            for (j = 0; j < 10; j++){
+                for (i = 0; i < DIST_MAXSIZE + 1; i++){
+                    a[i] = borRandMTInt(rand);
+                    b[i] = borRandMTInt(rand);
+                }
+
+                // unaligned keys
+                assertEquals(borVPTreeHammingDist(a + j % 2, b, size),
+                             hammingDistBytes(a + j % 2, b, size));
+            }
+        }
+    }
+
+    borVPTreeHammingImplSet(BOR_VPTREE_HAMMING_AUTO);
+    assertNotEquals(borVPTreeHammingImpl(), BOR_VPTREE_HAMMING_AUTO);
+
+    borRandMTDel(rand);
+}
+
+#define BATCH_SIZE 32
+#define BATCH_ELS_LEN 2000
+#define BATCH_QUERIES 100
+#define BATCH_NUM 5
+TEST(vptreeHammingBatch)
+{
+    bor_rand_mt_t *rand;
+    bor_vptree_hamming_t *vp;
+    bor_vptree_hamming_params_t params;
+    bor_task_pool_t *tp;
+    static unsigned char keys[BATCH_ELS_LEN][BATCH_SIZE];
+    static unsigned char qkeys[BATCH_QUERIES][BATCH_SIZE];
+    static bor_vptree_hamming_el_t els[BATCH_ELS_LEN];
+    const unsigned char *qs[BATCH_QUERIES];
+    bor_vptree_hamming_el_t *nn[BATCH_QUERIES * BATCH_NUM];
+    bor_vptree_hamming_el_t *nn2[BATCH_QUERIES * BATCH_NUM];
+    bor_vptree_hamming_el_t *nn3[BATCH_NUM];
+    size_t found[BATCH_QUERIES], found2[BATCH_QUERIES], len;
+    int i, j, d1, d2, d3;
+
+    rand = borRandMTNewAuto();
+    tp = borTaskPoolNew(3);
+    borTaskPoolRun(tp);
+
+    borVPTreeHammingParamsInit(&params);
+    params.size = BATCH_SIZE;
+    params.maxsize = 4;
+    vp = borVPTreeHammingNew(&params);
+
+    for (i = 0; i < BATCH_ELS_LEN; i++){
+        for (j = 0; j < BATCH_SIZE; j++)
+            keys[i][j] = borRandMTInt(rand);
+        borVPTreeHammingElInit(&els[i], keys[i]);
+        borVPTreeHammingAdd(vp, &els[i]);
+    }
+    for (i = 0; i < BATCH_QUERIES; i++){
+        for (j = 0; j < BATCH_SIZE; j++)
+            qkeys[i][j] = borRandMTInt(rand);
+        qs[i] = qkeys[i];
+    }
+
+    borVPTreeHammingNearestBatch(vp, qs, BATCH_QUERIES, BATCH_NUM,
+                                 nn, found, NULL);
+    borVPTreeHammingNearestBatch(vp, qs, BATCH_QUERIES, BATCH_NUM,
+                                 nn2, found2, tp);
+
+    for (i = 0; i < BATCH_QUERIES; i++){
+        len = borVPTreeHammingNearest(vp, qs[i], BATCH_NUM, nn3);
+        assertEquals(len, BATCH_NUM);
+        assertEquals(found[i], len);
+        assertEquals(found2[i], len);
+
+        for (j = 0; j < BATCH_NUM; j++){
+            d1 = hammingDistBytes(qs[i], nn[i * BATCH_NUM + j]->p, BATCH_SIZE);
+            d2 = hammingDistBytes(qs[i], nn2[i * BATCH_NUM + j]->p, BATCH_SIZE);
+            d3 = hammingDistBytes(qs[i], nn3[j]->p, BATCH_SIZE);
+            assertEquals(d1, d3);
+            assertEquals(d2, d3);
+        }
+
+        // compare with brute force search
+        d1 = BATCH_SIZE * 8;
+        for (j = 0; j < BATCH_ELS_LEN; j++){
+            d2 = hammingDistBytes(qs[i], keys[j], BATCH_SIZE);
+            d1 = BOR_MIN(d1, d2);
+        }
+        assertEquals(d1, hammingDistBytes(qs[i], nn3[0]->p, BATCH_SIZE));
+    }
+
+    // no nearest elements requested, nothing is found
+    borVPTreeHammingNearestBatch(vp, qs, BATCH_QUERIES, 0, nn, found, NULL);
+    for (i = 0; i < BATCH_QUERIES; i++)
+        assertEquals(found[i], 0);
+
+    borVPTreeHammingDel(vp);
+    borTaskPoolDel(tp);
+    borRandMTDel(rand);
+}
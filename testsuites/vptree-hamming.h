@@ -4,11 +4,16 @@
 
 TEST(vptreeHammingAdd);
 TEST(vptreeHammingAddRm);
+TEST(vptreeHammingDist);
+TEST(vptreeHammingBatch);
 
 TEST_SUITE(TSVPTreeHamming) {
     TEST_ADD(vptreeHammingAdd),
     TEST_ADD(vptreeHammingAddRm),
 
+    TEST_ADD(vptreeHammingDist),
+    TEST_ADD(vptreeHammingBatch),
+
     TEST_SUITE_CLOSURE
 };
 
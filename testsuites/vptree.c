@@ -277,3 +277,244 @@ TEST(vptreeAddRm)
 
     borRandMTDel(rand);
 }
+
+TEST(vptreeFreeze)
+{
+    bor_rand_mt_t *rand;
+    bor_vptree_t *vp;
+    bor_vptree_params_t params;
+    static bor_list_t els_list;
+    static int els_len = BUILD_ELS_LEN;
+    static el3_t els[BUILD_ELS_LEN];
+    int i, j, size;
+
+    rand = borRandMTNewAuto();
+
+    borListInit(&els_list);
+    for (i = 0; i < els_len; i++){
+        borVec3Set(&els[i].w, borRandMT(rand, -3, 3), borRandMT(rand, -3, 3), borRandMT(rand, -3, 3));
+        borVPTreeElInit(&els[i].el, (const bor_vec_t *)&els[i].w);
+        borListAppend(&els_list, &els[i].list);
+    }
+
+    for (size = 1; size < BUILD_MAXSIZE; size++){
+        borVPTreeParamsInit(&params);
+        params.dim = 3;
+        params.maxsize = size;
+        vp = borVPTreeBuild(&params, &els[0].el, els_len, sizeof(el3_t));
+        borVPTreeFreeze(vp);
+        assertTrue(borVPTreeFrozen(vp));
+
+        for (i = 0; i < BUILD_NUM_TESTS; i++){
+            for (j = 1; j <= BUILD_NUM_NNS; j++){
+                build3Test(rand, vp, &els_list, j);
+            }
+        }
+
+        // removing thaws the tree
+        for (i = size; i < els_len; i += 7){
+            borVPTreeRemove(vp, &els[i].el);
+            borListDel(&els[i].list);
+        }
+        assertFalse(borVPTreeFrozen(vp));
+
+        borVPTreeFreeze(vp);
+        for (i = 0; i < BUILD_NUM_TESTS; i++){
+            for (j = 1; j <= BUILD_NUM_NNS; j++){
+                build3Test(rand, vp, &els_list, j);
+            }
+        }
+
+        borVPTreeThaw(vp);
+        assertFalse(borVPTreeFrozen(vp));
+        for (i = 0; i < BUILD_NUM_TESTS; i++){
+            build3Test(rand, vp, &els_list, BUILD_NUM_NNS);
+        }
+        borVPTreeDel(vp);
+
+        // put removed elements back for the next round
+        for (i = size; i < els_len; i += 7)
+            borListAppend(&els_list, &els[i].list);
+    }
+
+    borRandMTDel(rand);
+}
+
+static void buildParCmp(const _bor_vptree_node_t *n1, const el3_t *els1,
+                        const _bor_vptree_node_t *n2, const el3_t *els2)
+{
+    bor_list_t *item1, *item2;
+    el3_t *el1, *el2;
+
+    assertEquals(!n1->left, !n2->left);
+    assertEquals(!n1->right, !n2->right);
+    assertEquals(n1->size, n2->size);
+
+    if (n1->left && n1->right && n2->left && n2->right){
+        assertTrue(borEq(n1->radius, n2->radius));
+        assertTrue(borVec3Eq((const bor_vec3_t *)n1->vp,
+                             (const bor_vec3_t *)n2->vp));
+        assertEquals(n2->left->parent, n2);
+        assertEquals(n2->right->parent, n2);
+        buildParCmp(n1->left, els1, n2->left, els2);
+        buildParCmp(n1->right, els1, n2->right, els2);
+
+    }else if (!n1->left && !n2->left){
+        item2 = n2->els.next;
+        BOR_LIST_FOR_EACH(&n1->els, item1){
+            el1 = BOR_LIST_ENTRY(item1, el3_t, el.list);
+            el2 = BOR_LIST_ENTRY(item2, el3_t, el.list);
+            assertEquals(el1 - els1, el2 - els2);
+            assertEquals(el2->el.node, n2);
+            item2 = item2->next;
+        }
+    }
+}
+
+TEST(vptreeBuildPar)
+{
+    bor_rand_mt_t *rand;
+    bor_vptree_t *vp, *vp2;
+    bor_vptree_params_t params;
+    bor_task_pool_t *tp;
+    static bor_list_t els_list;
+    static int els_len = BUILD_ELS_LEN;
+    static el3_t els[BUILD_ELS_LEN], els2[BUILD_ELS_LEN];
+    int i, j, parsize;
+
+    rand = borRandMTNewAuto();
+    tp = borTaskPoolNew(4);
+    borTaskPoolRun(tp);
+
+    borListInit(&els_list);
+    for (i = 0; i < els_len; i++){
+        borVec3Set(&els[i].w, borRandMT(rand, -3, 3), borRandMT(rand, -3, 3), borRandMT(rand, -3, 3));
+        borVPTreeElInit(&els[i].el, (const bor_vec_t *)&els[i].w);
+        borListAppend(&els_list, &els[i].list);
+
+        borVec3Copy(&els2[i].w, &els[i].w);
+        borVPTreeElInit(&els2[i].el, (const bor_vec_t *)&els2[i].w);
+    }
+
+    for (parsize = 10; parsize <= 100000; parsize *= 10){
+        borVPTreeParamsInit(&params);
+        params.dim = 3;
+        params.maxsize = 3;
+        params.seed = 1234 + parsize;
+        params.parsize = parsize;
+        vp = borVPTreeBuild(&params, &els[0].el, els_len, sizeof(el3_t));
+
+        // the same seed must give the same tree regardless of threads
+        params.tp = tp;
+        vp2 = borVPTreeBuild(&params, &els2[0].el, els_len, sizeof(el3_t));
+        buildParCmp(vp->root, els, vp2->root, els2);
+        borVPTreeDel(vp2);
+        borVPTreeDel(vp);
+
+        vp = borVPTreeBuild(&params, &els[0].el, els_len, sizeof(el3_t));
+        for (i = 0; i < BUILD_NUM_TESTS; i++){
+            for (j = 1; j <= BUILD_NUM_NNS; j++){
+                build3Test(rand, vp, &els_list, j);
+            }
+        }
+        borVPTreeDel(vp);
+    }
+
+    borTaskPoolDel(tp);
+    borRandMTDel(rand);
+}
+
+static void approxTest(bor_rand_mt_t *rand, bor_vptree_t *vp, size_t num)
+{
+    bor_vptree_el_t *nn[10], *nn2[10];
+    el3_t *el;
+    bor_vec3_t p;
+    bor_real_t d, d2, prev;
+    size_t len, len2, i;
+
+    borVec3Set(&p, borRandMT(rand, -3, 3), borRandMT(rand, -3, 3), borRandMT(rand, -3, 3));
+    vp->params.approx = 0;
+    len  = borVPTreeNearest(vp, (const bor_vec_t *)&p, num, nn);
+    len2 = borVPTreeNearestApprox(vp, (const bor_vec_t *)&p, num, nn2);
+    assertEquals(len, num);
+    assertTrue(len2 >= 1 && len2 <= num);
+
+    prev = BOR_ZERO;
+    for (i = 0; i < len2; i++){
+        el = bor_container_of(nn2[i], el3_t, el);
+        d2 = borVec3Dist(&p, &el->w);
+        assertTrue(d2 >= prev);
+        prev = d2;
+    }
+
+    el = bor_container_of(nn[0], el3_t, el);
+    d  = borVec3Dist(&p, &el->w);
+    el = bor_container_of(nn2[0], el3_t, el);
+    d2 = borVec3Dist(&p, &el->w);
+    assertTrue(d2 >= d);
+    if (vp->params.approx_leaves == 0){
+        assertTrue(d2 <= (BOR_ONE + vp->params.approx_eps) * d + BOR_EPS);
+    }
+
+    // .approx switches borVPTreeNearest() to approximate search
+    vp->params.approx = 1;
+    len = borVPTreeNearest(vp, (const bor_vec_t *)&p, num, nn);
+    assertEquals(len, len2);
+    for (i = 0; i < len && i < len2; i++)
+        assertEquals(nn[i], nn2[i]);
+}
+
+TEST(vptreeApprox)
+{
+    bor_rand_mt_t *rand;
+    bor_vptree_t *vp;
+    bor_vptree_params_t params;
+    static bor_list_t els_list;
+    static int els_len = BUILD_ELS_LEN;
+    static el3_t els[BUILD_ELS_LEN];
+    static const bor_real_t eps[] = { 0., 0.1, 0.5, 2. };
+    static const size_t leaves[] = { 0, 1, 5, 50 };
+    int i, j, e, l;
+
+    rand = borRandMTNewAuto();
+
+    borListInit(&els_list);
+    for (i = 0; i < els_len; i++){
+        borVec3Set(&els[i].w, borRandMT(rand, -3, 3), borRandMT(rand, -3, 3), borRandMT(rand, -3, 3));
+        borVPTreeElInit(&els[i].el, (const bor_vec_t *)&els[i].w);
+        borListAppend(&els_list, &els[i].list);
+    }
+
+    borVPTreeParamsInit(&params);
+    params.dim = 3;
+    params.maxsize = 4;
+    vp = borVPTreeBuild(&params, &els[0].el, els_len, sizeof(el3_t));
+
+    // without relaxation the approximate search is exact
+    vp->params.approx = 1;
+    for (i = 0; i < BUILD_NUM_TESTS; i++){
+        for (j = 1; j <= BUILD_NUM_NNS; j++){
+            build3Test(rand, vp, &els_list, j);
+        }
+    }
+
+    for (e = 0; e < sizeof(eps) / sizeof(bor_real_t); e++){
+        for (l = 0; l < sizeof(leaves) / sizeof(size_t); l++){
+            vp->params.approx_eps    = eps[e];
+            vp->params.approx_leaves = leaves[l];
+
+            for (i = 0; i < BUILD_NUM_TESTS / 10; i++){
+                approxTest(rand, vp, 1);
+                approxTest(rand, vp, BUILD_NUM_NNS);
+            }
+            borVPTreeFreeze(vp);
+            for (i = 0; i < BUILD_NUM_TESTS / 10; i++){
+                approxTest(rand, vp, BUILD_NUM_NNS);
+            }
+            borVPTreeThaw(vp);
+        }
+    }
+
+    borVPTreeDel(vp);
+    borRandMTDel(rand);
+}
@@ -4,16 +4,23 @@
 
 TEST(vptreeBuild2);
 TEST(vptreeBuild3);
+TEST(vptreeBuildPar);
 TEST(vptreeAdd);
 TEST(vptreeAddRm);
+TEST(vptreeFreeze);
+TEST(vptreeApprox);
 
 TEST_SUITE(TSVPTree) {
     TEST_ADD(vptreeBuild2),
     TEST_ADD(vptreeBuild3),
+    TEST_ADD(vptreeBuildPar),
 
     TEST_ADD(vptreeAdd),
     TEST_ADD(vptreeAddRm),
 
+    TEST_ADD(vptreeFreeze),
+    TEST_ADD(vptreeApprox),
+
     TEST_SUITE_CLOSURE
 };
 